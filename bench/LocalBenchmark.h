@@ -0,0 +1,82 @@
+#ifndef LOCAL_BENCHMARK_H
+#define LOCAL_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "../include/LocalBatch.h"
+#include "../include/LocalOperator.h"
+#include "../include/LocalSpool.h"
+
+// Helpers shared by the benchmarks: timing, generating batched input and running one operator to completion.
+
+namespace LocalBenchmark {
+
+    typedef std::vector<std::shared_ptr<const LocalBatch>> Batches;
+
+    // wall-clock seconds spent in f()
+    template<typename F>
+    double seconds(F f){
+        const auto begin = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    // rows rows cut into batches of batchSize; every batch starts from empty copies of layout
+    // and fill(columns, i) appends row i to them
+    template<typename F>
+    Batches makeBatches(size_t rows,const std::vector<LocalColumn>& layout,F fill,size_t batchSize = 4096){
+        Batches batches;
+        for(size_t begin = 0;begin < rows;begin += batchSize){
+            const size_t count = std::min(batchSize,rows - begin);
+            std::vector<LocalColumn> columns = layout;
+            for(size_t i = begin;i < begin + count;++i){
+                fill(columns,i);
+            }
+            std::shared_ptr<LocalBatch> batch = std::make_shared<LocalBatch>(count);
+            for(LocalColumn& column : columns){
+                batch->addColumn(std::move(column));
+            }
+            batches.push_back(batch);
+        }
+        return batches;
+    }
+
+    // queues every batch of inputs[i] on the operator's i-th input, runs it on this thread
+    // and hands each output batch to consume
+    template<typename F>
+    void runOperator(LocalOperator& op,const std::vector<Batches>& inputs,F consume){
+        std::vector<std::shared_ptr<LocalSpool>> spools;
+        for(size_t i = 0;i < inputs.size();++i){
+            spools.push_back(std::make_shared<LocalSpool>());
+            op.addInput(spools.back());
+        }
+        std::shared_ptr<LocalSpool> output = std::make_shared<LocalSpool>();
+        op.setOutput(output);
+        const int reader = output->subscribe();
+        for(size_t i = 0;i < inputs.size();++i){
+            for(const std::shared_ptr<const LocalBatch>& batch : inputs[i]){
+                spools[i]->push(batch);
+            }
+        }
+        for(const std::shared_ptr<LocalSpool>& spool : spools){
+            spool->close();
+        }
+        op.execute();
+        for(std::shared_ptr<const LocalBatch> batch = output->pop(reader);batch != nullptr;batch = output->pop(reader)){
+            consume(*batch);
+        }
+    }
+
+    // runOperator counting the output rows
+    inline size_t runOperator(LocalOperator& op,const std::vector<Batches>& inputs){
+        size_t rows = 0;
+        runOperator(op,inputs,[&](const LocalBatch& batch){ rows += batch.getRows(); });
+        return rows;
+    }
+
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/LocalFilterKernel.h"
+#include "LocalBenchmark.h"
+
+// Filter kernel throughput per predicate and column type, compared with row-at-a-time evaluation.
+// Usage: LocalFilterBenchmark [rows] [batch size]
+
+namespace {
+
+    struct Predicate{
+        std::string name;
+        std::string condition;
+        // bytes read per row from the columns the predicate touches
+        size_t bytesPerRow;
+    };
+
+    std::vector<std::shared_ptr<const LocalBatch>> makeBatches(size_t rows,size_t batchSize){
+        std::mt19937_64 random(42);
+        std::uniform_real_distribution<double> speed(0,160);
+        std::uniform_int_distribution<int64_t> rpm(600,6000);
+        std::uniform_int_distribution<int> vin(0,99),chance(0,99);
+        const std::vector<LocalColumn> layout = {
+            LocalColumn("speed",LocalType::DOUBLE),LocalColumn("speed_limit",LocalType::DOUBLE),LocalColumn("rpm",LocalType::INT),
+            LocalColumn("idle_rpm",LocalType::INT),LocalColumn("vin",LocalType::STRING),LocalColumn("gear",LocalType::INT)
+        };
+        return LocalBenchmark::makeBatches(rows,layout,[&](std::vector<LocalColumn>& columns,size_t){
+            columns[0].getDoubles().push_back(speed(random));
+            columns[1].getDoubles().push_back(80.0);
+            columns[2].getInts().push_back(rpm(random));
+            columns[3].getInts().push_back(800);
+            columns[4].getStrings().push_back("LVIN" + std::to_string(100000 + vin(random)));
+            // 5% of gear readings are missing
+            columns[5].append(chance(random) < 5 ? LocalValue() : LocalValue(static_cast<int64_t>(chance(random) % 6)));
+        },batchSize);
+    }
+
+    void report(const std::string& predicate,const std::string& mode,size_t rows,size_t bytes,size_t selected,double elapsed){
+        std::printf("%-22s %-8s %10.1f Mrows/s %8.2f GB/s %10zu rows selected\n",
+                    predicate.c_str(),mode.c_str(),rows / elapsed / 1e6,bytes / elapsed / 1e9,selected);
+    }
+
+}
+
+int main(int argc,char** argv){
+    const size_t rows = argc > 1 ? std::strtoull(argv[1],nullptr,10) : 4000000;
+    const size_t batchSize = argc > 2 ? std::strtoull(argv[2],nullptr,10) : 4096;
+    const std::vector<std::shared_ptr<const LocalBatch>> batches = makeBatches(rows,batchSize);
+    const std::vector<Predicate> predicates = {
+        {"int compare","rpm > 3000",8},
+        {"double compare","speed > 80",8},
+        {"string compare","vin = 'LVIN100042'",16},
+        {"int between","rpm between 1000 and 4000",8},
+        {"double between","speed between 60.5 and 90",8},
+        {"int in","rpm in (1000, 2000, 3000, 4000)",8},
+        {"string in","vin in ('LVIN100001', 'LVIN100002')",16},
+        {"is null","gear is null",1},
+        {"int column","rpm > idle_rpm",16},
+        {"double column","speed > speed_limit",16},
+        {"conjunction","speed > 80 and rpm between 1000 and 4000",16},
+        {"nullable compare","gear >= 3 or speed < 10",17}
+    };
+
+    std::printf("rows=%zu batch=%zu cpu=%s\n",rows,batchSize,LocalFilterKernel::toString(LocalFilterKernel::detect()).c_str());
+    std::vector<int64_t> selection;
+    for(const Predicate& predicate : predicates){
+        const std::shared_ptr<LocalExpression> condition = LocalExpression::parse(predicate.condition);
+        LocalFilterKernel kernel(condition,*batches.at(0));
+        const size_t bytes = rows * predicate.bytesPerRow;
+
+        size_t expected = 0;
+        const double rowElapsed = LocalBenchmark::seconds([&]{
+            for(auto& batch : batches){
+                for(size_t row = 0;row < batch->getRows();++row){
+                    expected += condition->evaluate(*batch,row).isTrue() ? 1 : 0;
+                }
+            }
+        });
+        report(predicate.name,"row",rows,bytes,expected,rowElapsed);
+
+        for(int set = 0;set <= static_cast<int>(LocalFilterKernel::detect());++set){
+            kernel.setInstructionSet(static_cast<LocalFilterKernel::InstructionSet>(set));
+            size_t selected = 0;
+            const double elapsed = LocalBenchmark::seconds([&]{
+                for(auto& batch : batches){
+                    kernel.select(*batch,selection);
+                    selected += selection.size();
+                }
+            });
+            report(predicate.name,LocalFilterKernel::toString(kernel.getInstructionSet()),rows,bytes,selected,elapsed);
+            if(selected != expected){
+                std::fprintf(stderr,"%s: kernel selected %zu rows, row evaluation %zu\n",predicate.name.c_str(),selected,expected);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
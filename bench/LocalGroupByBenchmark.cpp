@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/LocalAggregation.h"
+#include "../include/LocalGroupTable.h"
+#include "LocalBenchmark.h"
+
+// GroupBy throughput of the open-addressing group table against std::unordered_map, for integer and VIN keys.
+// Usage: LocalGroupByBenchmark [rows] [groups]
+
+namespace {
+
+    std::string vinOf(int64_t id){
+        std::string vin = std::to_string(id);
+        return "LVIN" + std::string(13 - vin.size(),'0') + vin;
+    }
+
+    std::vector<std::shared_ptr<const LocalBatch>> makeBatches(size_t rows,size_t groups){
+        std::mt19937_64 random(7);
+        std::uniform_int_distribution<int64_t> id(0,groups - 1);
+        std::uniform_real_distribution<double> speed(0,160);
+        return LocalBenchmark::makeBatches(rows,{LocalColumn("id",LocalType::INT),LocalColumn("vin",LocalType::STRING),LocalColumn("speed",LocalType::DOUBLE)},
+                                           [&](std::vector<LocalColumn>& columns,size_t){
+            const int64_t value = id(random);
+            columns[0].getInts().push_back(value);
+            columns[1].getStrings().push_back(vinOf(value));
+            columns[2].getDoubles().push_back(speed(random));
+        });
+    }
+
+    // the table plus sum/count/max states, as LocalGroupByOperator runs them
+    size_t runTable(const std::vector<std::shared_ptr<const LocalBatch>>& batches,const std::string& key,size_t& capacity){
+        LocalAggregation aggregation(key,key + ", sum(speed) as s, count(*) as n, max(speed) as m");
+        std::vector<LocalAggregate>& aggregates = aggregation.getAggregates();
+        LocalGroupTable table(aggregation.getKeys(),{key});
+        std::vector<LocalAggregate::States> states(aggregates.size());
+        std::vector<uint32_t> groups;
+        for(auto& batch : batches){
+            aggregation.bind(*batch);
+            table.lookup(*batch,groups);
+            for(size_t a = 0;a < aggregates.size();++a){
+                aggregates[a].resize(states[a],table.size());
+                aggregates[a].update(states[a],groups,*batch);
+            }
+        }
+        capacity = table.getCapacity();
+        return table.size();
+    }
+
+    // the previous row-at-a-time approach: a node-based map from the key to a group of row states
+    size_t runMap(const std::vector<std::shared_ptr<const LocalBatch>>& batches,const std::string& key){
+        LocalAggregation aggregation(key,key + ", sum(speed) as s, count(*) as n, max(speed) as m");
+        std::vector<LocalAggregate>& aggregates = aggregation.getAggregates();
+        std::unordered_map<std::string, size_t> groups;
+        std::vector<std::vector<LocalAggregate::State>> states;
+        for(auto& batch : batches){
+            aggregation.bind(*batch);
+            for(size_t row = 0;row < batch->getRows();++row){
+                const std::string serialized = aggregation.getKeys()[0]->evaluate(*batch,row).toString();
+                auto iter = groups.emplace(serialized,states.size()).first;
+                if(iter->second == states.size()){
+                    states.emplace_back(aggregates.size());
+                }
+                for(size_t a = 0;a < aggregates.size();++a){
+                    aggregates[a].update(states[iter->second][a],*batch,row);
+                }
+            }
+        }
+        return states.size();
+    }
+
+}
+
+int main(int argc,char** argv){
+    const size_t rows = argc > 1 ? std::strtoull(argv[1],nullptr,10) : 5000000;
+    const size_t groups = argc > 2 ? std::strtoull(argv[2],nullptr,10) : 1000000;
+    const std::vector<std::shared_ptr<const LocalBatch>> batches = makeBatches(rows,groups);
+    std::printf("rows=%zu groups=%zu\n",rows,groups);
+    for(const std::string key : {"id","vin"}){
+        size_t tableGroups = 0,mapGroups = 0,capacity = 0;
+        const double table = LocalBenchmark::seconds([&]{ tableGroups = runTable(batches,key,capacity); });
+        const double map = LocalBenchmark::seconds([&]{ mapGroups = runMap(batches,key); });
+        std::printf("%-4s table %8.1f Mrows/s %10zu groups %6.1f slot bytes/group\n",key.c_str(),rows / table / 1e6,tableGroups,capacity * 8.0 / tableGroups);
+        std::printf("%-4s map   %8.1f Mrows/s %10zu groups\n",key.c_str(),rows / map / 1e6,mapGroups);
+        if(tableGroups != mapGroups){
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/LocalRadixHashTable.h"
+#include "LocalBenchmark.h"
+
+// Hash join on integer keys: the radix-partitioned table, the same table with a single partition,
+// and a naive std::unordered_multimap join.
+// Usage: LocalHashJoinBenchmark [build rows] [probe rows] [probe batch]
+
+namespace {
+
+    std::vector<LocalColumn> makeColumns(size_t rows,size_t batch,int64_t range,uint64_t seed){
+        std::mt19937_64 random(seed);
+        std::uniform_int_distribution<int64_t> key(0,range - 1);
+        std::vector<LocalColumn> columns;
+        for(size_t begin = 0;begin < rows;begin += batch){
+            LocalColumn column("id",LocalType::INT);
+            for(size_t i = begin;i < std::min(rows,begin + batch);++i){
+                column.getInts().push_back(key(random));
+            }
+            columns.push_back(std::move(column));
+        }
+        return columns;
+    }
+
+    void report(const char* name,size_t buildRows,double build,size_t probeRows,double probe,size_t pairs,size_t partitions){
+        std::printf("%-12s build %8.1f Mrows/s  probe %8.1f Mrows/s  %12zu pairs  %6zu partitions\n",
+                    name,buildRows / build / 1e6,probeRows / probe / 1e6,pairs,partitions);
+    }
+
+}
+
+int main(int argc,char** argv){
+    const size_t buildRows = argc > 1 ? std::strtoull(argv[1],nullptr,10) : 1000000;
+    const size_t probeRows = argc > 2 ? std::strtoull(argv[2],nullptr,10) : 10000000;
+    const size_t probeBatch = argc > 3 ? std::strtoull(argv[3],nullptr,10) : 4096;
+    // build keys have duplicates, about half of the probe keys find a match
+    const LocalColumn build = makeColumns(buildRows,buildRows,buildRows,1).at(0);
+    const std::vector<LocalColumn> probes = makeColumns(probeRows,probeBatch,2 * buildRows,2);
+    std::printf("build=%zu probe=%zu batch=%zu partition=%zuKB\n",buildRows,probeRows,probeBatch,LocalRadixHashTable::defaultPartitionBytes() / 1024);
+
+    size_t expected = 0;
+    for(size_t partitionBytes : {LocalRadixHashTable::defaultPartitionBytes(),std::numeric_limits<size_t>::max()}){
+        LocalRadixHashTable table(partitionBytes);
+        const double buildTime = LocalBenchmark::seconds([&]{ table.build({&build}); });
+        size_t pairs = 0;
+        std::vector<int64_t> leftRows,rightRows;
+        const double probeTime = LocalBenchmark::seconds([&]{
+            for(const LocalColumn& probe : probes){
+                leftRows.clear();
+                rightRows.clear();
+                table.probe({&probe},leftRows,rightRows);
+                pairs += leftRows.size();
+            }
+        });
+        report(table.getPartitionCount() > 1 ? "radix" : "unpartitioned",buildRows,buildTime,probeRows,probeTime,pairs,table.getPartitionCount());
+        expected = pairs;
+    }
+
+    std::unordered_multimap<int64_t, int64_t> map;
+    const double buildTime = LocalBenchmark::seconds([&]{
+        map.reserve(buildRows);
+        for(size_t row = 0;row < buildRows;++row){
+            map.emplace(build.getInts()[row],row);
+        }
+    });
+    size_t pairs = 0;
+    std::vector<int64_t> leftRows,rightRows;
+    const double probeTime = LocalBenchmark::seconds([&]{
+        for(const LocalColumn& probe : probes){
+            leftRows.clear();
+            rightRows.clear();
+            for(size_t row = 0;row < probe.size();++row){
+                auto range = map.equal_range(probe.getInts()[row]);
+                for(auto iter = range.first;iter != range.second;++iter){
+                    leftRows.push_back(row);
+                    rightRows.push_back(iter->second);
+                }
+            }
+            pairs += leftRows.size();
+        }
+    });
+    report("multimap",buildRows,buildTime,probeRows,probeTime,pairs,1);
+    return pairs == expected ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/LocalExpression.h"
+#include "../include/LocalNestedJoinOperator.h"
+#include "LocalBenchmark.h"
+
+// Band join without equality keys: the block nested-loop NestedJoin on one thread and on every core,
+// against evaluating the condition row by row on each materialized pair.
+// Usage: LocalNestedJoinBenchmark [left rows] [right rows]
+
+namespace {
+
+    const std::string CONDITION = "x.ts BETWEEN y.begin AND y.end AND x.speed > y.limit";
+
+    std::vector<std::shared_ptr<const LocalBatch>> makeLeft(size_t rows){
+        std::mt19937_64 random(11);
+        std::uniform_int_distribution<int64_t> ts(0,1000000);
+        std::uniform_real_distribution<double> speed(0,160);
+        return LocalBenchmark::makeBatches(rows,{LocalColumn("ts",LocalType::INT),LocalColumn("speed",LocalType::DOUBLE)},
+                                           [&](std::vector<LocalColumn>& columns,size_t){
+            columns[0].getInts().push_back(ts(random));
+            columns[1].getDoubles().push_back(speed(random));
+        });
+    }
+
+    std::shared_ptr<const LocalBatch> makeRight(size_t rows){
+        std::mt19937_64 random(13);
+        std::uniform_int_distribution<int64_t> ts(0,1000000),width(0,20000);
+        std::uniform_real_distribution<double> limit(60,160);
+        LocalColumn begins("begin",LocalType::INT),ends("end",LocalType::INT),limits("limit",LocalType::DOUBLE);
+        for(size_t i = 0;i < rows;++i){
+            const int64_t begin = ts(random);
+            begins.getInts().push_back(begin);
+            ends.getInts().push_back(begin + width(random));
+            limits.getDoubles().push_back(limit(random));
+        }
+        std::shared_ptr<LocalBatch> batch = std::make_shared<LocalBatch>(rows);
+        batch->addColumn(std::move(begins));
+        batch->addColumn(std::move(ends));
+        batch->addColumn(std::move(limits));
+        return batch;
+    }
+
+    size_t runOperator(const std::vector<std::shared_ptr<const LocalBatch>>& left,const std::shared_ptr<const LocalBatch>& right,size_t threads){
+        LocalNestedJoinOperator join(LocalStepDefinition::parse("NestedJoin?input=s_1,input2=s_2,output=s_3(join_type=`inner`,left_alias=`x`,right_alias=`y`,condition=`" +
+                                                                CONDITION + "`)"));
+        join.setThreads(threads);
+        return LocalBenchmark::runOperator(join,{left,{right}});
+    }
+
+    // the previous approach: every pair materialized with all columns, then the condition evaluated row by row
+    size_t runRowByRow(const std::vector<std::shared_ptr<const LocalBatch>>& left,const std::shared_ptr<const LocalBatch>& right){
+        std::shared_ptr<LocalExpression> condition = LocalExpression::parse(CONDITION);
+        size_t pairs = 0;
+        std::vector<int64_t> leftRows,rightRows;
+        const auto check = [&](const LocalBatch& batch){
+            std::shared_ptr<LocalBatch> combined = std::make_shared<LocalBatch>(leftRows.size());
+            for(const LocalColumn& column : batch.getColumns()){
+                LocalColumn selected = column.select(leftRows);
+                selected.setName("x." + column.getName());
+                combined->addColumn(std::move(selected));
+            }
+            for(const LocalColumn& column : right->getColumns()){
+                LocalColumn selected = column.select(rightRows);
+                selected.setName("y." + column.getName());
+                combined->addColumn(std::move(selected));
+            }
+            condition->bind(*combined);
+            for(size_t i = 0;i < combined->getRows();++i){
+                pairs += condition->evaluate(*combined,i).isTrue() ? 1 : 0;
+            }
+            leftRows.clear();
+            rightRows.clear();
+        };
+        for(auto& batch : left){
+            for(size_t row = 0;row < batch->getRows();++row){
+                for(size_t other = 0;other < right->getRows();++other){
+                    leftRows.push_back(row);
+                    rightRows.push_back(other);
+                    if(leftRows.size() == 4096){
+                        check(*batch);
+                    }
+                }
+            }
+            check(*batch);
+        }
+        return pairs;
+    }
+
+}
+
+int main(int argc,char** argv){
+    const size_t leftCount = argc > 1 ? std::strtoull(argv[1],nullptr,10) : 20000;
+    const size_t rightCount = argc > 2 ? std::strtoull(argv[2],nullptr,10) : 2000;
+    const std::vector<std::shared_ptr<const LocalBatch>> left = makeLeft(leftCount);
+    const std::shared_ptr<const LocalBatch> right = makeRight(rightCount);
+    const double total = static_cast<double>(leftCount) * rightCount;
+    const size_t cores = std::max(1u,std::thread::hardware_concurrency());
+    std::printf("left=%zu right=%zu cores=%zu\n",leftCount,rightCount,cores);
+
+    size_t single = 0,parallel = 0,rows = 0;
+    // warm up the allocator so the first timed run is not charged for growing the heap
+    runOperator(left,right,1);
+    const double singleTime = LocalBenchmark::seconds([&]{ single = runOperator(left,right,1); });
+    const double parallelTime = LocalBenchmark::seconds([&]{ parallel = runOperator(left,right,cores); });
+    const double rowTime = LocalBenchmark::seconds([&]{ rows = runRowByRow(left,right); });
+    std::printf("block x1      %8.1f Mpairs/s %10zu matches\n",total / singleTime / 1e6,single);
+    std::printf("block x%-5zu  %8.1f Mpairs/s %10zu matches\n",cores,total / parallelTime / 1e6,parallel);
+    std::printf("row by row    %8.1f Mpairs/s %10zu matches\n",total / rowTime / 1e6,rows);
+    return single == rows && parallel == rows ? 0 : 1;
+}
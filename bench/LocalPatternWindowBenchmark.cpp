@@ -0,0 +1,114 @@
+#include <malloc.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/LocalExpression.h"
+#include "../include/LocalPatternWindowOperator.h"
+#include "LocalBenchmark.h"
+
+// PatternWindow over a fleet of vehicles: a window opens when the speed goes above 100 and closes when it drops below 40,
+// emitting the length, average, peak speed and start time of every closed window.
+// The flat per-key state machine against a hash map of per-vehicle objects evaluating the conditions row by row;
+// heap bytes are measured with mallinfo2 while the state is alive.
+// Usage: LocalPatternWindowBenchmark [events] [vehicles]
+
+namespace {
+
+    const std::string SELECTS = "vin, wsize() as n, wavg('speed') as a, wmax('speed') as peak, wlead('ts') as since";
+
+    // large arrays are mmapped and only show up in hblkhd
+    size_t heap(){
+        const struct mallinfo2 info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+    }
+
+    std::vector<std::shared_ptr<const LocalBatch>> makeEvents(size_t events,size_t vehicles){
+        std::mt19937_64 random(17);
+        std::uniform_real_distribution<double> speed(0,160);
+        return LocalBenchmark::makeBatches(events,{LocalColumn("ts",LocalType::INT),LocalColumn("vin",LocalType::INT),LocalColumn("speed",LocalType::DOUBLE)},
+                                           [&](std::vector<LocalColumn>& columns,size_t i){
+            columns[0].getInts().push_back(static_cast<int64_t>(i));
+            columns[1].getInts().push_back(static_cast<int64_t>(i * 7919 % vehicles));
+            columns[2].getDoubles().push_back(speed(random));
+        });
+    }
+
+    size_t runFlat(const std::vector<std::shared_ptr<const LocalBatch>>& events,size_t& bytes,size_t& perKey){
+        const size_t before = heap();
+        LocalPatternWindowOperator pattern(LocalStepDefinition::parse("PatternWindow?input=s_1,output=s_2(enter=`speed > 100`,exit=`speed < 40`,keys=`vin`,selects=`" +
+                                                                      SELECTS + "`)"));
+        const size_t windows = LocalBenchmark::runOperator(pattern,{events});
+        bytes = heap() - before;
+        perKey = pattern.getStateBytesPerKey();
+        return windows;
+    }
+
+    // one heap object per vehicle, as a map-of-objects implementation would keep it
+    struct Vehicle{
+        bool open = false;
+        int64_t size = 0;
+        LocalValue sum;
+        LocalValue peak;
+        LocalValue since;
+    };
+
+    size_t runObjects(const std::vector<std::shared_ptr<const LocalBatch>>& events,size_t& bytes){
+        const size_t before = heap();
+        std::shared_ptr<LocalExpression> enter = LocalExpression::parse("speed > 100"),exit = LocalExpression::parse("speed < 40");
+        std::unordered_map<int64_t, std::unique_ptr<Vehicle>> vehicles;
+        size_t windows = 0;
+        for(auto& batch : events){
+            enter->bind(*batch);
+            exit->bind(*batch);
+            const LocalColumn& vins = batch->getColumn(1);
+            const LocalColumn& speeds = batch->getColumn(2);
+            for(size_t row = 0;row < batch->getRows();++row){
+                std::unique_ptr<Vehicle>& vehicle = vehicles[vins.getInts()[row]];
+                if(vehicle == nullptr){
+                    vehicle.reset(new Vehicle());
+                }
+                if(!vehicle->open){
+                    if(!enter->evaluate(*batch,row).isTrue()){
+                        continue;
+                    }
+                    *vehicle = Vehicle();
+                    vehicle->open = true;
+                    vehicle->since = batch->getColumn(0).get(row);
+                }
+                const LocalValue speed = speeds.get(row);
+                vehicle->size++;
+                vehicle->sum = vehicle->sum.isNull() ? speed : LocalValue(vehicle->sum.asDouble() + speed.asDouble());
+                vehicle->peak = vehicle->peak.isNull() || LocalValue::compare(speed,vehicle->peak) > 0 ? speed : vehicle->peak;
+                if(exit->evaluate(*batch,row).isTrue()){
+                    vehicle->open = false;
+                    windows++;
+                }
+            }
+        }
+        bytes = heap() - before;
+        return windows;
+    }
+
+}
+
+int main(int argc,char** argv){
+    const size_t events = argc > 1 ? std::strtoull(argv[1],nullptr,10) : 4000000;
+    const size_t vehicles = argc > 2 ? std::strtoull(argv[2],nullptr,10) : 1000000;
+    const std::vector<std::shared_ptr<const LocalBatch>> batches = makeEvents(events,vehicles);
+    std::printf("events=%zu vehicles=%zu\n",events,vehicles);
+
+    size_t flat = 0,objects = 0,flatBytes = 0,objectBytes = 0,perKey = 0;
+    const double fast = LocalBenchmark::seconds([&]{ flat = runFlat(batches,flatBytes,perKey); });
+    const double slow = LocalBenchmark::seconds([&]{ objects = runObjects(batches,objectBytes); });
+    std::printf("flat     %8.2f Mevents/s %8zu windows %6.1f heap bytes/vehicle (%zu bytes of window state)\n",
+                events / fast / 1e6,flat,static_cast<double>(flatBytes) / vehicles,perKey);
+    std::printf("objects  %8.2f Mevents/s %8zu windows %6.1f heap bytes/vehicle\n",events / slow / 1e6,objects,static_cast<double>(objectBytes) / vehicles);
+    return flat == objects ? 0 : 1;
+}
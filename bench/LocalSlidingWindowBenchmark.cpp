@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/LocalSlidingWindowOperator.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "LocalBenchmark.h"
+
+// SlidingWindow over the last N rows of each of 8 keys with sum / avg / min / max of one column:
+// the incremental operator (subtract-on-evict and two-stacks) against recomputing every window from scratch.
+// Usage: LocalSlidingWindowBenchmark [events] [window rows]
+
+namespace {
+
+    const std::string SELECTS = "k, wsum('speed') as s, wavg('speed') as a, wmin('speed') as lo, wmax('speed') as hi";
+
+    std::vector<std::shared_ptr<const LocalBatch>> makeEvents(size_t events){
+        std::mt19937_64 random(17);
+        std::uniform_real_distribution<double> speed(0,160);
+        return LocalBenchmark::makeBatches(events,{LocalColumn("k",LocalType::INT),LocalColumn("speed",LocalType::DOUBLE)},
+                                           [&](std::vector<LocalColumn>& columns,size_t i){
+            columns[0].getInts().push_back(static_cast<int64_t>(i % 8));
+            columns[1].getDoubles().push_back(speed(random));
+        });
+    }
+
+    double runIncremental(const std::vector<std::shared_ptr<const LocalBatch>>& events,size_t rows){
+        LocalSlidingWindowOperator window(LocalStepDefinition::parse("SlidingWindow?input=s_1,output=s_2(inclusion=`" + std::to_string(rows) + "`,keys=`k`,selects=`" +
+                                                                     SELECTS + "`,aggregations=`" + SqlSyntaxUtils::getWindowAggregations(SELECTS) + "`)"));
+        double checksum = 0;
+        LocalBenchmark::runOperator(window,{events},[&](const LocalBatch& batch){
+            for(size_t row = 0;row < batch.getRows();++row){
+                checksum += batch.getColumn(2).get(row).asDouble() + batch.getColumn(4).get(row).asDouble() - batch.getColumn(3).get(row).asDouble();
+            }
+        });
+        return checksum;
+    }
+
+    double runRecompute(const std::vector<std::shared_ptr<const LocalBatch>>& events,size_t rows){
+        std::vector<std::deque<double>> windows(8);
+        double checksum = 0;
+        for(auto& batch : events){
+            const LocalColumn& keys = batch->getColumn(0);
+            const LocalColumn& speeds = batch->getColumn(1);
+            for(size_t row = 0;row < batch->getRows();++row){
+                std::deque<double>& window = windows[keys.getInts()[row]];
+                window.push_back(speeds.getDoubles()[row]);
+                if(window.size() > rows){
+                    window.pop_front();
+                }
+                double sum = 0,lo = window.front(),hi = window.front();
+                for(double value : window){
+                    sum += value;
+                    lo = std::min(lo,value);
+                    hi = std::max(hi,value);
+                }
+                checksum += sum / window.size() + hi - lo;
+            }
+        }
+        return checksum;
+    }
+
+}
+
+int main(int argc,char** argv){
+    const size_t events = argc > 1 ? std::strtoull(argv[1],nullptr,10) : 1000000;
+    const size_t rows = argc > 2 ? std::strtoull(argv[2],nullptr,10) : 1000;
+    const std::vector<std::shared_ptr<const LocalBatch>> batches = makeEvents(events);
+    std::printf("events=%zu keys=8 window=%zu rows, sum / avg / min / max\n",events,rows);
+
+    double incremental = 0,recomputed = 0;
+    const double fast = LocalBenchmark::seconds([&]{ incremental = runIncremental(batches,rows); });
+    const double slow = LocalBenchmark::seconds([&]{ recomputed = runRecompute(batches,rows); });
+    std::printf("incremental %8.2f Mevents/s\n",events / fast / 1e6);
+    std::printf("recompute   %8.2f Mevents/s\n",events / slow / 1e6);
+    // subtract-on-evict rounds differently from summing each window afresh
+    return std::abs(incremental - recomputed) <= 1e-6 * std::abs(recomputed) ? 0 : 1;
+}
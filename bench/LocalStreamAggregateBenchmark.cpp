@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/LocalAggregation.h"
+#include "../include/LocalStreamAggregateOperator.h"
+#include "LocalBenchmark.h"
+
+// StreamAggregate over an event stream at 1M events per second of event time, EVERY 1 SECOND with 10 aggregates:
+// the streaming ring-buffer operator against the previous approach of buffering every bucket in a std::map
+// and accumulating row by row until the input ends.
+// Usage: LocalStreamAggregateBenchmark [events] [events per second]
+
+namespace {
+
+    const std::string SELECTS = "count(*) as n, sum(speed) as s, avg(speed) as a, min(speed) as lo, max(speed) as hi, "
+                                "sum(rpm) as rs, avg(rpm) as ra, min(rpm) as rlo, max(rpm) as rhi, last(rpm) as rl";
+
+    std::vector<std::shared_ptr<const LocalBatch>> makeEvents(size_t events,size_t rate){
+        std::mt19937_64 random(17);
+        std::uniform_real_distribution<double> speed(0,160);
+        std::uniform_int_distribution<int64_t> rpm(700,6000);
+        return LocalBenchmark::makeBatches(events,{LocalColumn("ts",LocalType::INT),LocalColumn("speed",LocalType::DOUBLE),LocalColumn("rpm",LocalType::INT)},
+                                           [&](std::vector<LocalColumn>& columns,size_t i){
+            columns[0].getInts().push_back(static_cast<int64_t>(i * 1000 / rate));
+            columns[1].getDoubles().push_back(speed(random));
+            columns[2].getInts().push_back(rpm(random));
+        });
+    }
+
+    size_t runStreaming(const std::vector<std::shared_ptr<const LocalBatch>>& events,size_t& capacity){
+        LocalStreamAggregateOperator aggregate(LocalStepDefinition::parse("StreamAggregate?input=s_1,output=s_2(interval=`1`,time=`ts`,time_unit=`second`,selects=`" +
+                                                                          SELECTS + "`)"),SELECTS,false);
+        const size_t buckets = LocalBenchmark::runOperator(aggregate,{events});
+        capacity = aggregate.getCapacity();
+        return buckets;
+    }
+
+    size_t runBuffered(const std::vector<std::shared_ptr<const LocalBatch>>& events){
+        LocalAggregation aggregation("",SELECTS);
+        std::vector<LocalAggregate>& aggregates = aggregation.getAggregates();
+        std::shared_ptr<LocalExpression> time = LocalExpression::parse("ts");
+        std::map<int64_t, std::vector<LocalAggregate::State>> buckets;
+        for(auto& batch : events){
+            aggregation.bind(*batch);
+            time->bind(*batch);
+            for(size_t row = 0;row < batch->getRows();++row){
+                const int64_t bucket = time->evaluate(*batch,row).asInt() / 1000;
+                auto iter = buckets.find(bucket);
+                if(iter == buckets.end()){
+                    iter = buckets.emplace(bucket,std::vector<LocalAggregate::State>(aggregates.size())).first;
+                }
+                for(size_t a = 0;a < aggregates.size();++a){
+                    aggregates[a].update(iter->second[a],*batch,row);
+                }
+            }
+        }
+        size_t checksum = 0;
+        for(auto& bucket : buckets){
+            for(size_t a = 0;a < aggregates.size();++a){
+                checksum += aggregates[a].result(bucket.second[a]).isNull() ? 0 : 1;
+            }
+        }
+        return checksum == buckets.size() * aggregates.size() ? buckets.size() : 0;
+    }
+
+}
+
+int main(int argc,char** argv){
+    const size_t events = argc > 1 ? std::strtoull(argv[1],nullptr,10) : 10000000;
+    const size_t rate = argc > 2 ? std::strtoull(argv[2],nullptr,10) : 1000000;
+    const std::vector<std::shared_ptr<const LocalBatch>> batches = makeEvents(events,rate);
+    std::printf("events=%zu rate=%zu/s aggregates=10 every 1 second\n",events,rate);
+
+    size_t streamed = 0,buffered = 0,capacity = 0;
+    const double streaming = LocalBenchmark::seconds([&]{ streamed = runStreaming(batches,capacity); });
+    const double map = LocalBenchmark::seconds([&]{ buffered = runBuffered(batches); });
+    std::printf("streaming %8.2f Mevents/s %6zu buckets %4zu open slots  %6.1fx real time\n",events / streaming / 1e6,streamed,capacity,events / streaming / rate);
+    std::printf("buffered  %8.2f Mevents/s %6zu buckets\n",events / map / 1e6,buffered);
+    return streamed == buffered ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/LocalTumblingWindowOperator.h"
+#include "LocalBenchmark.h"
+
+// TumblingWindow over a fleet of vehicles: every vehicle's readings fall into windows of 16 rows,
+// emitting the count, average and peak speed and start time of every window.
+// The flat per-key slots reset in place, on one thread and on every hardware thread, against a hash map that
+// allocates a fresh per-vehicle window object whenever a window closes.
+// Usage: LocalTumblingWindowBenchmark [events] [vehicles]
+
+namespace {
+
+    const std::string SELECTS = "vin, wsize() as n, wavg('speed') as a, wmax('speed') as peak, wlead('ts') as since";
+
+    std::vector<std::shared_ptr<const LocalBatch>> makeEvents(size_t events,size_t vehicles){
+        std::mt19937_64 random(17);
+        std::uniform_real_distribution<double> speed(0,160);
+        return LocalBenchmark::makeBatches(events,{LocalColumn("ts",LocalType::INT),LocalColumn("vin",LocalType::INT),LocalColumn("speed",LocalType::DOUBLE)},
+                                           [&](std::vector<LocalColumn>& columns,size_t i){
+            columns[0].getInts().push_back(static_cast<int64_t>(i));
+            columns[1].getInts().push_back(static_cast<int64_t>(i * 7919 % vehicles));
+            columns[2].getDoubles().push_back(speed(random));
+        });
+    }
+
+    size_t runFlat(const std::vector<std::shared_ptr<const LocalBatch>>& events,size_t threads){
+        LocalTumblingWindowOperator tumbling(LocalStepDefinition::parse("TumblingWindow?input=s_1,output=s_2(inclusion=`16`,keys=`vin`,selects=`" + SELECTS + "`)"));
+        tumbling.setThreads(threads);
+        return LocalBenchmark::runOperator(tumbling,{events});
+    }
+
+    // one heap object per open window, replaced when the window closes
+    struct Window{
+        int64_t size = 0;
+        int64_t count = 0;
+        LocalValue sum;
+        LocalValue peak;
+        LocalValue since;
+    };
+
+    size_t runObjects(const std::vector<std::shared_ptr<const LocalBatch>>& events){
+        std::unordered_map<int64_t, std::unique_ptr<Window>> vehicles;
+        size_t windows = 0;
+        for(auto& batch : events){
+            const LocalColumn& ts = batch->getColumn(0);
+            const LocalColumn& vins = batch->getColumn(1);
+            const LocalColumn& speeds = batch->getColumn(2);
+            for(size_t row = 0;row < batch->getRows();++row){
+                std::unique_ptr<Window>& window = vehicles[vins.getInts()[row]];
+                if(window == nullptr){
+                    window.reset(new Window());
+                    window->since = ts.get(row);
+                }
+                const LocalValue speed = speeds.get(row);
+                window->size++;
+                window->count++;
+                window->sum = window->sum.isNull() ? speed : LocalValue(window->sum.asDouble() + speed.asDouble());
+                window->peak = window->peak.isNull() || LocalValue::compare(speed,window->peak) > 0 ? speed : window->peak;
+                if(window->size == 16){
+                    window.reset();
+                    windows++;
+                }
+            }
+        }
+        for(auto& vehicle : vehicles){
+            windows += vehicle.second != nullptr;
+        }
+        return windows;
+    }
+
+}
+
+int main(int argc,char** argv){
+    const size_t events = argc > 1 ? std::strtoull(argv[1],nullptr,10) : 4000000;
+    const size_t vehicles = argc > 2 ? std::strtoull(argv[2],nullptr,10) : 100000;
+    const size_t threads = std::max(1u,std::thread::hardware_concurrency());
+    const std::vector<std::shared_ptr<const LocalBatch>> batches = makeEvents(events,vehicles);
+    std::printf("events=%zu vehicles=%zu threads=%zu\n",events,vehicles,threads);
+
+    size_t single = 0,parallel = 0,objects = 0;
+    const double one = LocalBenchmark::seconds([&]{ single = runFlat(batches,1); });
+    const double all = LocalBenchmark::seconds([&]{ parallel = runFlat(batches,threads); });
+    const double slow = LocalBenchmark::seconds([&]{ objects = runObjects(batches); });
+    std::printf("flat x1  %8.2f Mevents/s %8zu windows\n",events / one / 1e6,single);
+    std::printf("flat x%-2zu %8.2f Mevents/s %8zu windows\n",threads,events / all / 1e6,parallel);
+    std::printf("objects  %8.2f Mevents/s %8zu windows\n",events / slow / 1e6,objects);
+    return single == objects && parallel == objects ? 0 : 1;
+}
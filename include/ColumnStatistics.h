@@ -0,0 +1,60 @@
+#ifndef COLUMN_STATISTICS_H
+#define COLUMN_STATISTICS_H
+
+/**
+ * 单列统计信息。未知的数值用负数表示，min/max 只对数值列有效。
+ */
+class ColumnStatistics {
+    private:
+        double distinctCount = -1;
+        double minValue = 0;
+        double maxValue = 0;
+        bool hasRange = false;
+        double nullFraction = -1;
+        double width = -1;
+
+    public:
+        double getDistinctCount() const {
+            return distinctCount;
+        }
+
+        void setDistinctCount(double distinctCount){
+            this->distinctCount = distinctCount;
+        }
+
+        bool hasMinMax() const {
+            return hasRange;
+        }
+
+        double getMin() const {
+            return minValue;
+        }
+
+        double getMax() const {
+            return maxValue;
+        }
+
+        void setMinMax(double minValue,double maxValue){
+            this->minValue = minValue;
+            this->maxValue = maxValue;
+            this->hasRange = true;
+        }
+
+        double getNullFraction() const {
+            return nullFraction;
+        }
+
+        void setNullFraction(double nullFraction){
+            this->nullFraction = nullFraction;
+        }
+
+        double getWidth() const {
+            return width;
+        }
+
+        void setWidth(double width){
+            this->width = width;
+        }
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef LOCAL_AGGREGATE_H
+#define LOCAL_AGGREGATE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "LocalBatch.h"
+#include "LocalExpression.h"
+#include "LocalValue.h"
+
+/**
+ * 一个聚合函数调用（count、sum、avg、min、max、first、last、stddev、variance、median）的逐行累加。
+ * 除 count(*) 外空值不参与聚合，没有参与聚合的值时 count 为 0，其余为空值。
+ */
+class LocalAggregate {
+    public:
+        /**
+         * 一个分组上的累加状态。
+         */
+        struct State{
+            int64_t count = 0;
+            int64_t intSum = 0;
+            double sum = 0;
+            double squares = 0;
+            bool integral = true;
+            LocalValue min;
+            LocalValue max;
+            LocalValue first;
+            LocalValue last;
+            std::vector<double> values;
+            std::unordered_set<std::string> seen;
+        };
+
+        /**
+         * 全部分组的累加状态，按分组编号存放在连续的数组中，只使用聚合函数需要的数组。
+         * median 与 distinct 需要保存取值，仍按分组使用 State。
+         */
+        struct States{
+            std::vector<int64_t> counts;
+            std::vector<int64_t> intSums;
+            std::vector<double> sums;
+            std::vector<double> squares;
+            std::vector<uint8_t> integral;
+            // min、max、first、last 的取值，按 type 只使用一个数组
+            LocalType type = LocalType::INT;
+            std::vector<int64_t> ints;
+            std::vector<double> doubles;
+            std::vector<std::string> strings;
+            std::vector<State> rows;
+        };
+
+    private:
+        // 按列累加时的方式
+        enum class Family{ COUNT, SUM, VALUE, ROW };
+
+        std::string function;
+        Family family = Family::ROW;
+        // count(*) 时为空
+        std::shared_ptr<LocalExpression> argument;
+        bool distinct = false;
+
+    public:
+        /**
+         * call 为聚合函数调用的表达式，参数不是一个时抛出 EngineException。
+         */
+        explicit LocalAggregate(const std::shared_ptr<LocalExpression>& call);
+
+        const std::string& getFunction() const {
+            return function;
+        }
+
+        const std::shared_ptr<LocalExpression>& getArgument() const {
+            return argument;
+        }
+
+        bool isDistinct() const {
+            return distinct;
+        }
+
+        void bind(const LocalBatch& batch);
+
+        void update(State& state,const LocalBatch& batch,size_t row) const;
+
+        LocalValue result(const State& state) const;
+
+        /**
+         * 把 states 扩展到 groups 个分组，新分组为初始状态。
+         */
+        void resize(States& states,size_t groups) const;
+
+        /**
+         * 把分组 [begin, end) 恢复为初始状态。
+         */
+        void reset(States& states,size_t begin,size_t end) const;
+
+        /**
+         * 把分组 from 的状态移到分组 to，from 恢复为初始状态。
+         */
+        void move(States& states,size_t from,size_t to) const;
+
+        /**
+         * 按列累加 batch，第 row 行累加到分组 groups[row]。
+         */
+        void update(States& states,const std::vector<uint32_t>& groups,const LocalBatch& batch) const;
+
+        /**
+         * 分组 [begin, end) 的聚合结果。
+         */
+        LocalColumn result(const States& states,const std::string& name,size_t begin,size_t end) const;
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef LOCAL_AGGREGATION_H
+#define LOCAL_AGGREGATION_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalAggregate.h"
+#include "LocalBatch.h"
+#include "LocalExpression.h"
+
+/**
+ * 聚合步骤的 keys 与 selects。selects 中的聚合调用被替换成聚合结果列，相同的调用只计算一次；
+ * 不含聚合也不是 key 的 select 项取分组内的第一个值。
+ * 聚合算子按 key 分组累加 getAggregates() 中的聚合，最后由 project 算出 select 项。
+ */
+class LocalAggregation {
+    private:
+        std::vector<std::string> keyNames;
+        std::vector<std::shared_ptr<LocalExpression>> keys;
+        std::vector<LocalAggregate> aggregates;
+        std::vector<std::string> aggregateTexts;
+        std::vector<std::string> names;
+        std::vector<std::shared_ptr<LocalExpression>> outputs;
+
+        // 把 expr 中的聚合调用换成结果列，返回替换后的表达式
+        std::shared_ptr<LocalExpression> collect(const std::shared_ptr<LocalExpression>& expr);
+
+    public:
+        static const std::string AGGREGATE_PREFIX;
+
+        LocalAggregation(const std::string& keys,const std::string& selects);
+
+        /**
+         * selects 中是否有聚合调用。
+         */
+        static bool hasAggregate(const std::string& selects);
+
+        /**
+         * 两阶段聚合的合并：把 selects 中的聚合调用改写成对 states 中部分状态列的合并
+         * （count 的状态求和，avg 为 sum 状态与 count 状态之比），select 项的输出名保持不变。
+         */
+        static std::string merge(const std::string& states,const std::string& selects);
+
+        const std::vector<std::string>& getKeyNames() const {
+            return keyNames;
+        }
+
+        const std::vector<std::shared_ptr<LocalExpression>>& getKeys() const {
+            return keys;
+        }
+
+        std::vector<LocalAggregate>& getAggregates(){
+            return aggregates;
+        }
+
+        const std::vector<std::string>& getNames() const {
+            return names;
+        }
+
+        /**
+         * 把 key 与聚合参数绑定到输入批次的列布局。
+         */
+        void bind(const LocalBatch& batch);
+
+        /**
+         * groups 的列依次为各个 key 与各个聚合的结果，每行一个分组，返回 select 项组成的批次。
+         */
+        std::shared_ptr<LocalBatch> project(const LocalBatch& groups);
+
+        /**
+         * 按 key 名与聚合结果列名组装 groups 的空列布局。
+         */
+        std::vector<std::string> getGroupColumnNames() const;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef LOCAL_ASOF_JOIN_OPERATOR_H
+#define LOCAL_ASOF_JOIN_OPERATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "LocalExpression.h"
+#include "LocalJoinOperator.h"
+
+/**
+ * AsofJoin 步骤：左侧每行只连接 key 相同、满足 left_time match right_time 的最近一行右侧记录，
+ * match 为 >=、>、<=、<。没有匹配的左侧行补空值输出（按 LEFT 连接处理），选出的行对上再检查 residual。
+ *
+ * 构建侧按 rights 的编码分组，组内按 right_time 稳定排序，左侧每行在自己的组内二分查找；
+ * 时间相同的右侧行中 >= / > 取最后一行，<= / < 取第一行。时间或 key 为空值的行不会匹配。
+ *
+ * 构建侧的全部历史都留在内存中，左侧的行可以匹配任意时间的右侧记录，不要求两侧按时间有序。
+ * 每个 key 只保留最新一行需要两侧按时间有序地交替读取，规划器目前不保证输入有序，这样的实现不在范围内。
+ */
+class LocalAsofJoinOperator : public LocalJoinOperator {
+    private:
+        std::vector<std::shared_ptr<LocalExpression>> lefts;
+        std::vector<std::shared_ptr<LocalExpression>> rights;
+        std::shared_ptr<LocalExpression> leftTime;
+        std::shared_ptr<LocalExpression> rightTime;
+        std::string match;
+        std::vector<double> buildTimes;
+        // 每个 key 的构建侧行，按 right_time 排序
+        std::unordered_map<std::string, std::vector<int64_t>> groups;
+
+        // group 中与时间 time 按 match 最近的一行，没有时返回 -1
+        int64_t nearest(const std::vector<int64_t>& group,double time) const;
+
+    protected:
+        void prepare() override;
+
+        bool probe(const LocalBatch& left) override;
+
+    public:
+        explicit LocalAsofJoinOperator(const LocalStepDefinition& step);
+};
+
+#endif
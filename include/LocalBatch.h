@@ -0,0 +1,70 @@
+#ifndef LOCAL_BATCH_H
+#define LOCAL_BATCH_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalColumn.h"
+
+/**
+ * 按列存放的一批记录，各列行数相同。批次放进 spool 后不再修改，可以被多个算子共享。
+ */
+class LocalBatch {
+    private:
+        std::vector<LocalColumn> columns;
+        size_t rows = 0;
+
+    public:
+        LocalBatch(){}
+
+        explicit LocalBatch(size_t rows) : rows(rows){}
+
+        size_t getRows() const {
+            return rows;
+        }
+
+        size_t getColumnCount() const {
+            return columns.size();
+        }
+
+        const std::vector<LocalColumn>& getColumns() const {
+            return columns;
+        }
+
+        const LocalColumn& getColumn(size_t column) const {
+            return columns.at(column);
+        }
+
+        LocalColumn& getColumn(size_t column){
+            return columns.at(column);
+        }
+
+        /**
+         * 添加一列，第一列决定批次的行数。
+         */
+        void addColumn(const LocalColumn& column);
+
+        void addColumn(LocalColumn&& column);
+
+        /**
+         * 按名字查找列：先找同名的列；找不到时带前缀的 t.a 匹配唯一的 a，不带前缀的 a 匹配唯一的 x.a。
+         * 找不到或有歧义时返回 -1。
+         */
+        int indexOf(const std::string& name) const;
+
+        /**
+         * 按下标取出若干行组成新批次，下标为负数的行各列都为空值。
+         */
+        std::shared_ptr<LocalBatch> select(const std::vector<int64_t>& rows) const;
+
+        std::shared_ptr<LocalBatch> slice(size_t begin,size_t end) const;
+
+        /**
+         * 把若干列名相同的批次合并成一个批次，batches 为空时返回空批次。
+         */
+        static std::shared_ptr<LocalBatch> concat(const std::vector<std::shared_ptr<const LocalBatch>>& batches);
+};
+
+#endif
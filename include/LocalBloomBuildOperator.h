@@ -0,0 +1,38 @@
+#ifndef LOCAL_BLOOM_BUILD_OPERATOR_H
+#define LOCAL_BLOOM_BUILD_OPERATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalExpression.h"
+#include "LocalOperator.h"
+
+/**
+ * BloomBuild 步骤：读完输入，把每行 keys 的编码放进 bits 位、hashes 个哈希函数的布隆过滤器。
+ * 输出一个批次：word 列为按 64 位一组的位图（位数向上取整到 64 的倍数），hashes 列每行都是哈希函数个数，
+ * 由 BloomFilter 步骤读取。key 中有空值的行不放进过滤器。
+ */
+class LocalBloomBuildOperator : public LocalOperator {
+    private:
+        std::vector<std::shared_ptr<LocalExpression>> keys;
+        size_t bits;
+        size_t hashes;
+
+    protected:
+        void run() override;
+
+    public:
+        explicit LocalBloomBuildOperator(const LocalStepDefinition& step);
+
+        /**
+         * key 编码的哈希值在 bits 位的过滤器中第 i 个哈希函数对应的位置（双重哈希）。
+         */
+        static size_t position(size_t hash,size_t i,size_t bits){
+            const size_t step = ((hash >> 32) | (hash << 32)) | 1;
+            return (hash + i * step) % bits;
+        }
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef LOCAL_BLOOM_FILTER_OPERATOR_H
+#define LOCAL_BLOOM_FILTER_OPERATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalExpression.h"
+#include "LocalOperator.h"
+
+/**
+ * BloomFilter 步骤：只保留 keys 可能在布隆过滤器中的行，key 中有空值的行被丢弃。
+ * 参数 bloom 指定的 BloomBuild 输出作为第二个输入，读完之后再逐批过滤第一个输入。
+ */
+class LocalBloomFilterOperator : public LocalOperator {
+    private:
+        std::vector<std::shared_ptr<LocalExpression>> keys;
+        std::vector<uint64_t> words;
+        size_t hashes = 0;
+
+        bool contains(size_t hash) const;
+
+    protected:
+        void run() override;
+
+    public:
+        explicit LocalBloomFilterOperator(const LocalStepDefinition& step);
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef LOCAL_COLUMN_H
+#define LOCAL_COLUMN_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LocalType.h"
+#include "LocalValue.h"
+
+/**
+ * 批次中的一列，按类型只使用 ints、doubles、strings 中的一个。
+ * nulls 为空表示整列没有空值，否则与行一一对应，空值行在数据数组中保留默认值。
+ */
+class LocalColumn {
+    private:
+        std::string name;
+        LocalType type = LocalType::INT;
+        std::vector<int64_t> ints;
+        std::vector<double> doubles;
+        std::vector<std::string> strings;
+        std::vector<uint8_t> nulls;
+
+        // 把列转换成更宽的类型（INT < DOUBLE < STRING），已经不窄于 wider 时不变
+        void promote(LocalType wider);
+
+    public:
+        LocalColumn(){}
+
+        LocalColumn(const std::string& name,LocalType type) : name(name),type(type){}
+
+        /**
+         * 按取值推断列的类型：含字符串时为 STRING，含浮点数时为 DOUBLE，否则为 INT。
+         */
+        static LocalColumn fromValues(const std::string& name,const std::vector<LocalValue>& values);
+
+        const std::string& getName() const {
+            return name;
+        }
+
+        void setName(const std::string& name){
+            this->name = name;
+        }
+
+        LocalType getType() const {
+            return type;
+        }
+
+        size_t size() const;
+
+        void reserve(size_t rows);
+
+        bool hasNulls() const {
+            return !nulls.empty();
+        }
+
+        bool isNull(size_t row) const {
+            return !nulls.empty() && nulls[row] != 0;
+        }
+
+        LocalValue get(size_t row) const;
+
+        /**
+         * 追加一个值，非空值转换成本列的类型。
+         */
+        void append(const LocalValue& value);
+
+        void appendNull();
+
+        /**
+         * 覆盖第 row 行的值，值比本列的类型宽时先把整列转换成较宽的类型。
+         */
+        void set(size_t row,const LocalValue& value);
+
+        /**
+         * 追加 other 中的全部行，类型不同时按较宽的类型合并。
+         */
+        void append(const LocalColumn& other);
+
+        /**
+         * 按下标取出若干行，下标为负数的行为空值。
+         */
+        LocalColumn select(const std::vector<int64_t>& rows) const;
+
+        /**
+         * 取出 [begin, end) 内的行。
+         */
+        LocalColumn slice(size_t begin,size_t end) const;
+
+        const std::vector<int64_t>& getInts() const {
+            return ints;
+        }
+
+        std::vector<int64_t>& getInts(){
+            return ints;
+        }
+
+        const std::vector<double>& getDoubles() const {
+            return doubles;
+        }
+
+        std::vector<double>& getDoubles(){
+            return doubles;
+        }
+
+        const std::vector<std::string>& getStrings() const {
+            return strings;
+        }
+
+        std::vector<std::string>& getStrings(){
+            return strings;
+        }
+
+        const std::vector<uint8_t>& getNulls() const {
+            return nulls;
+        }
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef LOCAL_EMPTY_OPERATOR_H
+#define LOCAL_EMPTY_OPERATOR_H
+
+#include <string>
+#include <vector>
+
+#include "LocalOperator.h"
+
+/**
+ * Empty 步骤：条件恒假的语句不读取任何输入，只输出一个按 selects 列布局的空批次。
+ * 列名与 Project 相同，为别名或表达式原文；没有 selects 时批次没有列。
+ */
+class LocalEmptyOperator : public LocalOperator {
+    private:
+        std::vector<std::string> names;
+
+    protected:
+        void run() override;
+
+    public:
+        explicit LocalEmptyOperator(const LocalStepDefinition& step);
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef LOCAL_EXCHANGE_OPERATOR_H
+#define LOCAL_EXCHANGE_OPERATOR_H
+
+#include "LocalOperator.h"
+
+/**
+ * Exchange 步骤：分布式计划中数据从 from 层传到 to 层，在本地执行时原样转发输入的批次。
+ */
+class LocalExchangeOperator : public LocalOperator {
+    protected:
+        void run() override;
+
+    public:
+        explicit LocalExchangeOperator(const LocalStepDefinition& step) : LocalOperator(step){}
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef LOCAL_EXECUTOR_H
+#define LOCAL_EXECUTOR_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalBatch.h"
+#include "LocalOperator.h"
+#include "LocalStepDefinition.h"
+#include "SqlPlan.h"
+
+/**
+ * 在本进程内执行 SqlPlan 的参考执行器，用于本地测试计划的正确性与性能。
+ * 每个步骤对应一个算子并在自己的线程里运行，步骤之间通过 spool（LocalSpool）传递按列存放的批次。
+ * Input 读取 directory 下的 name.csv 或注册过的内存表，Output 写出 directory 下的 name.csv。
+ *
+ * 支持的步骤：Input、Filter、Project、GroupBy、StreamAggregate、SlidingWindow、SlidingSession、TumblingWindow、TumblingSession、
+ * PatternWindow、PatternSession、ReduceJoin、BroadcastHashJoin、NestedJoin、IntervalJoin、AsofJoin、BloomBuild、BloomFilter、
+ * Exchange、Take、Output、Empty，以及两阶段聚合的 Partial / Final 步骤。
+ * Exchange 在本地原样转发批次，BloomFilter 按参数 bloom 读取 BloomBuild 的输出，因此分层计划可以拼接后一起执行。
+ */
+class LocalExecutor {
+    private:
+        std::string directory;
+        size_t batchSize = DEFAULT_BATCH_SIZE;
+        std::map<std::string, std::vector<std::shared_ptr<const LocalBatch>>> tables;
+
+        std::shared_ptr<LocalOperator> create(const LocalStepDefinition& step) const;
+
+    public:
+        static constexpr size_t DEFAULT_BATCH_SIZE = 4096;
+
+        explicit LocalExecutor(const std::string& directory = ".");
+
+        const std::string& getDirectory() const {
+            return directory;
+        }
+
+        size_t getBatchSize() const {
+            return batchSize;
+        }
+
+        void setBatchSize(size_t batchSize){
+            this->batchSize = batchSize > 0 ? batchSize : DEFAULT_BATCH_SIZE;
+        }
+
+        /**
+         * 注册内存表，Input 读取同名的表时优先使用。
+         */
+        void addTable(const std::string& name,const std::vector<std::shared_ptr<const LocalBatch>>& batches){
+            tables[name] = batches;
+        }
+
+        /**
+         * 执行计划，返回最后一个步骤输出的全部批次；最后一个步骤是 Output 时返回空。
+         * 任一算子出错时等所有算子结束后抛出第一个错误。
+         */
+        std::vector<std::shared_ptr<const LocalBatch>> execute(const std::vector<std::string>& plan);
+
+        std::vector<std::shared_ptr<const LocalBatch>> execute(const SqlPlan& plan){
+            return execute(plan.getPlan());
+        }
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef LOCAL_EXPRESSION_H
+#define LOCAL_EXPRESSION_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalBatch.h"
+#include "LocalColumn.h"
+#include "LocalValue.h"
+
+/**
+ * 本地执行器使用的表达式树，支持计划中 condition、selects、keys 等参数里的标量表达式：
+ * 列名、数字与字符串常量、四则运算、比较、and / or / not、between、in、like、is null 以及常用的标量函数。
+ * 空值按 SQL 的三值逻辑传播。聚合函数调用可以被解析，但只能由聚合算子求值。
+ *
+ * 求值前先用 bind 把列名绑定到批次中的下标，之后对同样列布局的批次可以并发地逐行求值。
+ */
+class LocalExpression {
+    public:
+        enum class Kind{
+            LITERAL,
+            COLUMN,
+            NEGATE,
+            NOT,
+            BINARY,
+            AND,
+            OR,
+            BETWEEN,
+            IN,
+            LIKE,
+            IS_NULL,
+            CALL
+        };
+
+    private:
+        Kind kind;
+        // 列名、二元运算符或小写的函数名
+        std::string text;
+        LocalValue value;
+        std::vector<std::shared_ptr<LocalExpression>> children;
+        // not between、not in、not like、is not null
+        bool negated = false;
+        // count(distinct x)
+        bool distinct = false;
+        int column = -1;
+
+        LocalValue call(const LocalBatch& batch,size_t row) const;
+
+    public:
+        LocalExpression(Kind kind,const std::string& text) : kind(kind),text(text){}
+
+        /**
+         * 解析表达式，语法错误时抛出 EngineException。
+         */
+        static std::shared_ptr<LocalExpression> parse(const std::string& expr);
+
+        static std::shared_ptr<LocalExpression> literal(const LocalValue& value);
+
+        Kind getKind() const {
+            return kind;
+        }
+
+        const std::string& getText() const {
+            return text;
+        }
+
+        const LocalValue& getValue() const {
+            return value;
+        }
+
+        const std::vector<std::shared_ptr<LocalExpression>>& getChildren() const {
+            return children;
+        }
+
+        void addChild(const std::shared_ptr<LocalExpression>& child){
+            children.push_back(child);
+        }
+
+        void setChild(size_t index,const std::shared_ptr<LocalExpression>& child){
+            children.at(index) = child;
+        }
+
+        bool isNegated() const {
+            return negated;
+        }
+
+        void setNegated(bool negated){
+            this->negated = negated;
+        }
+
+        bool isDistinct() const {
+            return distinct;
+        }
+
+        void setDistinct(bool distinct){
+            this->distinct = distinct;
+        }
+
+        // 绑定后的列下标，未绑定或不是列时为 -1
+        int getColumn() const {
+            return column;
+        }
+
+        bool isAggregate() const;
+
+        /**
+         * 规范化的表达式文本，相同的表达式得到相同的文本。
+         */
+        std::string toString() const;
+
+        /**
+         * 把表达式中的列名绑定到 batch 的列下标，找不到列或函数不支持时抛出 EngineException。
+         */
+        void bind(const LocalBatch& batch);
+
+        /**
+         * 对已绑定的列布局逐行求值。
+         */
+        LocalValue evaluate(const LocalBatch& batch,size_t row) const;
+
+        /**
+         * 绑定 batch 后对每一行求值，结果列的类型按取值推断。
+         */
+        LocalColumn evaluate(const LocalBatch& batch,const std::string& name);
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef LOCAL_FILTER_KERNEL_H
+#define LOCAL_FILTER_KERNEL_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalBatch.h"
+#include "LocalExpression.h"
+
+/**
+ * Filter 条件的向量化执行。条件按批次的列布局编译成位图程序：
+ * 列与常量、列与列的比较，between、in、is null 直接在整列上比较，数值列按 CPU 支持的指令集用 AVX2 / SSE4.2 一次比较多行；
+ * and / or / not 按 64 行一个字做位运算。其余的子条件（算术、函数等）逐行求值后写入位图。
+ *
+ * 每个子条件算出两张位图：为真的行与为假的行，两者都不含的行是空值，按三值逻辑组合，
+ * 最后只保留为真的行。
+ */
+class LocalFilterKernel {
+    public:
+        enum class InstructionSet{
+            SCALAR,
+            SSE42,
+            AVX2
+        };
+
+        /**
+         * 位图程序中的一个节点。
+         */
+        struct Node{
+            enum class Op{ COMPARE, BETWEEN, IN, IS_NULL, AND, OR, NOT, ROW };
+
+            Op op = Op::ROW;
+            // 比较符：= != < <= > >=
+            std::string comparison;
+            int column = -1;
+            // 列与列比较时的右侧列，上下界都是列的 between 的下界列，否则为 -1
+            int other = -1;
+            // 上下界都是列的 between 的上界列，否则为 -1
+            int upper = -1;
+            LocalType type = LocalType::INT;
+            std::vector<LocalValue> constants;
+            bool negated = false;
+            // in 列表中有空值，不匹配的行结果为空值
+            bool nullInList = false;
+            // 列与常量比较的结果恒为假（如整数列与非整数常量相等）
+            bool never = false;
+            std::shared_ptr<LocalExpression> expression;
+            std::vector<std::shared_ptr<Node>> children;
+        };
+
+    private:
+        std::shared_ptr<Node> root;
+        // 编译时依赖的列：下标、列名与类型
+        std::vector<int> columns;
+        std::vector<std::string> names;
+        std::vector<LocalType> types;
+        InstructionSet instructionSet;
+
+        std::shared_ptr<Node> compile(const std::shared_ptr<LocalExpression>& expr,const LocalBatch& layout);
+
+        std::shared_ptr<Node> compileComparison(const std::shared_ptr<LocalExpression>& expr,const LocalBatch& layout);
+
+        int require(const std::shared_ptr<LocalExpression>& expr,const LocalBatch& layout);
+
+        void run(const Node& node,const LocalBatch& batch,std::vector<uint64_t>& trues,std::vector<uint64_t>& falses) const;
+
+    public:
+        /**
+         * 按 layout 的列布局编译条件，condition 会被绑定到 layout。
+         */
+        LocalFilterKernel(const std::shared_ptr<LocalExpression>& condition,const LocalBatch& layout);
+
+        /**
+         * 当前 CPU 支持的最快指令集。
+         */
+        static InstructionSet detect();
+
+        static std::string toString(InstructionSet instructionSet);
+
+        InstructionSet getInstructionSet() const {
+            return instructionSet;
+        }
+
+        /**
+         * 指定使用的指令集，超出 CPU 支持范围时使用 detect() 的结果。
+         */
+        void setInstructionSet(InstructionSet instructionSet);
+
+        const std::shared_ptr<Node>& getRoot() const {
+            return root;
+        }
+
+        /**
+         * batch 的列布局是否与编译时相同，不同时需要重新编译。
+         */
+        bool accepts(const LocalBatch& batch) const;
+
+        /**
+         * 条件为真的行的位图，第 i 行对应第 i / 64 个字的第 i % 64 位。
+         */
+        void evaluate(const LocalBatch& batch,std::vector<uint64_t>& trues) const;
+
+        /**
+         * 条件为真的行号（选择向量）。
+         */
+        void select(const LocalBatch& batch,std::vector<int64_t>& rows) const;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef LOCAL_FILTER_OPERATOR_H
+#define LOCAL_FILTER_OPERATOR_H
+
+#include <memory>
+
+#include "LocalExpression.h"
+#include "LocalFilterKernel.h"
+#include "LocalOperator.h"
+
+/**
+ * Filter 步骤：只保留 condition 为真的行，条件为空值的行被丢弃。
+ * 条件按批次的列布局编译成 LocalFilterKernel，布局不变时复用。
+ */
+class LocalFilterOperator : public LocalOperator {
+    private:
+        std::shared_ptr<LocalExpression> condition;
+        std::shared_ptr<LocalFilterKernel> kernel;
+
+    protected:
+        void run() override;
+
+    public:
+        explicit LocalFilterOperator(const LocalStepDefinition& step);
+};
+
+#endif
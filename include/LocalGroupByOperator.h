@@ -0,0 +1,26 @@
+#ifndef LOCAL_GROUP_BY_OPERATOR_H
+#define LOCAL_GROUP_BY_OPERATOR_H
+
+#include <string>
+
+#include "LocalAggregation.h"
+#include "LocalOperator.h"
+
+/**
+ * GroupBy 步骤：读完输入后按 keys 输出每个分组的 selects。没有 key 时整个输入是一个分组，
+ * 输入为空也输出一行。PartialGroupBy、FinalGroupBy 与含聚合的 Project 也由它执行，
+ * 由执行器传入改写后的 keys 与 selects。
+ * 分组由 LocalGroupTable 编号，聚合状态按分组编号存放在 LocalAggregate::States 的连续数组中。
+ */
+class LocalGroupByOperator : public LocalOperator {
+    private:
+        LocalAggregation aggregation;
+
+    protected:
+        void run() override;
+
+    public:
+        LocalGroupByOperator(const LocalStepDefinition& step,const std::string& keys,const std::string& selects);
+};
+
+#endif
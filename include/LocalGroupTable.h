@@ -0,0 +1,97 @@
+#ifndef LOCAL_GROUP_TABLE_H
+#define LOCAL_GROUP_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalBatch.h"
+#include "LocalExpression.h"
+
+/**
+ * GroupBy 的分组表：把每行的 key 映射成从 0 开始连续编号的分组，编号即分组第一次出现的顺序。
+ *
+ * 开放寻址、线性探测，槽位只有 8 字节：key 的 32 位哈希与分组编号，扩容时按槽位中的哈希重排，不再读取 key。
+ * key 按分组编号保存在连续数组中，不为每个分组单独分配内存：
+ * - INT：单个整数 key，保存在 int64 数组中；
+ * - STRING：单个字符串 key，按字典编码保存，字符串只在字节区中存一次，分组编号就是字典编码；
+ * - GENERIC：多个 key 或其他类型，每个分组的 key 按类型编码后存入字节区。
+ * 第一批有数据的批次决定使用哪种方式，之后 key 的类型变化时转换成 GENERIC，分组编号不变。
+ * 不同类型的 key 属于不同分组，如 1 与 1.0。
+ */
+class LocalGroupTable {
+    public:
+        enum class Mode{ INT, STRING, GENERIC };
+
+    private:
+        struct Slot{
+            uint32_t hash;
+            uint32_t group;
+        };
+
+        static const uint32_t EMPTY;
+
+        std::vector<std::shared_ptr<LocalExpression>> keys;
+        std::vector<std::string> names;
+        Mode mode = Mode::GENERIC;
+        bool initialized = false;
+        std::vector<Slot> slots;
+        size_t groups = 0;
+        // INT 方式的 key
+        std::vector<int64_t> ints;
+        // STRING 与 GENERIC 方式的 key：第 g 个分组占 [offsets[g], offsets[g + 1])
+        std::string bytes;
+        std::vector<uint64_t> offsets;
+        // INT 与 STRING 方式下 key 为空值的分组，没有时为 -1
+        int64_t nullGroup = -1;
+        std::string encoded;
+
+        // 把新分组写入空槽位 slot
+        uint32_t add(Slot& slot,uint32_t hash);
+
+        void grow();
+
+        uint32_t findInt(int64_t key);
+
+        uint32_t findBytes(const char* data,size_t size);
+
+        uint32_t addNull();
+
+        // 按第 g 个分组的 key 编码 GENERIC 方式的字节
+        void encodeGroup(size_t group,std::string& out) const;
+
+        void toGeneric();
+
+    public:
+        LocalGroupTable(const std::vector<std::shared_ptr<LocalExpression>>& keys,const std::vector<std::string>& names);
+
+        Mode getMode() const {
+            return mode;
+        }
+
+        size_t size() const {
+            return groups;
+        }
+
+        size_t getCapacity() const {
+            return slots.size();
+        }
+
+        /**
+         * 预留 expected 个分组的空间，避免读取过程中扩容。
+         */
+        void reserve(size_t expected);
+
+        /**
+         * 计算 batch 每行所属的分组，新的 key 追加新的分组。
+         */
+        void lookup(const LocalBatch& batch,std::vector<uint32_t>& result);
+
+        /**
+         * 第 key 个 key 在分组 [begin, end) 上的取值。
+         */
+        LocalColumn getKeyColumn(size_t key,size_t begin,size_t end) const;
+};
+
+#endif
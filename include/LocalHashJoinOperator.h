@@ -0,0 +1,31 @@
+#ifndef LOCAL_HASH_JOIN_OPERATOR_H
+#define LOCAL_HASH_JOIN_OPERATOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalExpression.h"
+#include "LocalJoinOperator.h"
+#include "LocalRadixHashTable.h"
+
+/**
+ * ReduceJoin / BroadcastHashJoin 步骤：在构建侧按 rights 建按基数分区的哈希表，左侧按 lefts 逐批分区探测，
+ * key 相等的行对上再检查 residual。key 中有空值的行不会匹配。
+ */
+class LocalHashJoinOperator : public LocalJoinOperator {
+    private:
+        std::vector<std::shared_ptr<LocalExpression>> lefts;
+        std::vector<std::shared_ptr<LocalExpression>> rights;
+        LocalRadixHashTable table;
+
+    protected:
+        void prepare() override;
+
+        bool probe(const LocalBatch& left) override;
+
+    public:
+        explicit LocalHashJoinOperator(const LocalStepDefinition& step);
+};
+
+#endif
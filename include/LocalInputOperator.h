@@ -0,0 +1,27 @@
+#ifndef LOCAL_INPUT_OPERATOR_H
+#define LOCAL_INPUT_OPERATOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalOperator.h"
+
+/**
+ * Input 步骤：按 name 读取表。注册过同名的内存表时直接输出内存表的批次，
+ * 否则按 batchSize 分批读取 directory 下的 name.csv（格式见 LocalTableFile）。
+ */
+class LocalInputOperator : public LocalOperator {
+    private:
+        std::string directory;
+        const std::vector<std::shared_ptr<const LocalBatch>>* table = nullptr;
+
+    protected:
+        void run() override;
+
+    public:
+        LocalInputOperator(const LocalStepDefinition& step,const std::string& directory,
+                           const std::vector<std::shared_ptr<const LocalBatch>>* table);
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef LOCAL_INTERVAL_JOIN_OPERATOR_H
+#define LOCAL_INTERVAL_JOIN_OPERATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalExpression.h"
+#include "LocalJoinOperator.h"
+#include "LocalRadixHashTable.h"
+
+/**
+ * IntervalJoin 步骤：行对满足 lower <= right_time - left_time <= upper，有 lefts / rights 时 key 还要相等，再检查 residual。
+ *
+ * 有 key 时在构建侧按 rights 建哈希表，key 相等的行对再按时间差过滤；没有 key 时构建侧按 right_time 排序，
+ * 左侧每行二分查找 [left_time + lower, left_time + upper] 内的行。时间或 key 为空值的行不会匹配。
+ *
+ * 构建侧整个读入内存，内存随构建侧的行数而不是区间宽度增长。只缓存区间内的行需要两侧都按时间有序到达再归并，
+ * 规划器目前不保证输入有序，这样的实现不在范围内。
+ */
+class LocalIntervalJoinOperator : public LocalJoinOperator {
+    private:
+        std::vector<std::shared_ptr<LocalExpression>> lefts;
+        std::vector<std::shared_ptr<LocalExpression>> rights;
+        std::shared_ptr<LocalExpression> leftTime;
+        std::shared_ptr<LocalExpression> rightTime;
+        double lower;
+        double upper;
+        LocalRadixHashTable table;
+        std::vector<double> buildTimes;
+        std::vector<uint8_t> buildValid;
+        // 没有 key 时时间有效的构建侧行，按 right_time 排序
+        std::vector<int64_t> sorted;
+
+    protected:
+        void prepare() override;
+
+        bool probe(const LocalBatch& left) override;
+
+    public:
+        explicit LocalIntervalJoinOperator(const LocalStepDefinition& step);
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef LOCAL_JOIN_OPERATOR_H
+#define LOCAL_JOIN_OPERATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalBatch.h"
+#include "LocalExpression.h"
+#include "LocalOperator.h"
+#include "SqlJoinType.h"
+
+/**
+ * 二元连接的公共部分。右侧输入 input2 先全部读入作为构建侧，左侧输入逐批探测。
+ * 连接结果中右侧的列加上 right_alias 前缀；left_alias 只有一个别名时左侧的列也加上前缀，
+ * 多个别名时左侧来自之前的连接，列名已经带前缀。
+ * 子类找出候选行对后交给 join 检查条件并输出，LEFT / RIGHT / FULL 连接的未匹配行补空值输出。
+ */
+class LocalJoinOperator : public LocalOperator {
+    private:
+        bool selectAll = true;
+        std::vector<std::string> names;
+        std::vector<std::shared_ptr<LocalExpression>> outputs;
+        std::shared_ptr<LocalExpression> condition;
+        std::string leftPrefix;
+        std::string rightPrefix;
+        // 左侧的列布局，右侧未匹配的行按它补空值
+        std::shared_ptr<const LocalBatch> leftLayout;
+
+        std::shared_ptr<LocalBatch> combine(const LocalBatch& left,const std::vector<int64_t>& leftRows,const std::vector<int64_t>& rightRows) const;
+
+        bool output(const std::shared_ptr<LocalBatch>& batch);
+
+    protected:
+        SqlJoinType type;
+        // 按右侧别名改名后的构建侧
+        std::shared_ptr<LocalBatch> build;
+        std::vector<uint8_t> buildMatched;
+
+        // 左侧的列在连接结果中的前缀
+        const std::string& getLeftPrefix() const {
+            return leftPrefix;
+        }
+
+        bool keepsLeft() const {
+            return type == SqlJoinType::LEFT || type == SqlJoinType::FULL;
+        }
+
+        bool keepsRight() const {
+            return type == SqlJoinType::RIGHT || type == SqlJoinType::FULL;
+        }
+
+        /**
+         * key 表达式在 batch 上的列：直接引用批次中的列，其他表达式求值后存入 evaluated。
+         */
+        static std::vector<const LocalColumn*> keyColumns(const std::vector<std::shared_ptr<LocalExpression>>& keys,const LocalBatch& batch,
+                                                          std::vector<LocalColumn>& evaluated);
+
+        /**
+         * 时间表达式在 batch 上的值，空值或非数值的行 valid 为 0。
+         */
+        static void timeValues(const std::shared_ptr<LocalExpression>& time,const LocalBatch& batch,
+                               std::vector<double>& values,std::vector<uint8_t>& valid);
+
+        /**
+         * 检查候选行对上的条件并输出匹配的行，在 leftMatched 中标记匹配到的左侧行。
+         * 返回 false 表示已经不需要更多输出。
+         */
+        bool join(const LocalBatch& left,const std::vector<int64_t>& leftRows,const std::vector<int64_t>& rightRows,std::vector<uint8_t>& leftMatched);
+
+        /**
+         * 一个左侧批次探测完之后输出其中未匹配的行。
+         */
+        bool finishLeft(const LocalBatch& left,const std::vector<uint8_t>& leftMatched);
+
+        /**
+         * 构建侧读入之后的准备工作，如建哈希表。
+         */
+        virtual void prepare(){}
+
+        /**
+         * 探测一个左侧批次。
+         */
+        virtual bool probe(const LocalBatch& left) = 0;
+
+        void run() override;
+
+    public:
+        /**
+         * condition 为候选行对上还要检查的条件，为空时不检查。
+         */
+        LocalJoinOperator(const LocalStepDefinition& step,const std::string& condition);
+
+        /**
+         * 计划中 join_type 参数对应的连接类型，OUTER 按 FULL 处理，其余内连接都按 INNER 处理。
+         */
+        static SqlJoinType parseType(const std::string& type);
+};
+
+#endif
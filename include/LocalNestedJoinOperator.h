@@ -0,0 +1,59 @@
+#ifndef LOCAL_NESTED_JOIN_OPERATOR_H
+#define LOCAL_NESTED_JOIN_OPERATOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalExpression.h"
+#include "LocalJoinOperator.h"
+
+/**
+ * NestedJoin 步骤：没有等值 key 时对左右两侧的每一对行检查 condition。
+ *
+ * 按块嵌套循环：左侧一批行与构建侧都切成块，一对块只取出 condition 用到的列展开成约 BLOCK_PAIRS 个行对，
+ * 用 LocalFilterKernel 按列求值，不再为每个行对拼出完整的连接结果。
+ * 各对块分给多个线程检查，匹配的行对按块的顺序由算子线程交给 join 输出。
+ */
+class LocalNestedJoinOperator : public LocalJoinOperator {
+    private:
+        std::shared_ptr<LocalExpression> condition;
+        size_t threads;
+
+        // 一对块中 condition 用到的列：列名、是否来自左侧、在左侧批次或构建侧中的下标
+        struct BlockColumn{
+            std::string name;
+            bool left;
+            size_t index;
+        };
+
+        std::vector<BlockColumn> resolve(const LocalBatch& left) const;
+
+        /**
+         * 左侧 [leftBegin, leftEnd) 与构建侧 [rightBegin, rightEnd) 两两配对的块，行对的来源写入 leftRows 与 rightRows。
+         */
+        std::shared_ptr<LocalBatch> block(const LocalBatch& left,const std::vector<BlockColumn>& columns,size_t leftBegin,size_t leftEnd,
+                                          size_t rightBegin,size_t rightEnd,std::vector<int64_t>& leftRows,std::vector<int64_t>& rightRows) const;
+
+    protected:
+        bool probe(const LocalBatch& left) override;
+
+    public:
+        // 一对块展开的行对数，condition 用到几列时块内的数据能放进 L2 缓存
+        static const size_t BLOCK_PAIRS;
+
+        explicit LocalNestedJoinOperator(const LocalStepDefinition& step);
+
+        size_t getThreads() const {
+            return threads;
+        }
+
+        /**
+         * 检查行对的线程数，默认为 CPU 核数。
+         */
+        void setThreads(size_t threads){
+            this->threads = threads == 0 ? 1 : threads;
+        }
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef LOCAL_OPERATOR_H
+#define LOCAL_OPERATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "LocalBatch.h"
+#include "LocalSpool.h"
+#include "LocalStepDefinition.h"
+
+/**
+ * 本地执行器中一个计划步骤的算子。算子从输入 spool 读批次，把结果写入输出 spool，
+ * 每个算子在自己的线程里运行，execute 结束时关闭输出 spool。
+ * 步骤带有下推的 limit_count 时输出在达到行数后截断。
+ *
+ * 输出不再需要（达到 limit_count，或输出 spool 的读者都已取消，如下游的 Take 已经取够）时 emit 返回 false、
+ * next 返回 nullptr，算子随即结束；execute 结束时取消在输入 spool 上的订阅，取消由此逐级传到上游，
+ * Input 停止读文件，途中的批次被丢弃。
+ */
+class LocalOperator {
+    private:
+        std::vector<std::shared_ptr<LocalSpool>> inputs;
+        std::vector<int> consumers;
+        std::shared_ptr<LocalSpool> output;
+        int64_t limit = -1;
+        int64_t emitted = 0;
+        bool pushed = false;
+
+        void cancelInputs();
+
+        // 达到 limit_count 或下游都已取消
+        bool isDone() const {
+            return (limit >= 0 && emitted >= limit) || (output != nullptr && output->isCancelled());
+        }
+
+    protected:
+        LocalStepDefinition step;
+        size_t batchSize = 4096;
+
+        /**
+         * 读取第 input 个输入的下一个批次，读完或不再需要输出时返回 nullptr。
+         */
+        std::shared_ptr<const LocalBatch> next(size_t input = 0);
+
+        /**
+         * 读完第 input 个输入的全部批次。
+         */
+        std::vector<std::shared_ptr<const LocalBatch>> drain(size_t input);
+
+        /**
+         * 写出一个批次，返回 false 表示已经达到 limit_count 或下游都已取消，不再需要更多输出。
+         * 空批次只在还没有写出过批次时写出，用来把列布局传给下游。
+         */
+        bool emit(const std::shared_ptr<const LocalBatch>& batch);
+
+        /**
+         * 算子本身的处理逻辑。
+         */
+        virtual void run() = 0;
+
+    public:
+        explicit LocalOperator(const LocalStepDefinition& step);
+
+        virtual ~LocalOperator(){}
+
+        const LocalStepDefinition& getStep() const {
+            return step;
+        }
+
+        /**
+         * 按 input、input2 的顺序连接输入，连接时在 spool 上注册读者。
+         */
+        void addInput(const std::shared_ptr<LocalSpool>& spool);
+
+        void setOutput(const std::shared_ptr<LocalSpool>& spool){
+            this->output = spool;
+        }
+
+        void setBatchSize(size_t batchSize){
+            this->batchSize = batchSize;
+        }
+
+        /**
+         * 运行算子，正常结束或抛出异常时都会关闭输出并取消在输入上的订阅。
+         */
+        void execute();
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef LOCAL_OUTPUT_OPERATOR_H
+#define LOCAL_OUTPUT_OPERATOR_H
+
+#include <string>
+
+#include "LocalOperator.h"
+
+/**
+ * Output 步骤：把输入写到 directory 下的 name.csv，已有的文件被覆盖。
+ */
+class LocalOutputOperator : public LocalOperator {
+    private:
+        std::string directory;
+
+    protected:
+        void run() override;
+
+    public:
+        LocalOutputOperator(const LocalStepDefinition& step,const std::string& directory);
+};
+
+#endif
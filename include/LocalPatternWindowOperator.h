@@ -0,0 +1,72 @@
+#ifndef LOCAL_PATTERN_WINDOW_OPERATOR_H
+#define LOCAL_PATTERN_WINDOW_OPERATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalExpression.h"
+#include "LocalFilterKernel.h"
+#include "LocalWindowOperator.h"
+#include "LocalWindowState.h"
+
+/**
+ * PatternWindow / PatternSession 步骤：enter 与 exit 编译成每个分区一个的两状态状态机。
+ * 关闭的分区遇到 enter 为真的行时打开新窗口（这一行属于窗口），打开的分区每行加入窗口后检查 exit，
+ * 为真时关闭窗口并在这一行上按窗口的取值输出（还要满足 validity）。输入结束时仍然打开的窗口不输出。
+ *
+ * 状态按分区编号放在平铺的数组中，不为每个分区分配对象：状态机一个字节，窗口函数的状态见 LocalWindowState，
+ * 窗口关闭时原地清空。每个分区的字节数见 getStateBytesPerKey，分区编号由 LocalGroupTable 分配。
+ *
+ * 不用窗口函数的 enter / exit 每批用 LocalFilterKernel 按列求值，逐行只查位图；
+ * exit 不用窗口函数时只在窗口关闭的行上写入窗口函数的取值。
+ */
+class LocalPatternWindowOperator : public LocalWindowOperator {
+    private:
+        enum State : uint8_t{ CLOSED = 0, OPEN = 1 };
+
+        // 条件与按列求值的结果：condition 为空表示恒为真，rowwise 表示用到了窗口函数需要逐行求值
+        struct Transition{
+            std::shared_ptr<LocalExpression> condition;
+            bool rowwise = false;
+            std::shared_ptr<LocalFilterKernel> kernel;
+            std::vector<uint64_t> trues;
+        };
+
+        Transition enter;
+        Transition exit;
+
+        std::vector<uint8_t> states;
+        // 关闭的分区的窗口为空：窗口关闭时就原地清空
+        std::unique_ptr<LocalWindowState> state;
+
+        // 把分区 key 的窗口上各窗口函数的取值写入 work 的第 row 行
+        void fill(uint32_t key,size_t row);
+
+        bool accepts(Transition& transition,uint32_t key,size_t row);
+
+    protected:
+        void start() override;
+
+        bool consume(size_t row) override;
+
+    public:
+        explicit LocalPatternWindowOperator(const LocalStepDefinition& step);
+
+        /**
+         * 目前为止出现过的分区数。
+         */
+        size_t getKeyCount() const {
+            return states.size();
+        }
+
+        /**
+         * 每个分区的状态占用的字节数，不含分区 key 本身。
+         */
+        size_t getStateBytesPerKey() const {
+            return sizeof(uint8_t) + state->getBytesPerKey();
+        }
+};
+
+#endif
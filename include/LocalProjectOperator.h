@@ -0,0 +1,28 @@
+#ifndef LOCAL_PROJECT_OPERATOR_H
+#define LOCAL_PROJECT_OPERATOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalExpression.h"
+#include "LocalOperator.h"
+
+/**
+ * Project 步骤：逐行计算 selects，* 表示输入的全部列。输出列名为别名，没有别名时为表达式原文。
+ * 含聚合的 Project 是整个输入上的聚合，由 LocalGroupByOperator 执行。
+ */
+class LocalProjectOperator : public LocalOperator {
+    private:
+        std::vector<std::string> names;
+        // * 对应的项为 nullptr
+        std::vector<std::shared_ptr<LocalExpression>> outputs;
+
+    protected:
+        void run() override;
+
+    public:
+        explicit LocalProjectOperator(const LocalStepDefinition& step);
+};
+
+#endif
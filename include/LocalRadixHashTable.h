@@ -0,0 +1,91 @@
+#ifndef LOCAL_RADIX_HASH_TABLE_H
+#define LOCAL_RADIX_HASH_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LocalColumn.h"
+
+/**
+ * 哈希连接构建侧的按基数分区的哈希表。
+ *
+ * 构建时按 key 哈希值的高位把行分到 2^bits 个分区，分区数使每个分区不超过 partitionBytes（默认为 L2 缓存的一半）。
+ * 分区内再按哈希值的低位分桶，条目按（分区，桶）连续存放，桶数组只记录每个桶的第一个条目，
+ * 探测一个 key 只读相邻的两个桶边界和桶内连续的条目，不需要像开放寻址那样一直找到空槽位。
+ * 探测时先把一批行按同样的高位分区，再逐个分区探测，同一时间只访问一个分区的数据。
+ *
+ * 单个整数 key 直接按 int64 比较；其他情况把 key 编码成字节比较，整数与值相等的浮点数编码相同。
+ * key 中有空值的行不会匹配。
+ */
+class LocalRadixHashTable {
+    private:
+        size_t partitionBytes;
+        bool integral = false;
+        int bits = 0;
+        // 按分区、桶排列的条目：构建侧的行号、32 位哈希与 key
+        std::vector<uint32_t> rows;
+        std::vector<uint32_t> hashes;
+        std::vector<int64_t> ints;
+        std::string bytes;
+        std::vector<uint64_t> offsets;
+        // 第 p 个分区的桶边界为 buckets[bases[p]] 到 buckets[bases[p + 1] - 1]，桶的个数是 2 的幂
+        std::vector<uint32_t> buckets;
+        std::vector<uint64_t> bases;
+
+        // 一批行的 key：哈希、是否可以匹配，以及整数或字节形式的 key
+        struct Keys{
+            std::vector<uint64_t> hashes;
+            std::vector<uint8_t> valid;
+            std::vector<int64_t> ints;
+            std::string bytes;
+            std::vector<uint64_t> offsets;
+        };
+
+        Keys probeKeys;
+        // 按分区重排后的探测行：行号、32 位哈希与整数 key
+        std::vector<uint32_t> order;
+        std::vector<uint32_t> orderHashes;
+        std::vector<int64_t> orderInts;
+        std::vector<uint32_t> counts;
+
+        void computeKeys(const std::vector<const LocalColumn*>& columns,size_t count,Keys& keys) const;
+
+        size_t partitionOf(uint64_t hash) const {
+            return bits == 0 ? 0 : static_cast<size_t>(hash >> (64 - bits));
+        }
+
+    public:
+        explicit LocalRadixHashTable(size_t partitionBytes = defaultPartitionBytes());
+
+        /**
+         * L2 缓存大小的一半，取不到缓存大小时按 256KB 的 L2 计算。
+         */
+        static size_t defaultPartitionBytes();
+
+        /**
+         * 把 columns 第 row 行的 key 按多列 key 的编码追加到 bytes，整数与值相等的浮点数编码相同。
+         * key 中有空值时返回 false，bytes 不变。
+         */
+        static bool encodeKey(const std::vector<const LocalColumn*>& columns,size_t row,std::string& bytes);
+
+        /**
+         * 按构建侧的 key 列建表，columns 中每列的行数相同。
+         */
+        void build(const std::vector<const LocalColumn*>& columns);
+
+        /**
+         * 用一批探测侧的 key 列探测，把 key 相等的行对追加到 leftRows 与 rightRows。
+         */
+        void probe(const std::vector<const LocalColumn*>& columns,std::vector<int64_t>& leftRows,std::vector<int64_t>& rightRows);
+
+        size_t getPartitionCount() const {
+            return static_cast<size_t>(1) << bits;
+        }
+
+        size_t size() const {
+            return rows.size();
+        }
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef LOCAL_SLIDING_WINDOW_OPERATOR_H
+#define LOCAL_SLIDING_WINDOW_OPERATOR_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "LocalExpression.h"
+#include "LocalWindowOperator.h"
+
+/**
+ * SlidingWindow / SlidingSession 步骤：每个分区的窗口随每一行滑动，每读到一行按它所在的窗口输出一行。
+ *
+ * 新的一行先加入所在分区的窗口，再从最早的一行开始移出：inclusion 为整数 N 时窗口保留最近的 N 行，
+ * 否则一直移出到 inclusion 在窗口上为真（至少保留新的一行），没有 inclusion 时窗口不移出。
+ *
+ * 窗口聚合增量维护，每行摊还 O(1)，不随窗口大小重算：
+ * - subtract：wcount、wsum、wavg 可逆，行移出时从和与个数中减去，整数部分单独累加，不会有舍入误差；
+ * - two_stacks：wmin、wmax 不可逆，用两个栈实现的队列维护，栈中每个元素带着栈底到它的聚合值，
+ *   出队侧为空时把入队侧整个倒过去，每行最多移动一次。
+ * 计划中的 aggregations 参数（如 wsum('b'):subtract）给出每个聚合使用的策略，没有时按函数推断。
+ */
+class LocalSlidingWindowOperator : public LocalWindowOperator {
+    public:
+        enum class Strategy{ NONE, SUBTRACT, TWO_STACKS };
+
+    private:
+        // 一个参数上的 subtract 状态，同一参数的 wcount、wsum、wavg 共用
+        struct Sum{
+            int64_t count = 0;
+            int64_t ints = 0;
+            double doubles = 0;
+            // 窗口中非整数值的个数，为 0 时和为整数
+            int64_t others = 0;
+        };
+
+        // 一个 wmin / wmax 的 two_stacks 状态，元素为值与栈底到它的聚合值
+        struct Extreme{
+            // 出队侧，栈顶是窗口中最早的一行
+            std::vector<std::pair<LocalValue, LocalValue>> front;
+            std::vector<std::pair<LocalValue, LocalValue>> back;
+        };
+
+        // 一个分区的窗口
+        struct Window{
+            size_t size = 0;
+            // 每个参数在窗口各行上的取值，按到达的顺序
+            std::vector<std::deque<LocalValue>> values;
+            std::vector<Sum> sums;
+            std::vector<Extreme> extremes;
+        };
+
+        std::shared_ptr<LocalExpression> inclusion;
+        // inclusion 为整数时窗口的行数，否则为 0
+        size_t limit = 0;
+        std::vector<Strategy> strategies;
+        // 需要 subtract 状态的参数
+        std::vector<uint8_t> summed;
+        // 每个 wmin / wmax 在 Window::extremes 中的下标，其余为 -1
+        std::vector<int> extremeIndexes;
+        size_t extremeCount = 0;
+        std::vector<Window> windows;
+
+        LocalValue better(size_t call,const LocalValue& left,const LocalValue& right) const;
+
+        void push(Window& window,size_t row);
+
+        void pop(Window& window);
+
+        // 把窗口上各窗口函数的取值写入 work 的第 row 行
+        void fill(const Window& window,size_t row);
+
+    protected:
+        bool consume(size_t row) override;
+
+    public:
+        explicit LocalSlidingWindowOperator(const LocalStepDefinition& step);
+
+        /**
+         * 第 call 个窗口函数调用（按 getCalls 的顺序）使用的策略，不是聚合时为 NONE。
+         */
+        Strategy getStrategy(size_t call) const {
+            return strategies.at(call);
+        }
+
+        /**
+         * 按 text 查找窗口函数调用的策略，没有这个调用时为 NONE。
+         */
+        Strategy getStrategy(const std::string& text) const;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef LOCAL_SPOOL_H
+#define LOCAL_SPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "LocalBatch.h"
+
+/**
+ * 算子之间的批次队列，对应计划中的一个 s_N。一个 spool 可以有多个读者，
+ * 每个读者各自有一条队列，写入的批次共享给所有读者。队列不设上限，写入方不会阻塞。
+ * 读者不再需要批次时取消订阅，队列中的批次随即丢弃；所有读者都取消后写入方据此停止产生批次。
+ */
+class LocalSpool {
+    private:
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::vector<std::deque<std::shared_ptr<const LocalBatch>>> queues;
+        std::vector<uint8_t> cancelled;
+        size_t cancels = 0;
+        bool closed = false;
+
+    public:
+        /**
+         * 注册一个读者，返回读者编号。读者只能读到注册之后写入的批次。
+         */
+        int subscribe();
+
+        /**
+         * 写入一个批次，关闭之后写入的批次被丢弃。返回 false 表示所有读者都已取消，不再需要写入。
+         */
+        bool push(const std::shared_ptr<const LocalBatch>& batch);
+
+        /**
+         * 结束写入，读者读完队列中剩余的批次后读到 nullptr。
+         */
+        void close();
+
+        bool isClosed();
+
+        /**
+         * 读者 consumer 不再读取：丢弃它队列中的批次，之后写入的批次也不再给它，pop 返回 nullptr。
+         */
+        void cancel(int consumer);
+
+        /**
+         * 是否有读者且所有读者都已取消。
+         */
+        bool isCancelled();
+
+        /**
+         * 取出读者 consumer 的下一个批次，队列为空时等待；已经结束且队列为空时返回 nullptr。
+         */
+        std::shared_ptr<const LocalBatch> pop(int consumer);
+};
+
+#endif
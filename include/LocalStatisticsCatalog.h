@@ -0,0 +1,37 @@
+#ifndef LOCAL_STATISTICS_CATALOG_H
+#define LOCAL_STATISTICS_CATALOG_H
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "StatisticsCatalog.h"
+
+/**
+ * 基于本地文件的统计信息。文件按行书写，# 开头为注释：
+ *
+ *   table t1 rows=100000 width=64 rate=100
+ *   column t1 speed ndv=120 min=0 max=240 null_fraction=0.01 width=8
+ */
+class LocalStatisticsCatalog : public StatisticsCatalog {
+    private:
+        std::map<std::string, std::shared_ptr<TableStatistics>> tables;
+
+        std::shared_ptr<TableStatistics> getOrCreate(const std::string& table);
+
+    public:
+        LocalStatisticsCatalog();
+
+        std::shared_ptr<TableStatistics> getTableStatistics(const std::string& table) override;
+
+        void setTableStatistics(const std::string& table,std::shared_ptr<TableStatistics> statistics);
+
+        /**
+         * 从文件加载统计信息，同名的表和列会被覆盖。
+         */
+        void load(const std::string& path);
+
+        void parse(const std::string& content);
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef LOCAL_STEP_DEFINITION_H
+#define LOCAL_STEP_DEFINITION_H
+
+#include <map>
+#include <string>
+
+/**
+ * 计划中的一个步骤，由步骤字符串 Name?id=d_1,input=s_0,output=s_1(key=`value`,...) 解析而来。
+ */
+class LocalStepDefinition {
+    private:
+        std::string name;
+        std::map<std::string, std::string> attributes;
+        std::map<std::string, std::string> parameters;
+
+    public:
+        /**
+         * 解析步骤字符串，格式错误时抛出 EngineException。
+         */
+        static LocalStepDefinition parse(const std::string& step);
+
+        const std::string& getName() const {
+            return name;
+        }
+
+        /**
+         * id、input、input2、output 等属性，不存在时返回空串。
+         */
+        std::string getAttribute(const std::string& key) const {
+            auto iter = attributes.find(key);
+            return iter == attributes.end() ? "" : iter->second;
+        }
+
+        bool hasParameter(const std::string& key) const {
+            return parameters.find(key) != parameters.end();
+        }
+
+        /**
+         * 步骤参数，不存在时返回空串。
+         */
+        std::string getParameter(const std::string& key) const {
+            auto iter = parameters.find(key);
+            return iter == parameters.end() ? "" : iter->second;
+        }
+
+        const std::map<std::string, std::string>& getParameters() const {
+            return parameters;
+        }
+};
+
+#endif
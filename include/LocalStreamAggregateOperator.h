@@ -0,0 +1,89 @@
+#ifndef LOCAL_STREAM_AGGREGATE_OPERATOR_H
+#define LOCAL_STREAM_AGGREGATE_OPERATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalAggregate.h"
+#include "LocalAggregation.h"
+#include "LocalExpression.h"
+#include "LocalOperator.h"
+
+/**
+ * StreamAggregate 步骤：按 time 列（毫秒时间戳）落入的 interval 个 time_unit 的时间桶聚合 selects，
+ * 按时间桶的先后输出，time 为空值的行不参与聚合。
+ * keepTime 时在 selects 前输出以 time 命名的时间桶起点，PartialStreamAggregate 用它把部分状态交给合并步骤。
+ *
+ * 流式执行：只保留未关闭的时间桶，按桶编号放在环形缓冲区中（桶 b 位于 b & (capacity - 1)），聚合状态按列累加。
+ * 读到的最大时间减去可选的 lateness（同样以 time_unit 计）越过一个桶的结束时间时输出并清空这个桶，
+ * 之后落入已关闭的桶的迟到行被丢弃。内存只与未关闭的桶数有关，与输入的行数无关。
+ *
+ * holdBuckets 时（FinalStreamAggregate）不按读到的时间关闭桶：各设备上传部分状态的进度不同，
+ * 一个设备已经越过的桶仍可能收到其他设备的部分状态，所以所有桶保留到输入结束再按桶的先后输出，
+ * 环形缓冲区随读到的最早与最晚的桶向两端扩展。
+ */
+class LocalStreamAggregateOperator : public LocalOperator {
+    private:
+        LocalAggregation aggregation;
+        std::shared_ptr<LocalExpression> time;
+        int64_t width;
+        int64_t lateness = 0;
+        bool keepTime;
+        bool holdBuckets;
+
+        // 环形缓冲区的槽位数，最后多出的一个槽位收集迟到与时间为空的行，每批之后清空
+        size_t capacity = 0;
+        std::vector<LocalAggregate::States> states;
+        std::vector<uint8_t> filled;
+        bool started = false;
+        // 未关闭的桶为 [first, last]，watermark 为读到的最大时间
+        int64_t first = 0;
+        int64_t last = 0;
+        int64_t watermark = 0;
+        size_t lateRows = 0;
+        std::vector<int64_t> numbers;
+        std::vector<uint32_t> groups;
+
+        void grow(size_t span);
+
+        bool consume(const LocalBatch& batch);
+
+        /**
+         * 关闭编号小于 below 的桶并输出，返回 false 表示已经不需要更多输出。
+         */
+        bool close(int64_t below);
+
+        /**
+         * 输出槽位 [slot, slot + count) 中有数据的桶，第一个槽位的桶编号为 bucket。
+         */
+        bool flush(size_t slot,size_t count,int64_t bucket);
+
+    protected:
+        void run() override;
+
+    public:
+        LocalStreamAggregateOperator(const LocalStepDefinition& step,const std::string& selects,bool keepTime,bool holdBuckets = false);
+
+        /**
+         * interval 个 time_unit 的毫秒数。
+         */
+        static int64_t toMilliseconds(int64_t interval,const std::string& unit);
+
+        /**
+         * 环形缓冲区当前的槽位数。
+         */
+        size_t getCapacity() const {
+            return capacity;
+        }
+
+        /**
+         * 因为所在的桶已经关闭而丢弃的行数。
+         */
+        size_t getLateRows() const {
+            return lateRows;
+        }
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef LOCAL_TABLE_FILE_H
+#define LOCAL_TABLE_FILE_H
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalBatch.h"
+#include "LocalColumn.h"
+
+/**
+ * 本地执行器读写的表文件，逗号分隔的文本，第一行为带类型的列名：
+ *
+ *   vin:string,time:int,speed:double
+ *   LSV001,1700000000000,82.5
+ *
+ * 类型为 int、double、string，省略时为 string。空字段为空值，含逗号、引号或换行的字符串写在双引号内。
+ */
+class LocalTableFile final {
+    private:
+        LocalTableFile();
+
+    public:
+        /**
+         * 读取表头，返回各列的空列。
+         */
+        static std::vector<LocalColumn> readHeader(std::istream& in);
+
+        /**
+         * 按表头的列布局读取至多 rows 行，没有更多行时返回 nullptr。
+         */
+        static std::shared_ptr<LocalBatch> read(std::istream& in,const std::vector<LocalColumn>& layout,size_t rows);
+
+        static void writeHeader(std::ostream& out,const LocalBatch& batch);
+
+        static void write(std::ostream& out,const LocalBatch& batch);
+};
+
+#endif
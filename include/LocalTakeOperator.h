@@ -0,0 +1,22 @@
+#ifndef LOCAL_TAKE_OPERATOR_H
+#define LOCAL_TAKE_OPERATOR_H
+
+#include <cstdint>
+
+#include "LocalOperator.h"
+
+/**
+ * Take 步骤：只输出前 rows 行，取够后立即结束，上游随之取消。
+ */
+class LocalTakeOperator : public LocalOperator {
+    private:
+        int64_t rows;
+
+    protected:
+        void run() override;
+
+    public:
+        explicit LocalTakeOperator(const LocalStepDefinition& step);
+};
+
+#endif
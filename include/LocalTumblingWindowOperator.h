@@ -0,0 +1,90 @@
+#ifndef LOCAL_TUMBLING_WINDOW_OPERATOR_H
+#define LOCAL_TUMBLING_WINDOW_OPERATOR_H
+
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalExpression.h"
+#include "LocalWindowOperator.h"
+#include "LocalWindowState.h"
+
+/**
+ * TumblingWindow / TumblingSession 步骤：每个分区的行依次落入互不重叠的窗口，每个关闭的窗口输出一行。
+ *
+ * inclusion 为整数 N 时窗口满 N 行关闭；否则新的一行先按加入之后的窗口求 inclusion，为假时当前窗口关闭，
+ * 新的一行开始下一个窗口（窗口至少有一行），没有 inclusion 时窗口直到输入结束才关闭。输入结束时仍然打开的窗口
+ * 按分区编号的顺序关闭。selects 与 validity 中的普通列取窗口最后一行的值。
+ *
+ * 窗口函数的状态按分区编号平铺存放（LocalWindowState），窗口关闭时原地清空，分区数不变时不再分配内存。
+ * 分区按编号对线程数取模分给各线程，每个线程只读写自己的分区，不需要加锁；一批中关闭的窗口
+ * 按关闭它的行的顺序合并成一个批次输出，与线程数无关。
+ */
+class LocalTumblingWindowOperator : public LocalWindowOperator {
+    private:
+        // 一个线程：负责编号对线程数取模为 index 的分区，分区在 state 中的编号为分区编号除以线程数
+        struct Worker{
+            size_t index = 0;
+            std::unique_ptr<LocalWindowState> state;
+            // 当前批次中属于这个线程的行
+            std::vector<int64_t> rows;
+            // 按 rows 从 work 选出的行，用于求 inclusion，只有一个线程时为空（直接用 work）
+            std::shared_ptr<LocalBatch> batch;
+            // 本批关闭的窗口：每个窗口函数一列，以及关闭窗口的行号
+            std::vector<LocalColumn> closed;
+            std::vector<int64_t> closers;
+            std::exception_ptr error;
+        };
+
+        std::shared_ptr<LocalExpression> inclusion;
+        // inclusion 为整数时窗口的行数，否则为 0
+        size_t limit = 0;
+        size_t threads;
+        std::vector<Worker> workers;
+
+        // 清空 worker 本批关闭的窗口
+        void clear(Worker& worker);
+
+        // 把当前批次的行按分区分给各线程
+        void prepareWorkers();
+
+        // 关闭 worker 的第 key 个分区的窗口，closer 为关闭它的行号
+        void close(Worker& worker,uint32_t key,int64_t closer);
+
+        void process(Worker& worker);
+
+        // 把各线程关闭的窗口按关闭的顺序合并输出
+        bool emitClosed();
+
+    protected:
+        bool consume(size_t) override {
+            return true;
+        }
+
+        bool end() override;
+
+        bool finish() override;
+
+    public:
+        explicit LocalTumblingWindowOperator(const LocalStepDefinition& step);
+
+        size_t getThreads() const {
+            return threads;
+        }
+
+        /**
+         * 设置处理分区的线程数，默认为硬件线程数，需要在执行之前设置。
+         */
+        void setThreads(size_t threads){
+            this->threads = threads == 0 ? 1 : threads;
+        }
+
+        /**
+         * 每个分区的状态占用的字节数，不含分区 key 本身。
+         */
+        size_t getStateBytesPerKey() const;
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef LOCAL_TYPE_H
+#define LOCAL_TYPE_H
+
+#include <string>
+
+/**
+ * 本地执行器中列的类型，布尔值按 0 / 1 存成 INT。
+ */
+enum class LocalType{
+    INT,
+    DOUBLE,
+    STRING
+};
+
+inline std::string toString(LocalType type) {
+    switch (type) {
+        case LocalType::INT:    return "int";
+        case LocalType::DOUBLE: return "double";
+        case LocalType::STRING: return "string";
+        default:                return "unknown";
+    }
+}
+
+#endif
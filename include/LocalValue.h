@@ -0,0 +1,128 @@
+#ifndef LOCAL_VALUE_H
+#define LOCAL_VALUE_H
+
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <variant>
+
+#include "LocalType.h"
+
+/**
+ * 逐行求值时的单个值，可以为空。数值之间按数值比较，其余按字符串比较。
+ */
+class LocalValue {
+    private:
+        std::variant<std::monostate, int64_t, double, std::string> value;
+
+    public:
+        LocalValue(){}
+
+        LocalValue(int64_t value) : value(value){}
+
+        LocalValue(int value) : value(static_cast<int64_t>(value)){}
+
+        LocalValue(bool value) : value(static_cast<int64_t>(value ? 1 : 0)){}
+
+        LocalValue(double value) : value(value){}
+
+        LocalValue(const std::string& value) : value(value){}
+
+        LocalValue(const char* value) : value(std::string(value)){}
+
+        bool isNull() const {
+            return value.index() == 0;
+        }
+
+        bool isNumeric() const {
+            return value.index() == 1 || value.index() == 2;
+        }
+
+        // 空值没有类型，按 INT 返回
+        LocalType getType() const {
+            return value.index() == 2 ? LocalType::DOUBLE : value.index() == 3 ? LocalType::STRING : LocalType::INT;
+        }
+
+        int64_t asInt() const {
+            switch(value.index()){
+                case 1: return std::get<int64_t>(value);
+                case 2: return static_cast<int64_t>(std::get<double>(value));
+                case 3: return std::stoll(std::get<std::string>(value));
+                default: return 0;
+            }
+        }
+
+        double asDouble() const {
+            switch(value.index()){
+                case 1: return static_cast<double>(std::get<int64_t>(value));
+                case 2: return std::get<double>(value);
+                case 3: return std::stod(std::get<std::string>(value));
+                default: return 0;
+            }
+        }
+
+        std::string toString() const {
+            switch(value.index()){
+                case 1: return std::to_string(std::get<int64_t>(value));
+                case 2: {
+                    std::ostringstream out;
+                    out.precision(15);
+                    out << std::get<double>(value);
+                    return out.str();
+                }
+                case 3: return std::get<std::string>(value);
+                default: return "";
+            }
+        }
+
+        /**
+         * 作为条件时的真假，空值与 0 为假。
+         */
+        bool isTrue() const {
+            switch(value.index()){
+                case 1: return std::get<int64_t>(value) != 0;
+                case 2: return std::get<double>(value) != 0;
+                case 3: return !std::get<std::string>(value).empty();
+                default: return false;
+            }
+        }
+
+        /**
+         * 比较两个非空值，返回负数、0 或正数。
+         */
+        static int compare(const LocalValue& left,const LocalValue& right){
+            if(left.value.index() == 1 && right.value.index() == 1){
+                const int64_t l = std::get<int64_t>(left.value),r = std::get<int64_t>(right.value);
+                return l < r ? -1 : l > r ? 1 : 0;
+            }
+            if(left.isNumeric() && right.isNumeric()){
+                const double l = left.asDouble(),r = right.asDouble();
+                return l < r ? -1 : l > r ? 1 : 0;
+            }
+            return left.toString().compare(right.toString());
+        }
+
+        bool operator==(const LocalValue& other) const {
+            if(isNull() || other.isNull()){
+                return isNull() && other.isNull();
+            }
+            return compare(*this,other) == 0;
+        }
+
+        bool operator!=(const LocalValue& other) const {
+            return !(*this == other);
+        }
+
+        // 与 == 一致：数值相等的整数和浮点数哈希相同
+        size_t hash() const {
+            switch(value.index()){
+                case 1: return std::hash<double>()(static_cast<double>(std::get<int64_t>(value)));
+                case 2: return std::hash<double>()(std::get<double>(value));
+                case 3: return std::hash<std::string>()(std::get<std::string>(value));
+                default: return 0;
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,195 @@
+#ifndef LOCAL_WINDOW_OPERATOR_H
+#define LOCAL_WINDOW_OPERATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocalExpression.h"
+#include "LocalFilterKernel.h"
+#include "LocalGroupTable.h"
+#include "LocalOperator.h"
+
+/**
+ * 窗口步骤（SlidingWindow、TumblingWindow、PatternWindow 与对应的 Session）的公共部分。
+ *
+ * 行按 keys 分区（没有 keys 时整个输入是一个分区），分区用 LocalGroupTable 编成从 0 开始的连续编号，
+ * sorts 为空时每个分区内按到达的顺序处理；不为空时先读完全部输入，按 sorts 稳定排序（每项可以带 asc / desc，
+ * 空值排在最前）后再处理，各分区内的行因此按 sorts 的顺序到达。selects、validity 与子类的条件中可以使用窗口函数：
+ * wsize() 为窗口的行数，wcount / wsum / wavg / wmin / wmax(x) 为窗口中 x 的非空值的聚合，
+ * wlead(x) 与 wlag(x) 为窗口中最早与最晚一行的 x。x 是列名字符串（如 wsum('b')）或表达式。
+ *
+ * 窗口函数调用被替换成附加在当前批次后面的列，子类处理一行时把这一行所在窗口的取值写入这些列，
+ * 再用 mark 选出要输出的行；一批处理完后按列求 validity 与 selects，其中普通的列取被选出的行上的值。
+ * Session 步骤在本地按同样的方式执行。
+ */
+class LocalWindowOperator : public LocalOperator {
+    public:
+        enum class Function{ SIZE, COUNT, SUM, AVG, MIN, MAX, LEAD, LAG };
+
+        // 一个窗口函数调用，相同的调用只保留一个
+        struct Call{
+            Function function;
+            std::string text;
+            // 参数在 getArgument 中的下标，wsize() 为 -1
+            int argument = -1;
+        };
+
+    private:
+        std::vector<std::string> names;
+        // * 对应的项为 nullptr
+        std::vector<std::shared_ptr<LocalExpression>> selects;
+        std::shared_ptr<LocalExpression> validity;
+        std::shared_ptr<LocalFilterKernel> kernel;
+        std::shared_ptr<LocalGroupTable> partitions;
+        std::vector<Call> calls;
+        std::vector<std::shared_ptr<LocalExpression>> arguments;
+        // 引用窗口函数列的表达式，每批绑定到 work
+        std::vector<std::shared_ptr<LocalExpression>> expressions;
+        std::vector<LocalColumn> evaluated;
+        std::vector<const LocalColumn*> values;
+        std::vector<int64_t> marked;
+        size_t inputColumns = 0;
+        bool perWindow;
+        // sorts 的各项与是否降序
+        std::vector<std::shared_ptr<LocalExpression>> sorts;
+        std::vector<bool> descending;
+
+        // lastRow 时把不在窗口函数参数中的列改写成 wlag(列)
+        std::shared_ptr<LocalExpression> rewrite(const std::shared_ptr<LocalExpression>& expr,bool lastRow);
+
+        std::shared_ptr<LocalExpression> compile(const std::string& text,bool lastRow);
+
+        // 为一个输入批次准备 work、分区编号与参数的取值
+        void prepare(const std::shared_ptr<const LocalBatch>& batch);
+
+        // 处理一个输入批次，返回 false 表示不需要更多输出
+        bool process(const std::shared_ptr<const LocalBatch>& batch);
+
+        // 读完全部输入并按 sorts 稳定排序，没有输入时返回 nullptr
+        std::shared_ptr<const LocalBatch> sortInput();
+
+        // 对 mark 选出的行求 validity 与 selects 并输出
+        bool flush();
+
+        // 对 candidates 求 validity 与 selects 并输出
+        bool output(const LocalBatch& candidates);
+
+    protected:
+        // 当前批次加上每个窗口函数调用一列
+        LocalBatch work;
+        // 当前批次每行的分区编号
+        std::vector<uint32_t> partitionIds;
+
+        /**
+         * 解析子类使用的条件，其中的窗口函数调用与 selects、validity 共用窗口函数列。
+         */
+        std::shared_ptr<LocalExpression> compile(const std::string& text);
+
+        const std::vector<Call>& getCalls() const {
+            return calls;
+        }
+
+        /**
+         * compile 得到的条件是否用到了窗口函数。
+         */
+        static bool referencesCalls(const LocalExpression& expr);
+
+        /**
+         * 目前为止出现过的分区数，分区编号小于它。
+         */
+        size_t getPartitionCount() const {
+            return partitions == nullptr ? 1 : partitions->size();
+        }
+
+        size_t getArgumentCount() const {
+            return arguments.size();
+        }
+
+        /**
+         * 第 argument 个参数在当前批次上的取值。
+         */
+        const LocalColumn& getArgument(size_t argument) const {
+            return *values[argument];
+        }
+
+        const std::vector<const LocalColumn*>& getArguments() const {
+            return values;
+        }
+
+        /**
+         * 把第 call 个窗口函数在第 row 行的取值写入 work。
+         */
+        void setCall(size_t call,size_t row,const LocalValue& value){
+            setCall(work,call,row,value);
+        }
+
+        /**
+         * 把第 call 个窗口函数在第 row 行的取值写入与 work 列布局相同的 batch（如 work 的一部分行）。
+         */
+        void setCall(LocalBatch& batch,size_t call,size_t row,const LocalValue& value) const {
+            batch.getColumn(inputColumns + call).set(row,value);
+        }
+
+        /**
+         * condition 在 work 第 row 行上是否为真，调用前先写好这一行的窗口函数取值。
+         */
+        bool test(const LocalExpression& condition,size_t row) const {
+            return condition.evaluate(work,row).isTrue();
+        }
+
+        /**
+         * 输出已经关闭的窗口：windows 的第 c 列为第 c 个窗口函数在各窗口上的取值，每行一个窗口。
+         * 只能用于按窗口输出的算子，selects 与 validity 中的普通列取窗口最后一行的值。
+         */
+        bool emitWindows(LocalBatch& windows);
+
+        /**
+         * 输出 work 的第 row 行（还要满足 validity），行号需要递增。
+         */
+        void mark(size_t row){
+            marked.push_back(static_cast<int64_t>(row));
+        }
+
+        /**
+         * 开始处理一个批次，work 与 partitionIds 已经准备好。
+         */
+        virtual void start(){
+        }
+
+        /**
+         * 处理当前批次的第 row 行，返回 false 表示不需要更多输出。
+         */
+        virtual bool consume(size_t row) = 0;
+
+        /**
+         * 当前批次的行都处理完之后的处理，在输出 mark 选出的行之前，返回 false 表示不需要更多输出。
+         */
+        virtual bool end(){
+            return true;
+        }
+
+        /**
+         * 输入读完之后的处理。
+         */
+        virtual bool finish(){
+            return true;
+        }
+
+        void run() override;
+
+    public:
+        /**
+         * perWindow 时每个关闭的窗口输出一行（TumblingWindow），selects 与 validity 中不在窗口函数参数中的列
+         * 按 wlag 取窗口最后一行的值，不支持 *。
+         */
+        explicit LocalWindowOperator(const LocalStepDefinition& step,bool perWindow = false);
+
+        /**
+         * 窗口函数名对应的函数，不是窗口函数时返回 false。
+         */
+        static bool toFunction(const std::string& name,Function& function);
+};
+
+#endif
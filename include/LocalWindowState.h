@@ -0,0 +1,84 @@
+#ifndef LOCAL_WINDOW_STATE_H
+#define LOCAL_WINDOW_STATE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LocalColumn.h"
+#include "LocalValue.h"
+#include "LocalWindowOperator.h"
+
+/**
+ * 只追加行的窗口（PatternWindow、TumblingWindow）的窗口函数状态，按分区编号平铺存放，不为每个分区分配对象：
+ * 窗口行数 4 字节；wcount / wsum / wavg 的每个参数一组非空值个数、整数和、其余数值的和与是否有非整数值；
+ * wmin / wmax / wlead / wlag 各一列按分区编号存放的值（LocalColumn，按取值的类型存放）。
+ * 窗口关闭时用 reset 原地清空，分区数不变时不再分配内存。
+ */
+class LocalWindowState {
+    private:
+        std::vector<LocalWindowOperator::Call> calls;
+        // 每个参数在 counts 等数组中的下标，不需要累加时为 -1
+        std::vector<int> sumIndexes;
+        std::vector<uint32_t> sizes;
+        std::vector<std::vector<int64_t>> counts;
+        std::vector<std::vector<int64_t>> ints;
+        std::vector<std::vector<double>> doubles;
+        // 窗口中有非整数值，和按 DOUBLE 输出
+        std::vector<std::vector<uint8_t>> fractional;
+        // 每个 wmin / wmax / wlead / wlag 在 values 中的下标，其余为 -1
+        std::vector<int> valueIndexes;
+        std::vector<LocalColumn> values;
+
+        // 窗口中的值与 value 里较小（wmin）或较大（wmax）的一个
+        LocalValue better(size_t call,const LocalValue& current,const LocalValue& value) const;
+
+    public:
+        LocalWindowState(const std::vector<LocalWindowOperator::Call>& calls,size_t arguments);
+
+        /**
+         * 分区数。
+         */
+        size_t size() const {
+            return sizes.size();
+        }
+
+        /**
+         * 把分区数扩大到 keys，新的分区的窗口为空。
+         */
+        void grow(size_t keys);
+
+        /**
+         * 分区 key 的窗口行数。
+         */
+        uint32_t getRows(uint32_t key) const {
+            return sizes[key];
+        }
+
+        /**
+         * 清空分区 key 的窗口。
+         */
+        void reset(uint32_t key);
+
+        /**
+         * 把第 row 行加入分区 key 的窗口，arguments 为各参数在这一批上的取值。
+         */
+        void append(uint32_t key,const std::vector<const LocalColumn*>& arguments,size_t row);
+
+        /**
+         * 第 call 个窗口函数在分区 key 的窗口上的取值。
+         */
+        LocalValue get(size_t call,uint32_t key) const;
+
+        /**
+         * 第 call 个窗口函数在分区 key 的窗口再加入第 row 行之后的取值，窗口本身不变。
+         */
+        LocalValue get(size_t call,uint32_t key,const std::vector<const LocalColumn*>& arguments,size_t row) const;
+
+        /**
+         * 每个分区占用的字节数。
+         */
+        size_t getBytesPerKey() const;
+};
+
+#endif
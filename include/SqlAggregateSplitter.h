@@ -0,0 +1,27 @@
+#ifndef SQL_AGGREGATE_SPLITTER_H
+#define SQL_AGGREGATE_SPLITTER_H
+
+#include <string>
+
+/**
+ * 两阶段聚合的拆分。sum、count、min、max 可以先在各个边缘按 key 算出部分状态，
+ * 再在云端按同样的 key 合并（count 的状态求和，其余取同名聚合），avg 拆成 sum 与 count 两个状态。
+ * 合并时 selects 中的每个聚合调用都能在部分状态里找到同样写法的调用（avg(x) 对应 sum(x) 与 count(x)）。
+ */
+class SqlAggregateSplitter final {
+    private:
+        SqlAggregateSplitter();
+
+    public:
+        static const std::string STATE_PREFIX;
+
+        /**
+         * 拆出 selects 中聚合的部分状态，states 为 "聚合调用 as 状态列" 的列表，相同的调用只保留一个，
+         * 状态列名避开 reserved 中出现过的名字。
+         * keys 为空时按时间桶聚合。key 不是列名、没有聚合、不含聚合的 select 项不是 key，
+         * 或有不能拆分的聚合（distinct、嵌套聚合、其它聚合函数）时返回 false。
+         */
+        static bool split(const std::string& keys,const std::string& selects,const std::string& reserved,std::string& states);
+};
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef SQL_COST_ESTIMATOR_H
+#define SQL_COST_ESTIMATOR_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "StatisticsCatalog.h"
+#include "SqlJoinType.h"
+#include "SqlRelation.h"
+#include "SqlStepEstimate.h"
+
+/**
+ * 基数与代价估算。规划器每生成一个步骤就调用对应的方法，结果按步骤 id 记录，
+ * 上游步骤以其输出 spool 的 id 引用（与步骤 id 相同）。
+ * 没有统计信息时使用保守的默认值。
+ */
+class SqlCostEstimator {
+    public:
+        static constexpr double DEFAULT_ROW_COUNT = 10000;
+        static constexpr double DEFAULT_ROW_WIDTH = 64;
+        static constexpr double DEFAULT_COLUMN_WIDTH = 8;
+        static constexpr double DEFAULT_EQUALITY_SELECTIVITY = 0.1;
+        static constexpr double DEFAULT_RANGE_SELECTIVITY = 1.0 / 3;
+        static constexpr double DEFAULT_SELECTIVITY = 0.25;
+        static constexpr double DEFAULT_NULL_FRACTION = 0.1;
+        static constexpr double DEFAULT_GROUP_RATIO = 0.1;
+        // 广播连接构建侧的默认内存预算（字节）
+        static constexpr double DEFAULT_BROADCAST_BUDGET = 8 * 1024 * 1024;
+        // 没有统计时流式数据源每秒产生的行数
+        static constexpr double DEFAULT_ROW_RATE = 100;
+        // Bloom 过滤器的默认误判率
+        static constexpr double DEFAULT_BLOOM_FALSE_POSITIVE_RATE = 0.01;
+
+    private:
+        std::shared_ptr<StatisticsCatalog> catalog;
+        std::map<int, SqlStepEstimate> estimates;
+
+        SqlStepEstimate record(int id,const SqlStepEstimate& estimate);
+
+        double distinctCount(const std::shared_ptr<TableStatistics>& statistics,const std::string& column,double rows) const;
+
+        double predicateSelectivity(const std::string& predicate,const std::shared_ptr<TableStatistics>& statistics) const;
+
+    public:
+        explicit SqlCostEstimator(std::shared_ptr<StatisticsCatalog> catalog);
+
+        std::shared_ptr<StatisticsCatalog> getCatalog() const;
+
+        SqlStepEstimate input(int id,const std::string& table);
+
+        SqlStepEstimate empty(int id);
+
+        SqlStepEstimate filter(int id,int input,const std::string& condition);
+
+        SqlStepEstimate project(int id,int input,const std::string& selects);
+
+        SqlStepEstimate aggregate(int id,int input,const std::string& keys,const std::string& selects);
+
+        SqlStepEstimate window(int id,int input);
+
+        /**
+         * 等值连接的 key 由 leftKeys / rightKeys 给出，此时 condition 为 key 相等之外还要检查的 residual；
+         * key 为空时按嵌套循环连接估算 condition。
+         * broadcast 为 true 时右侧广播建表，省去两侧的分区代价。
+         */
+        SqlStepEstimate join(int id,int left,int right,
+                             const std::vector<std::string>& leftKeys,
+                             const std::vector<std::string>& rightKeys,
+                             const std::string& condition,
+                             const std::string& joinType,
+                             bool broadcast = false);
+
+        /**
+         * 区间连接：每行只和另一侧区间内的行比较，区间条件按范围条件的默认选择率估算。
+         * key 可以为空，residual 为区间条件之外还要检查的条件。
+         */
+        SqlStepEstimate intervalJoin(int id,int left,int right,
+                                     const std::vector<std::string>& leftKeys,
+                                     const std::vector<std::string>& rightKeys,
+                                     const std::string& residual,
+                                     const std::string& joinType);
+
+        /**
+         * ASOF 连接：左侧每行最多连接一行右侧记录，输出行数与左侧相同。
+         */
+        SqlStepEstimate asofJoin(int id,int left,int right,
+                                 const std::vector<std::string>& leftKeys,
+                                 const std::vector<std::string>& rightKeys);
+
+        /**
+         * 在步骤 build 的 keys 上建 Bloom 过滤器，输出一行，行宽为过滤器的字节数。
+         */
+        SqlStepEstimate bloomBuild(int id,int build,const std::vector<std::string>& keys,double falsePositiveRate);
+
+        /**
+         * 用步骤 build 的 buildKeys 上建的 Bloom 过滤器过滤步骤 probe，按 bloomSelectivity 保留行。
+         */
+        SqlStepEstimate bloomFilter(int id,int probe,const std::vector<std::string>& probeKeys,
+                                    int build,const std::vector<std::string>& buildKeys,double falsePositiveRate);
+
+        SqlStepEstimate take(int id,int input,int rows);
+
+        /**
+         * 层间传输：行数与行宽不变，代价按传输的行数计。
+         */
+        SqlStepEstimate exchange(int id,int input);
+
+        SqlStepEstimate output(int id,int input);
+
+        /**
+         * 条件的选择率，statistics 为条件所引用列的统计，可以为空。
+         */
+        double selectivity(const std::string& condition,const std::shared_ptr<TableStatistics>& statistics) const;
+
+        /**
+         * 步骤 left 的 leftKey 与步骤 right 的 rightKey 等值连接的选择率（1 / 较大的不同值个数）。
+         */
+        double joinSelectivity(int left,const std::string& leftKey,int right,const std::string& rightKey) const;
+
+        /**
+         * Bloom 过滤器要容纳的元素个数：步骤 build 的 keys 组合的不同值个数。
+         */
+        double bloomItems(int build,const std::vector<std::string>& keys) const;
+
+        /**
+         * 探测侧的 key 在构建侧出现的行全部保留，其余的行按误判率保留，返回保留的比例。
+         */
+        double bloomSelectivity(int probe,const std::vector<std::string>& probeKeys,
+                                int build,const std::vector<std::string>& buildKeys,double falsePositiveRate) const;
+
+        /**
+         * 容纳 items 个元素、误判率为 falsePositiveRate 时 Bloom 过滤器的最优位数 -n ln p / (ln 2)^2。
+         */
+        static double bloomBits(double items,double falsePositiveRate);
+
+        /**
+         * 位数为 bits、元素个数为 items 时的最优哈希函数个数 (m / n) ln 2，至少为 1。
+         */
+        static int bloomHashes(double bits,double items);
+
+        /**
+         * 步骤输出是否确定（基于统计信息）能放进 budget 字节的内存。
+         */
+        bool fitsInMemory(int id,double budget) const;
+
+        /**
+         * 等值连接是否以右侧 relation 为构建侧广播（仅 inner / left 连接）：
+         * relation 的别名或表名在 hints 中，或构建侧 buildSpool 确定能放进 budget 字节的内存。
+         */
+        bool isBroadcastJoin(SqlJoinType type,const std::shared_ptr<SqlRelation>& relation,int buildSpool,
+                             const std::unordered_set<std::string>& hints,double budget) const;
+
+        bool has(int id) const;
+
+        SqlStepEstimate get(int id) const;
+
+        /**
+         * 从步骤字符串中取出步骤 id（d_N 中的 N），没有 id 时返回 -1。
+         */
+        static int stepId(const std::string& step);
+
+        /**
+         * 把步骤和估算拼成 EXPLAIN 的一行。
+         */
+        static std::string explain(const std::string& step,const SqlStepEstimate& estimate);
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef SQL_CPU_CLASS_H
+#define SQL_CPU_CLASS_H
+
+#include <string>
+
+/**
+ * 部署层的 CPU 等级，按算力从低到高排列。
+ */
+enum class SqlCpuClass{
+    LOW,
+    MEDIUM,
+    HIGH
+};
+
+inline std::string toString(SqlCpuClass cpuClass) {
+    switch (cpuClass) {
+        case SqlCpuClass::LOW:    return "LOW";
+        case SqlCpuClass::MEDIUM: return "MEDIUM";
+        case SqlCpuClass::HIGH:   return "HIGH";
+        default:                  return "UNKNOWN";
+    }
+}
+
+#endif
@@ -3,13 +3,29 @@
 
 #include <vector>
 #include <string>
+
+#include "SqlStepEstimate.h"
+#include "SqlCostEstimator.h"
+
 class SqlDistributedPlan{
     private:
         std::vector<std::string> cloudPlan;
         std::vector<std::string> edgePlan;
+        std::vector<std::string> diagnostics;
+        std::vector<SqlStepEstimate> cloudEstimates;
+        std::vector<SqlStepEstimate> edgeEstimates;
+        // 分层部署时从设备到云端各层的名称、步骤和估算，未配置分层时为空
+        std::vector<std::string> tiers;
+        std::vector<std::vector<std::string>> tierPlans;
+        std::vector<std::vector<SqlStepEstimate>> tierEstimates;
+        // 估算的边缘到云端的上传带宽（字节每秒）
+        double uploadBytesPerSecond = 0;
     public:
         SqlDistributedPlan(std::vector<std::string> cloudPlan,std::vector<std::string> edgePlan) : cloudPlan(cloudPlan),edgePlan(edgePlan){}
 
+        SqlDistributedPlan(std::vector<std::string> cloudPlan,std::vector<std::string> edgePlan,std::vector<std::string> diagnostics)
+            : cloudPlan(cloudPlan),edgePlan(edgePlan),diagnostics(diagnostics){}
+
         const std::vector<std::string>& getCloudPlan() const {
             return cloudPlan;
         }
@@ -25,6 +41,88 @@ class SqlDistributedPlan{
             edgePlan = plan;
         }
 
+        // 与 cloudPlan / edgePlan 一一对应的估算结果
+        const std::vector<SqlStepEstimate>& getCloudEstimates() const {
+            return cloudEstimates;
+        }
+
+        void setCloudEstimates(std::vector<SqlStepEstimate> estimates){
+            cloudEstimates = estimates;
+        }
+
+        const std::vector<SqlStepEstimate>& getEdgeEstimates() const {
+            return edgeEstimates;
+        }
+
+        void setEdgeEstimates(std::vector<SqlStepEstimate> estimates){
+            edgeEstimates = estimates;
+        }
+
+        double getUploadBytesPerSecond() const {
+            return uploadBytesPerSecond;
+        }
+
+        void setUploadBytesPerSecond(double uploadBytesPerSecond){
+            this->uploadBytesPerSecond = uploadBytesPerSecond;
+        }
+
+        const std::vector<std::string>& getTiers() const {
+            return tiers;
+        }
+
+        const std::vector<std::vector<std::string>>& getTierPlans() const {
+            return tierPlans;
+        }
+
+        const std::vector<std::vector<SqlStepEstimate>>& getTierEstimates() const {
+            return tierEstimates;
+        }
+
+        /**
+         * 设置分层部署的结果，edgePlan / cloudPlan 同时改为第一层与最后一层的步骤。
+         */
+        void setTierPlans(std::vector<std::string> tiers,
+                          std::vector<std::vector<std::string>> plans,
+                          std::vector<std::vector<SqlStepEstimate>> estimates){
+            this->tiers = tiers;
+            this->tierPlans = plans;
+            this->tierEstimates = estimates;
+            if(!plans.empty()){
+                edgePlan = plans.front();
+                edgeEstimates = estimates.front();
+                cloudPlan = plans.back();
+                cloudEstimates = estimates.back();
+            }
+        }
+
+        /**
+         * EXPLAIN 输出：先 edge 后 cloud（分层时按层的顺序，以层名开头），每个步骤后附带估算的行数、行宽和累计代价。
+         */
+        std::vector<std::string> explain() const {
+            std::vector<std::string> lines;
+            if(!tiers.empty()){
+                for(size_t t = 0;t < tiers.size();++t){
+                    for(size_t i = 0;i < tierPlans.at(t).size();++i){
+                        lines.push_back(tiers.at(t) + ": " + SqlCostEstimator::explain(tierPlans.at(t).at(i),
+                            i < tierEstimates.at(t).size() ? tierEstimates.at(t).at(i) : SqlStepEstimate()));
+                    }
+                }
+                return lines;
+            }
+            for(size_t i = 0;i < edgePlan.size();++i){
+                lines.push_back("edge: " + SqlCostEstimator::explain(edgePlan.at(i),i < edgeEstimates.size() ? edgeEstimates.at(i) : SqlStepEstimate()));
+            }
+            for(size_t i = 0;i < cloudPlan.size();++i){
+                lines.push_back("cloud: " + SqlCostEstimator::explain(cloudPlan.at(i),i < cloudEstimates.size() ? cloudEstimates.at(i) : SqlStepEstimate()));
+            }
+            return lines;
+        }
+
+        // 规划过程的诊断信息，形如 key=value
+        const std::vector<std::string>& getDiagnostics() const {
+            return diagnostics;
+        }
+
 };
 
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <unordered_set>
 
 #include "ClassDefinition.h"
 #include "XStringUtils.h"
@@ -17,9 +18,60 @@
 #include "PatternWindowSpec.h"
 #include "SlidingWindowSpec.h"
 #include "TumblingWindowSpec.h"
+#include "StatisticsCatalog.h"
+#include "SqlCostEstimator.h"
+#include "SqlJoinChain.h"
+#include "SqlTierProfile.h"
 
 class SqlDistributedPlanner{
+    private:
+        std::shared_ptr<StatisticsCatalog> catalog = nullptr;
+        // 当前规划过程的估算器，每次 plan 时重建
+        std::shared_ptr<SqlCostEstimator> estimator = nullptr;
+        // 广播连接构建侧（右侧）允许占用的内存（字节）
+        double broadcastBudget = SqlCostEstimator::DEFAULT_BROADCAST_BUDGET;
+        // 强制广播的关系（别名或表名）
+        std::unordered_set<std::string> broadcastHints;
+        // 云端连接下发到边缘的 Bloom 过滤器的误判率，不在 (0, 1) 内时不生成过滤器
+        double bloomFalsePositiveRate = SqlCostEstimator::DEFAULT_BLOOM_FALSE_POSITIVE_RATE;
+        // 边缘单个步骤的状态可以占用的内存（字节），小于 0 时不限
+        double edgeMemoryBudget = -1;
+        // 分层部署时从设备到云端的各层，为空时只分 edge / cloud 两层
+        std::vector<SqlTierProfile> tiers;
+
     public:
+        /**
+         * 设置统计信息来源，未设置时按默认值估算。
+         */
+        void setStatisticsCatalog(std::shared_ptr<StatisticsCatalog> catalog);
+
+        /**
+         * 设置广播连接的内存预算，统计信息表明右侧输出不超过预算时使用 BroadcastHashJoin。
+         */
+        void setBroadcastBudget(double bytes);
+
+        /**
+         * 提示把别名或表名为 relation 的连接右侧广播，不再参考统计信息。
+         */
+        void addBroadcastHint(const std::string& relation);
+
+        /**
+         * 设置 Bloom 过滤器的误判率，误判率越低过滤器越大、上传的行越少，不在 (0, 1) 内时关闭半连接过滤。
+         */
+        void setBloomFalsePositiveRate(double rate);
+
+        /**
+         * 设置边缘单个步骤可用的内存，状态（构建侧、聚合、窗口）估算超出预算的步骤及其下游改在云端运行。
+         */
+        void setEdgeMemoryBudget(double bytes);
+
+        /**
+         * 设置分层部署的各层（从设备到云端）。至少两层时，原本在边缘运行的步骤放在不低于其输入、
+         * 且支持该步骤类型、CPU 等级和内存都满足要求的最低一层，中间层按设备分别运行这些步骤；
+         * 原本在云端运行的步骤放在最后一层；数据跨层时在发送方插入逐层传输的 Exchange。
+         */
+        void setTiers(const std::vector<SqlTierProfile>& tiers);
+
         std::shared_ptr<SqlDistributedPlan> plan(const std::shared_ptr<SqlStatement>& stmt);
 
     protected:
@@ -31,6 +83,100 @@ class SqlDistributedPlanner{
                 std::shared_ptr<MutableInt> lastSpool);
 
     private:
+        /**
+         * 调整 edge / cloud 的切分：先把云端不依赖云端结果的输入链拉回边缘（pullToEdge），
+         * 超出边缘内存预算的步骤及其下游移到云端；
+         * 再把紧挨着切分点的逐行步骤（Filter / Project / BloomFilter）按上传字节最少的位置移到云端。
+         */
+        void chooseCut(std::vector<std::string>& edgePlan,std::vector<std::string>& cloudPlan) const;
+
+        // 云端的 Input 及其后只有一个下游的 Filter / Project 链按上传字节最少的长度移到边缘
+        void pullToEdge(std::vector<std::string>& edgePlan,std::vector<std::string>& cloudPlan) const;
+
+        // 跨过切分点上传的字节数，云端的 Input 按整表上传计算，没有云端步骤时为边缘最后一个步骤的输出
+        double uploadBytes(const std::vector<std::string>& edgePlan,const std::vector<std::string>& cloudPlan) const;
+
+        // 按所有输入的速率把上传的字节数换算成每秒的字节数
+        double uploadBytesPerSecond(const std::vector<std::string>& edgePlan,const std::vector<std::string>& cloudPlan) const;
+
+        // 把 edge / cloud 两层的规划结果分配到各层，nextId 为可用的下一个步骤 id
+        void placeTiers(const std::vector<std::string>& edgePlan,const std::vector<std::string>& cloudPlan,
+                int nextId,const std::shared_ptr<SqlDistributedPlan>& result);
+
+        // 步骤的状态（哈希表、构建侧、窗口等）需要的内存估算（字节）
+        double requiredMemory(const std::string& step) const;
+
+        // 运行该类步骤需要的最低 CPU 等级
+        static SqlCpuClass requiredCpuClass(const std::string& name);
+
+        /**
+         * 半连接过滤：落在云端的等值连接左侧仍在边缘时，在云端对右侧的 key 建 BloomBuild，
+         * 下发到边缘用 BloomFilter 先过滤左侧再上传。估算上传节省的字节不超过过滤器大小时不生成。
+         * 返回连接左侧应使用的 spool。
+         */
+        int planBloomFilter(const std::shared_ptr<SqlStatement>& stmt,SqlJoinType type,
+                const std::vector<std::string>& lefts,
+                const std::vector<std::string>& rights,
+                int leftSpool,int rightSpool,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt>& edgeRunnable,
+                std::shared_ptr<MutableInt>& currentId);
+
+        // ASOF 连接：左侧每行连接 key 相同、满足 left_time match right_time 的最近一行右侧记录
+        void planAsofJoin(const std::shared_ptr<ClassDefinition>& step,const SqlJoinStep& join,
+                int id,int leftSpool,int rightSpool);
+
+        // 区间连接：right_time - left_time 落在 [lower, upper] 内的行对才会连接
+        void planIntervalJoin(const std::shared_ptr<ClassDefinition>& step,const SqlJoinStep& join,
+                int id,int leftSpool,int rightSpool,const std::string& joinType);
+
+        // 在上一个步骤之后追加 Project，保留全部列并追加计算列
+        void planComputes(const std::shared_ptr<SqlStatement>& stmt,
+                const std::string& computes,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt>& edgeRunnable,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool);
+
+        // 在上一个步骤之后追加 Filter
+        void planFilter(const std::shared_ptr<SqlStatement>& stmt,
+                const std::string& condition,
+                bool switchOverPushdown,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt>& edgeRunnable,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool);
+
+        // 规划连接右侧关系的输入（子查询或表）
+        void planRelation(const std::shared_ptr<SqlStatement>& stmt,
+                const std::shared_ptr<SqlRelation>& relation,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt>& edgeRunnable,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool);
+
+        // 多路连接：按连接顺序展开成一串二元连接，filters 为下推到各关系输入上的条件
+        void planJoins(const std::shared_ptr<SqlStatement>& stmt,
+                const std::string& selects,
+                const std::vector<std::string>& filters,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt>& edgeRunnable,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool);
+
+        // 条件恒假的语句只输出一个空数据源（以及 into 对应的 Output）
+        void planEmpty(const std::shared_ptr<SqlStatement>& stmt,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt> edgeRunnable,
+                std::shared_ptr<MutableInt> currentId,
+                std::shared_ptr<MutableInt> lastSpool);
+
         void addStep(const std::shared_ptr<SqlStatement>& stmt,
                     const std::shared_ptr<ClassDefinition>& step,
                     std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
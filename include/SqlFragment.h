@@ -11,6 +11,7 @@ enum class SqlFragment{
     INTERVAL_BY,
     JOIN,
     JOIN_ON,
+    MATCH_CONDITION,
     ORDER_BY,
     PARTITION_BY,
     SELECT,
@@ -29,6 +30,7 @@ inline std::string toString(SqlFragment type) {
         case SqlFragment::INTERVAL_BY: return "INTERVAL_BY";
         case SqlFragment::JOIN: return "JOIN";
         case SqlFragment::JOIN_ON: return "JOIN_ON";
+        case SqlFragment::MATCH_CONDITION: return "MATCH_CONDITION";
         case SqlFragment::ORDER_BY: return "ORDER_BY";
         case SqlFragment::PARTITION_BY: return "PARTITION_BY";
         case SqlFragment::SELECT: return "SELECT";
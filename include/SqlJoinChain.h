@@ -0,0 +1,69 @@
+#ifndef SQL_JOIN_CHAIN_H
+#define SQL_JOIN_CHAIN_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SqlStatement.h"
+#include "SqlRelation.h"
+#include "SqlJoinStep.h"
+#include "SqlCostEstimator.h"
+
+/**
+ * 语句中 from 与各个 join 组成的连接链。第 0 个关系是 from，第 i 个关系是第 i 个 join 的右侧。
+ * 全部为内连接时各连接条件按 and 拆开后合并成连接图，可以任意调整连接顺序；
+ * 含外连接时保持书写顺序，每个连接只检查自己的 on 条件。
+ */
+class SqlJoinChain {
+    private:
+        std::vector<std::shared_ptr<SqlRelation>> relations;
+        std::vector<SqlJoinType> types;
+        // 每个关系的 ASOF 匹配条件，不是 ASOF 连接时为空串
+        std::vector<std::string> matches;
+        // 会被外连接补空的关系，where 中引用它们的条件不能下推
+        std::vector<bool> nullable;
+        std::vector<std::string> conditions;
+        // 条件所属的关系（写在哪个 join 的 on 中）
+        std::vector<int> owners;
+        // 条件引用到的关系
+        std::vector<std::vector<bool>> references;
+        bool reorderable = true;
+
+        // 带别名前缀的列所属的关系与去掉前缀的列名，不属于任何关系时返回 false
+        bool qualified(const std::string& column,int& relation,std::string& name) const;
+
+        // 等值条件两侧的关系与列，不是跨两个关系的等值条件时返回 false
+        bool equality(int condition,int& left,std::string& leftKey,int& right,std::string& rightKey) const;
+
+        // relation 与已连接关系之间的区间条件，写成 relation 的列减去另一侧的列落在 [lower, upper] 内，单侧条件只写一个界
+        bool band(int condition,int relation,const std::vector<bool>& joined,
+                  int& left,std::string& leftTime,std::string& rightTime,std::string& lower,std::string& upper) const;
+
+    public:
+        explicit SqlJoinChain(const std::shared_ptr<SqlStatement>& stmt);
+
+        size_t size() const;
+
+        std::shared_ptr<SqlRelation> getRelation(int relation) const;
+
+        bool isReorderable() const;
+
+        /**
+         * 把 where 中只引用一个关系的条件下推到该关系的输入上，被外连接补空的关系除外。
+         * 返回每个关系下推的条件（已去掉别名前缀，没有时为空串），where 中只保留其余条件。
+         */
+        std::vector<std::string> pushdown(std::string& where) const;
+
+        /**
+         * 连接顺序：可调整时按 spools 中各关系输入的估算求代价最小的顺序，否则为书写顺序。
+         */
+        std::vector<int> order(const std::shared_ptr<SqlCostEstimator>& estimator,const std::vector<int>& spools) const;
+
+        /**
+         * 按 order 展开成二元连接，第一个关系作为最左侧的输入，不单独生成连接。
+         */
+        std::vector<SqlJoinStep> steps(const std::vector<int>& order) const;
+};
+
+#endif
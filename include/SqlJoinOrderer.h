@@ -0,0 +1,55 @@
+#ifndef SQL_JOIN_ORDERER_H
+#define SQL_JOIN_ORDERER_H
+
+#include <vector>
+
+/**
+ * 多路内连接的连接顺序枚举，只生成左深树，代价为所有中间结果的行数之和。
+ * 关系个数不超过 DP_LIMIT 时按子集动态规划求最优顺序，否则贪心地每次并入使中间结果最小的关系。
+ * 连接图上不相邻的关系只有在无法避免时才做笛卡尔积。
+ */
+class SqlJoinOrderer {
+    public:
+        static constexpr int DP_LIMIT = 10;
+
+    private:
+        std::vector<double> rows;
+        // 两两之间所有连接谓词的选择率之积，没有谓词时为 1
+        std::vector<std::vector<double>> selectivities;
+        std::vector<std::vector<bool>> edges;
+
+        // relations 已经连接后再并入 relation 的结果行数
+        double extend(const std::vector<bool>& relations,double cardinality,int relation) const;
+
+        bool connected(const std::vector<bool>& relations,int relation) const;
+
+        // relations 之外是否还有与之相邻的关系
+        bool hasNeighbour(const std::vector<bool>& relations) const;
+
+        std::vector<int> dynamicOrder() const;
+
+        std::vector<int> greedyOrder() const;
+
+    public:
+        /**
+         * rows 为每个关系的估算行数。
+         */
+        explicit SqlJoinOrderer(const std::vector<double>& rows);
+
+        /**
+         * 添加关系 left 与 right 之间的连接谓词。
+         */
+        void addPredicate(int left,int right,double selectivity);
+
+        /**
+         * 按 order 依次连接时中间结果（含最终结果）的行数之和。
+         */
+        double cost(const std::vector<int>& order) const;
+
+        /**
+         * 代价最小的连接顺序，第一个关系为最左侧的输入，其余依次作为构建侧并入。
+         */
+        std::vector<int> order() const;
+};
+
+#endif
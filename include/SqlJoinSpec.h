@@ -11,6 +11,8 @@ class SqlJoinSpec {
         std::shared_ptr<SqlRelation> relation = nullptr;
         SqlJoinType type;
         std::shared_ptr<ExpressionContainer> condition = std::make_shared<ExpressionContainer>();
+        // ASOF JOIN 的 MATCH_CONDITION，如 a.ts >= b.ts
+        std::string matchCondition;
     public:
         std::shared_ptr<SqlRelation> getRelation(){
             return this->relation;
@@ -43,6 +45,14 @@ class SqlJoinSpec {
                 throw EngineException(std::string("SQL_SYNTAX_JOIN_ON_") + e.what());
             }
         }
+
+        const std::string& getMatchCondition() const {
+            return this->matchCondition;
+        }
+
+        void setMatchCondition(const std::string& matchCondition){
+            this->matchCondition = matchCondition;
+        }
 };
 
 #endif
\ No newline at end of file
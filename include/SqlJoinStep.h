@@ -0,0 +1,149 @@
+#ifndef SQL_JOIN_STEP_H
+#define SQL_JOIN_STEP_H
+
+#include <string>
+#include <vector>
+
+#include "SqlJoinType.h"
+
+/**
+ * 多路连接展开后的一个二元连接：把第 relation 个关系并入已经连接的 leftAliases。
+ * lefts / rights 为等值连接的列，左侧由多个关系组成时列名带别名前缀；
+ * condition 为本次连接要检查的全部条件，residual 为其中不是等值连接的部分，有 key 时只在 key 相等的行对上检查。
+ * 区间连接时右侧的 rightTime 减去左侧的 leftTime 落在 [lower, upper] 内，区间条件不再计入 residual。
+ * ASOF 连接时左侧每行只连接 key 相同、满足 leftTime match rightTime 的最近一行右侧记录。
+ */
+class SqlJoinStep {
+    private:
+        int relation = -1;
+        SqlJoinType type = SqlJoinType::INNER;
+        std::vector<std::string> leftAliases;
+        std::string rightAlias;
+        std::vector<std::string> lefts;
+        std::vector<std::string> rights;
+        std::string condition;
+        std::string residual;
+        std::string leftTime;
+        std::string rightTime;
+        std::string lower;
+        std::string upper;
+        std::string match;
+
+    public:
+        int getRelation() const {
+            return relation;
+        }
+
+        void setRelation(int relation){
+            this->relation = relation;
+        }
+
+        SqlJoinType getType() const {
+            return type;
+        }
+
+        void setType(SqlJoinType type){
+            this->type = type;
+        }
+
+        const std::vector<std::string>& getLeftAliases() const {
+            return leftAliases;
+        }
+
+        void setLeftAliases(const std::vector<std::string>& leftAliases){
+            this->leftAliases = leftAliases;
+        }
+
+        const std::string& getRightAlias() const {
+            return rightAlias;
+        }
+
+        void setRightAlias(const std::string& rightAlias){
+            this->rightAlias = rightAlias;
+        }
+
+        const std::vector<std::string>& getLefts() const {
+            return lefts;
+        }
+
+        const std::vector<std::string>& getRights() const {
+            return rights;
+        }
+
+        void addKeys(const std::string& left,const std::string& right){
+            lefts.push_back(left);
+            rights.push_back(right);
+        }
+
+        const std::string& getCondition() const {
+            return condition;
+        }
+
+        void setCondition(const std::string& condition){
+            this->condition = condition;
+        }
+
+        const std::string& getResidual() const {
+            return residual;
+        }
+
+        void setResidual(const std::string& residual){
+            this->residual = residual;
+        }
+
+        const std::string& getLeftTime() const {
+            return leftTime;
+        }
+
+        const std::string& getRightTime() const {
+            return rightTime;
+        }
+
+        const std::string& getLower() const {
+            return lower;
+        }
+
+        const std::string& getUpper() const {
+            return upper;
+        }
+
+        void setBand(const std::string& leftTime,const std::string& rightTime,const std::string& lower,const std::string& upper){
+            this->leftTime = leftTime;
+            this->rightTime = rightTime;
+            this->lower = lower;
+            this->upper = upper;
+        }
+
+        const std::string& getMatch() const {
+            return match;
+        }
+
+        void setMatch(const std::string& leftTime,const std::string& rightTime,const std::string& match){
+            this->leftTime = leftTime;
+            this->rightTime = rightTime;
+            this->match = match;
+        }
+
+        /**
+         * 是否有区间条件（lower 与 upper 都不为空）。
+         */
+        bool isBandJoin() const {
+            return !lower.empty() && !upper.empty();
+        }
+
+        /**
+         * 是否为 ASOF 连接（有 match 条件）。
+         */
+        bool isAsofJoin() const {
+            return !match.empty();
+        }
+
+        /**
+         * 只有等值条件时可以按 key 分区或建哈希表连接。
+         */
+        bool isEquiJoin() const {
+            return !lefts.empty() && residual.empty();
+        }
+};
+
+#endif
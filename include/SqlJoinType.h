@@ -9,7 +9,8 @@ enum class SqlJoinType{
     LEFT,
     RIGHT,
     OUTER,
-    FULL
+    FULL,
+    ASOF
 };
 
 inline std::string toString(SqlJoinType type) {
@@ -21,6 +22,7 @@ inline std::string toString(SqlJoinType type) {
         case SqlJoinType::RIGHT: return "RIGHT";
         case SqlJoinType::OUTER: return "OUTER";
         case SqlJoinType::FULL:  return "FULL";
+        case SqlJoinType::ASOF:  return "ASOF";
         default:                 return "UNKNOWN";
     }
 }
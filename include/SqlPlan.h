@@ -3,11 +3,19 @@
 
 #include <vector>
 #include <string>
+
+#include "SqlStepEstimate.h"
+#include "SqlCostEstimator.h"
+
 class SqlPlan{
     private:
         std::vector<std::string> plan;
+        std::vector<std::string> diagnostics;
+        std::vector<SqlStepEstimate> estimates;
     public:
         SqlPlan(std::vector<std::string> plan) : plan(plan){}
+
+        SqlPlan(std::vector<std::string> plan,std::vector<std::string> diagnostics) : plan(plan),diagnostics(diagnostics){}
         const std::vector<std::string>& getPlan() const {
             return plan;
         }
@@ -15,6 +23,31 @@ class SqlPlan{
         void setPlan(std::vector<std::string> plan){
             this->plan = plan;
         }
+
+        // 与 plan 一一对应的估算结果
+        const std::vector<SqlStepEstimate>& getEstimates() const {
+            return estimates;
+        }
+
+        void setEstimates(std::vector<SqlStepEstimate> estimates){
+            this->estimates = estimates;
+        }
+
+        /**
+         * EXPLAIN 输出：每个步骤后附带估算的行数、行宽和累计代价。
+         */
+        std::vector<std::string> explain() const {
+            std::vector<std::string> lines;
+            for(size_t i = 0;i < plan.size();++i){
+                lines.push_back(SqlCostEstimator::explain(plan.at(i),i < estimates.size() ? estimates.at(i) : SqlStepEstimate()));
+            }
+            return lines;
+        }
+
+        // 规划过程的诊断信息，形如 key=value
+        const std::vector<std::string>& getDiagnostics() const {
+            return diagnostics;
+        }
         
 };
 
@@ -0,0 +1,29 @@
+#ifndef SQL_PREDICATE_SIMPLIFIER_H
+#define SQL_PREDICATE_SIMPLIFIER_H
+
+#include <string>
+
+/**
+ * 规划期的谓词化简：折叠常量运算和常量比较，去掉恒真项，识别恒假条件，
+ * 并把条件整理成统一的形状（展平 and/or、去重、常量放在比较右侧、消去 not）。
+ * 遇到无法完整识别的语法（下标、-> 赋值、未知运算符等）时原样返回条件。
+ */
+class SqlPredicateSimplifier final {
+    private:
+        SqlPredicateSimplifier();
+
+    public:
+        static const std::string ALWAYS_TRUE;
+        static const std::string ALWAYS_FALSE;
+
+        /**
+         * 化简条件表达式，恒真时返回 ALWAYS_TRUE，恒假时返回 ALWAYS_FALSE。
+         */
+        static std::string simplify(const std::string& condition);
+
+        static bool isAlwaysTrue(const std::string& condition);
+
+        static bool isAlwaysFalse(const std::string& condition);
+};
+
+#endif
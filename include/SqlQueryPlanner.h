@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <unordered_set>
 
 #include "ClassDefinition.h"
 #include "XStringUtils.h"
@@ -17,10 +18,37 @@
 #include "PatternWindowSpec.h"
 #include "SlidingWindowSpec.h"
 #include "TumblingWindowSpec.h"
+#include "StatisticsCatalog.h"
+#include "SqlCostEstimator.h"
+#include "SqlJoinChain.h"
 
 
 class SqlQueryPlanner{
+    private:
+        std::shared_ptr<StatisticsCatalog> catalog = nullptr;
+        // 当前规划过程的估算器，每次 plan 时重建
+        std::shared_ptr<SqlCostEstimator> estimator = nullptr;
+        // 广播连接构建侧（右侧）允许占用的内存（字节）
+        double broadcastBudget = SqlCostEstimator::DEFAULT_BROADCAST_BUDGET;
+        // 强制广播的关系（别名或表名）
+        std::unordered_set<std::string> broadcastHints;
+
     public:
+        /**
+         * 设置统计信息来源，未设置时按默认值估算。
+         */
+        void setStatisticsCatalog(std::shared_ptr<StatisticsCatalog> catalog);
+
+        /**
+         * 设置广播连接的内存预算，统计信息表明右侧输出不超过预算时使用 BroadcastHashJoin。
+         */
+        void setBroadcastBudget(double bytes);
+
+        /**
+         * 提示把别名或表名为 relation 的连接右侧广播，不再参考统计信息。
+         */
+        void addBroadcastHint(const std::string& relation);
+
         std::shared_ptr<SqlPlan> plan(const std::shared_ptr<SqlStatement>& stmt);
     protected:
         void plan(const std::shared_ptr<SqlStatement>& stmt,
@@ -28,6 +56,46 @@ class SqlQueryPlanner{
                 std::shared_ptr<MutableInt>& currentId,
                 std::shared_ptr<MutableInt>& lastSpool);
     private:
+        // ASOF 连接：左侧每行连接 key 相同、满足 left_time match right_time 的最近一行右侧记录
+        void planAsofJoin(const std::shared_ptr<ClassDefinition>& step,const SqlJoinStep& join,
+                int id,int leftSpool,int rightSpool);
+
+        // 区间连接：right_time - left_time 落在 [lower, upper] 内的行对才会连接
+        void planIntervalJoin(const std::shared_ptr<ClassDefinition>& step,const SqlJoinStep& join,
+                int id,int leftSpool,int rightSpool,const std::string& joinType);
+
+        // 在上一个步骤之后追加 Project，保留全部列并追加计算列
+        void planComputes(const std::string& computes,
+                std::vector<std::shared_ptr<ClassDefinition>>& steps,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool);
+
+        // 在上一个步骤之后追加 Filter
+        void planFilter(const std::string& condition,
+                std::vector<std::shared_ptr<ClassDefinition>>& steps,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool);
+
+        // 规划连接右侧关系的输入（子查询或表）
+        void planRelation(const std::shared_ptr<SqlRelation>& relation,
+                std::vector<std::shared_ptr<ClassDefinition>>& steps,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool);
+
+        // 多路连接：按连接顺序展开成一串二元连接，filters 为下推到各关系输入上的条件
+        void planJoins(const std::shared_ptr<SqlStatement>& stmt,
+                const std::string& selects,
+                const std::vector<std::string>& filters,
+                std::vector<std::shared_ptr<ClassDefinition>>& steps,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool);
+
+        // 条件恒假的语句只输出一个空数据源（以及 into 对应的 Output）
+        void planEmpty(const std::shared_ptr<SqlStatement>& stmt,
+                std::vector<std::shared_ptr<ClassDefinition>>& steps,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool);
+
         static bool selectOnly(std::shared_ptr<SqlStatement> stmt);
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef SQL_QUERY_REWRITER_H
+#define SQL_QUERY_REWRITER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "SqlStatement.h"
+#include "QueryRelation.h"
+#include "SqlJoinSpec.h"
+
+/**
+ * 规划前的语句改写。
+ * 改写结果是新的语句对象，解析得到的原语句不会被修改。
+ */
+class SqlQueryRewriter final {
+    private:
+        SqlQueryRewriter();
+
+    public:
+        static std::shared_ptr<SqlStatement> rewrite(const std::shared_ptr<SqlStatement>& stmt);
+
+        /**
+         * 改写语句，并把改写效果以 key=value 的形式追加到 diagnostics。
+         */
+        static std::shared_ptr<SqlStatement> rewrite(const std::shared_ptr<SqlStatement>& stmt,
+                                                     std::vector<std::string>& diagnostics);
+
+    private:
+        // 子查询合并与谓词化简
+        static std::shared_ptr<SqlStatement> optimize(const std::shared_ptr<SqlStatement>& stmt);
+
+        // 用 rewriter 递归改写 from / join 中的子查询，没有变化时返回原语句
+        static std::shared_ptr<SqlStatement> rewriteRelations(
+            const std::shared_ptr<SqlStatement>& stmt,
+            const std::function<std::shared_ptr<SqlStatement>(const std::shared_ptr<SqlStatement>&)>& rewriter);
+
+        // 把外层语句合并进 from 子查询（view merging），不能合并时原样返回
+        static std::shared_ptr<SqlStatement> mergeSubquery(const std::shared_ptr<SqlStatement>& stmt);
+
+        static std::shared_ptr<SqlStatement> mergeIntoAggregate(const std::shared_ptr<SqlStatement>& stmt,
+                                                                const std::shared_ptr<QueryRelation>& relation);
+
+        static std::shared_ptr<SqlStatement> mergeIntoProjection(const std::shared_ptr<SqlStatement>& stmt,
+                                                                 const std::shared_ptr<QueryRelation>& relation);
+
+        static std::string composeSelects(const std::string& selects,
+                                          const std::string& qualifier,
+                                          const std::unordered_map<std::string, std::string>& columns);
+
+        static bool isAggregate(const std::shared_ptr<SqlStatement>& stmt);
+
+        // 化简 where / having，条件恒假或输入恒空时把语句标记为空
+        static std::shared_ptr<SqlStatement> simplifyPredicates(const std::shared_ptr<SqlStatement>& stmt);
+
+        static bool isEmptyInput(const std::shared_ptr<SqlStatement>& stmt);
+
+        /**
+         * 公共子表达式消除：where、group by 和 select 中重复出现的非聚合函数调用提取为计算列，
+         * having 中与 select 相同的聚合直接引用 select 别名。eliminated 累加省掉的求值次数。
+         */
+        static std::shared_ptr<SqlStatement> eliminateCommonSubexpressions(const std::shared_ptr<SqlStatement>& stmt,
+                                                                           int& eliminated);
+
+        static std::shared_ptr<SqlStatement> extractComputes(const std::shared_ptr<SqlStatement>& stmt, int& eliminated);
+};
+
+#endif
@@ -56,6 +56,7 @@ private:
     static const std::unordered_set<std::string> OUTER_WORDS;
     static const std::unordered_set<std::string> JOIN_WORDS;
     static const std::unordered_set<std::string> JOIN_ON_WORDS;
+    static const std::unordered_set<std::string> JOIN_END_WORDS;
 
     static const std::unordered_set<std::string> WINDOW_KINDS;
     static const std::unordered_set<std::string> PATTERN_ON_WORDS;
@@ -99,6 +100,9 @@ private:
 
     std::shared_ptr<SqlRelation> readRelation(const unordered_set<std::string> wordsToStopAt,const SqlFragment syntax);
 
+    // 读取 ASOF JOIN 的 MATCH_CONDITION(...)，并检查 on 中只有等值的 key
+    void readAsofMatch(const std::shared_ptr<SqlJoinSpec>& joinSpec);
+
     static std::string keywordsToErrorMessage(std::unordered_set<std::string> words);
 };
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define SQL_STATEMENT_H
 #include <memory>
 #include <string>
+#include <vector>
 #include "SqlJoinSpec.h"
 #include "SqlWindowSpec.h"
 #include "IntervalSpec.h"
@@ -17,7 +18,8 @@ class SqlStatement {
 private:
     std::shared_ptr<SqlRelation> from = nullptr;
     std::shared_ptr<SqlRelation> into = nullptr;
-    std::shared_ptr<SqlJoinSpec> join = nullptr;
+    // 按书写顺序排列的连接链，第一个连接的左侧是 from
+    std::vector<std::shared_ptr<SqlJoinSpec>> joins;
     std::shared_ptr<SqlWindowSpec> window = nullptr;
     std::shared_ptr<IntervalSpec> interval = nullptr;
 
@@ -26,7 +28,10 @@ private:
     std::shared_ptr<ExpressionListContainer> groupbys = std::make_shared<ExpressionListContainer>();
     std::shared_ptr<ExpressionContainer> where = std::make_shared<ExpressionContainer>();
     std::shared_ptr<ExpressionContainer> having = std::make_shared<ExpressionContainer>();
+    std::shared_ptr<ExpressionListContainer> computes = std::make_shared<ExpressionListContainer>();
+    std::shared_ptr<ExpressionListContainer> filteredComputes = std::make_shared<ExpressionListContainer>();
     int limit = 0;
+    bool alwaysEmpty = false;
 
     std::string query;
 public:
@@ -36,10 +41,22 @@ public:
 
     void setFrom(std::shared_ptr<SqlRelation> rel);
 
+    /**
+     * 返回第一个连接，没有连接时返回 nullptr。
+     */
     std::shared_ptr<SqlJoinSpec> getJoin();
 
+    /**
+     * 把连接链替换为单个连接，spec 为 nullptr 时清空连接链。
+     */
     void setJoin(std::shared_ptr<SqlJoinSpec> spec);
 
+    const std::vector<std::shared_ptr<SqlJoinSpec>>& getJoins();
+
+    void setJoins(const std::vector<std::shared_ptr<SqlJoinSpec>>& joins);
+
+    void addJoin(std::shared_ptr<SqlJoinSpec> spec);
+
     std::shared_ptr<SqlRelation> getInto();
 
     void setInto(std::shared_ptr<SqlRelation> into);
@@ -67,10 +84,28 @@ public:
     std::string getWhere();
     void setWhere(std::string where);
 
+    void removeWhere();
+
     std::string getHaving();
 
     void setHaving(std::string having);
 
+    void removeHaving();
+
+    /**
+     * 计算列（expr as name 列表），在 where 之前追加到输入数据上，供 where 和后续步骤按列名引用。
+     */
+    std::string getComputes();
+
+    void setComputes(std::string computes);
+
+    /**
+     * 计算列（expr as name 列表），在 where 之后追加，只在通过过滤的行上求值，where 不引用这些列。
+     */
+    std::string getFilteredComputes();
+
+    void setFilteredComputes(std::string computes);
+
     int getLimit();
 
     void setLimit(int rows);
@@ -84,6 +119,19 @@ public:
 
     bool isEdgeRunnable();
 
+    /**
+     * 条件恒假时语句不会产生任何数据，规划时整条流水线替换为空数据源。
+     */
+    bool isAlwaysEmpty();
+
+    void setAlwaysEmpty(bool alwaysEmpty);
+
+    /**
+     * 复制语句。表达式容器会按文本重新编译，修改副本不会影响原语句；
+     * relation、join、window、interval 等规格对象与原语句共享。
+     */
+    std::shared_ptr<SqlStatement> clone();
+
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef SQL_STEP_ESTIMATE_H
+#define SQL_STEP_ESTIMATE_H
+
+#include <memory>
+
+#include "TableStatistics.h"
+
+/**
+ * 单个步骤的估算结果：输出行数、平均行宽（字节）以及包含上游在内的累计代价。
+ */
+class SqlStepEstimate {
+    private:
+        double rows = 0;
+        double width = 0;
+        double cost = 0;
+        // 是否完全来自统计信息（而不是默认值）
+        bool fromStatistics = false;
+        // 输出列的统计，来自上游的表
+        std::shared_ptr<TableStatistics> statistics = nullptr;
+
+    public:
+        SqlStepEstimate(){}
+
+        SqlStepEstimate(double rows,double width,double cost) : rows(rows),width(width),cost(cost){}
+
+        double getRows() const {
+            return rows;
+        }
+
+        void setRows(double rows){
+            this->rows = rows;
+        }
+
+        double getWidth() const {
+            return width;
+        }
+
+        void setWidth(double width){
+            this->width = width;
+        }
+
+        double getBytes() const {
+            return rows * width;
+        }
+
+        double getCost() const {
+            return cost;
+        }
+
+        void setCost(double cost){
+            this->cost = cost;
+        }
+
+        bool isFromStatistics() const {
+            return fromStatistics;
+        }
+
+        void setFromStatistics(bool fromStatistics){
+            this->fromStatistics = fromStatistics;
+        }
+
+        std::shared_ptr<TableStatistics> getStatistics() const {
+            return statistics;
+        }
+
+        void setStatistics(std::shared_ptr<TableStatistics> statistics){
+            this->statistics = statistics;
+        }
+};
+
+#endif
@@ -5,6 +5,8 @@
 #include "SqlJoinType.h"
 #include "SqlWindowType.h"
 #include <string>
+#include <vector>
+#include <unordered_map>
 
 class SqlSyntaxUtils final {
     private:
@@ -24,6 +26,126 @@ class SqlSyntaxUtils final {
         static SqlJoinType getJoinType(const std::string& word);
 
         static SqlWindowType getWindowType(const std::string& word);
+
+        /**
+         * 按顶层逗号切分表达式列表，忽略引号和括号内的逗号。
+         */
+        static std::vector<std::string> splitExpressions(const std::string& exprs);
+
+        /**
+         * 获取 select 项的别名（顶层 AS 之后的部分），没有别名时返回空字符串。
+         */
+        static std::string getExpressionAlias(const std::string& item);
+
+        /**
+         * 去掉 select 项顶层的 AS 别名，返回表达式本身。
+         */
+        static std::string removeExpressionAlias(const std::string& item);
+
+        static bool isIdentifier(const std::string& word);
+
+        /**
+         * 替换表达式中的列名引用：qualifier 前缀（如 t.a 中的 t）会被去掉，
+         * 命中 replacements 的列名被替换，非单一列名的替换结果加括号。
+         * 引号内的内容、函数名以及 :: 变量不受影响。
+         */
+        static std::string replaceIdentifiers(const std::string& expr,
+                                              const std::string& qualifier,
+                                              const std::unordered_map<std::string, std::string>& replacements);
+
+        /**
+         * 以 and 连接两个条件，含顶层 or 的一侧加括号；任一侧为空时返回另一侧。
+         */
+        static std::string conjoin(const std::string& left, const std::string& right);
+
+        /**
+         * 表达式是否依赖行间状态（:: 变量或 -> 赋值），这类表达式不能跨步骤移动。
+         */
+        static bool isStateful(const std::string& expr);
+
+        /**
+         * 按顶层的 and / or 切分条件；切分 and 时不会拆开 between ... and ...。
+         */
+        static std::vector<std::string> splitConditions(const std::string& expr, const std::string& word);
+
+        static bool referencesIdentifier(const std::string& expr, const std::string& name);
+
+        /**
+         * 表达式是否引用了以 qualifier. 开头的列名（如 t.a 中的 t）。
+         */
+        static bool referencesQualifier(const std::string& expr, const std::string& qualifier);
+
+        /**
+         * 条件是否为两个列名的等值比较（a = b），是则分别写入 left / right。
+         */
+        static bool splitEquality(const std::string& condition, std::string& left, std::string& right);
+
+        /**
+         * 条件是否为两个列名的大小比较（>=、>、<=、<），是则写入两侧列名与比较符。
+         */
+        static bool splitComparison(const std::string& condition, std::string& left, std::string& op, std::string& right);
+
+        /**
+         * 条件是否为区间条件 column between base + lower and base + upper（偏移为数字常量，可以省略），
+         * 是则写入两侧列名与带符号的偏移。
+         */
+        static bool splitBand(const std::string& condition, std::string& column, std::string& base,
+                              std::string& lower, std::string& upper);
+
+        /**
+         * 条件是否为单侧区间条件 column >= base + offset 或 column <= base + offset（两侧可以互换），
+         * lowerBound 表示 offset 是下界。
+         */
+        static bool splitBound(const std::string& condition, std::string& column, std::string& base,
+                               std::string& offset, bool& lowerBound);
+
+        static bool isAggregateFunction(const std::string& name);
+
+        /**
+         * 表达式中是否有聚合函数调用（包括嵌套在表达式里的）。
+         */
+        static bool hasAggregateCall(const std::string& expr);
+
+        /**
+         * 找出表达式中所有的函数调用（包括嵌套在参数里的），按出现位置返回调用原文。
+         */
+        static std::vector<std::string> findFunctionCalls(const std::string& expr);
+
+        /**
+         * 把引号外 case ... end（包括嵌套）中的字符换成空格，长度和其余位置不变。
+         */
+        static std::string maskCaseExpressions(const std::string& expr);
+
+        /**
+         * 在 maskCaseExpressions 的基础上，把第一个逻辑 and / or（between 的 and 除外）及之后的字符也换成空格：
+         * 剩下的部分每行都会求值，其余部分可能因短路不被求值。
+         */
+        static std::string maskGuardedExpressions(const std::string& expr);
+
+        /**
+         * 去掉引号外的空白，用于判断两段表达式是否相同。
+         */
+        static std::string normalizeExpression(const std::string& expr);
+
+        /**
+         * 把表达式中与 target 相同的函数调用替换为 name。
+         */
+        static std::string replaceFunctionCall(const std::string& expr, const std::string& target, const std::string& name);
+
+        /**
+         * selects 中窗口聚合调用可以使用的增量策略，如 wsum('b'):subtract, wmax('c'):two_stacks，没有时返回空串。
+         * wcount、wsum、wavg 可以在行移出窗口时减去（subtract），wmin、wmax 不能减去，用两个栈维护（two_stacks）。
+         */
+        static std::string getWindowAggregations(const std::string& selects);
+
+    private:
+        // 拆分 base、base + n 或 base - n，offset 为带符号的 n
+        static bool splitOffset(const std::string& expr, std::string& base, std::string& offset);
+
+        static int findTopLevelWord(const std::string& expr, const std::string& word, int from);
+
+        // 从 begin 处的函数名开始找到调用结束的 ) 位置，不是函数调用时返回 -1
+        static int findCallEnd(const std::string& expr, int begin, int& nameEnd);
 };
 
 #endif
\ No newline at end of file
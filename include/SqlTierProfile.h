@@ -0,0 +1,69 @@
+#ifndef SQL_TIER_PROFILE_H
+#define SQL_TIER_PROFILE_H
+
+#include <string>
+#include <unordered_set>
+
+#include "SqlCpuClass.h"
+
+/**
+ * 分层部署中一层的能力描述：单个步骤可用的内存、CPU 等级以及支持的步骤类型。
+ * 各层按从设备到云端的顺序排列，最后一层视为云端，不受这些限制。
+ */
+class SqlTierProfile {
+    private:
+        std::string name;
+        // 单个步骤的状态可以占用的内存（字节），小于 0 时不限
+        double memoryBudget = -1;
+        SqlCpuClass cpuClass = SqlCpuClass::HIGH;
+        // 支持的步骤类型（步骤类名），为空时支持全部
+        std::unordered_set<std::string> operators;
+
+    public:
+        SqlTierProfile(){}
+
+        SqlTierProfile(const std::string& name,double memoryBudget,SqlCpuClass cpuClass)
+            : name(name),memoryBudget(memoryBudget),cpuClass(cpuClass){}
+
+        const std::string& getName() const {
+            return name;
+        }
+
+        void setName(const std::string& name){
+            this->name = name;
+        }
+
+        double getMemoryBudget() const {
+            return memoryBudget;
+        }
+
+        void setMemoryBudget(double memoryBudget){
+            this->memoryBudget = memoryBudget;
+        }
+
+        SqlCpuClass getCpuClass() const {
+            return cpuClass;
+        }
+
+        void setCpuClass(SqlCpuClass cpuClass){
+            this->cpuClass = cpuClass;
+        }
+
+        const std::unordered_set<std::string>& getOperators() const {
+            return operators;
+        }
+
+        void addOperator(const std::string& name){
+            operators.insert(name);
+        }
+
+        bool supports(const std::string& name) const {
+            return operators.empty() || operators.count(name) > 0;
+        }
+
+        bool fits(double bytes) const {
+            return memoryBudget < 0 || bytes <= memoryBudget;
+        }
+};
+
+#endif
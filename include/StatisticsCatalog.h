@@ -0,0 +1,22 @@
+#ifndef STATISTICS_CATALOG_H
+#define STATISTICS_CATALOG_H
+
+#include <memory>
+#include <string>
+
+#include "TableStatistics.h"
+
+/**
+ * 规划器读取表统计信息的接口，由部署环境提供具体实现。
+ */
+class StatisticsCatalog {
+    public:
+        virtual ~StatisticsCatalog() = default;
+
+        /**
+         * 返回表的统计信息，没有统计时返回 nullptr。
+         */
+        virtual std::shared_ptr<TableStatistics> getTableStatistics(const std::string& table) = 0;
+};
+
+#endif
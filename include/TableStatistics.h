@@ -0,0 +1,66 @@
+#ifndef TABLE_STATISTICS_H
+#define TABLE_STATISTICS_H
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "ColumnStatistics.h"
+
+/**
+ * 表级统计信息：行数、平均行宽以及各列的统计。未知的数值用负数表示。
+ */
+class TableStatistics {
+    private:
+        double rowCount = -1;
+        double width = -1;
+        // 流式数据源每秒产生的行数
+        double rate = -1;
+        std::map<std::string, std::shared_ptr<ColumnStatistics>> columns;
+
+    public:
+        double getRowCount() const {
+            return rowCount;
+        }
+
+        void setRowCount(double rowCount){
+            this->rowCount = rowCount;
+        }
+
+        double getWidth() const {
+            return width;
+        }
+
+        void setWidth(double width){
+            this->width = width;
+        }
+
+        double getRate() const {
+            return rate;
+        }
+
+        void setRate(double rate){
+            this->rate = rate;
+        }
+
+        const std::map<std::string, std::shared_ptr<ColumnStatistics>>& getColumns() const {
+            return columns;
+        }
+
+        /**
+         * 按列名查找统计，t.a 这样带限定名的列按 a 查找，没有统计时返回 nullptr。
+         */
+        std::shared_ptr<ColumnStatistics> getColumn(const std::string& name) const {
+            auto iter = columns.find(name);
+            if(iter == columns.end() && name.rfind('.') != std::string::npos){
+                iter = columns.find(name.substr(name.rfind('.') + 1));
+            }
+            return iter == columns.end() ? nullptr : iter->second;
+        }
+
+        void setColumn(const std::string& name,std::shared_ptr<ColumnStatistics> column){
+            columns[name] = column;
+        }
+};
+
+#endif
@@ -0,0 +1,352 @@
+#include "../include/LocalAggregate.h"
+#include "EngineException.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    enum Pick{ PICK_MIN, PICK_MAX, PICK_FIRST, PICK_LAST };
+
+    // min、max、first、last 的按列累加，counts 为分组已累加的非空值个数
+    template<typename T>
+    void pick(Pick which,std::vector<T>& values,std::vector<int64_t>& counts,const std::vector<T>& data,
+              const uint8_t* nulls,const std::vector<uint32_t>& groups){
+        for(size_t row = 0;row < groups.size();++row){
+            if(nulls != nullptr && nulls[row] != 0){
+                continue;
+            }
+            const uint32_t group = groups[row];
+            const T& value = data[row];
+            if(counts[group]++ == 0 || (which == PICK_MIN && value < values[group]) ||
+               (which == PICK_MAX && values[group] < value) || which == PICK_LAST){
+                values[group] = value;
+            }
+        }
+    }
+
+    // INT < DOUBLE < STRING
+    LocalType wider(LocalType left,LocalType right){
+        return left == LocalType::STRING || right == LocalType::STRING ? LocalType::STRING :
+               left == LocalType::DOUBLE || right == LocalType::DOUBLE ? LocalType::DOUBLE : LocalType::INT;
+    }
+
+    // 把已有的取值转换成更宽的类型
+    void promote(LocalAggregate::States& states,LocalType type){
+        if(states.type == type){
+            return;
+        }
+        if(type == LocalType::DOUBLE){
+            states.doubles.assign(states.ints.begin(),states.ints.end());
+        }else{
+            states.strings.resize(std::max(states.ints.size(),states.doubles.size()));
+            for(size_t group = 0;group < states.strings.size();++group){
+                states.strings[group] = states.type == LocalType::INT ? LocalValue(states.ints[group]).toString() : LocalValue(states.doubles[group]).toString();
+            }
+        }
+        states.ints.clear();
+        if(type == LocalType::STRING){
+            states.doubles.clear();
+        }
+        states.type = type;
+    }
+
+    template<typename T>
+    void moveValue(std::vector<T>& values,size_t from,size_t to){
+        if(!values.empty()){
+            values[to] = std::move(values[from]);
+        }
+    }
+
+}
+
+LocalAggregate::LocalAggregate(const std::shared_ptr<LocalExpression>& call) :
+    function(call->getText()),distinct(call->isDistinct()){
+    if(call->getChildren().size() > 1 || (call->getChildren().empty() && function != "count")){
+        throw EngineException("SQL_EXECUTOR_INVALID_ARGUMENTS: " + function);
+    }
+    if(!call->getChildren().empty()){
+        argument = call->getChildren().front();
+    }
+    if(distinct || function == "median"){
+        family = Family::ROW;
+    }else if(function == "count"){
+        family = Family::COUNT;
+    }else if(function == "sum" || function == "avg" || function == "stddev" || function == "variance"){
+        family = Family::SUM;
+    }else if(function == "min" || function == "max" || function == "first" || function == "last"){
+        family = Family::VALUE;
+    }
+}
+
+void LocalAggregate::bind(const LocalBatch& batch){
+    if(argument != nullptr){
+        argument->bind(batch);
+    }
+}
+
+void LocalAggregate::update(State& state,const LocalBatch& batch,size_t row) const {
+    if(argument == nullptr){
+        state.count++;
+        return;
+    }
+    const LocalValue value = argument->evaluate(batch,row);
+    if(value.isNull() || (distinct && !state.seen.insert(std::to_string(static_cast<int>(value.getType())) + value.toString()).second)){
+        return;
+    }
+    state.count++;
+    if(state.first.isNull()){
+        state.first = value;
+    }
+    state.last = value;
+    if(state.min.isNull() || LocalValue::compare(value,state.min) < 0){
+        state.min = value;
+    }
+    if(state.max.isNull() || LocalValue::compare(value,state.max) > 0){
+        state.max = value;
+    }
+    if(function == "sum" || function == "avg" || function == "stddev" || function == "variance" || function == "median"){
+        if(!value.isNumeric()){
+            throw EngineException("SQL_EXECUTOR_NUMERIC_REQUIRED: " + function);
+        }
+        state.integral = state.integral && value.getType() == LocalType::INT;
+        if(value.getType() == LocalType::INT){
+            state.intSum += value.asInt();
+        }
+        const double d = value.asDouble();
+        state.sum += d;
+        state.squares += d * d;
+        if(function == "median"){
+            state.values.push_back(d);
+        }
+    }
+}
+
+LocalValue LocalAggregate::result(const State& state) const {
+    if(function == "count"){
+        return LocalValue(state.count);
+    }
+    if(state.count == 0){
+        return LocalValue();
+    }
+    if(function == "sum"){
+        return state.integral ? LocalValue(state.intSum) : LocalValue(state.sum);
+    }
+    if(function == "avg"){
+        return LocalValue(state.sum / state.count);
+    }
+    if(function == "min"){
+        return state.min;
+    }
+    if(function == "max"){
+        return state.max;
+    }
+    if(function == "first"){
+        return state.first;
+    }
+    if(function == "last"){
+        return state.last;
+    }
+    if(function == "variance" || function == "stddev"){
+        // 样本方差，少于两个值时为空
+        if(state.count < 2){
+            return LocalValue();
+        }
+        const double variance = std::max(0.0,(state.squares - state.sum * state.sum / state.count) / (state.count - 1));
+        return LocalValue(function == "variance" ? variance : std::sqrt(variance));
+    }
+    if(function == "median"){
+        std::vector<double> values = state.values;
+        const size_t middle = values.size() / 2;
+        std::nth_element(values.begin(),values.begin() + middle,values.end());
+        if(values.size() % 2 == 1){
+            return LocalValue(values[middle]);
+        }
+        const double upper = values[middle];
+        return LocalValue((*std::max_element(values.begin(),values.begin() + middle) + upper) / 2);
+    }
+    throw EngineException("SQL_EXECUTOR_UNSUPPORTED_FUNCTION: " + function);
+}
+
+void LocalAggregate::resize(States& states,size_t groups) const {
+    switch(family){
+        case Family::COUNT:
+            states.counts.resize(groups,0);
+            break;
+        case Family::SUM:
+            states.counts.resize(groups,0);
+            states.intSums.resize(groups,0);
+            states.sums.resize(groups,0);
+            states.squares.resize(groups,0);
+            states.integral.resize(groups,1);
+            break;
+        case Family::VALUE:
+            states.counts.resize(groups,0);
+            switch(states.type){
+                case LocalType::INT: states.ints.resize(groups); break;
+                case LocalType::DOUBLE: states.doubles.resize(groups); break;
+                default: states.strings.resize(groups);
+            }
+            break;
+        default:
+            states.rows.resize(groups);
+    }
+}
+
+void LocalAggregate::reset(States& states,size_t begin,size_t end) const {
+    if(family == Family::ROW){
+        std::fill(states.rows.begin() + begin,states.rows.begin() + end,State());
+        return;
+    }
+    // min、max 等的取值只在 counts 为 0 之后的第一个值覆盖，不需要清空
+    std::fill(states.counts.begin() + begin,states.counts.begin() + end,0);
+    if(family == Family::SUM){
+        std::fill(states.intSums.begin() + begin,states.intSums.begin() + end,0);
+        std::fill(states.sums.begin() + begin,states.sums.begin() + end,0);
+        std::fill(states.squares.begin() + begin,states.squares.begin() + end,0);
+        std::fill(states.integral.begin() + begin,states.integral.begin() + end,1);
+    }
+}
+
+void LocalAggregate::move(States& states,size_t from,size_t to) const {
+    moveValue(states.counts,from,to);
+    moveValue(states.intSums,from,to);
+    moveValue(states.sums,from,to);
+    moveValue(states.squares,from,to);
+    moveValue(states.integral,from,to);
+    moveValue(states.ints,from,to);
+    moveValue(states.doubles,from,to);
+    moveValue(states.strings,from,to);
+    moveValue(states.rows,from,to);
+    reset(states,from,from + 1);
+}
+
+void LocalAggregate::update(States& states,const std::vector<uint32_t>& groups,const LocalBatch& batch) const {
+    const size_t rows = batch.getRows();
+    if(family == Family::ROW){
+        for(size_t row = 0;row < rows;++row){
+            update(states.rows[groups[row]],batch,row);
+        }
+        return;
+    }
+    if(argument == nullptr){
+        for(size_t row = 0;row < rows;++row){
+            states.counts[groups[row]]++;
+        }
+        return;
+    }
+
+    LocalColumn evaluated;
+    const LocalColumn* column = &evaluated;
+    if(argument->getKind() == LocalExpression::Kind::COLUMN){
+        column = &batch.getColumn(argument->getColumn());
+    }else{
+        evaluated = argument->evaluate(batch,function);
+    }
+    const uint8_t* nulls = column->hasNulls() ? column->getNulls().data() : nullptr;
+
+    if(family == Family::COUNT){
+        for(size_t row = 0;row < rows;++row){
+            states.counts[groups[row]] += nulls == nullptr || nulls[row] == 0 ? 1 : 0;
+        }
+        return;
+    }
+    if(family == Family::SUM){
+        if(column->getType() == LocalType::STRING){
+            for(size_t row = 0;row < rows;++row){
+                if(nulls == nullptr || nulls[row] == 0){
+                    throw EngineException("SQL_EXECUTOR_NUMERIC_REQUIRED: " + function);
+                }
+            }
+            return;
+        }
+        const bool integral = column->getType() == LocalType::INT;
+        for(size_t row = 0;row < rows;++row){
+            if(nulls != nullptr && nulls[row] != 0){
+                continue;
+            }
+            const uint32_t group = groups[row];
+            double value;
+            if(integral){
+                states.intSums[group] += column->getInts()[row];
+                value = static_cast<double>(column->getInts()[row]);
+            }else{
+                states.integral[group] = 0;
+                value = column->getDoubles()[row];
+            }
+            states.counts[group]++;
+            states.sums[group] += value;
+            states.squares[group] += value * value;
+        }
+        return;
+    }
+
+    // 列的类型与已有取值不同时都转换成较宽的类型
+    const LocalType type = wider(states.type,column->getType());
+    promote(states,type);
+    if(column->getType() != type){
+        LocalColumn converted(column->getName(),type);
+        converted.reserve(rows);
+        for(size_t row = 0;row < rows;++row){
+            converted.append(column->get(row));
+        }
+        evaluated = std::move(converted);
+        column = &evaluated;
+        nulls = column->hasNulls() ? column->getNulls().data() : nullptr;
+    }
+    const Pick which = function == "min" ? PICK_MIN : function == "max" ? PICK_MAX : function == "first" ? PICK_FIRST : PICK_LAST;
+    switch(type){
+        case LocalType::INT: pick(which,states.ints,states.counts,column->getInts(),nulls,groups); break;
+        case LocalType::DOUBLE: pick(which,states.doubles,states.counts,column->getDoubles(),nulls,groups); break;
+        default: pick(which,states.strings,states.counts,column->getStrings(),nulls,groups);
+    }
+}
+
+LocalColumn LocalAggregate::result(const States& states,const std::string& name,size_t begin,size_t end) const {
+    if(family == Family::ROW){
+        std::vector<LocalValue> values;
+        values.reserve(end - begin);
+        for(size_t group = begin;group < end;++group){
+            values.push_back(result(states.rows[group]));
+        }
+        return LocalColumn::fromValues(name,values);
+    }
+    if(family == Family::COUNT){
+        LocalColumn column(name,LocalType::INT);
+        column.getInts().assign(states.counts.begin() + begin,states.counts.begin() + end);
+        return column;
+    }
+
+    LocalType type = family == Family::VALUE ? states.type : LocalType::DOUBLE;
+    if(function == "sum"){
+        type = LocalType::INT;
+        for(size_t group = begin;group < end;++group){
+            if(states.counts[group] > 0 && states.integral[group] == 0){
+                type = LocalType::DOUBLE;
+            }
+        }
+    }
+    LocalColumn column(name,type);
+    column.reserve(end - begin);
+    for(size_t group = begin;group < end;++group){
+        const int64_t count = states.counts[group];
+        if(count == 0 || ((function == "variance" || function == "stddev") && count < 2)){
+            column.appendNull();
+        }else if(function == "sum"){
+            column.append(states.integral[group] != 0 ? LocalValue(states.intSums[group]) : LocalValue(states.sums[group]));
+        }else if(function == "avg"){
+            column.append(LocalValue(states.sums[group] / count));
+        }else if(family == Family::SUM){
+            // 样本方差
+            const double variance = std::max(0.0,(states.squares[group] - states.sums[group] * states.sums[group] / count) / (count - 1));
+            column.append(LocalValue(function == "variance" ? variance : std::sqrt(variance)));
+        }else if(type == LocalType::INT){
+            column.append(LocalValue(states.ints[group]));
+        }else if(type == LocalType::DOUBLE){
+            column.append(LocalValue(states.doubles[group]));
+        }else{
+            column.append(LocalValue(states.strings[group]));
+        }
+    }
+    return column;
+}
@@ -0,0 +1,133 @@
+#include "../include/LocalAggregation.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+#include <map>
+
+const std::string LocalAggregation::AGGREGATE_PREFIX = "__aggregate_";
+
+LocalAggregation::LocalAggregation(const std::string& keys,const std::string& selects){
+    std::vector<std::string> normalizedKeys;
+    for(const std::string& key : SqlSyntaxUtils::splitExpressions(keys)){
+        if(XStringUtils::isBlank(key)){
+            continue;
+        }
+        keyNames.push_back(XStringUtils::trim(key));
+        normalizedKeys.push_back(SqlSyntaxUtils::normalizeExpression(key));
+        this->keys.push_back(LocalExpression::parse(key));
+    }
+
+    for(const std::string& item : SqlSyntaxUtils::splitExpressions(selects)){
+        const std::string alias = SqlSyntaxUtils::getExpressionAlias(item);
+        const std::string expr = XStringUtils::trim(SqlSyntaxUtils::removeExpressionAlias(item));
+        names.push_back(alias.empty() ? expr : alias);
+
+        std::shared_ptr<LocalExpression> parsed = LocalExpression::parse(expr);
+        bool keyed = false;
+        for(const std::string& key : normalizedKeys){
+            keyed = keyed || key == SqlSyntaxUtils::normalizeExpression(expr);
+        }
+        if(!keyed && !hasAggregate(expr)){
+            // 分组内不唯一的值取第一个
+            std::shared_ptr<LocalExpression> first = std::make_shared<LocalExpression>(LocalExpression::Kind::CALL,"first");
+            first->addChild(parsed);
+            parsed = first;
+        }
+        outputs.push_back(collect(parsed));
+    }
+}
+
+bool LocalAggregation::hasAggregate(const std::string& selects){
+    for(const std::string& call : SqlSyntaxUtils::findFunctionCalls(selects)){
+        if(SqlSyntaxUtils::isAggregateFunction(call.substr(0,call.find('(')))){
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<LocalExpression> LocalAggregation::collect(const std::shared_ptr<LocalExpression>& expr){
+    if(expr->isAggregate()){
+        const std::string text = expr->toString();
+        size_t index = 0;
+        while(index < aggregateTexts.size() && aggregateTexts[index] != text){
+            index++;
+        }
+        if(index == aggregateTexts.size()){
+            for(auto& child : expr->getChildren()){
+                if(hasAggregate(child->toString())){
+                    throw EngineException("SQL_EXECUTOR_NESTED_AGGREGATE: " + text);
+                }
+            }
+            aggregates.emplace_back(expr);
+            aggregateTexts.push_back(text);
+        }
+        return std::make_shared<LocalExpression>(LocalExpression::Kind::COLUMN,AGGREGATE_PREFIX + std::to_string(index));
+    }
+    for(size_t i = 0;i < expr->getChildren().size();++i){
+        expr->setChild(i,collect(expr->getChildren()[i]));
+    }
+    return expr;
+}
+
+std::string LocalAggregation::merge(const std::string& states,const std::string& selects){
+    std::map<std::string, std::string> merged;
+    for(const std::string& state : SqlSyntaxUtils::splitExpressions(states)){
+        const std::string call = SqlSyntaxUtils::removeExpressionAlias(state);
+        const std::string name = SqlSyntaxUtils::getExpressionAlias(state);
+        const std::string function = XStringUtils::toLowerCase(XStringUtils::trim(call.substr(0,call.find('('))));
+        merged[SqlSyntaxUtils::normalizeExpression(XStringUtils::toLowerCase(call))] = (function == "count" ? "sum" : function) + "(" + name + ")";
+    }
+    const auto lookup = [&](const std::string& call){
+        auto iter = merged.find(SqlSyntaxUtils::normalizeExpression(XStringUtils::toLowerCase(call)));
+        if(iter == merged.end()){
+            throw EngineException("SQL_EXECUTOR_MISSING_PARTIAL_STATE: " + call);
+        }
+        return iter->second;
+    };
+
+    std::string result;
+    for(const std::string& item : SqlSyntaxUtils::splitExpressions(selects)){
+        const std::string alias = SqlSyntaxUtils::getExpressionAlias(item);
+        const std::string expr = XStringUtils::trim(SqlSyntaxUtils::removeExpressionAlias(item));
+        std::string rewritten = expr;
+        for(const std::string& call : SqlSyntaxUtils::findFunctionCalls(expr)){
+            const std::string function = XStringUtils::toLowerCase(XStringUtils::trim(call.substr(0,call.find('('))));
+            if(!SqlSyntaxUtils::isAggregateFunction(function)){
+                continue;
+            }
+            const std::string argument = call.substr(call.find('(') + 1,call.rfind(')') - call.find('(') - 1);
+            const std::string replacement = function == "avg" ?
+                "(" + lookup("sum(" + argument + ")") + " / " + lookup("count(" + argument + ")") + ")" : lookup(call);
+            rewritten = SqlSyntaxUtils::replaceFunctionCall(rewritten,call,replacement);
+        }
+        result += (result.empty() ? "" : ", ") + rewritten + " as " + (alias.empty() ? expr : alias);
+    }
+    return result;
+}
+
+void LocalAggregation::bind(const LocalBatch& batch){
+    for(auto& key : keys){
+        key->bind(batch);
+    }
+    for(auto& aggregate : aggregates){
+        aggregate.bind(batch);
+    }
+}
+
+std::vector<std::string> LocalAggregation::getGroupColumnNames() const {
+    std::vector<std::string> result = keyNames;
+    for(size_t i = 0;i < aggregates.size();++i){
+        result.push_back(AGGREGATE_PREFIX + std::to_string(i));
+    }
+    return result;
+}
+
+std::shared_ptr<LocalBatch> LocalAggregation::project(const LocalBatch& groups){
+    std::shared_ptr<LocalBatch> result = std::make_shared<LocalBatch>(groups.getRows());
+    for(size_t i = 0;i < outputs.size();++i){
+        result->addColumn(outputs[i]->evaluate(groups,names[i]));
+    }
+    return result;
+}
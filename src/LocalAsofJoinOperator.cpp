@@ -0,0 +1,98 @@
+#include "../include/LocalAsofJoinOperator.h"
+#include "../include/LocalRadixHashTable.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+#include <algorithm>
+
+LocalAsofJoinOperator::LocalAsofJoinOperator(const LocalStepDefinition& step) :
+    LocalJoinOperator(step,step.getParameter("residual")),match(XStringUtils::trim(step.getParameter("match"))){
+    type = SqlJoinType::LEFT;
+    if(match != ">=" && match != ">" && match != "<=" && match != "<"){
+        throw EngineException("SQL_EXECUTOR_INVALID_MATCH: " + match);
+    }
+    for(const std::string& key : SqlSyntaxUtils::splitExpressions(step.getParameter("lefts"))){
+        lefts.push_back(LocalExpression::parse(key));
+    }
+    for(const std::string& key : SqlSyntaxUtils::splitExpressions(step.getParameter("rights"))){
+        rights.push_back(LocalExpression::parse(key));
+    }
+    if(lefts.size() != rights.size()){
+        throw EngineException("SQL_EXECUTOR_INVALID_JOIN_KEYS: " + step.getParameter("lefts") + " / " + step.getParameter("rights"));
+    }
+    leftTime = LocalExpression::parse(step.getParameter("left_time"));
+    rightTime = LocalExpression::parse(step.getParameter("right_time"));
+}
+
+void LocalAsofJoinOperator::prepare(){
+    std::vector<uint8_t> valid;
+    timeValues(rightTime,*build,buildTimes,valid);
+    std::vector<LocalColumn> evaluated;
+    const std::vector<const LocalColumn*> keys = keyColumns(rights,*build,evaluated);
+    std::string bytes;
+    for(size_t row = 0;row < valid.size();++row){
+        bytes.clear();
+        if(valid[row] && LocalRadixHashTable::encodeKey(keys,row,bytes)){
+            groups[bytes].push_back(row);
+        }
+    }
+    for(auto& group : groups){
+        std::stable_sort(group.second.begin(),group.second.end(),[this](int64_t a,int64_t b){
+            return buildTimes[a] < buildTimes[b];
+        });
+    }
+}
+
+int64_t LocalAsofJoinOperator::nearest(const std::vector<int64_t>& group,double time) const {
+    const auto before = [this](int64_t row,double value){
+        return buildTimes[row] < value;
+    };
+    const auto after = [this](double value,int64_t row){
+        return value < buildTimes[row];
+    };
+    // >= 取 right_time <= time 的最后一行，> 取 right_time < time 的最后一行，<= / < 对称
+    std::vector<int64_t>::const_iterator iter;
+    if(match == ">=" || match == "<"){
+        iter = std::upper_bound(group.begin(),group.end(),time,after);
+    }else{
+        iter = std::lower_bound(group.begin(),group.end(),time,before);
+    }
+    if(match[0] == '>'){
+        return iter == group.begin() ? -1 : *(iter - 1);
+    }
+    return iter == group.end() ? -1 : *iter;
+}
+
+bool LocalAsofJoinOperator::probe(const LocalBatch& left){
+    std::vector<double> leftTimes;
+    std::vector<uint8_t> valid;
+    timeValues(leftTime,left,leftTimes,valid);
+    std::vector<LocalColumn> evaluated;
+    const std::vector<const LocalColumn*> keys = keyColumns(lefts,left,evaluated);
+
+    std::vector<uint8_t> leftMatched(left.getRows(),0);
+    std::vector<int64_t> leftRows,rightRows;
+    std::string bytes;
+    for(size_t row = 0;row < left.getRows();++row){
+        bytes.clear();
+        if(!valid[row] || !LocalRadixHashTable::encodeKey(keys,row,bytes)){
+            continue;
+        }
+        auto iter = groups.find(bytes);
+        const int64_t other = iter == groups.end() ? -1 : nearest(iter->second,leftTimes[row]);
+        if(other < 0){
+            continue;
+        }
+        leftRows.push_back(row);
+        rightRows.push_back(other);
+        if(leftRows.size() == batchSize){
+            if(!join(left,leftRows,rightRows,leftMatched)){
+                return false;
+            }
+            leftRows.clear();
+            rightRows.clear();
+        }
+    }
+    return join(left,leftRows,rightRows,leftMatched) && finishLeft(left,leftMatched);
+}
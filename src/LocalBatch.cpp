@@ -0,0 +1,76 @@
+#include "../include/LocalBatch.h"
+
+void LocalBatch::addColumn(const LocalColumn& column){
+    if(columns.empty()){
+        rows = column.size();
+    }
+    columns.push_back(column);
+}
+
+void LocalBatch::addColumn(LocalColumn&& column){
+    if(columns.empty()){
+        rows = column.size();
+    }
+    columns.push_back(std::move(column));
+}
+
+int LocalBatch::indexOf(const std::string& name) const {
+    for(size_t i = 0;i < columns.size();++i){
+        if(columns[i].getName() == name){
+            return i;
+        }
+    }
+
+    const size_t dot = name.rfind('.');
+    int found = -1;
+    for(size_t i = 0;i < columns.size();++i){
+        const std::string& column = columns[i].getName();
+        const bool matched = dot != std::string::npos ? column == name.substr(dot + 1) :
+            column.size() > name.size() && column.compare(column.size() - name.size() - 1,std::string::npos,"." + name) == 0;
+        if(matched){
+            if(found >= 0){
+                return -1;
+            }
+            found = i;
+        }
+    }
+    return found;
+}
+
+std::shared_ptr<LocalBatch> LocalBatch::select(const std::vector<int64_t>& rows) const {
+    std::shared_ptr<LocalBatch> result = std::make_shared<LocalBatch>(rows.size());
+    for(const LocalColumn& column : columns){
+        result->addColumn(column.select(rows));
+    }
+    return result;
+}
+
+std::shared_ptr<LocalBatch> LocalBatch::slice(size_t begin,size_t end) const {
+    std::shared_ptr<LocalBatch> result = std::make_shared<LocalBatch>(end - begin);
+    for(const LocalColumn& column : columns){
+        result->addColumn(column.slice(begin,end));
+    }
+    return result;
+}
+
+std::shared_ptr<LocalBatch> LocalBatch::concat(const std::vector<std::shared_ptr<const LocalBatch>>& batches){
+    std::shared_ptr<LocalBatch> result = std::make_shared<LocalBatch>();
+    if(batches.empty()){
+        return result;
+    }
+    size_t total = 0;
+    for(auto& batch : batches){
+        total += batch->getRows();
+    }
+    result->columns = batches.front()->columns;
+    for(LocalColumn& column : result->columns){
+        column.reserve(total);
+    }
+    for(size_t b = 1;b < batches.size();++b){
+        for(size_t c = 0;c < result->columns.size();++c){
+            result->columns[c].append(batches[b]->columns.at(c));
+        }
+    }
+    result->rows = total;
+    return result;
+}
@@ -0,0 +1,56 @@
+#include "../include/LocalBloomBuildOperator.h"
+#include "../include/LocalRadixHashTable.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "EngineException.h"
+
+#include <cstdlib>
+#include <functional>
+#include <string_view>
+
+LocalBloomBuildOperator::LocalBloomBuildOperator(const LocalStepDefinition& step) : LocalOperator(step){
+    for(const std::string& key : SqlSyntaxUtils::splitExpressions(step.getParameter("keys"))){
+        keys.push_back(LocalExpression::parse(key));
+    }
+    const long long bitCount = std::atoll(step.getParameter("bits").c_str());
+    const long long hashCount = std::atoll(step.getParameter("hashes").c_str());
+    if(keys.empty() || bitCount < 1 || hashCount < 1){
+        throw EngineException("SQL_EXECUTOR_INVALID_BLOOM: keys=" + step.getParameter("keys") +
+                              ",bits=" + step.getParameter("bits") + ",hashes=" + step.getParameter("hashes"));
+    }
+    bits = (static_cast<size_t>(bitCount) + 63) / 64 * 64;
+    hashes = static_cast<size_t>(hashCount);
+}
+
+void LocalBloomBuildOperator::run(){
+    std::vector<int64_t> words(bits / 64,0);
+    std::string bytes;
+    for(std::shared_ptr<const LocalBatch> batch = next();batch != nullptr;batch = next()){
+        std::vector<LocalColumn> evaluated;
+        std::vector<const LocalColumn*> columns;
+        evaluated.reserve(keys.size());
+        for(auto& key : keys){
+            key->bind(*batch);
+            evaluated.push_back(key->evaluate(*batch,key->toString()));
+            columns.push_back(&evaluated.back());
+        }
+        for(size_t row = 0;row < batch->getRows();++row){
+            bytes.clear();
+            if(!LocalRadixHashTable::encodeKey(columns,row,bytes)){
+                continue;
+            }
+            const size_t hash = std::hash<std::string_view>()(bytes);
+            for(size_t i = 0;i < hashes;++i){
+                const size_t bit = position(hash,i,bits);
+                words[bit / 64] |= static_cast<int64_t>(uint64_t(1) << (bit % 64));
+            }
+        }
+    }
+
+    LocalColumn word("word",LocalType::INT),count("hashes",LocalType::INT);
+    word.getInts() = std::move(words);
+    count.getInts().assign(word.size(),static_cast<int64_t>(hashes));
+    std::shared_ptr<LocalBatch> result = std::make_shared<LocalBatch>(word.size());
+    result->addColumn(std::move(word));
+    result->addColumn(std::move(count));
+    emit(result);
+}
@@ -0,0 +1,61 @@
+#include "../include/LocalBloomFilterOperator.h"
+#include "../include/LocalBloomBuildOperator.h"
+#include "../include/LocalRadixHashTable.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "EngineException.h"
+
+#include <functional>
+#include <string_view>
+
+LocalBloomFilterOperator::LocalBloomFilterOperator(const LocalStepDefinition& step) : LocalOperator(step){
+    for(const std::string& key : SqlSyntaxUtils::splitExpressions(step.getParameter("keys"))){
+        keys.push_back(LocalExpression::parse(key));
+    }
+    if(keys.empty()){
+        throw EngineException("SQL_EXECUTOR_INVALID_BLOOM: keys=" + step.getParameter("keys"));
+    }
+}
+
+bool LocalBloomFilterOperator::contains(size_t hash) const {
+    const size_t bits = words.size() * 64;
+    for(size_t i = 0;i < hashes;++i){
+        const size_t bit = LocalBloomBuildOperator::position(hash,i,bits);
+        if((words[bit / 64] & (uint64_t(1) << (bit % 64))) == 0){
+            return false;
+        }
+    }
+    return true;
+}
+
+void LocalBloomFilterOperator::run(){
+    for(const std::shared_ptr<const LocalBatch>& batch : drain(1)){
+        if(batch->getRows() == 0){
+            continue;
+        }
+        const std::vector<int64_t>& bitmap = batch->getColumn(0).getInts();
+        words.insert(words.end(),bitmap.begin(),bitmap.end());
+        hashes = static_cast<size_t>(batch->getColumn(1).getInts()[0]);
+    }
+
+    std::string bytes;
+    for(std::shared_ptr<const LocalBatch> batch = next();batch != nullptr;batch = next()){
+        std::vector<LocalColumn> evaluated;
+        std::vector<const LocalColumn*> columns;
+        evaluated.reserve(keys.size());
+        for(auto& key : keys){
+            key->bind(*batch);
+            evaluated.push_back(key->evaluate(*batch,key->toString()));
+            columns.push_back(&evaluated.back());
+        }
+        std::vector<int64_t> kept;
+        for(size_t row = 0;row < batch->getRows();++row){
+            bytes.clear();
+            if(!words.empty() && LocalRadixHashTable::encodeKey(columns,row,bytes) && contains(std::hash<std::string_view>()(bytes))){
+                kept.push_back(row);
+            }
+        }
+        if(!emit(kept.size() == batch->getRows() ? batch : batch->select(kept))){
+            return;
+        }
+    }
+}
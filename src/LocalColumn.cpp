@@ -0,0 +1,202 @@
+#include "../include/LocalColumn.h"
+
+#include <algorithm>
+
+LocalColumn LocalColumn::fromValues(const std::string& name,const std::vector<LocalValue>& values){
+    LocalType type = LocalType::INT;
+    for(const LocalValue& value : values){
+        if(value.isNull()){
+            continue;
+        }
+        if(value.getType() == LocalType::STRING){
+            type = LocalType::STRING;
+            break;
+        }
+        if(value.getType() == LocalType::DOUBLE){
+            type = LocalType::DOUBLE;
+        }
+    }
+    LocalColumn column(name,type);
+    column.reserve(values.size());
+    for(const LocalValue& value : values){
+        column.append(value);
+    }
+    return column;
+}
+
+size_t LocalColumn::size() const {
+    switch(type){
+        case LocalType::INT: return ints.size();
+        case LocalType::DOUBLE: return doubles.size();
+        default: return strings.size();
+    }
+}
+
+void LocalColumn::reserve(size_t rows){
+    switch(type){
+        case LocalType::INT: ints.reserve(rows); break;
+        case LocalType::DOUBLE: doubles.reserve(rows); break;
+        default: strings.reserve(rows);
+    }
+}
+
+LocalValue LocalColumn::get(size_t row) const {
+    if(isNull(row)){
+        return LocalValue();
+    }
+    switch(type){
+        case LocalType::INT: return LocalValue(ints[row]);
+        case LocalType::DOUBLE: return LocalValue(doubles[row]);
+        default: return LocalValue(strings[row]);
+    }
+}
+
+void LocalColumn::append(const LocalValue& value){
+    if(value.isNull()){
+        appendNull();
+        return;
+    }
+    if(!nulls.empty()){
+        nulls.push_back(0);
+    }
+    switch(type){
+        case LocalType::INT: ints.push_back(value.asInt()); break;
+        case LocalType::DOUBLE: doubles.push_back(value.asDouble()); break;
+        default: strings.push_back(value.toString());
+    }
+}
+
+void LocalColumn::appendNull(){
+    if(nulls.empty()){
+        nulls.assign(size(),0);
+    }
+    nulls.push_back(1);
+    switch(type){
+        case LocalType::INT: ints.push_back(0); break;
+        case LocalType::DOUBLE: doubles.push_back(0); break;
+        default: strings.emplace_back();
+    }
+}
+
+void LocalColumn::set(size_t row,const LocalValue& value){
+    if(value.isNull()){
+        if(nulls.empty()){
+            nulls.assign(size(),0);
+        }
+        nulls[row] = 1;
+        return;
+    }
+    promote(value.getType());
+    if(!nulls.empty()){
+        nulls[row] = 0;
+    }
+    switch(type){
+        case LocalType::INT: ints[row] = value.asInt(); break;
+        case LocalType::DOUBLE: doubles[row] = value.asDouble(); break;
+        default: strings[row] = value.toString();
+    }
+}
+
+void LocalColumn::promote(LocalType wider){
+    if(wider == type || wider == LocalType::INT || (wider == LocalType::DOUBLE && type == LocalType::STRING)){
+        return;
+    }
+    std::vector<LocalValue> values;
+    values.reserve(size());
+    for(size_t row = 0;row < size();++row){
+        values.push_back(get(row));
+    }
+    ints.clear();
+    doubles.clear();
+    strings.clear();
+    nulls.clear();
+    type = wider;
+    for(const LocalValue& value : values){
+        append(value);
+    }
+}
+
+void LocalColumn::append(const LocalColumn& other){
+    // 不同批次推断出的类型可能不同，按较宽的类型合并
+    if(other.type != type){
+        promote(other.type);
+        if(other.type != type){
+            for(size_t row = 0;row < other.size();++row){
+                append(other.get(row));
+            }
+            return;
+        }
+    }
+    if(other.hasNulls() || hasNulls()){
+        if(nulls.empty()){
+            nulls.assign(size(),0);
+        }
+        if(other.hasNulls()){
+            nulls.insert(nulls.end(),other.nulls.begin(),other.nulls.end());
+        }else{
+            nulls.insert(nulls.end(),other.size(),0);
+        }
+    }
+    switch(type){
+        case LocalType::INT: ints.insert(ints.end(),other.ints.begin(),other.ints.end()); break;
+        case LocalType::DOUBLE: doubles.insert(doubles.end(),other.doubles.begin(),other.doubles.end()); break;
+        default: strings.insert(strings.end(),other.strings.begin(),other.strings.end());
+    }
+}
+
+LocalColumn LocalColumn::select(const std::vector<int64_t>& rows) const {
+    LocalColumn result(name,type);
+    // 没有空值也不需要补空值时按类型整列收集
+    if(nulls.empty() && std::all_of(rows.begin(),rows.end(),[](int64_t row){ return row >= 0; })){
+        const size_t count = rows.size();
+        switch(type){
+            case LocalType::INT:
+                result.ints.resize(count);
+                for(size_t i = 0;i < count;++i){
+                    result.ints[i] = ints[rows[i]];
+                }
+                break;
+            case LocalType::DOUBLE:
+                result.doubles.resize(count);
+                for(size_t i = 0;i < count;++i){
+                    result.doubles[i] = doubles[rows[i]];
+                }
+                break;
+            default:
+                result.strings.reserve(count);
+                for(int64_t row : rows){
+                    result.strings.push_back(strings[row]);
+                }
+        }
+        return result;
+    }
+    result.reserve(rows.size());
+    for(int64_t row : rows){
+        if(row < 0 || isNull(row)){
+            result.appendNull();
+            continue;
+        }
+        if(!result.nulls.empty()){
+            result.nulls.push_back(0);
+        }
+        switch(type){
+            case LocalType::INT: result.ints.push_back(ints[row]); break;
+            case LocalType::DOUBLE: result.doubles.push_back(doubles[row]); break;
+            default: result.strings.push_back(strings[row]);
+        }
+    }
+    return result;
+}
+
+LocalColumn LocalColumn::slice(size_t begin,size_t end) const {
+    LocalColumn result(name,type);
+    switch(type){
+        case LocalType::INT: result.ints.assign(ints.begin() + begin,ints.begin() + end); break;
+        case LocalType::DOUBLE: result.doubles.assign(doubles.begin() + begin,doubles.begin() + end); break;
+        default: result.strings.assign(strings.begin() + begin,strings.begin() + end);
+    }
+    if(!nulls.empty()){
+        result.nulls.assign(nulls.begin() + begin,nulls.begin() + end);
+    }
+    return result;
+}
@@ -0,0 +1,18 @@
+#include "../include/LocalEmptyOperator.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "XStringUtils.h"
+
+LocalEmptyOperator::LocalEmptyOperator(const LocalStepDefinition& step) : LocalOperator(step){
+    for(const std::string& item : SqlSyntaxUtils::splitExpressions(step.getParameter("selects"))){
+        const std::string alias = SqlSyntaxUtils::getExpressionAlias(item);
+        names.push_back(alias.empty() ? XStringUtils::trim(SqlSyntaxUtils::removeExpressionAlias(item)) : alias);
+    }
+}
+
+void LocalEmptyOperator::run(){
+    std::shared_ptr<LocalBatch> batch = std::make_shared<LocalBatch>(0);
+    for(const std::string& name : names){
+        batch->addColumn(LocalColumn(name,LocalType::INT));
+    }
+    emit(batch);
+}
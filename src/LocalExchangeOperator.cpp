@@ -0,0 +1,9 @@
+#include "../include/LocalExchangeOperator.h"
+
+void LocalExchangeOperator::run(){
+    for(std::shared_ptr<const LocalBatch> batch = next();batch != nullptr;batch = next()){
+        if(!emit(batch)){
+            return;
+        }
+    }
+}
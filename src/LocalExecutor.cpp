@@ -0,0 +1,178 @@
+#include "../include/LocalExecutor.h"
+#include "../include/LocalAggregation.h"
+#include "../include/LocalAsofJoinOperator.h"
+#include "../include/LocalBloomBuildOperator.h"
+#include "../include/LocalBloomFilterOperator.h"
+#include "../include/LocalEmptyOperator.h"
+#include "../include/LocalExchangeOperator.h"
+#include "../include/LocalFilterOperator.h"
+#include "../include/LocalGroupByOperator.h"
+#include "../include/LocalHashJoinOperator.h"
+#include "../include/LocalInputOperator.h"
+#include "../include/LocalIntervalJoinOperator.h"
+#include "../include/LocalNestedJoinOperator.h"
+#include "../include/LocalOutputOperator.h"
+#include "../include/LocalPatternWindowOperator.h"
+#include "../include/LocalProjectOperator.h"
+#include "../include/LocalSlidingWindowOperator.h"
+#include "../include/LocalSpool.h"
+#include "../include/LocalStreamAggregateOperator.h"
+#include "../include/LocalTakeOperator.h"
+#include "../include/LocalTumblingWindowOperator.h"
+#include "EngineException.h"
+
+#include <exception>
+#include <mutex>
+#include <thread>
+
+LocalExecutor::LocalExecutor(const std::string& directory) : directory(directory){}
+
+std::shared_ptr<LocalOperator> LocalExecutor::create(const LocalStepDefinition& step) const {
+    const std::string& name = step.getName();
+    if(name == "Input"){
+        auto iter = tables.find(step.getParameter("name"));
+        return std::make_shared<LocalInputOperator>(step,directory,iter == tables.end() ? nullptr : &iter->second);
+    }
+    if(name == "Filter"){
+        return std::make_shared<LocalFilterOperator>(step);
+    }
+    if(name == "Project"){
+        const std::string selects = step.getParameter("selects");
+        if(LocalAggregation::hasAggregate(selects)){
+            return std::make_shared<LocalGroupByOperator>(step,"",selects);
+        }
+        return std::make_shared<LocalProjectOperator>(step);
+    }
+    if(name == "GroupBy" || name == "PartialGroupBy"){
+        return std::make_shared<LocalGroupByOperator>(step,step.getParameter("keys"),step.getParameter("selects"));
+    }
+    if(name == "FinalGroupBy"){
+        return std::make_shared<LocalGroupByOperator>(step,step.getParameter("keys"),
+            LocalAggregation::merge(step.getParameter("states"),step.getParameter("selects")));
+    }
+    if(name == "StreamAggregate" || name == "PartialStreamAggregate"){
+        return std::make_shared<LocalStreamAggregateOperator>(step,step.getParameter("selects"),name == "PartialStreamAggregate");
+    }
+    if(name == "FinalStreamAggregate"){
+        return std::make_shared<LocalStreamAggregateOperator>(step,
+            LocalAggregation::merge(step.getParameter("states"),step.getParameter("selects")),false,true);
+    }
+    if(name == "ReduceJoin" || name == "BroadcastHashJoin"){
+        return std::make_shared<LocalHashJoinOperator>(step);
+    }
+    if(name == "NestedJoin"){
+        return std::make_shared<LocalNestedJoinOperator>(step);
+    }
+    if(name == "IntervalJoin"){
+        return std::make_shared<LocalIntervalJoinOperator>(step);
+    }
+    if(name == "AsofJoin"){
+        return std::make_shared<LocalAsofJoinOperator>(step);
+    }
+    if(name == "BloomBuild"){
+        return std::make_shared<LocalBloomBuildOperator>(step);
+    }
+    if(name == "BloomFilter"){
+        return std::make_shared<LocalBloomFilterOperator>(step);
+    }
+    if(name == "Exchange"){
+        return std::make_shared<LocalExchangeOperator>(step);
+    }
+    if(name == "PatternWindow" || name == "PatternSession"){
+        return std::make_shared<LocalPatternWindowOperator>(step);
+    }
+    if(name == "SlidingWindow" || name == "SlidingSession"){
+        return std::make_shared<LocalSlidingWindowOperator>(step);
+    }
+    if(name == "TumblingWindow" || name == "TumblingSession"){
+        return std::make_shared<LocalTumblingWindowOperator>(step);
+    }
+    if(name == "Take"){
+        return std::make_shared<LocalTakeOperator>(step);
+    }
+    if(name == "Output"){
+        return std::make_shared<LocalOutputOperator>(step,directory);
+    }
+    if(name == "Empty"){
+        return std::make_shared<LocalEmptyOperator>(step);
+    }
+    throw EngineException("SQL_EXECUTOR_UNSUPPORTED_STEP: " + name);
+}
+
+std::vector<std::shared_ptr<const LocalBatch>> LocalExecutor::execute(const std::vector<std::string>& plan){
+    std::vector<std::shared_ptr<LocalOperator>> operators;
+    std::map<std::string, std::shared_ptr<LocalSpool>> spools;
+    for(const std::string& text : plan){
+        const LocalStepDefinition step = LocalStepDefinition::parse(text);
+        std::shared_ptr<LocalOperator> op = create(step);
+        op->setBatchSize(batchSize);
+        const std::string output = step.getAttribute("output");
+        if(!output.empty()){
+            std::shared_ptr<LocalSpool> spool = std::make_shared<LocalSpool>();
+            spools[output] = spool;
+            op->setOutput(spool);
+        }
+        operators.push_back(op);
+    }
+    // 所有输出 spool 建好之后再连接输入：分布式计划中边缘的 BloomFilter 读取云端 BloomBuild 的输出
+    for(auto& op : operators){
+        const LocalStepDefinition& step = op->getStep();
+        std::vector<std::string> inputs = {step.getAttribute("input"),step.getAttribute("input2")};
+        // BloomFilter 的布隆过滤器来自参数 bloom 指定的 spool，作为第二个输入
+        if(step.getName() == "BloomFilter"){
+            inputs.push_back(step.getParameter("bloom"));
+        }
+        for(const std::string& input : inputs){
+            if(input.empty()){
+                continue;
+            }
+            auto iter = spools.find(input);
+            if(iter == spools.end()){
+                throw EngineException("SQL_EXECUTOR_UNKNOWN_SPOOL: " + input);
+            }
+            op->addInput(iter->second);
+        }
+    }
+    if(operators.empty()){
+        return {};
+    }
+
+    // 最后一个步骤的输出由调用方读取
+    std::shared_ptr<LocalSpool> result;
+    int consumer = -1;
+    const std::string last = operators.back()->getStep().getAttribute("output");
+    if(!last.empty()){
+        result = spools.at(last);
+        consumer = result->subscribe();
+    }
+
+    std::mutex mutex;
+    std::exception_ptr error;
+    std::vector<std::thread> threads;
+    for(auto& op : operators){
+        threads.emplace_back([op,&mutex,&error]{
+            try{
+                op->execute();
+            }catch(...){
+                std::lock_guard<std::mutex> lock(mutex);
+                if(error == nullptr){
+                    error = std::current_exception();
+                }
+            }
+        });
+    }
+
+    std::vector<std::shared_ptr<const LocalBatch>> batches;
+    if(result != nullptr){
+        for(std::shared_ptr<const LocalBatch> batch = result->pop(consumer);batch != nullptr;batch = result->pop(consumer)){
+            batches.push_back(batch);
+        }
+    }
+    for(auto& thread : threads){
+        thread.join();
+    }
+    if(error != nullptr){
+        std::rethrow_exception(error);
+    }
+    return batches;
+}
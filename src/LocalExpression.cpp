@@ -0,0 +1,655 @@
+#include "../include/LocalExpression.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+#include <cctype>
+#include <cmath>
+
+namespace {
+
+    struct Token{
+        enum class Type{ NUMBER, STRING, WORD, SYMBOL, END };
+        Type type;
+        std::string text;
+    };
+
+    std::vector<Token> tokenize(const std::string& expr){
+        std::vector<Token> tokens;
+        const size_t len = expr.size();
+        size_t i = 0;
+        while(i < len){
+            const char c = expr[i];
+            if(std::isspace(static_cast<unsigned char>(c))){
+                i++;
+            }else if(std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && i + 1 < len && std::isdigit(static_cast<unsigned char>(expr[i + 1])))){
+                size_t j = i;
+                while(j < len && (std::isdigit(static_cast<unsigned char>(expr[j])) || expr[j] == '.')){
+                    j++;
+                }
+                if(j < len && (expr[j] == 'e' || expr[j] == 'E')){
+                    size_t k = j + 1;
+                    if(k < len && (expr[k] == '+' || expr[k] == '-')){
+                        k++;
+                    }
+                    if(k < len && std::isdigit(static_cast<unsigned char>(expr[k]))){
+                        j = k;
+                        while(j < len && std::isdigit(static_cast<unsigned char>(expr[j]))){
+                            j++;
+                        }
+                    }
+                }
+                tokens.push_back({Token::Type::NUMBER,expr.substr(i,j - i)});
+                i = j;
+            }else if(c == '\''){
+                // 引号内两个单引号表示一个单引号
+                std::string text;
+                size_t j = i + 1;
+                for(;j < len;++j){
+                    if(expr[j] == '\''){
+                        if(j + 1 < len && expr[j + 1] == '\''){
+                            text += '\'';
+                            j++;
+                            continue;
+                        }
+                        break;
+                    }
+                    text += expr[j];
+                }
+                if(j >= len){
+                    throw EngineException("SQL_EXECUTOR_UNTERMINATED_STRING: " + expr);
+                }
+                tokens.push_back({Token::Type::STRING,text});
+                i = j + 1;
+            }else if(c == '`' || c == '"'){
+                const size_t end = expr.find(c,i + 1);
+                if(end == std::string::npos){
+                    throw EngineException("SQL_EXECUTOR_UNTERMINATED_IDENTIFIER: " + expr);
+                }
+                tokens.push_back({Token::Type::WORD,expr.substr(i + 1,end - i - 1)});
+                i = end + 1;
+            }else if(std::isalpha(static_cast<unsigned char>(c)) || c == '_'){
+                size_t j = i;
+                while(j < len && (std::isalnum(static_cast<unsigned char>(expr[j])) || expr[j] == '_' || expr[j] == '.')){
+                    j++;
+                }
+                tokens.push_back({Token::Type::WORD,expr.substr(i,j - i)});
+                i = j;
+            }else{
+                static const std::vector<std::string> symbols = {"==","!=","<>","<=",">=","||","(",")",",","+","-","*","/","%","=","<",">"};
+                bool matched = false;
+                for(const std::string& symbol : symbols){
+                    if(expr.compare(i,symbol.size(),symbol) == 0){
+                        tokens.push_back({Token::Type::SYMBOL,symbol});
+                        i += symbol.size();
+                        matched = true;
+                        break;
+                    }
+                }
+                if(!matched){
+                    throw EngineException("SQL_EXECUTOR_UNEXPECTED_CHARACTER: " + expr.substr(i,1) + " in " + expr);
+                }
+            }
+        }
+        tokens.push_back({Token::Type::END,""});
+        return tokens;
+    }
+
+    class Parser{
+        private:
+            const std::string& expr;
+            std::vector<Token> tokens;
+            size_t pos = 0;
+
+            const Token& peek() const {
+                return tokens[pos];
+            }
+
+            bool isWord(const std::string& word) const {
+                return peek().type == Token::Type::WORD && XStringUtils::toLowerCase(peek().text) == word;
+            }
+
+            bool isSymbol(const std::string& symbol) const {
+                return peek().type == Token::Type::SYMBOL && peek().text == symbol;
+            }
+
+            void expectSymbol(const std::string& symbol){
+                if(!isSymbol(symbol)){
+                    fail();
+                }
+                pos++;
+            }
+
+            void expectWord(const std::string& word){
+                if(!isWord(word)){
+                    fail();
+                }
+                pos++;
+            }
+
+            [[noreturn]] void fail() const {
+                throw EngineException("SQL_EXECUTOR_INVALID_EXPRESSION: " + expr);
+            }
+
+            static std::shared_ptr<LocalExpression> node(LocalExpression::Kind kind,const std::string& text,
+                                                         std::initializer_list<std::shared_ptr<LocalExpression>> children){
+                std::shared_ptr<LocalExpression> result = std::make_shared<LocalExpression>(kind,text);
+                for(auto& child : children){
+                    result->addChild(child);
+                }
+                return result;
+            }
+
+            std::shared_ptr<LocalExpression> parseOr(){
+                std::shared_ptr<LocalExpression> left = parseAnd();
+                while(isWord("or")){
+                    pos++;
+                    left = node(LocalExpression::Kind::OR,"or",{left,parseAnd()});
+                }
+                return left;
+            }
+
+            std::shared_ptr<LocalExpression> parseAnd(){
+                std::shared_ptr<LocalExpression> left = parseNot();
+                while(isWord("and")){
+                    pos++;
+                    left = node(LocalExpression::Kind::AND,"and",{left,parseNot()});
+                }
+                return left;
+            }
+
+            std::shared_ptr<LocalExpression> parseNot(){
+                if(isWord("not")){
+                    pos++;
+                    return node(LocalExpression::Kind::NOT,"not",{parseNot()});
+                }
+                return parsePredicate();
+            }
+
+            std::shared_ptr<LocalExpression> parsePredicate(){
+                std::shared_ptr<LocalExpression> left = parseAdditive();
+                static const std::vector<std::string> comparisons = {"=","==","!=","<>","<","<=",">",">="};
+                for(const std::string& op : comparisons){
+                    if(isSymbol(op)){
+                        pos++;
+                        return node(LocalExpression::Kind::BINARY,op == "==" ? "=" : op == "<>" ? "!=" : op,{left,parseAdditive()});
+                    }
+                }
+                if(isWord("is")){
+                    pos++;
+                    std::shared_ptr<LocalExpression> result = node(LocalExpression::Kind::IS_NULL,"is null",{left});
+                    if(isWord("not")){
+                        pos++;
+                        result->setNegated(true);
+                    }
+                    expectWord("null");
+                    return result;
+                }
+                bool negated = false;
+                if(isWord("not")){
+                    pos++;
+                    negated = true;
+                }
+                std::shared_ptr<LocalExpression> result;
+                if(isWord("between")){
+                    pos++;
+                    std::shared_ptr<LocalExpression> lower = parseAdditive();
+                    expectWord("and");
+                    result = node(LocalExpression::Kind::BETWEEN,"between",{left,lower,parseAdditive()});
+                }else if(isWord("in")){
+                    pos++;
+                    expectSymbol("(");
+                    result = node(LocalExpression::Kind::IN,"in",{left});
+                    result->addChild(parseOr());
+                    while(isSymbol(",")){
+                        pos++;
+                        result->addChild(parseOr());
+                    }
+                    expectSymbol(")");
+                }else if(isWord("like")){
+                    pos++;
+                    result = node(LocalExpression::Kind::LIKE,"like",{left,parseAdditive()});
+                }else if(negated){
+                    fail();
+                }else{
+                    return left;
+                }
+                result->setNegated(negated);
+                return result;
+            }
+
+            std::shared_ptr<LocalExpression> parseAdditive(){
+                std::shared_ptr<LocalExpression> left = parseMultiplicative();
+                while(isSymbol("+") || isSymbol("-") || isSymbol("||")){
+                    const std::string op = peek().text;
+                    pos++;
+                    left = node(LocalExpression::Kind::BINARY,op,{left,parseMultiplicative()});
+                }
+                return left;
+            }
+
+            std::shared_ptr<LocalExpression> parseMultiplicative(){
+                std::shared_ptr<LocalExpression> left = parseUnary();
+                while(isSymbol("*") || isSymbol("/") || isSymbol("%")){
+                    const std::string op = peek().text;
+                    pos++;
+                    left = node(LocalExpression::Kind::BINARY,op,{left,parseUnary()});
+                }
+                return left;
+            }
+
+            std::shared_ptr<LocalExpression> parseUnary(){
+                if(isSymbol("-")){
+                    pos++;
+                    return node(LocalExpression::Kind::NEGATE,"-",{parseUnary()});
+                }
+                if(isSymbol("+")){
+                    pos++;
+                    return parseUnary();
+                }
+                return parsePrimary();
+            }
+
+            std::shared_ptr<LocalExpression> parsePrimary(){
+                const Token token = peek();
+                switch(token.type){
+                    case Token::Type::NUMBER:
+                        pos++;
+                        if(token.text.find_first_of(".eE") == std::string::npos){
+                            return LocalExpression::literal(LocalValue(static_cast<int64_t>(std::stoll(token.text))));
+                        }
+                        return LocalExpression::literal(LocalValue(std::stod(token.text)));
+                    case Token::Type::STRING:
+                        pos++;
+                        return LocalExpression::literal(LocalValue(token.text));
+                    case Token::Type::SYMBOL:
+                        if(token.text == "("){
+                            pos++;
+                            std::shared_ptr<LocalExpression> inner = parseOr();
+                            expectSymbol(")");
+                            return inner;
+                        }
+                        fail();
+                    case Token::Type::WORD:
+                        break;
+                    default:
+                        fail();
+                }
+
+                pos++;
+                const std::string word = XStringUtils::toLowerCase(token.text);
+                if(!isSymbol("(")){
+                    if(word == "true" || word == "false"){
+                        return LocalExpression::literal(LocalValue(word == "true"));
+                    }
+                    if(word == "null"){
+                        return LocalExpression::literal(LocalValue());
+                    }
+                    if(SqlSyntaxUtils::isReservedKeyword(word)){
+                        fail();
+                    }
+                    return std::make_shared<LocalExpression>(LocalExpression::Kind::COLUMN,token.text);
+                }
+
+                pos++;
+                std::shared_ptr<LocalExpression> result = std::make_shared<LocalExpression>(LocalExpression::Kind::CALL,word);
+                if(isSymbol("*")){
+                    // count(*) 不带参数
+                    pos++;
+                }else if(!isSymbol(")")){
+                    if(isWord("distinct")){
+                        pos++;
+                        result->setDistinct(true);
+                    }
+                    result->addChild(parseOr());
+                    while(isSymbol(",")){
+                        pos++;
+                        result->addChild(parseOr());
+                    }
+                }
+                expectSymbol(")");
+                return result;
+            }
+
+        public:
+            explicit Parser(const std::string& expr) : expr(expr),tokens(tokenize(expr)){}
+
+            std::shared_ptr<LocalExpression> parse(){
+                if(SqlSyntaxUtils::isStateful(expr)){
+                    throw EngineException("SQL_EXECUTOR_STATEFUL_EXPRESSION: " + expr);
+                }
+                std::shared_ptr<LocalExpression> result = parseOr();
+                if(peek().type != Token::Type::END){
+                    fail();
+                }
+                return result;
+            }
+    };
+
+    bool isScalarFunction(const std::string& name){
+        return name == "abs" || name == "sqrt" || name == "floor" || name == "ceil" || name == "round" ||
+               name == "pow" || name == "power" || name == "exp" || name == "ln" || name == "log10" ||
+               name == "lower" || name == "upper" || name == "length" || name == "trim" || name == "concat" ||
+               name == "coalesce" || name == "if";
+    }
+
+    // like 模式匹配，% 匹配任意个字符，_ 匹配一个字符
+    bool like(const std::string& text,const std::string& pattern){
+        size_t t = 0,p = 0,star = std::string::npos,mark = 0;
+        while(t < text.size()){
+            if(p < pattern.size() && (pattern[p] == '_' || pattern[p] == text[t])){
+                t++;
+                p++;
+            }else if(p < pattern.size() && pattern[p] == '%'){
+                star = p++;
+                mark = t;
+            }else if(star != std::string::npos){
+                p = star + 1;
+                t = ++mark;
+            }else{
+                return false;
+            }
+        }
+        while(p < pattern.size() && pattern[p] == '%'){
+            p++;
+        }
+        return p == pattern.size();
+    }
+
+    LocalValue arithmetic(const std::string& op,const LocalValue& left,const LocalValue& right){
+        if(left.isNull() || right.isNull()){
+            return LocalValue();
+        }
+        if(op == "||"){
+            return LocalValue(left.toString() + right.toString());
+        }
+        const bool integral = left.getType() == LocalType::INT && right.getType() == LocalType::INT;
+        if(op == "+"){
+            return integral ? LocalValue(left.asInt() + right.asInt()) : LocalValue(left.asDouble() + right.asDouble());
+        }
+        if(op == "-"){
+            return integral ? LocalValue(left.asInt() - right.asInt()) : LocalValue(left.asDouble() - right.asDouble());
+        }
+        if(op == "*"){
+            return integral ? LocalValue(left.asInt() * right.asInt()) : LocalValue(left.asDouble() * right.asDouble());
+        }
+        // 除数为 0 时结果为空
+        if(op == "/"){
+            return right.asDouble() == 0 ? LocalValue() : LocalValue(left.asDouble() / right.asDouble());
+        }
+        if(integral){
+            return right.asInt() == 0 ? LocalValue() : LocalValue(left.asInt() % right.asInt());
+        }
+        return right.asDouble() == 0 ? LocalValue() : LocalValue(std::fmod(left.asDouble(),right.asDouble()));
+    }
+
+    LocalValue comparison(const std::string& op,const LocalValue& left,const LocalValue& right){
+        if(left.isNull() || right.isNull()){
+            return LocalValue();
+        }
+        const int result = LocalValue::compare(left,right);
+        if(op == "="){
+            return LocalValue(result == 0);
+        }
+        if(op == "!="){
+            return LocalValue(result != 0);
+        }
+        if(op == "<"){
+            return LocalValue(result < 0);
+        }
+        if(op == "<="){
+            return LocalValue(result <= 0);
+        }
+        if(op == ">"){
+            return LocalValue(result > 0);
+        }
+        return LocalValue(result >= 0);
+    }
+
+}
+
+std::shared_ptr<LocalExpression> LocalExpression::parse(const std::string& expr){
+    return Parser(expr).parse();
+}
+
+std::shared_ptr<LocalExpression> LocalExpression::literal(const LocalValue& value){
+    std::shared_ptr<LocalExpression> result = std::make_shared<LocalExpression>(Kind::LITERAL,value.toString());
+    result->value = value;
+    return result;
+}
+
+bool LocalExpression::isAggregate() const {
+    return kind == Kind::CALL && SqlSyntaxUtils::isAggregateFunction(text);
+}
+
+std::string LocalExpression::toString() const {
+    switch(kind){
+        case Kind::LITERAL:
+            return value.getType() == LocalType::STRING ? "'" + value.toString() + "'" : value.isNull() ? "null" : value.toString();
+        case Kind::COLUMN:
+            return text;
+        case Kind::NEGATE:
+            return "-" + children[0]->toString();
+        case Kind::NOT:
+            return "not " + children[0]->toString();
+        case Kind::CALL: {
+            std::string result = text + "(" + (distinct ? "distinct " : "") + (children.empty() && text == "count" ? "*" : "");
+            for(size_t i = 0;i < children.size();++i){
+                result += (i > 0 ? ", " : "") + children[i]->toString();
+            }
+            return result + ")";
+        }
+        case Kind::IS_NULL:
+            return "(" + children[0]->toString() + (negated ? " is not null)" : " is null)");
+        case Kind::BETWEEN:
+            return "(" + children[0]->toString() + (negated ? " not between " : " between ") + children[1]->toString() + " and " + children[2]->toString() + ")";
+        case Kind::IN: {
+            std::string result = "(" + children[0]->toString() + (negated ? " not in (" : " in (");
+            for(size_t i = 1;i < children.size();++i){
+                result += (i > 1 ? ", " : "") + children[i]->toString();
+            }
+            return result + "))";
+        }
+        default:
+            return "(" + children[0]->toString() + " " + (negated ? "not " : "") + text + " " + children[1]->toString() + ")";
+    }
+}
+
+void LocalExpression::bind(const LocalBatch& batch){
+    if(kind == Kind::COLUMN){
+        column = batch.indexOf(text);
+        if(column < 0){
+            throw EngineException("SQL_EXECUTOR_UNKNOWN_COLUMN: " + text);
+        }
+    }else if(kind == Kind::CALL){
+        if(isAggregate()){
+            throw EngineException("SQL_EXECUTOR_AGGREGATE_NOT_ALLOWED: " + text);
+        }
+        if(!isScalarFunction(text)){
+            throw EngineException("SQL_EXECUTOR_UNSUPPORTED_FUNCTION: " + text);
+        }
+    }
+    for(auto& child : children){
+        child->bind(batch);
+    }
+}
+
+LocalValue LocalExpression::evaluate(const LocalBatch& batch,size_t row) const {
+    switch(kind){
+        case Kind::LITERAL:
+            return value;
+        case Kind::COLUMN:
+            return batch.getColumn(column).get(row);
+        case Kind::NEGATE: {
+            const LocalValue v = children[0]->evaluate(batch,row);
+            if(v.isNull()){
+                return v;
+            }
+            return v.getType() == LocalType::INT ? LocalValue(-v.asInt()) : LocalValue(-v.asDouble());
+        }
+        case Kind::NOT: {
+            const LocalValue v = children[0]->evaluate(batch,row);
+            return v.isNull() ? v : LocalValue(!v.isTrue());
+        }
+        case Kind::AND: {
+            const LocalValue l = children[0]->evaluate(batch,row);
+            if(!l.isNull() && !l.isTrue()){
+                return LocalValue(false);
+            }
+            const LocalValue r = children[1]->evaluate(batch,row);
+            if(!r.isNull() && !r.isTrue()){
+                return LocalValue(false);
+            }
+            return l.isNull() || r.isNull() ? LocalValue() : LocalValue(true);
+        }
+        case Kind::OR: {
+            const LocalValue l = children[0]->evaluate(batch,row);
+            if(l.isTrue()){
+                return LocalValue(true);
+            }
+            const LocalValue r = children[1]->evaluate(batch,row);
+            if(r.isTrue()){
+                return LocalValue(true);
+            }
+            return l.isNull() || r.isNull() ? LocalValue() : LocalValue(false);
+        }
+        case Kind::BINARY: {
+            const LocalValue l = children[0]->evaluate(batch,row);
+            const LocalValue r = children[1]->evaluate(batch,row);
+            if(text == "+" || text == "-" || text == "*" || text == "/" || text == "%" || text == "||"){
+                return arithmetic(text,l,r);
+            }
+            return comparison(text,l,r);
+        }
+        case Kind::BETWEEN: {
+            const LocalValue v = children[0]->evaluate(batch,row);
+            const LocalValue lower = children[1]->evaluate(batch,row);
+            const LocalValue upper = children[2]->evaluate(batch,row);
+            if(v.isNull() || lower.isNull() || upper.isNull()){
+                return LocalValue();
+            }
+            const bool inside = LocalValue::compare(v,lower) >= 0 && LocalValue::compare(v,upper) <= 0;
+            return LocalValue(inside != negated);
+        }
+        case Kind::IN: {
+            const LocalValue v = children[0]->evaluate(batch,row);
+            if(v.isNull()){
+                return v;
+            }
+            bool unknown = false;
+            for(size_t i = 1;i < children.size();++i){
+                const LocalValue item = children[i]->evaluate(batch,row);
+                if(item.isNull()){
+                    unknown = true;
+                }else if(LocalValue::compare(v,item) == 0){
+                    return LocalValue(!negated);
+                }
+            }
+            return unknown ? LocalValue() : LocalValue(negated);
+        }
+        case Kind::LIKE: {
+            const LocalValue v = children[0]->evaluate(batch,row);
+            const LocalValue pattern = children[1]->evaluate(batch,row);
+            if(v.isNull() || pattern.isNull()){
+                return LocalValue();
+            }
+            return LocalValue(like(v.toString(),pattern.toString()) != negated);
+        }
+        case Kind::IS_NULL:
+            return LocalValue(children[0]->evaluate(batch,row).isNull() != negated);
+        case Kind::CALL:
+            return call(batch,row);
+    }
+    return LocalValue();
+}
+
+LocalValue LocalExpression::call(const LocalBatch& batch,size_t row) const {
+    std::vector<LocalValue> args;
+    for(auto& child : children){
+        args.push_back(child->evaluate(batch,row));
+    }
+    const auto require = [&](size_t count){
+        if(args.size() < count){
+            throw EngineException("SQL_EXECUTOR_INVALID_ARGUMENTS: " + text);
+        }
+    };
+
+    if(text == "coalesce"){
+        for(const LocalValue& arg : args){
+            if(!arg.isNull()){
+                return arg;
+            }
+        }
+        return LocalValue();
+    }
+    if(text == "if"){
+        require(3);
+        return args[0].isTrue() ? args[1] : args[2];
+    }
+    if(text == "concat"){
+        std::string result;
+        for(const LocalValue& arg : args){
+            result += arg.toString();
+        }
+        return LocalValue(result);
+    }
+    require(1);
+    for(const LocalValue& arg : args){
+        if(arg.isNull()){
+            return arg;
+        }
+    }
+    const LocalValue& x = args[0];
+    if(text == "abs"){
+        return x.getType() == LocalType::INT ? LocalValue(x.asInt() < 0 ? -x.asInt() : x.asInt()) : LocalValue(std::fabs(x.asDouble()));
+    }
+    if(text == "floor"){
+        return x.getType() == LocalType::INT ? x : LocalValue(std::floor(x.asDouble()));
+    }
+    if(text == "ceil"){
+        return x.getType() == LocalType::INT ? x : LocalValue(std::ceil(x.asDouble()));
+    }
+    if(text == "round"){
+        const double scale = args.size() > 1 ? std::pow(10.0,args[1].asInt()) : 1.0;
+        return x.getType() == LocalType::INT ? x : LocalValue(std::round(x.asDouble() * scale) / scale);
+    }
+    if(text == "sqrt"){
+        return LocalValue(std::sqrt(x.asDouble()));
+    }
+    if(text == "pow" || text == "power"){
+        require(2);
+        return LocalValue(std::pow(x.asDouble(),args[1].asDouble()));
+    }
+    if(text == "exp"){
+        return LocalValue(std::exp(x.asDouble()));
+    }
+    if(text == "ln"){
+        return LocalValue(std::log(x.asDouble()));
+    }
+    if(text == "log10"){
+        return LocalValue(std::log10(x.asDouble()));
+    }
+    if(text == "lower"){
+        return LocalValue(XStringUtils::toLowerCase(x.toString()));
+    }
+    if(text == "upper"){
+        return LocalValue(XStringUtils::toUpperCase(x.toString()));
+    }
+    if(text == "trim"){
+        return LocalValue(XStringUtils::trim(x.toString()));
+    }
+    if(text == "length"){
+        return LocalValue(static_cast<int64_t>(x.toString().size()));
+    }
+    throw EngineException("SQL_EXECUTOR_UNSUPPORTED_FUNCTION: " + text);
+}
+
+LocalColumn LocalExpression::evaluate(const LocalBatch& batch,const std::string& name){
+    bind(batch);
+    std::vector<LocalValue> values;
+    values.reserve(batch.getRows());
+    for(size_t row = 0;row < batch.getRows();++row){
+        values.push_back(evaluate(batch,row));
+    }
+    return LocalColumn::fromValues(name,values);
+}
@@ -0,0 +1,611 @@
+#include "../include/LocalFilterKernel.h"
+#include "EngineException.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define LOCAL_FILTER_X86 1
+#endif
+
+namespace {
+
+    // 比较只算 > < = 三种，>= <= != 由它们取反得到
+    enum class Base{ GT, LT, EQ };
+
+    void parseComparison(const std::string& comparison,Base& base,bool& inverted){
+        inverted = comparison == "!=" || comparison == ">=" || comparison == "<=";
+        base = comparison == "=" || comparison == "!=" ? Base::EQ :
+               comparison == ">" || comparison == "<=" ? Base::GT : Base::LT;
+    }
+
+    // 常量写在左侧时交换比较符两侧
+    std::string flip(const std::string& comparison){
+        if(comparison == "<"){
+            return ">";
+        }
+        if(comparison == "<="){
+            return ">=";
+        }
+        if(comparison == ">"){
+            return "<";
+        }
+        if(comparison == ">="){
+            return "<=";
+        }
+        return comparison;
+    }
+
+    bool isComparison(const std::string& op){
+        return op == "=" || op == "!=" || op == "<" || op == "<=" || op == ">" || op == ">=";
+    }
+
+    size_t wordsOf(size_t rows){
+        return (rows + 63) / 64;
+    }
+
+    template<typename T,Base B,bool Y>
+    void compareScalar(const T* x,const T* y,T c,size_t begin,size_t n,uint64_t* out){
+        for(size_t w = begin / 64;w * 64 < n;++w){
+            const size_t base = w * 64,limit = std::min<size_t>(64,n - base);
+            uint64_t word = 0;
+            for(size_t i = 0;i < limit;++i){
+                const T a = x[base + i],b = Y ? y[base + i] : c;
+                const bool bit = B == Base::GT ? a > b : B == Base::LT ? a < b : a == b;
+                word |= static_cast<uint64_t>(bit) << i;
+            }
+            out[w] = word;
+        }
+    }
+
+#ifdef LOCAL_FILTER_X86
+    template<Base B,bool Y>
+    __attribute__((target("avx2")))
+    void compareInt64Avx2(const int64_t* x,const int64_t* y,int64_t c,size_t n,uint64_t* out){
+        const size_t full = n / 64;
+        const __m256i cv = _mm256_set1_epi64x(c);
+        for(size_t w = 0;w < full;++w){
+            uint64_t word = 0;
+            for(int k = 0;k < 16;++k){
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + w * 64 + 4 * k));
+                const __m256i b = Y ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + w * 64 + 4 * k)) : cv;
+                const __m256i m = B == Base::GT ? _mm256_cmpgt_epi64(a,b) : B == Base::LT ? _mm256_cmpgt_epi64(b,a) : _mm256_cmpeq_epi64(a,b);
+                word |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(m))) << (4 * k);
+            }
+            out[w] = word;
+        }
+        compareScalar<int64_t,B,Y>(x,y,c,full * 64,n,out);
+    }
+
+    template<Base B,bool Y>
+    __attribute__((target("avx2")))
+    void compareDoubleAvx2(const double* x,const double* y,double c,size_t n,uint64_t* out){
+        const size_t full = n / 64;
+        const __m256d cv = _mm256_set1_pd(c);
+        for(size_t w = 0;w < full;++w){
+            uint64_t word = 0;
+            for(int k = 0;k < 16;++k){
+                const __m256d a = _mm256_loadu_pd(x + w * 64 + 4 * k);
+                const __m256d b = Y ? _mm256_loadu_pd(y + w * 64 + 4 * k) : cv;
+                const __m256d m = B == Base::GT ? _mm256_cmp_pd(a,b,_CMP_GT_OQ) : B == Base::LT ? _mm256_cmp_pd(a,b,_CMP_LT_OQ) : _mm256_cmp_pd(a,b,_CMP_EQ_OQ);
+                word |= static_cast<uint64_t>(_mm256_movemask_pd(m)) << (4 * k);
+            }
+            out[w] = word;
+        }
+        compareScalar<double,B,Y>(x,y,c,full * 64,n,out);
+    }
+
+    template<Base B,bool Y>
+    __attribute__((target("sse4.2")))
+    void compareInt64Sse42(const int64_t* x,const int64_t* y,int64_t c,size_t n,uint64_t* out){
+        const size_t full = n / 64;
+        const __m128i cv = _mm_set1_epi64x(c);
+        for(size_t w = 0;w < full;++w){
+            uint64_t word = 0;
+            for(int k = 0;k < 32;++k){
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + w * 64 + 2 * k));
+                const __m128i b = Y ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + w * 64 + 2 * k)) : cv;
+                const __m128i m = B == Base::GT ? _mm_cmpgt_epi64(a,b) : B == Base::LT ? _mm_cmpgt_epi64(b,a) : _mm_cmpeq_epi64(a,b);
+                word |= static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(m))) << (2 * k);
+            }
+            out[w] = word;
+        }
+        compareScalar<int64_t,B,Y>(x,y,c,full * 64,n,out);
+    }
+
+    template<Base B,bool Y>
+    __attribute__((target("sse4.2")))
+    void compareDoubleSse42(const double* x,const double* y,double c,size_t n,uint64_t* out){
+        const size_t full = n / 64;
+        const __m128d cv = _mm_set1_pd(c);
+        for(size_t w = 0;w < full;++w){
+            uint64_t word = 0;
+            for(int k = 0;k < 32;++k){
+                const __m128d a = _mm_loadu_pd(x + w * 64 + 2 * k);
+                const __m128d b = Y ? _mm_loadu_pd(y + w * 64 + 2 * k) : cv;
+                const __m128d m = B == Base::GT ? _mm_cmpgt_pd(a,b) : B == Base::LT ? _mm_cmplt_pd(a,b) : _mm_cmpeq_pd(a,b);
+                word |= static_cast<uint64_t>(_mm_movemask_pd(m)) << (2 * k);
+            }
+            out[w] = word;
+        }
+        compareScalar<double,B,Y>(x,y,c,full * 64,n,out);
+    }
+#endif
+
+    template<Base B,bool Y>
+    void compareInt64(const int64_t* x,const int64_t* y,int64_t c,size_t n,uint64_t* out,LocalFilterKernel::InstructionSet isa){
+#ifdef LOCAL_FILTER_X86
+        if(isa == LocalFilterKernel::InstructionSet::AVX2){
+            compareInt64Avx2<B,Y>(x,y,c,n,out);
+            return;
+        }
+        if(isa == LocalFilterKernel::InstructionSet::SSE42){
+            compareInt64Sse42<B,Y>(x,y,c,n,out);
+            return;
+        }
+#endif
+        compareScalar<int64_t,B,Y>(x,y,c,0,n,out);
+    }
+
+    template<Base B,bool Y>
+    void compareDouble(const double* x,const double* y,double c,size_t n,uint64_t* out,LocalFilterKernel::InstructionSet isa){
+#ifdef LOCAL_FILTER_X86
+        if(isa == LocalFilterKernel::InstructionSet::AVX2){
+            compareDoubleAvx2<B,Y>(x,y,c,n,out);
+            return;
+        }
+        if(isa == LocalFilterKernel::InstructionSet::SSE42){
+            compareDoubleSse42<B,Y>(x,y,c,n,out);
+            return;
+        }
+#endif
+        compareScalar<double,B,Y>(x,y,c,0,n,out);
+    }
+
+    template<bool Y>
+    void compareNumeric(const LocalColumn& column,const LocalColumn* other,const LocalValue& constant,Base base,
+                        size_t n,uint64_t* out,LocalFilterKernel::InstructionSet isa){
+        if(column.getType() == LocalType::INT){
+            const int64_t* x = column.getInts().data();
+            const int64_t* y = Y ? other->getInts().data() : nullptr;
+            const int64_t c = Y ? 0 : constant.asInt();
+            switch(base){
+                case Base::GT: compareInt64<Base::GT,Y>(x,y,c,n,out,isa); break;
+                case Base::LT: compareInt64<Base::LT,Y>(x,y,c,n,out,isa); break;
+                default: compareInt64<Base::EQ,Y>(x,y,c,n,out,isa);
+            }
+            return;
+        }
+        const double* x = column.getDoubles().data();
+        const double* y = Y ? other->getDoubles().data() : nullptr;
+        const double c = Y ? 0 : constant.asDouble();
+        switch(base){
+            case Base::GT: compareDouble<Base::GT,Y>(x,y,c,n,out,isa); break;
+            case Base::LT: compareDouble<Base::LT,Y>(x,y,c,n,out,isa); break;
+            default: compareDouble<Base::EQ,Y>(x,y,c,n,out,isa);
+        }
+    }
+
+    void compareStrings(const LocalColumn& column,const LocalColumn* other,const std::string& constant,Base base,size_t n,uint64_t* out){
+        const std::vector<std::string>& x = column.getStrings();
+        for(size_t w = 0;w < wordsOf(n);++w){
+            const size_t begin = w * 64,limit = std::min<size_t>(64,n - begin);
+            uint64_t word = 0;
+            for(size_t i = 0;i < limit;++i){
+                const int result = x[begin + i].compare(other != nullptr ? other->getStrings()[begin + i] : constant);
+                const bool bit = base == Base::GT ? result > 0 : base == Base::LT ? result < 0 : result == 0;
+                word |= static_cast<uint64_t>(bit) << i;
+            }
+            out[w] = word;
+        }
+    }
+
+    // 列的非空位图，没有空值时全为 1
+    void validOf(const LocalColumn& column,size_t n,std::vector<uint64_t>& out){
+        out.assign(wordsOf(n),~0ULL);
+        if(!column.hasNulls()){
+            return;
+        }
+        const uint8_t* nulls = column.getNulls().data();
+        for(size_t w = 0;w < out.size();++w){
+            const size_t begin = w * 64,limit = std::min<size_t>(64,n - begin);
+            uint64_t word = 0;
+            for(size_t i = 0;i < limit;++i){
+                word |= static_cast<uint64_t>(nulls[begin + i] == 0) << i;
+            }
+            out[w] = word;
+        }
+    }
+
+    bool isNumericLiteral(const std::shared_ptr<LocalExpression>& expr){
+        return expr->getKind() == LocalExpression::Kind::LITERAL && expr->getValue().isNumeric();
+    }
+
+    bool isStringLiteral(const std::shared_ptr<LocalExpression>& expr){
+        return expr->getKind() == LocalExpression::Kind::LITERAL && expr->getValue().getType() == LocalType::STRING && !expr->getValue().isNull();
+    }
+
+    bool isColumnOf(const std::shared_ptr<LocalExpression>& expr,LocalType type,const LocalBatch& layout){
+        return expr->getKind() == LocalExpression::Kind::COLUMN && layout.getColumn(expr->getColumn()).getType() == type;
+    }
+
+    // 整数列能精确比较的浮点常量范围
+    bool fitsInt64(double value){
+        return value > -9.2e18 && value < 9.2e18;
+    }
+
+}
+
+LocalFilterKernel::LocalFilterKernel(const std::shared_ptr<LocalExpression>& condition,const LocalBatch& layout) :
+    instructionSet(detect()){
+    condition->bind(layout);
+    for(const LocalColumn& column : layout.getColumns()){
+        names.push_back(column.getName());
+    }
+    root = compile(condition,layout);
+}
+
+LocalFilterKernel::InstructionSet LocalFilterKernel::detect(){
+#ifdef LOCAL_FILTER_X86
+    static const InstructionSet detected = []{
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")){
+            return InstructionSet::AVX2;
+        }
+        if(__builtin_cpu_supports("sse4.2")){
+            return InstructionSet::SSE42;
+        }
+        return InstructionSet::SCALAR;
+    }();
+    return detected;
+#else
+    return InstructionSet::SCALAR;
+#endif
+}
+
+std::string LocalFilterKernel::toString(InstructionSet instructionSet){
+    switch(instructionSet){
+        case InstructionSet::AVX2: return "avx2";
+        case InstructionSet::SSE42: return "sse4.2";
+        default: return "scalar";
+    }
+}
+
+void LocalFilterKernel::setInstructionSet(InstructionSet instructionSet){
+    this->instructionSet = static_cast<int>(instructionSet) <= static_cast<int>(detect()) ? instructionSet : detect();
+}
+
+int LocalFilterKernel::require(const std::shared_ptr<LocalExpression>& expr,const LocalBatch& layout){
+    const int column = expr->getColumn();
+    columns.push_back(column);
+    types.push_back(layout.getColumn(column).getType());
+    return column;
+}
+
+std::shared_ptr<LocalFilterKernel::Node> LocalFilterKernel::compile(const std::shared_ptr<LocalExpression>& expr,const LocalBatch& layout){
+    std::shared_ptr<Node> node = std::make_shared<Node>();
+    const auto& children = expr->getChildren();
+    const bool onColumn = !children.empty() && children[0]->getKind() == LocalExpression::Kind::COLUMN;
+    const LocalType type = onColumn ? layout.getColumn(children[0]->getColumn()).getType() : LocalType::INT;
+    switch(expr->getKind()){
+        case LocalExpression::Kind::AND:
+        case LocalExpression::Kind::OR:
+            node->op = expr->getKind() == LocalExpression::Kind::AND ? Node::Op::AND : Node::Op::OR;
+            node->children = {compile(children[0],layout),compile(children[1],layout)};
+            return node;
+        case LocalExpression::Kind::NOT:
+            node->op = Node::Op::NOT;
+            node->children = {compile(children[0],layout)};
+            return node;
+        case LocalExpression::Kind::BINARY:
+            if(isComparison(expr->getText())){
+                std::shared_ptr<Node> comparison = compileComparison(expr,layout);
+                if(comparison != nullptr){
+                    return comparison;
+                }
+            }
+            break;
+        case LocalExpression::Kind::IS_NULL:
+            if(onColumn){
+                node->op = Node::Op::IS_NULL;
+                node->negated = expr->isNegated();
+                node->column = require(children[0],layout);
+                return node;
+            }
+            break;
+        case LocalExpression::Kind::BETWEEN:
+            if(onColumn && type != LocalType::STRING && isNumericLiteral(children[1]) && isNumericLiteral(children[2])){
+                node->op = Node::Op::BETWEEN;
+                node->negated = expr->isNegated();
+                node->type = type;
+                LocalValue lower = children[1]->getValue(),upper = children[2]->getValue();
+                if(type == LocalType::INT){
+                    // 整数列上 [1.5, 3.5] 等价于 [2, 3]
+                    if(!fitsInt64(lower.asDouble()) || !fitsInt64(upper.asDouble())){
+                        break;
+                    }
+                    lower = LocalValue(static_cast<int64_t>(std::ceil(lower.asDouble())));
+                    upper = LocalValue(static_cast<int64_t>(std::floor(upper.asDouble())));
+                }
+                node->constants = {lower,upper};
+                node->column = require(children[0],layout);
+                return node;
+            }
+            if(onColumn && type == LocalType::STRING && isStringLiteral(children[1]) && isStringLiteral(children[2])){
+                node->op = Node::Op::BETWEEN;
+                node->negated = expr->isNegated();
+                node->type = type;
+                node->constants = {children[1]->getValue(),children[2]->getValue()};
+                node->column = require(children[0],layout);
+                return node;
+            }
+            // 连接条件中常见的上下界都是同类型的列
+            if(onColumn && isColumnOf(children[1],type,layout) && isColumnOf(children[2],type,layout)){
+                node->op = Node::Op::BETWEEN;
+                node->negated = expr->isNegated();
+                node->type = type;
+                node->column = require(children[0],layout);
+                node->other = require(children[1],layout);
+                node->upper = require(children[2],layout);
+                return node;
+            }
+            break;
+        case LocalExpression::Kind::IN: {
+            if(!onColumn){
+                break;
+            }
+            bool supported = true;
+            for(size_t i = 1;i < children.size() && supported;++i){
+                const LocalValue& value = children[i]->getValue();
+                if(children[i]->getKind() != LocalExpression::Kind::LITERAL){
+                    supported = false;
+                }else if(value.isNull()){
+                    node->nullInList = true;
+                }else if(type == LocalType::STRING ? value.getType() != LocalType::STRING : !value.isNumeric()){
+                    supported = false;
+                }else if(type == LocalType::INT && value.asDouble() != std::floor(value.asDouble())){
+                    // 非整数常量不会与整数列相等
+                    continue;
+                }else{
+                    node->constants.push_back(type == LocalType::INT ? LocalValue(value.asInt()) : value);
+                }
+            }
+            if(!supported){
+                node->constants.clear();
+                node->nullInList = false;
+                break;
+            }
+            node->op = Node::Op::IN;
+            node->negated = expr->isNegated();
+            node->type = type;
+            node->column = require(children[0],layout);
+            return node;
+        }
+        default:
+            break;
+    }
+    node->op = Node::Op::ROW;
+    node->expression = expr;
+    return node;
+}
+
+std::shared_ptr<LocalFilterKernel::Node> LocalFilterKernel::compileComparison(const std::shared_ptr<LocalExpression>& expr,const LocalBatch& layout){
+    std::shared_ptr<LocalExpression> left = expr->getChildren()[0],right = expr->getChildren()[1];
+    std::string comparison = expr->getText();
+    if(left->getKind() == LocalExpression::Kind::LITERAL && right->getKind() == LocalExpression::Kind::COLUMN){
+        std::swap(left,right);
+        comparison = flip(comparison);
+    }
+    if(left->getKind() != LocalExpression::Kind::COLUMN){
+        return nullptr;
+    }
+    const LocalType type = layout.getColumn(left->getColumn()).getType();
+
+    std::shared_ptr<Node> node = std::make_shared<Node>();
+    node->op = Node::Op::COMPARE;
+    node->type = type;
+    if(right->getKind() == LocalExpression::Kind::COLUMN){
+        if(layout.getColumn(right->getColumn()).getType() != type){
+            return nullptr;
+        }
+        node->comparison = comparison;
+        node->column = require(left,layout);
+        node->other = require(right,layout);
+        return node;
+    }
+    if(type == LocalType::STRING ? !isStringLiteral(right) : !isNumericLiteral(right)){
+        return nullptr;
+    }
+
+    LocalValue constant = right->getValue();
+    if(type == LocalType::INT && constant.getType() == LocalType::DOUBLE){
+        // 整数列与非整数常量比较时把常量取整，比较符不变
+        const double c = constant.asDouble();
+        if(!fitsInt64(c)){
+            return nullptr;
+        }
+        if(c != std::floor(c)){
+            if(comparison == "=" || comparison == "!="){
+                node->never = true;
+            }
+            constant = LocalValue(static_cast<int64_t>(comparison == ">" || comparison == "<=" ? std::floor(c) : std::ceil(c)));
+        }else{
+            constant = LocalValue(static_cast<int64_t>(c));
+        }
+    }
+    node->comparison = comparison;
+    node->constants = {constant};
+    node->column = require(left,layout);
+    return node;
+}
+
+bool LocalFilterKernel::accepts(const LocalBatch& batch) const {
+    if(batch.getColumnCount() != names.size()){
+        return false;
+    }
+    for(size_t c = 0;c < names.size();++c){
+        if(batch.getColumn(c).getName() != names[c]){
+            return false;
+        }
+    }
+    for(size_t i = 0;i < columns.size();++i){
+        if(batch.getColumn(columns[i]).getType() != types[i]){
+            return false;
+        }
+    }
+    return true;
+}
+
+void LocalFilterKernel::run(const Node& node,const LocalBatch& batch,std::vector<uint64_t>& trues,std::vector<uint64_t>& falses) const {
+    const size_t n = batch.getRows(),words = wordsOf(n);
+    trues.assign(words,0);
+    falses.assign(words,0);
+    std::vector<uint64_t> valid,result(words,0),scratch(words,0);
+
+    switch(node.op){
+        case Node::Op::AND:
+        case Node::Op::OR: {
+            std::vector<uint64_t> otherTrues,otherFalses;
+            run(*node.children[0],batch,trues,falses);
+            run(*node.children[1],batch,otherTrues,otherFalses);
+            for(size_t w = 0;w < words;++w){
+                if(node.op == Node::Op::AND){
+                    trues[w] &= otherTrues[w];
+                    falses[w] |= otherFalses[w];
+                }else{
+                    trues[w] |= otherTrues[w];
+                    falses[w] &= otherFalses[w];
+                }
+            }
+            return;
+        }
+        case Node::Op::NOT:
+            run(*node.children[0],batch,falses,trues);
+            return;
+        case Node::Op::ROW:
+            for(size_t row = 0;row < n;++row){
+                const LocalValue value = node.expression->evaluate(batch,row);
+                if(value.isTrue()){
+                    trues[row / 64] |= 1ULL << (row % 64);
+                }else if(!value.isNull()){
+                    falses[row / 64] |= 1ULL << (row % 64);
+                }
+            }
+            return;
+        case Node::Op::IS_NULL:
+            validOf(batch.getColumn(node.column),n,valid);
+            for(size_t w = 0;w < words;++w){
+                trues[w] = node.negated ? valid[w] : ~valid[w];
+                falses[w] = ~trues[w];
+            }
+            return;
+        default:
+            break;
+    }
+
+    const LocalColumn& column = batch.getColumn(node.column);
+    validOf(column,n,valid);
+    const bool nullOnMiss = node.op == Node::Op::IN && node.nullInList;
+    if(node.op == Node::Op::COMPARE){
+        const LocalColumn* other = node.other >= 0 ? &batch.getColumn(node.other) : nullptr;
+        if(other != nullptr && other->hasNulls()){
+            validOf(*other,n,scratch);
+            for(size_t w = 0;w < words;++w){
+                valid[w] &= scratch[w];
+            }
+        }
+        Base base;
+        bool inverted;
+        parseComparison(node.comparison,base,inverted);
+        if(node.never){
+            std::fill(result.begin(),result.end(),0);
+        }else if(node.type == LocalType::STRING){
+            compareStrings(column,other,other != nullptr ? "" : node.constants[0].toString(),base,n,result.data());
+        }else if(other != nullptr){
+            compareNumeric<true>(column,other,LocalValue(),base,n,result.data(),instructionSet);
+        }else{
+            compareNumeric<false>(column,nullptr,node.constants[0],base,n,result.data(),instructionSet);
+        }
+        if(inverted){
+            for(uint64_t& word : result){
+                word = ~word;
+            }
+        }
+    }else if(node.op == Node::Op::BETWEEN){
+        // 不小于下界且不大于上界
+        if(node.other >= 0){
+            const LocalColumn& lower = batch.getColumn(node.other);
+            const LocalColumn& upper = batch.getColumn(node.upper);
+            for(const LocalColumn* bound : {&lower,&upper}){
+                if(bound->hasNulls()){
+                    validOf(*bound,n,scratch);
+                    for(size_t w = 0;w < words;++w){
+                        valid[w] &= scratch[w];
+                    }
+                }
+            }
+            if(node.type == LocalType::STRING){
+                compareStrings(column,&lower,"",Base::LT,n,result.data());
+                compareStrings(column,&upper,"",Base::GT,n,scratch.data());
+            }else{
+                compareNumeric<true>(column,&lower,LocalValue(),Base::LT,n,result.data(),instructionSet);
+                compareNumeric<true>(column,&upper,LocalValue(),Base::GT,n,scratch.data(),instructionSet);
+            }
+        }else if(node.type == LocalType::STRING){
+            compareStrings(column,nullptr,node.constants[0].toString(),Base::LT,n,result.data());
+            compareStrings(column,nullptr,node.constants[1].toString(),Base::GT,n,scratch.data());
+        }else{
+            compareNumeric<false>(column,nullptr,node.constants[0],Base::LT,n,result.data(),instructionSet);
+            compareNumeric<false>(column,nullptr,node.constants[1],Base::GT,n,scratch.data(),instructionSet);
+        }
+        for(size_t w = 0;w < words;++w){
+            result[w] = ~(result[w] | scratch[w]);
+        }
+    }else if(node.type == LocalType::STRING){
+        std::unordered_set<std::string> set;
+        for(const LocalValue& value : node.constants){
+            set.insert(value.toString());
+        }
+        const std::vector<std::string>& strings = column.getStrings();
+        for(size_t row = 0;row < n;++row){
+            result[row / 64] |= static_cast<uint64_t>(set.count(strings[row]) > 0) << (row % 64);
+        }
+    }else{
+        for(const LocalValue& value : node.constants){
+            compareNumeric<false>(column,nullptr,value,Base::EQ,n,scratch.data(),instructionSet);
+            for(size_t w = 0;w < words;++w){
+                result[w] |= scratch[w];
+            }
+        }
+    }
+
+    for(size_t w = 0;w < words;++w){
+        trues[w] = result[w] & valid[w];
+        falses[w] = nullOnMiss ? 0 : ~result[w] & valid[w];
+    }
+    if(node.negated){
+        trues.swap(falses);
+    }
+}
+
+void LocalFilterKernel::evaluate(const LocalBatch& batch,std::vector<uint64_t>& trues) const {
+    std::vector<uint64_t> falses;
+    run(*root,batch,trues,falses);
+    const size_t tail = batch.getRows() % 64;
+    if(tail != 0){
+        trues.back() &= (1ULL << tail) - 1;
+    }
+}
+
+void LocalFilterKernel::select(const LocalBatch& batch,std::vector<int64_t>& rows) const {
+    std::vector<uint64_t> trues;
+    evaluate(batch,trues);
+    rows.clear();
+    for(size_t w = 0;w < trues.size();++w){
+        for(uint64_t word = trues[w];word != 0;word &= word - 1){
+            rows.push_back(w * 64 + __builtin_ctzll(word));
+        }
+    }
+}
@@ -0,0 +1,18 @@
+#include "../include/LocalFilterOperator.h"
+
+LocalFilterOperator::LocalFilterOperator(const LocalStepDefinition& step) :
+    LocalOperator(step),condition(LocalExpression::parse(step.getParameter("condition"))){
+}
+
+void LocalFilterOperator::run(){
+    std::vector<int64_t> rows;
+    for(std::shared_ptr<const LocalBatch> batch = next();batch != nullptr;batch = next()){
+        if(kernel == nullptr || !kernel->accepts(*batch)){
+            kernel = std::make_shared<LocalFilterKernel>(condition,*batch);
+        }
+        kernel->select(*batch,rows);
+        if(!emit(rows.size() == batch->getRows() ? batch : batch->select(rows))){
+            return;
+        }
+    }
+}
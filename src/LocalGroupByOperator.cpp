@@ -0,0 +1,45 @@
+#include "../include/LocalGroupByOperator.h"
+#include "../include/LocalGroupTable.h"
+
+#include <algorithm>
+
+LocalGroupByOperator::LocalGroupByOperator(const LocalStepDefinition& step,const std::string& keys,const std::string& selects) :
+    LocalOperator(step),aggregation(keys,selects){
+}
+
+void LocalGroupByOperator::run(){
+    const size_t keyCount = aggregation.getKeys().size();
+    std::vector<LocalAggregate>& aggregates = aggregation.getAggregates();
+    const std::vector<std::string> names = aggregation.getGroupColumnNames();
+    LocalGroupTable table(aggregation.getKeys(),std::vector<std::string>(names.begin(),names.begin() + keyCount));
+    std::vector<LocalAggregate::States> states(aggregates.size());
+
+    std::vector<uint32_t> groups;
+    for(std::shared_ptr<const LocalBatch> batch = next();batch != nullptr;batch = next()){
+        aggregation.bind(*batch);
+        table.lookup(*batch,groups);
+        for(size_t a = 0;a < aggregates.size();++a){
+            aggregates[a].resize(states[a],std::max<size_t>(table.size(),1));
+            aggregates[a].update(states[a],groups,*batch);
+        }
+    }
+    // 没有 key 时即使没有输入也输出一行
+    const size_t groupCount = keyCount == 0 ? 1 : table.size();
+    for(size_t a = 0;a < aggregates.size();++a){
+        aggregates[a].resize(states[a],groupCount);
+    }
+
+    for(size_t begin = 0;begin < groupCount || begin == 0;begin += batchSize){
+        const size_t end = std::min(groupCount,begin + batchSize);
+        LocalBatch groupBatch(end - begin);
+        for(size_t k = 0;k < keyCount;++k){
+            groupBatch.addColumn(table.getKeyColumn(k,begin,end));
+        }
+        for(size_t a = 0;a < aggregates.size();++a){
+            groupBatch.addColumn(aggregates[a].result(states[a],names[keyCount + a],begin,end));
+        }
+        if(!emit(aggregation.project(groupBatch))){
+            return;
+        }
+    }
+}
@@ -0,0 +1,313 @@
+#include "../include/LocalGroupTable.h"
+
+#include <cstring>
+#include <string_view>
+
+const uint32_t LocalGroupTable::EMPTY = UINT32_MAX;
+
+namespace {
+
+    const size_t INITIAL_CAPACITY = 1024;
+
+    uint32_t fold(uint64_t hash){
+        return static_cast<uint32_t>(hash ^ (hash >> 32));
+    }
+
+    // murmur3 的 64 位收尾混合，相邻的整数 key 落到不同的槽位
+    uint32_t hashInt(int64_t key){
+        uint64_t h = static_cast<uint64_t>(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return fold(h);
+    }
+
+    uint32_t hashBytes(const char* data,size_t size){
+        return fold(std::hash<std::string_view>()(std::string_view(data,size)));
+    }
+
+    // GENERIC 方式的 key 编码：一个字节的类型，之后是 8 字节的数值或 4 字节长度加字符串
+    enum Tag : char{ TAG_NULL = 0, TAG_INT = 1, TAG_DOUBLE = 2, TAG_STRING = 3 };
+
+    void encodeInt(int64_t value,std::string& out){
+        out += static_cast<char>(TAG_INT);
+        out.append(reinterpret_cast<const char*>(&value),sizeof(value));
+    }
+
+    void encodeString(const char* data,size_t size,std::string& out){
+        const uint32_t length = static_cast<uint32_t>(size);
+        out += static_cast<char>(TAG_STRING);
+        out.append(reinterpret_cast<const char*>(&length),sizeof(length));
+        out.append(data,size);
+    }
+
+    void encode(const LocalColumn& column,size_t row,std::string& out){
+        if(column.isNull(row)){
+            out += static_cast<char>(TAG_NULL);
+            return;
+        }
+        switch(column.getType()){
+            case LocalType::INT:
+                encodeInt(column.getInts()[row],out);
+                break;
+            case LocalType::DOUBLE:
+                out += static_cast<char>(TAG_DOUBLE);
+                out.append(reinterpret_cast<const char*>(&column.getDoubles()[row]),sizeof(double));
+                break;
+            default:
+                encodeString(column.getStrings()[row].data(),column.getStrings()[row].size(),out);
+        }
+    }
+
+    LocalValue decode(const char*& data){
+        const char tag = *data++;
+        if(tag == TAG_INT){
+            int64_t value;
+            std::memcpy(&value,data,sizeof(value));
+            data += sizeof(value);
+            return LocalValue(value);
+        }
+        if(tag == TAG_DOUBLE){
+            double value;
+            std::memcpy(&value,data,sizeof(value));
+            data += sizeof(value);
+            return LocalValue(value);
+        }
+        if(tag == TAG_STRING){
+            uint32_t length;
+            std::memcpy(&length,data,sizeof(length));
+            data += sizeof(length);
+            const std::string value(data,length);
+            data += length;
+            return LocalValue(value);
+        }
+        return LocalValue();
+    }
+
+}
+
+LocalGroupTable::LocalGroupTable(const std::vector<std::shared_ptr<LocalExpression>>& keys,const std::vector<std::string>& names) :
+    keys(keys),names(names),slots(INITIAL_CAPACITY,Slot{0,EMPTY}),offsets(1,0){
+}
+
+uint32_t LocalGroupTable::add(Slot& slot,uint32_t hash){
+    const uint32_t group = static_cast<uint32_t>(groups++);
+    slot = Slot{hash,group};
+    // 装载率超过 3/4 时扩容
+    if(groups * 4 > slots.size() * 3){
+        grow();
+    }
+    return group;
+}
+
+void LocalGroupTable::grow(){
+    std::vector<Slot> old(slots.size() * 2,Slot{0,EMPTY});
+    old.swap(slots);
+    const size_t mask = slots.size() - 1;
+    for(const Slot& slot : old){
+        if(slot.group == EMPTY){
+            continue;
+        }
+        size_t index = slot.hash & mask;
+        while(slots[index].group != EMPTY){
+            index = (index + 1) & mask;
+        }
+        slots[index] = slot;
+    }
+}
+
+void LocalGroupTable::reserve(size_t expected){
+    while(expected * 4 > slots.size() * 3){
+        grow();
+    }
+    if(mode == Mode::INT){
+        ints.reserve(expected);
+    }else{
+        offsets.reserve(expected + 1);
+    }
+}
+
+uint32_t LocalGroupTable::findInt(int64_t key){
+    const uint32_t hash = hashInt(key);
+    const size_t mask = slots.size() - 1;
+    for(size_t index = hash & mask;;index = (index + 1) & mask){
+        Slot& slot = slots[index];
+        if(slot.group == EMPTY){
+            ints.push_back(key);
+            return add(slot,hash);
+        }
+        if(slot.hash == hash && ints[slot.group] == key){
+            return slot.group;
+        }
+    }
+}
+
+uint32_t LocalGroupTable::findBytes(const char* data,size_t size){
+    const uint32_t hash = hashBytes(data,size);
+    const size_t mask = slots.size() - 1;
+    for(size_t index = hash & mask;;index = (index + 1) & mask){
+        Slot& slot = slots[index];
+        if(slot.group == EMPTY){
+            bytes.append(data,size);
+            offsets.push_back(bytes.size());
+            return add(slot,hash);
+        }
+        if(slot.hash == hash && offsets[slot.group + 1] - offsets[slot.group] == size &&
+           std::memcmp(bytes.data() + offsets[slot.group],data,size) == 0){
+            return slot.group;
+        }
+    }
+}
+
+uint32_t LocalGroupTable::addNull(){
+    // 空值分组不进入哈希表，只占一个编号
+    if(mode == Mode::INT){
+        ints.push_back(0);
+    }else{
+        offsets.push_back(bytes.size());
+    }
+    nullGroup = static_cast<int64_t>(groups);
+    return static_cast<uint32_t>(groups++);
+}
+
+void LocalGroupTable::encodeGroup(size_t group,std::string& out) const {
+    if(static_cast<int64_t>(group) == nullGroup){
+        out += static_cast<char>(TAG_NULL);
+    }else if(mode == Mode::INT){
+        encodeInt(ints[group],out);
+    }else{
+        encodeString(bytes.data() + offsets[group],offsets[group + 1] - offsets[group],out);
+    }
+}
+
+void LocalGroupTable::toGeneric(){
+    std::string generic;
+    std::vector<uint64_t> genericOffsets(1,0);
+    genericOffsets.reserve(groups + 1);
+    for(size_t group = 0;group < groups;++group){
+        encodeGroup(group,generic);
+        genericOffsets.push_back(generic.size());
+    }
+    bytes.swap(generic);
+    offsets.swap(genericOffsets);
+    std::vector<int64_t>().swap(ints);
+    nullGroup = -1;
+    mode = Mode::GENERIC;
+
+    std::fill(slots.begin(),slots.end(),Slot{0,EMPTY});
+    const size_t mask = slots.size() - 1;
+    for(size_t group = 0;group < groups;++group){
+        const uint32_t hash = hashBytes(bytes.data() + offsets[group],offsets[group + 1] - offsets[group]);
+        size_t index = hash & mask;
+        while(slots[index].group != EMPTY){
+            index = (index + 1) & mask;
+        }
+        slots[index] = Slot{hash,static_cast<uint32_t>(group)};
+    }
+}
+
+void LocalGroupTable::lookup(const LocalBatch& batch,std::vector<uint32_t>& result){
+    const size_t rows = batch.getRows();
+    result.resize(rows);
+    if(rows == 0){
+        return;
+    }
+    // 直接引用批次中的列，其他表达式先整列求值
+    std::vector<LocalColumn> evaluated;
+    std::vector<const LocalColumn*> columns;
+    evaluated.reserve(keys.size());
+    for(size_t k = 0;k < keys.size();++k){
+        keys[k]->bind(batch);
+        if(keys[k]->getKind() == LocalExpression::Kind::COLUMN){
+            columns.push_back(&batch.getColumn(keys[k]->getColumn()));
+        }else{
+            evaluated.push_back(keys[k]->evaluate(batch,names[k]));
+            columns.push_back(&evaluated.back());
+        }
+    }
+    if(!initialized){
+        initialized = true;
+        if(keys.size() == 1 && columns[0]->getType() == LocalType::INT){
+            mode = Mode::INT;
+        }else if(keys.size() == 1 && columns[0]->getType() == LocalType::STRING){
+            mode = Mode::STRING;
+        }
+    }
+    if(mode != Mode::GENERIC && columns[0]->getType() != (mode == Mode::INT ? LocalType::INT : LocalType::STRING)){
+        toGeneric();
+    }
+
+    // 相邻行的 key 相同时沿用上一行的分组
+    size_t previous = rows;
+    switch(mode){
+        case Mode::INT: {
+            const LocalColumn& first = *columns.front();
+            const int64_t* values = first.getInts().data();
+            for(size_t row = 0;row < rows;++row){
+                if(first.isNull(row)){
+                    result[row] = nullGroup < 0 ? addNull() : static_cast<uint32_t>(nullGroup);
+                }else if(previous < rows && values[row] == values[previous]){
+                    result[row] = result[previous];
+                    previous = row;
+                }else{
+                    result[row] = findInt(values[row]);
+                    previous = row;
+                }
+            }
+            break;
+        }
+        case Mode::STRING: {
+            const LocalColumn& first = *columns.front();
+            const std::vector<std::string>& values = first.getStrings();
+            for(size_t row = 0;row < rows;++row){
+                if(first.isNull(row)){
+                    result[row] = nullGroup < 0 ? addNull() : static_cast<uint32_t>(nullGroup);
+                }else if(previous < rows && values[row] == values[previous]){
+                    result[row] = result[previous];
+                    previous = row;
+                }else{
+                    result[row] = findBytes(values[row].data(),values[row].size());
+                    previous = row;
+                }
+            }
+            break;
+        }
+        default:
+            for(size_t row = 0;row < rows;++row){
+                encoded.clear();
+                for(const LocalColumn* column : columns){
+                    encode(*column,row,encoded);
+                }
+                result[row] = findBytes(encoded.data(),encoded.size());
+            }
+    }
+}
+
+LocalColumn LocalGroupTable::getKeyColumn(size_t key,size_t begin,size_t end) const {
+    if(mode == Mode::GENERIC){
+        std::vector<LocalValue> values;
+        values.reserve(end - begin);
+        for(size_t group = begin;group < end;++group){
+            const char* data = bytes.data() + offsets[group];
+            for(size_t k = 0;k < key;++k){
+                decode(data);
+            }
+            values.push_back(decode(data));
+        }
+        return LocalColumn::fromValues(names[key],values);
+    }
+    LocalColumn column(names[key],mode == Mode::INT ? LocalType::INT : LocalType::STRING);
+    column.reserve(end - begin);
+    for(size_t group = begin;group < end;++group){
+        if(static_cast<int64_t>(group) == nullGroup){
+            column.appendNull();
+        }else if(mode == Mode::INT){
+            column.append(LocalValue(ints[group]));
+        }else{
+            column.append(LocalValue(bytes.substr(offsets[group],offsets[group + 1] - offsets[group])));
+        }
+    }
+    return column;
+}
@@ -0,0 +1,39 @@
+#include "../include/LocalHashJoinOperator.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "EngineException.h"
+
+#include <algorithm>
+
+LocalHashJoinOperator::LocalHashJoinOperator(const LocalStepDefinition& step) :
+    LocalJoinOperator(step,step.getParameter("residual")){
+    for(const std::string& key : SqlSyntaxUtils::splitExpressions(step.getParameter("lefts"))){
+        lefts.push_back(LocalExpression::parse(key));
+    }
+    for(const std::string& key : SqlSyntaxUtils::splitExpressions(step.getParameter("rights"))){
+        rights.push_back(LocalExpression::parse(key));
+    }
+    if(lefts.empty() || lefts.size() != rights.size()){
+        throw EngineException("SQL_EXECUTOR_INVALID_JOIN_KEYS: " + step.getParameter("lefts") + " / " + step.getParameter("rights"));
+    }
+}
+
+void LocalHashJoinOperator::prepare(){
+    std::vector<LocalColumn> evaluated;
+    table.build(keyColumns(rights,*build,evaluated));
+}
+
+bool LocalHashJoinOperator::probe(const LocalBatch& left){
+    std::vector<LocalColumn> evaluated;
+    std::vector<int64_t> leftRows,rightRows;
+    table.probe(keyColumns(lefts,left,evaluated),leftRows,rightRows);
+
+    std::vector<uint8_t> leftMatched(left.getRows(),0);
+    for(size_t begin = 0;begin < leftRows.size();begin += batchSize){
+        const size_t end = std::min(leftRows.size(),begin + batchSize);
+        if(!join(left,std::vector<int64_t>(leftRows.begin() + begin,leftRows.begin() + end),
+                 std::vector<int64_t>(rightRows.begin() + begin,rightRows.begin() + end),leftMatched)){
+            return false;
+        }
+    }
+    return finishLeft(left,leftMatched);
+}
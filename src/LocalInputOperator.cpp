@@ -0,0 +1,44 @@
+#include "../include/LocalInputOperator.h"
+#include "../include/LocalTableFile.h"
+#include "EngineException.h"
+
+#include <fstream>
+
+LocalInputOperator::LocalInputOperator(const LocalStepDefinition& step,const std::string& directory,
+                                       const std::vector<std::shared_ptr<const LocalBatch>>* table) :
+    LocalOperator(step),directory(directory),table(table){
+}
+
+void LocalInputOperator::run(){
+    if(table != nullptr){
+        for(auto& batch : *table){
+            if(!emit(batch)){
+                return;
+            }
+        }
+        return;
+    }
+
+    const std::string path = directory + "/" + step.getParameter("name") + ".csv";
+    std::ifstream file(path);
+    if(!file.is_open()){
+        throw EngineException("SQL_EXECUTOR_TABLE_NOT_FOUND: " + path);
+    }
+    const std::vector<LocalColumn> layout = LocalTableFile::readHeader(file);
+    bool any = false;
+    for(std::shared_ptr<LocalBatch> batch = LocalTableFile::read(file,layout,batchSize);batch != nullptr;
+        batch = LocalTableFile::read(file,layout,batchSize)){
+        any = true;
+        if(!emit(batch)){
+            return;
+        }
+    }
+    // 空表也要把列布局传给下游
+    if(!any){
+        std::shared_ptr<LocalBatch> empty = std::make_shared<LocalBatch>();
+        for(const LocalColumn& column : layout){
+            empty->addColumn(column);
+        }
+        emit(empty);
+    }
+}
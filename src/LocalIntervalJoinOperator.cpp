@@ -0,0 +1,108 @@
+#include "../include/LocalIntervalJoinOperator.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+    double parseBound(const LocalStepDefinition& step,const std::string& name){
+        const std::string text = XStringUtils::trim(step.getParameter(name));
+        char* end = nullptr;
+        const double value = std::strtod(text.c_str(),&end);
+        if(text.empty() || *end != '\0'){
+            throw EngineException("SQL_EXECUTOR_INVALID_INTERVAL: " + name + "=" + text);
+        }
+        return value;
+    }
+
+}
+
+LocalIntervalJoinOperator::LocalIntervalJoinOperator(const LocalStepDefinition& step) :
+    LocalJoinOperator(step,step.getParameter("residual")),
+    lower(parseBound(step,"lower")),upper(parseBound(step,"upper")){
+    for(const std::string& key : SqlSyntaxUtils::splitExpressions(step.getParameter("lefts"))){
+        lefts.push_back(LocalExpression::parse(key));
+    }
+    for(const std::string& key : SqlSyntaxUtils::splitExpressions(step.getParameter("rights"))){
+        rights.push_back(LocalExpression::parse(key));
+    }
+    if(lefts.size() != rights.size()){
+        throw EngineException("SQL_EXECUTOR_INVALID_JOIN_KEYS: " + step.getParameter("lefts") + " / " + step.getParameter("rights"));
+    }
+    leftTime = LocalExpression::parse(step.getParameter("left_time"));
+    rightTime = LocalExpression::parse(step.getParameter("right_time"));
+}
+
+void LocalIntervalJoinOperator::prepare(){
+    timeValues(rightTime,*build,buildTimes,buildValid);
+    if(!rights.empty()){
+        std::vector<LocalColumn> evaluated;
+        table.build(keyColumns(rights,*build,evaluated));
+        return;
+    }
+    for(size_t row = 0;row < buildValid.size();++row){
+        if(buildValid[row]){
+            sorted.push_back(row);
+        }
+    }
+    std::stable_sort(sorted.begin(),sorted.end(),[this](int64_t a,int64_t b){
+        return buildTimes[a] < buildTimes[b];
+    });
+}
+
+bool LocalIntervalJoinOperator::probe(const LocalBatch& left){
+    std::vector<double> leftTimes;
+    std::vector<uint8_t> leftValid;
+    timeValues(leftTime,left,leftTimes,leftValid);
+    std::vector<uint8_t> leftMatched(left.getRows(),0);
+    std::vector<int64_t> leftRows,rightRows;
+    // 凑满 batchSize 个行对交给 join
+    const auto add = [&](int64_t leftRow,int64_t rightRow){
+        leftRows.push_back(leftRow);
+        rightRows.push_back(rightRow);
+        if(leftRows.size() < batchSize){
+            return true;
+        }
+        const bool more = join(left,leftRows,rightRows,leftMatched);
+        leftRows.clear();
+        rightRows.clear();
+        return more;
+    };
+
+    if(!lefts.empty()){
+        std::vector<LocalColumn> evaluated;
+        std::vector<int64_t> candidateLefts,candidateRights;
+        table.probe(keyColumns(lefts,left,evaluated),candidateLefts,candidateRights);
+        for(size_t i = 0;i < candidateLefts.size();++i){
+            const int64_t leftRow = candidateLefts[i];
+            const int64_t rightRow = candidateRights[i];
+            if(!leftValid[leftRow] || !buildValid[rightRow]){
+                continue;
+            }
+            const double delta = buildTimes[rightRow] - leftTimes[leftRow];
+            if(delta >= lower && delta <= upper && !add(leftRow,rightRow)){
+                return false;
+            }
+        }
+    }else{
+        const auto before = [this](int64_t row,double time){
+            return buildTimes[row] < time;
+        };
+        for(size_t row = 0;row < left.getRows();++row){
+            if(!leftValid[row]){
+                continue;
+            }
+            const double last = leftTimes[row] + upper;
+            for(auto iter = std::lower_bound(sorted.begin(),sorted.end(),leftTimes[row] + lower,before);
+                iter != sorted.end() && buildTimes[*iter] <= last;++iter){
+                if(!add(row,*iter)){
+                    return false;
+                }
+            }
+        }
+    }
+    return join(left,leftRows,rightRows,leftMatched) && finishLeft(left,leftMatched);
+}
@@ -0,0 +1,186 @@
+#include "../include/LocalJoinOperator.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "XStringUtils.h"
+
+LocalJoinOperator::LocalJoinOperator(const LocalStepDefinition& step,const std::string& condition) :
+    LocalOperator(step),type(parseType(step.getParameter("join_type"))){
+    if(XStringUtils::isNotBlank(condition)){
+        this->condition = LocalExpression::parse(condition);
+    }
+    const std::string leftAlias = XStringUtils::trim(step.getParameter("left_alias"));
+    const std::string rightAlias = XStringUtils::trim(step.getParameter("right_alias"));
+    leftPrefix = leftAlias.empty() || leftAlias.find(',') != std::string::npos ? "" : leftAlias + ".";
+    rightPrefix = rightAlias.empty() ? "" : rightAlias + ".";
+
+    const std::string selects = XStringUtils::trim(step.getParameter("selects"));
+    selectAll = selects.empty() || selects == "*";
+    if(!selectAll){
+        for(const std::string& item : SqlSyntaxUtils::splitExpressions(selects)){
+            const std::string alias = SqlSyntaxUtils::getExpressionAlias(item);
+            const std::string expr = XStringUtils::trim(SqlSyntaxUtils::removeExpressionAlias(item));
+            names.push_back(alias.empty() ? expr : alias);
+            outputs.push_back(LocalExpression::parse(expr));
+        }
+    }
+}
+
+SqlJoinType LocalJoinOperator::parseType(const std::string& type){
+    const std::string mytype = XStringUtils::toLowerCase(XStringUtils::trim(type));
+    if(mytype == "left"){
+        return SqlJoinType::LEFT;
+    }
+    if(mytype == "right"){
+        return SqlJoinType::RIGHT;
+    }
+    if(mytype == "full" || mytype == "outer"){
+        return SqlJoinType::FULL;
+    }
+    return SqlJoinType::INNER;
+}
+
+std::vector<const LocalColumn*> LocalJoinOperator::keyColumns(const std::vector<std::shared_ptr<LocalExpression>>& keys,const LocalBatch& batch,
+                                                              std::vector<LocalColumn>& evaluated){
+    std::vector<const LocalColumn*> columns;
+    evaluated.reserve(keys.size());
+    for(auto& key : keys){
+        key->bind(batch);
+        if(key->getKind() == LocalExpression::Kind::COLUMN){
+            columns.push_back(&batch.getColumn(key->getColumn()));
+        }else{
+            evaluated.push_back(key->evaluate(batch,key->toString()));
+            columns.push_back(&evaluated.back());
+        }
+    }
+    return columns;
+}
+
+void LocalJoinOperator::timeValues(const std::shared_ptr<LocalExpression>& time,const LocalBatch& batch,
+                                   std::vector<double>& values,std::vector<uint8_t>& valid){
+    std::vector<LocalColumn> evaluated;
+    const LocalColumn& column = *keyColumns({time},batch,evaluated).at(0);
+    const size_t rows = batch.getRows();
+    values.assign(rows,0);
+    valid.assign(rows,0);
+    for(size_t row = 0;row < rows;++row){
+        if(column.isNull(row)){
+            continue;
+        }
+        if(column.getType() == LocalType::INT){
+            values[row] = static_cast<double>(column.getInts()[row]);
+        }else if(column.getType() == LocalType::DOUBLE){
+            values[row] = column.getDoubles()[row];
+        }else{
+            continue;
+        }
+        valid[row] = 1;
+    }
+}
+
+std::shared_ptr<LocalBatch> LocalJoinOperator::combine(const LocalBatch& left,const std::vector<int64_t>& leftRows,const std::vector<int64_t>& rightRows) const {
+    std::shared_ptr<LocalBatch> result = std::make_shared<LocalBatch>(leftRows.size());
+    for(const LocalColumn& column : left.getColumns()){
+        LocalColumn selected = column.select(leftRows);
+        selected.setName(leftPrefix + column.getName());
+        result->addColumn(std::move(selected));
+    }
+    for(const LocalColumn& column : build->getColumns()){
+        result->addColumn(column.select(rightRows));
+    }
+    return result;
+}
+
+bool LocalJoinOperator::output(const std::shared_ptr<LocalBatch>& batch){
+    if(selectAll){
+        return emit(batch);
+    }
+    std::shared_ptr<LocalBatch> result = std::make_shared<LocalBatch>(batch->getRows());
+    for(size_t i = 0;i < outputs.size();++i){
+        result->addColumn(outputs[i]->evaluate(*batch,names[i]));
+    }
+    return emit(result);
+}
+
+bool LocalJoinOperator::join(const LocalBatch& left,const std::vector<int64_t>& leftRows,const std::vector<int64_t>& rightRows,
+                             std::vector<uint8_t>& leftMatched){
+    if(leftRows.empty()){
+        return true;
+    }
+    std::shared_ptr<LocalBatch> pairs = combine(left,leftRows,rightRows);
+    if(condition != nullptr){
+        condition->bind(*pairs);
+        std::vector<int64_t> kept;
+        for(size_t i = 0;i < pairs->getRows();++i){
+            if(condition->evaluate(*pairs,i).isTrue()){
+                kept.push_back(i);
+                leftMatched[leftRows[i]] = 1;
+                buildMatched[rightRows[i]] = 1;
+            }
+        }
+        if(kept.empty()){
+            return true;
+        }
+        if(kept.size() < pairs->getRows()){
+            pairs = pairs->select(kept);
+        }
+    }else{
+        for(size_t i = 0;i < leftRows.size();++i){
+            leftMatched[leftRows[i]] = 1;
+            buildMatched[rightRows[i]] = 1;
+        }
+    }
+    return output(pairs);
+}
+
+bool LocalJoinOperator::finishLeft(const LocalBatch& left,const std::vector<uint8_t>& leftMatched){
+    if(!keepsLeft()){
+        return true;
+    }
+    std::vector<int64_t> leftRows,rightRows;
+    for(size_t row = 0;row < leftMatched.size();++row){
+        if(!leftMatched[row]){
+            leftRows.push_back(row);
+            rightRows.push_back(-1);
+        }
+    }
+    return leftRows.empty() || output(combine(left,leftRows,rightRows));
+}
+
+void LocalJoinOperator::run(){
+    build = LocalBatch::concat(drain(1));
+    for(size_t c = 0;c < build->getColumnCount();++c){
+        build->getColumn(c).setName(rightPrefix + build->getColumn(c).getName());
+    }
+    buildMatched.assign(build->getRows(),0);
+    prepare();
+
+    bool more = true;
+    for(std::shared_ptr<const LocalBatch> batch = next();batch != nullptr && more;batch = next()){
+        if(leftLayout == nullptr){
+            leftLayout = batch->slice(0,0);
+        }
+        more = probe(*batch);
+    }
+    if(!more || !keepsRight()){
+        return;
+    }
+
+    const LocalBatch empty;
+    const LocalBatch& left = leftLayout == nullptr ? empty : *leftLayout;
+    std::vector<int64_t> leftRows,rightRows;
+    for(size_t row = 0;row < buildMatched.size();++row){
+        if(!buildMatched[row]){
+            leftRows.push_back(-1);
+            rightRows.push_back(row);
+            if(rightRows.size() == batchSize){
+                if(!output(combine(left,leftRows,rightRows))){
+                    return;
+                }
+                leftRows.clear();
+                rightRows.clear();
+            }
+        }
+    }
+    if(!rightRows.empty()){
+        output(combine(left,leftRows,rightRows));
+    }
+}
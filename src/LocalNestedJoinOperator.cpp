@@ -0,0 +1,192 @@
+#include "../include/LocalNestedJoinOperator.h"
+#include "../include/LocalFilterKernel.h"
+#include "XStringUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+const size_t LocalNestedJoinOperator::BLOCK_PAIRS = 16384;
+
+namespace {
+
+    // 一个块至少包含的左侧行数，构建侧较大时每块取 BLOCK_PAIRS / MIN_LEFT_ROWS 行
+    const size_t MIN_LEFT_ROWS = 64;
+
+    // 每个线程一轮处理的块数，一轮的结果输出之后再开始下一轮
+    const size_t TASKS_PER_THREAD = 16;
+
+    void collectColumns(const std::shared_ptr<LocalExpression>& expr,std::vector<std::string>& names){
+        if(expr->getKind() == LocalExpression::Kind::COLUMN){
+            if(std::find(names.begin(),names.end(),expr->getText()) == names.end()){
+                names.push_back(expr->getText());
+            }
+            return;
+        }
+        for(auto& child : expr->getChildren()){
+            collectColumns(child,names);
+        }
+    }
+
+    // 一对块的匹配结果
+    struct Matches{
+        std::vector<int64_t> leftRows;
+        std::vector<int64_t> rightRows;
+    };
+
+}
+
+LocalNestedJoinOperator::LocalNestedJoinOperator(const LocalStepDefinition& step) :
+    LocalJoinOperator(step,""),threads(std::max(1u,std::thread::hardware_concurrency())){
+    // 条件由本算子按块求值，基类只负责输出
+    const std::string text = step.getParameter("condition");
+    if(XStringUtils::isNotBlank(text)){
+        condition = LocalExpression::parse(text);
+    }
+}
+
+std::vector<LocalNestedJoinOperator::BlockColumn> LocalNestedJoinOperator::resolve(const LocalBatch& left) const {
+    // 与连接结果相同的列布局，按它解析列名，找不到或有歧义时 bind 抛出异常
+    LocalBatch layout;
+    for(const LocalColumn& column : left.getColumns()){
+        LocalColumn renamed(getLeftPrefix() + column.getName(),column.getType());
+        layout.addColumn(std::move(renamed));
+    }
+    for(const LocalColumn& column : build->getColumns()){
+        layout.addColumn(LocalColumn(column.getName(),column.getType()));
+    }
+    condition->bind(layout);
+
+    std::vector<std::string> names;
+    collectColumns(condition,names);
+    std::vector<BlockColumn> columns;
+    for(const std::string& name : names){
+        const size_t index = static_cast<size_t>(layout.indexOf(name));
+        const bool fromLeft = index < left.getColumnCount();
+        const size_t source = fromLeft ? index : index - left.getColumnCount();
+        const bool seen = std::any_of(columns.begin(),columns.end(),[&](const BlockColumn& column){
+            return column.left == fromLeft && column.index == source;
+        });
+        if(!seen){
+            columns.push_back(BlockColumn{layout.getColumn(index).getName(),fromLeft,source});
+        }
+    }
+    return columns;
+}
+
+std::shared_ptr<LocalBatch> LocalNestedJoinOperator::block(const LocalBatch& left,const std::vector<BlockColumn>& columns,size_t leftBegin,size_t leftEnd,
+                                                           size_t rightBegin,size_t rightEnd,std::vector<int64_t>& leftRows,std::vector<int64_t>& rightRows) const {
+    const size_t width = rightEnd - rightBegin;
+    leftRows.resize((leftEnd - leftBegin) * width);
+    rightRows.resize(leftRows.size());
+    for(size_t row = leftBegin,i = 0;row < leftEnd;++row){
+        for(size_t other = rightBegin;other < rightEnd;++other,++i){
+            leftRows[i] = row;
+            rightRows[i] = other;
+        }
+    }
+    std::shared_ptr<LocalBatch> result = std::make_shared<LocalBatch>(leftRows.size());
+    for(const BlockColumn& column : columns){
+        LocalColumn selected = column.left ? left.getColumn(column.index).select(leftRows) : build->getColumn(column.index).select(rightRows);
+        selected.setName(column.name);
+        result->addColumn(std::move(selected));
+    }
+    return result;
+}
+
+bool LocalNestedJoinOperator::probe(const LocalBatch& left){
+    const size_t leftCount = left.getRows();
+    const size_t rightCount = build->getRows();
+    std::vector<uint8_t> leftMatched(leftCount,0);
+    if(leftCount == 0 || rightCount == 0){
+        return finishLeft(left,leftMatched);
+    }
+
+    // 构建侧较小时整个构建侧为一块，左侧多取几行凑满 BLOCK_PAIRS 个行对
+    const size_t rightBlock = std::min(rightCount,BLOCK_PAIRS / MIN_LEFT_ROWS);
+    const size_t leftBlock = std::min(leftCount,std::max<size_t>(1,BLOCK_PAIRS / rightBlock));
+    const size_t rightBlocks = (rightCount + rightBlock - 1) / rightBlock;
+    const size_t blocks = (leftCount + leftBlock - 1) / leftBlock * rightBlocks;
+
+    std::vector<BlockColumn> columns;
+    std::shared_ptr<LocalFilterKernel> kernel;
+    if(condition != nullptr){
+        columns = resolve(left);
+        std::vector<int64_t> leftRows,rightRows;
+        kernel = std::make_shared<LocalFilterKernel>(condition,*block(left,columns,0,0,0,0,leftRows,rightRows));
+    }
+
+    // 第 task 对块：左侧第 task / rightBlocks 块与构建侧第 task % rightBlocks 块，编译之后的 kernel 可以并发使用
+    const auto match = [&](size_t task,Matches& matches){
+        const size_t leftBegin = task / rightBlocks * leftBlock;
+        const size_t rightBegin = task % rightBlocks * rightBlock;
+        std::vector<int64_t> leftRows,rightRows;
+        std::shared_ptr<LocalBatch> pairs = block(left,columns,leftBegin,std::min(leftCount,leftBegin + leftBlock),
+                                                  rightBegin,std::min(rightCount,rightBegin + rightBlock),leftRows,rightRows);
+        if(kernel == nullptr){
+            matches.leftRows.swap(leftRows);
+            matches.rightRows.swap(rightRows);
+            return;
+        }
+        std::vector<int64_t> selected;
+        kernel->select(*pairs,selected);
+        matches.leftRows.reserve(selected.size());
+        matches.rightRows.reserve(selected.size());
+        for(int64_t i : selected){
+            matches.leftRows.push_back(leftRows[i]);
+            matches.rightRows.push_back(rightRows[i]);
+        }
+    };
+
+    const size_t workers = std::min(threads,blocks);
+    const size_t wave = workers * TASKS_PER_THREAD;
+    std::vector<int64_t> leftRows,rightRows;
+    for(size_t first = 0;first < blocks;first += wave){
+        std::vector<Matches> results(std::min(wave,blocks - first));
+        if(workers == 1){
+            for(size_t i = 0;i < results.size();++i){
+                match(first + i,results[i]);
+            }
+        }else{
+            std::atomic<size_t> cursor(0);
+            std::vector<std::exception_ptr> errors(workers);
+            std::vector<std::thread> pool;
+            for(size_t w = 0;w < workers;++w){
+                pool.emplace_back([&,w]{
+                    try{
+                        for(size_t i = cursor++;i < results.size();i = cursor++){
+                            match(first + i,results[i]);
+                        }
+                    }catch(...){
+                        errors[w] = std::current_exception();
+                    }
+                });
+            }
+            for(std::thread& worker : pool){
+                worker.join();
+            }
+            for(const std::exception_ptr& error : errors){
+                if(error){
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+        // 按块的顺序凑满 batchSize 个行对输出
+        for(Matches& matches : results){
+            for(size_t i = 0;i < matches.leftRows.size();++i){
+                leftRows.push_back(matches.leftRows[i]);
+                rightRows.push_back(matches.rightRows[i]);
+                if(leftRows.size() == batchSize){
+                    if(!join(left,leftRows,rightRows,leftMatched)){
+                        return false;
+                    }
+                    leftRows.clear();
+                    rightRows.clear();
+                }
+            }
+        }
+    }
+    return join(left,leftRows,rightRows,leftMatched) && finishLeft(left,leftMatched);
+}
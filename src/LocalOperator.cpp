@@ -0,0 +1,74 @@
+#include "../include/LocalOperator.h"
+#include "XStringUtils.h"
+
+LocalOperator::LocalOperator(const LocalStepDefinition& step) : step(step){
+    const std::string count = step.getParameter("limit_count");
+    if(XStringUtils::isNotBlank(count)){
+        limit = std::stoll(count);
+    }
+}
+
+void LocalOperator::addInput(const std::shared_ptr<LocalSpool>& spool){
+    inputs.push_back(spool);
+    consumers.push_back(spool->subscribe());
+}
+
+std::shared_ptr<const LocalBatch> LocalOperator::next(size_t input){
+    if(isDone()){
+        return nullptr;
+    }
+    return inputs.at(input)->pop(consumers.at(input));
+}
+
+std::vector<std::shared_ptr<const LocalBatch>> LocalOperator::drain(size_t input){
+    std::vector<std::shared_ptr<const LocalBatch>> batches;
+    for(std::shared_ptr<const LocalBatch> batch = next(input);batch != nullptr;batch = next(input)){
+        batches.push_back(batch);
+    }
+    return batches;
+}
+
+bool LocalOperator::emit(const std::shared_ptr<const LocalBatch>& batch){
+    if(output == nullptr){
+        return true;
+    }
+    if(isDone()){
+        return false;
+    }
+    if(batch->getRows() == 0 && pushed){
+        return true;
+    }
+    std::shared_ptr<const LocalBatch> result = batch;
+    if(limit >= 0 && emitted + static_cast<int64_t>(batch->getRows()) > limit){
+        result = batch->slice(0,limit - emitted);
+    }
+    emitted += result->getRows();
+    pushed = true;
+    if(!output->push(result)){
+        return false;
+    }
+    return limit < 0 || emitted < limit;
+}
+
+void LocalOperator::cancelInputs(){
+    for(size_t i = 0;i < inputs.size();++i){
+        inputs[i]->cancel(consumers[i]);
+    }
+}
+
+void LocalOperator::execute(){
+    try{
+        run();
+    }catch(...){
+        if(output != nullptr){
+            output->close();
+        }
+        cancelInputs();
+        throw;
+    }
+    if(output != nullptr){
+        output->close();
+    }
+    // 没有读完的输入不再需要，上游据此停止
+    cancelInputs();
+}
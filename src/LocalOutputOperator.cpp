@@ -0,0 +1,25 @@
+#include "../include/LocalOutputOperator.h"
+#include "../include/LocalTableFile.h"
+#include "EngineException.h"
+
+#include <fstream>
+
+LocalOutputOperator::LocalOutputOperator(const LocalStepDefinition& step,const std::string& directory) :
+    LocalOperator(step),directory(directory){
+}
+
+void LocalOutputOperator::run(){
+    const std::string path = directory + "/" + step.getParameter("name") + ".csv";
+    std::ofstream file(path,std::ios::trunc);
+    if(!file.is_open()){
+        throw EngineException("SQL_EXECUTOR_CANNOT_WRITE: " + path);
+    }
+    bool header = false;
+    for(std::shared_ptr<const LocalBatch> batch = next();batch != nullptr;batch = next()){
+        if(!header){
+            LocalTableFile::writeHeader(file,*batch);
+            header = true;
+        }
+        LocalTableFile::write(file,*batch);
+    }
+}
@@ -0,0 +1,74 @@
+#include "../include/LocalPatternWindowOperator.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+LocalPatternWindowOperator::LocalPatternWindowOperator(const LocalStepDefinition& step) : LocalWindowOperator(step){
+    if(XStringUtils::isNotBlank(step.getParameter("enter"))){
+        enter.condition = compile(step.getParameter("enter"));
+        // on true 的分区每行都可以打开窗口，不需要求值
+        if(enter.condition->getKind() == LocalExpression::Kind::LITERAL && enter.condition->getValue().isTrue()){
+            enter.condition = nullptr;
+        }
+    }
+    if(XStringUtils::isBlank(step.getParameter("exit"))){
+        throw EngineException("SQL_EXECUTOR_MISSING_PATTERN_EXIT: " + step.getParameter("enter"));
+    }
+    exit.condition = compile(step.getParameter("exit"));
+    enter.rowwise = enter.condition != nullptr && referencesCalls(*enter.condition);
+    exit.rowwise = referencesCalls(*exit.condition);
+
+    state.reset(new LocalWindowState(getCalls(),getArgumentCount()));
+}
+
+void LocalPatternWindowOperator::fill(uint32_t key,size_t row){
+    for(size_t c = 0;c < getCalls().size();++c){
+        setCall(c,row,state->get(c,key));
+    }
+}
+
+bool LocalPatternWindowOperator::accepts(Transition& transition,uint32_t key,size_t row){
+    if(transition.condition == nullptr){
+        return true;
+    }
+    if(!transition.rowwise){
+        return (transition.trues[row >> 6] >> (row & 63)) & 1;
+    }
+    fill(key,row);
+    return test(*transition.condition,row);
+}
+
+void LocalPatternWindowOperator::start(){
+    for(Transition* transition : {&enter,&exit}){
+        if(transition->condition == nullptr || transition->rowwise){
+            continue;
+        }
+        if(transition->kernel == nullptr || !transition->kernel->accepts(work)){
+            transition->kernel = std::make_shared<LocalFilterKernel>(transition->condition,work);
+        }
+        transition->kernel->evaluate(work,transition->trues);
+    }
+}
+
+bool LocalPatternWindowOperator::consume(size_t row){
+    const uint32_t key = partitionIds[row];
+    if(key >= states.size()){
+        states.resize(getPartitionCount(),CLOSED);
+        state->grow(getPartitionCount());
+    }
+    if(states[key] == CLOSED){
+        if(!accepts(enter,key,row)){
+            return true;
+        }
+        states[key] = OPEN;
+    }
+    state->append(key,getArguments(),row);
+    if(accepts(exit,key,row)){
+        if(!exit.rowwise){
+            fill(key,row);
+        }
+        states[key] = CLOSED;
+        state->reset(key);
+        mark(row);
+    }
+    return true;
+}
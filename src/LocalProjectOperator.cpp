@@ -0,0 +1,30 @@
+#include "../include/LocalProjectOperator.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "XStringUtils.h"
+
+LocalProjectOperator::LocalProjectOperator(const LocalStepDefinition& step) : LocalOperator(step){
+    for(const std::string& item : SqlSyntaxUtils::splitExpressions(step.getParameter("selects"))){
+        const std::string alias = SqlSyntaxUtils::getExpressionAlias(item);
+        const std::string expr = XStringUtils::trim(SqlSyntaxUtils::removeExpressionAlias(item));
+        names.push_back(alias.empty() ? expr : alias);
+        outputs.push_back(expr == "*" ? nullptr : LocalExpression::parse(expr));
+    }
+}
+
+void LocalProjectOperator::run(){
+    for(std::shared_ptr<const LocalBatch> batch = next();batch != nullptr;batch = next()){
+        std::shared_ptr<LocalBatch> result = std::make_shared<LocalBatch>(batch->getRows());
+        for(size_t i = 0;i < outputs.size();++i){
+            if(outputs[i] == nullptr){
+                for(const LocalColumn& column : batch->getColumns()){
+                    result->addColumn(column);
+                }
+            }else{
+                result->addColumn(outputs[i]->evaluate(*batch,names[i]));
+            }
+        }
+        if(!emit(result)){
+            return;
+        }
+    }
+}
@@ -0,0 +1,249 @@
+#include "../include/LocalRadixHashTable.h"
+
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include <unistd.h>
+
+namespace {
+
+    // 最多 2^16 个分区
+    const int MAX_BITS = 16;
+
+    uint64_t hashInt(int64_t key){
+        uint64_t h = static_cast<uint64_t>(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // 整数值的浮点数按整数处理，与相等的整数 key 匹配
+    bool integralOf(double value,int64_t& out){
+        if(value != std::floor(value) || !(value > -9.2e18 && value < 9.2e18)){
+            return false;
+        }
+        out = static_cast<int64_t>(value);
+        return true;
+    }
+
+    void append(char tag,const void* data,size_t size,std::string& out){
+        out += tag;
+        out.append(static_cast<const char*>(data),size);
+    }
+
+    size_t powerOfTwo(size_t value){
+        size_t result = 2;
+        while(result < value){
+            result <<= 1;
+        }
+        return result;
+    }
+
+}
+
+LocalRadixHashTable::LocalRadixHashTable(size_t partitionBytes) : partitionBytes(partitionBytes){
+}
+
+size_t LocalRadixHashTable::defaultPartitionBytes(){
+    static const size_t bytes = []{
+        long l2 = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+        return static_cast<size_t>(l2 > 0 ? l2 : 256 * 1024) / 2;
+    }();
+    return bytes;
+}
+
+void LocalRadixHashTable::computeKeys(const std::vector<const LocalColumn*>& columns,size_t count,Keys& keys) const {
+    keys.hashes.resize(count);
+    keys.valid.assign(count,0);
+    if(integral){
+        const LocalColumn& column = *columns[0];
+        keys.ints.resize(count);
+        for(size_t row = 0;row < count;++row){
+            if(column.isNull(row)){
+                continue;
+            }
+            if(column.getType() == LocalType::INT){
+                keys.ints[row] = column.getInts()[row];
+                keys.valid[row] = 1;
+            }else if(column.getType() == LocalType::DOUBLE){
+                keys.valid[row] = integralOf(column.getDoubles()[row],keys.ints[row]) ? 1 : 0;
+            }
+            keys.hashes[row] = hashInt(keys.ints[row]);
+        }
+        return;
+    }
+
+    keys.bytes.clear();
+    keys.offsets.resize(count + 1);
+    keys.offsets[0] = 0;
+    for(size_t row = 0;row < count;++row){
+        const size_t begin = keys.bytes.size();
+        const bool valid = encodeKey(columns,row,keys.bytes);
+        keys.offsets[row + 1] = keys.bytes.size();
+        keys.valid[row] = valid ? 1 : 0;
+        keys.hashes[row] = valid ? std::hash<std::string_view>()(std::string_view(keys.bytes.data() + begin,keys.bytes.size() - begin)) : 0;
+    }
+}
+
+bool LocalRadixHashTable::encodeKey(const std::vector<const LocalColumn*>& columns,size_t row,std::string& bytes){
+    const size_t begin = bytes.size();
+    for(const LocalColumn* column : columns){
+        int64_t value;
+        if(column->isNull(row)){
+            bytes.resize(begin);
+            return false;
+        }
+        if(column->getType() == LocalType::INT){
+            append('n',&column->getInts()[row],sizeof(int64_t),bytes);
+        }else if(column->getType() == LocalType::DOUBLE){
+            if(integralOf(column->getDoubles()[row],value)){
+                append('n',&value,sizeof(value),bytes);
+            }else{
+                append('d',&column->getDoubles()[row],sizeof(double),bytes);
+            }
+        }else{
+            const std::string& text = column->getStrings()[row];
+            const uint32_t length = static_cast<uint32_t>(text.size());
+            append('s',&length,sizeof(length),bytes);
+            bytes.append(text);
+        }
+    }
+    return true;
+}
+
+void LocalRadixHashTable::build(const std::vector<const LocalColumn*>& columns){
+    const size_t count = columns.empty() ? 0 : columns[0]->size();
+    integral = columns.size() == 1 && columns[0]->getType() == LocalType::INT;
+    Keys keys;
+    computeKeys(columns,count,keys);
+    size_t entries = 0;
+    for(uint8_t valid : keys.valid){
+        entries += valid;
+    }
+
+    // 每个条目：行号、哈希、按一半装载率计算的两个桶边界，以及 key
+    const size_t keyBytes = integral ? sizeof(int64_t) : sizeof(uint64_t) + (entries == 0 ? 0 : keys.bytes.size() / entries);
+    const size_t total = entries * (3 * sizeof(uint32_t) + keyBytes);
+    bits = 0;
+    while(bits < MAX_BITS && (total >> bits) > partitionBytes){
+        bits++;
+    }
+    const size_t partitions = getPartitionCount();
+
+    // 每个分区的桶数不少于条目数，外加一个结束边界
+    std::vector<uint64_t> sizes(partitions,0);
+    for(size_t row = 0;row < count;++row){
+        if(keys.valid[row]){
+            sizes[partitionOf(keys.hashes[row])]++;
+        }
+    }
+    bases.assign(partitions + 1,0);
+    for(size_t p = 0;p < partitions;++p){
+        bases[p + 1] = bases[p] + powerOfTwo(sizes[p]) + 1;
+    }
+    const auto bucketOf = [&](uint64_t hash){
+        const size_t p = partitionOf(hash);
+        return bases[p] + (static_cast<uint32_t>(hash) & (bases[p + 1] - bases[p] - 2));
+    };
+
+    // 按全局的桶号计数排序
+    buckets.assign(bases[partitions],0);
+    for(size_t row = 0;row < count;++row){
+        if(keys.valid[row]){
+            buckets[bucketOf(keys.hashes[row]) + 1]++;
+        }
+    }
+    for(size_t i = 0;i + 1 < buckets.size();++i){
+        buckets[i + 1] += buckets[i];
+    }
+    std::vector<uint32_t> cursors(buckets);
+    rows.resize(entries);
+    hashes.resize(entries);
+    ints.resize(integral ? entries : 0);
+    for(size_t row = 0;row < count;++row){
+        if(!keys.valid[row]){
+            continue;
+        }
+        const uint32_t entry = cursors[bucketOf(keys.hashes[row])]++;
+        rows[entry] = static_cast<uint32_t>(row);
+        hashes[entry] = static_cast<uint32_t>(keys.hashes[row]);
+        if(integral){
+            ints[entry] = keys.ints[row];
+        }
+    }
+    bytes.clear();
+    offsets.assign(1,0);
+    if(!integral){
+        bytes.reserve(keys.bytes.size());
+        offsets.reserve(entries + 1);
+        for(uint32_t row : rows){
+            bytes.append(keys.bytes,keys.offsets[row],keys.offsets[row + 1] - keys.offsets[row]);
+            offsets.push_back(bytes.size());
+        }
+    }
+}
+
+void LocalRadixHashTable::probe(const std::vector<const LocalColumn*>& columns,std::vector<int64_t>& leftRows,std::vector<int64_t>& rightRows){
+    const size_t count = columns.empty() ? 0 : columns[0]->size();
+    if(rows.empty() || count == 0){
+        return;
+    }
+    computeKeys(columns,count,probeKeys);
+
+    // 按分区重排探测的行，之后按顺序读取
+    const size_t partitions = getPartitionCount();
+    counts.assign(partitions + 1,0);
+    for(size_t row = 0;row < count;++row){
+        if(probeKeys.valid[row]){
+            counts[partitionOf(probeKeys.hashes[row]) + 1]++;
+        }
+    }
+    for(size_t p = 0;p < partitions;++p){
+        counts[p + 1] += counts[p];
+    }
+    order.resize(counts[partitions]);
+    orderHashes.resize(counts[partitions]);
+    orderInts.resize(integral ? counts[partitions] : 0);
+    for(size_t row = 0;row < count;++row){
+        if(probeKeys.valid[row]){
+            const uint32_t i = counts[partitionOf(probeKeys.hashes[row])]++;
+            order[i] = static_cast<uint32_t>(row);
+            orderHashes[i] = static_cast<uint32_t>(probeKeys.hashes[row]);
+            if(integral){
+                orderInts[i] = probeKeys.ints[row];
+            }
+        }
+    }
+
+    // 重排之后 counts[p] 是第 p 个分区的结束位置
+    size_t begin = 0;
+    for(size_t p = 0;p < partitions;++p){
+        const uint32_t* bucket = buckets.data() + bases[p];
+        const uint32_t mask = static_cast<uint32_t>(bases[p + 1] - bases[p] - 2);
+        for(size_t i = begin;i < counts[p];++i){
+            const uint32_t hash = orderHashes[i];
+            const uint32_t b = hash & mask;
+            for(uint32_t entry = bucket[b];entry < bucket[b + 1];++entry){
+                if(hashes[entry] != hash){
+                    continue;
+                }
+                const uint32_t row = order[i];
+                const bool equal = integral ? ints[entry] == orderInts[i] :
+                    offsets[entry + 1] - offsets[entry] == probeKeys.offsets[row + 1] - probeKeys.offsets[row] &&
+                    std::memcmp(bytes.data() + offsets[entry],probeKeys.bytes.data() + probeKeys.offsets[row],
+                                probeKeys.offsets[row + 1] - probeKeys.offsets[row]) == 0;
+                if(equal){
+                    leftRows.push_back(row);
+                    rightRows.push_back(rows[entry]);
+                }
+            }
+        }
+        begin = counts[p];
+    }
+}
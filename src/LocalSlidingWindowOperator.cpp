@@ -0,0 +1,201 @@
+#include "../include/LocalSlidingWindowOperator.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+LocalSlidingWindowOperator::LocalSlidingWindowOperator(const LocalStepDefinition& step) : LocalWindowOperator(step){
+    const std::string text = step.getParameter("inclusion");
+    if(XStringUtils::isNotBlank(text)){
+        std::shared_ptr<LocalExpression> parsed = LocalExpression::parse(text);
+        const LocalValue& value = parsed->getValue();
+        if(parsed->getKind() == LocalExpression::Kind::LITERAL && !value.isNull() && value.getType() == LocalType::INT){
+            if(value.asInt() < 1){
+                throw EngineException("SQL_EXECUTOR_INVALID_INCLUSION: " + text);
+            }
+            limit = static_cast<size_t>(value.asInt());
+        }else{
+            inclusion = compile(text);
+        }
+    }
+
+    const std::vector<Call>& calls = getCalls();
+    strategies.assign(calls.size(),Strategy::NONE);
+    summed.assign(getArgumentCount(),0);
+    extremeIndexes.assign(calls.size(),-1);
+    for(size_t c = 0;c < calls.size();++c){
+        switch(calls[c].function){
+            case Function::COUNT:
+            case Function::SUM:
+            case Function::AVG:
+                strategies[c] = Strategy::SUBTRACT;
+                summed[calls[c].argument] = 1;
+                break;
+            case Function::MIN:
+            case Function::MAX:
+                strategies[c] = Strategy::TWO_STACKS;
+                extremeIndexes[c] = static_cast<int>(extremeCount++);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // 计划标注的策略必须与函数相符，不认识的调用（如只出现在 validity 中）按推断的策略执行
+    for(const std::string& item : SqlSyntaxUtils::splitExpressions(step.getParameter("aggregations"))){
+        const size_t colon = item.rfind(':');
+        if(colon == std::string::npos){
+            throw EngineException("SQL_EXECUTOR_INVALID_AGGREGATIONS: " + XStringUtils::trim(item));
+        }
+        const std::string strategy = XStringUtils::toLowerCase(XStringUtils::trim(item.substr(colon + 1)));
+        const Strategy annotated = strategy == "subtract" ? Strategy::SUBTRACT : strategy == "two_stacks" ? Strategy::TWO_STACKS : Strategy::NONE;
+        const Strategy inferred = getStrategy(item.substr(0,colon));
+        if(annotated == Strategy::NONE || (inferred != Strategy::NONE && inferred != annotated)){
+            throw EngineException("SQL_EXECUTOR_UNSUPPORTED_AGGREGATION: " + XStringUtils::trim(item));
+        }
+    }
+}
+
+LocalSlidingWindowOperator::Strategy LocalSlidingWindowOperator::getStrategy(const std::string& text) const {
+    const std::string normalized = LocalExpression::parse(text)->toString();
+    const std::vector<Call>& calls = getCalls();
+    for(size_t c = 0;c < calls.size();++c){
+        if(calls[c].text == normalized){
+            return strategies[c];
+        }
+    }
+    return Strategy::NONE;
+}
+
+LocalValue LocalSlidingWindowOperator::better(size_t call,const LocalValue& left,const LocalValue& right) const {
+    if(left.isNull()){
+        return right;
+    }
+    if(right.isNull()){
+        return left;
+    }
+    const int cmp = LocalValue::compare(left,right);
+    return (getCalls()[call].function == Function::MIN ? cmp <= 0 : cmp >= 0) ? left : right;
+}
+
+void LocalSlidingWindowOperator::push(Window& window,size_t row){
+    for(size_t a = 0;a < window.values.size();++a){
+        const LocalValue value = getArgument(a).get(row);
+        if(summed[a] && !value.isNull()){
+            Sum& sum = window.sums[a];
+            sum.count++;
+            if(value.getType() == LocalType::INT){
+                sum.ints += value.asInt();
+            }else{
+                sum.doubles += value.asDouble();
+                sum.others++;
+            }
+        }
+        window.values[a].push_back(value);
+    }
+    const std::vector<Call>& calls = getCalls();
+    for(size_t c = 0;c < calls.size();++c){
+        if(extremeIndexes[c] >= 0){
+            Extreme& extreme = window.extremes[extremeIndexes[c]];
+            const LocalValue& value = window.values[calls[c].argument].back();
+            extreme.back.emplace_back(value,better(c,extreme.back.empty() ? LocalValue() : extreme.back.back().second,value));
+        }
+    }
+    window.size++;
+}
+
+void LocalSlidingWindowOperator::pop(Window& window){
+    const std::vector<Call>& calls = getCalls();
+    for(size_t c = 0;c < calls.size();++c){
+        if(extremeIndexes[c] < 0){
+            continue;
+        }
+        Extreme& extreme = window.extremes[extremeIndexes[c]];
+        if(extreme.front.empty()){
+            // 入队侧倒过来压入出队侧，栈顶变成最早的一行，相等时保留较早的值
+            for(size_t i = extreme.back.size();i-- > 0;){
+                const LocalValue& value = extreme.back[i].first;
+                extreme.front.emplace_back(value,better(c,value,extreme.front.empty() ? LocalValue() : extreme.front.back().second));
+            }
+            extreme.back.clear();
+        }
+        extreme.front.pop_back();
+    }
+    for(size_t a = 0;a < window.values.size();++a){
+        const LocalValue& value = window.values[a].front();
+        if(summed[a] && !value.isNull()){
+            Sum& sum = window.sums[a];
+            sum.count--;
+            if(value.getType() == LocalType::INT){
+                sum.ints -= value.asInt();
+            }else{
+                sum.doubles -= value.asDouble();
+                // 非整数值都已移出时清掉减法累积的舍入误差
+                if(--sum.others == 0){
+                    sum.doubles = 0;
+                }
+            }
+        }
+        window.values[a].pop_front();
+    }
+    window.size--;
+}
+
+void LocalSlidingWindowOperator::fill(const Window& window,size_t row){
+    const std::vector<Call>& calls = getCalls();
+    for(size_t c = 0;c < calls.size();++c){
+        const Call& call = calls[c];
+        switch(call.function){
+            case Function::SIZE:
+                setCall(c,row,LocalValue(static_cast<int64_t>(window.size)));
+                break;
+            case Function::COUNT:
+                setCall(c,row,LocalValue(window.sums[call.argument].count));
+                break;
+            case Function::SUM: {
+                const Sum& sum = window.sums[call.argument];
+                setCall(c,row,sum.count == 0 ? LocalValue() : sum.others == 0 ? LocalValue(sum.ints) : LocalValue(sum.ints + sum.doubles));
+                break;
+            }
+            case Function::AVG: {
+                const Sum& sum = window.sums[call.argument];
+                setCall(c,row,sum.count == 0 ? LocalValue() : LocalValue((sum.ints + sum.doubles) / sum.count));
+                break;
+            }
+            case Function::MIN:
+            case Function::MAX: {
+                const Extreme& extreme = window.extremes[extremeIndexes[c]];
+                setCall(c,row,better(c,extreme.front.empty() ? LocalValue() : extreme.front.back().second,
+                                     extreme.back.empty() ? LocalValue() : extreme.back.back().second));
+                break;
+            }
+            case Function::LEAD:
+                setCall(c,row,window.values[call.argument].front());
+                break;
+            case Function::LAG:
+                setCall(c,row,window.values[call.argument].back());
+                break;
+        }
+    }
+}
+
+bool LocalSlidingWindowOperator::consume(size_t row){
+    const uint32_t partition = partitionIds[row];
+    while(partition >= windows.size()){
+        windows.emplace_back();
+        windows.back().values.resize(getArgumentCount());
+        windows.back().sums.resize(getArgumentCount());
+        windows.back().extremes.resize(extremeCount);
+    }
+    Window& window = windows[partition];
+    push(window,row);
+    while(limit > 0 && window.size > limit){
+        pop(window);
+    }
+    fill(window,row);
+    while(inclusion != nullptr && window.size > 1 && !test(*inclusion,row)){
+        pop(window);
+        fill(window,row);
+    }
+    mark(row);
+    return true;
+}
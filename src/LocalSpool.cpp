@@ -0,0 +1,70 @@
+#include "../include/LocalSpool.h"
+
+int LocalSpool::subscribe(){
+    std::lock_guard<std::mutex> lock(mutex);
+    queues.emplace_back();
+    cancelled.push_back(0);
+    return queues.size() - 1;
+}
+
+bool LocalSpool::push(const std::shared_ptr<const LocalBatch>& batch){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!queues.empty() && cancels == queues.size()){
+            return false;
+        }
+        if(closed){
+            return true;
+        }
+        for(size_t i = 0;i < queues.size();++i){
+            if(!cancelled[i]){
+                queues[i].push_back(batch);
+            }
+        }
+    }
+    ready.notify_all();
+    return true;
+}
+
+void LocalSpool::close(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    ready.notify_all();
+}
+
+bool LocalSpool::isClosed(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return closed;
+}
+
+void LocalSpool::cancel(int consumer){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(cancelled.at(consumer)){
+            return;
+        }
+        cancelled[consumer] = 1;
+        cancels++;
+        std::deque<std::shared_ptr<const LocalBatch>>().swap(queues[consumer]);
+    }
+    ready.notify_all();
+}
+
+bool LocalSpool::isCancelled(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return !queues.empty() && cancels == queues.size();
+}
+
+std::shared_ptr<const LocalBatch> LocalSpool::pop(int consumer){
+    std::unique_lock<std::mutex> lock(mutex);
+    std::deque<std::shared_ptr<const LocalBatch>>& queue = queues.at(consumer);
+    ready.wait(lock,[&]{ return closed || cancelled[consumer] || !queue.empty(); });
+    if(cancelled[consumer] || queue.empty()){
+        return nullptr;
+    }
+    std::shared_ptr<const LocalBatch> batch = queue.front();
+    queue.pop_front();
+    return batch;
+}
@@ -0,0 +1,116 @@
+#include "../include/LocalStatisticsCatalog.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+LocalStatisticsCatalog::LocalStatisticsCatalog(){}
+
+std::shared_ptr<TableStatistics> LocalStatisticsCatalog::getTableStatistics(const std::string& table){
+    auto iter = tables.find(table);
+    return iter == tables.end() ? nullptr : iter->second;
+}
+
+void LocalStatisticsCatalog::setTableStatistics(const std::string& table,std::shared_ptr<TableStatistics> statistics){
+    tables[table] = statistics;
+}
+
+std::shared_ptr<TableStatistics> LocalStatisticsCatalog::getOrCreate(const std::string& table){
+    std::shared_ptr<TableStatistics> statistics = getTableStatistics(table);
+    if(statistics == nullptr){
+        statistics = std::make_shared<TableStatistics>();
+        tables[table] = statistics;
+    }
+    return statistics;
+}
+
+void LocalStatisticsCatalog::load(const std::string& path){
+    std::ifstream file(path);
+    if(!file.is_open()){
+        throw EngineException(std::string("SQL_STATISTICS_FILE_NOT_FOUND: ") + path);
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    parse(content.str());
+}
+
+void LocalStatisticsCatalog::parse(const std::string& content){
+    std::istringstream lines(content);
+    std::string line;
+    int lineNumber = 0;
+    while(std::getline(lines,line)){
+        lineNumber++;
+        line = XStringUtils::trim(line);
+        if(line.empty() || line.at(0) == '#'){
+            continue;
+        }
+
+        std::istringstream words(line);
+        std::vector<std::string> tokens;
+        std::string word;
+        while(words >> word){
+            tokens.push_back(word);
+        }
+
+        const std::string kind = XStringUtils::toLowerCase(tokens.at(0));
+        size_t first;
+        if(kind == "table" && tokens.size() >= 2){
+            first = 2;
+        }else if(kind == "column" && tokens.size() >= 3){
+            first = 3;
+        }else{
+            throw EngineException("SQL_STATISTICS_INVALID_LINE: " + std::to_string(lineNumber));
+        }
+
+        std::shared_ptr<TableStatistics> table = getOrCreate(tokens.at(1));
+        std::shared_ptr<ColumnStatistics> column = nullptr;
+        if(kind == "column"){
+            column = table->getColumn(tokens.at(2));
+            if(column == nullptr){
+                column = std::make_shared<ColumnStatistics>();
+                table->setColumn(tokens.at(2),column);
+            }
+        }
+
+        bool hasMin = false,hasMax = false;
+        double minValue = 0,maxValue = 0;
+        for(size_t i = first;i < tokens.size();++i){
+            const size_t eq = tokens.at(i).find('=');
+            if(eq == std::string::npos){
+                throw EngineException("SQL_STATISTICS_INVALID_LINE: " + std::to_string(lineNumber));
+            }
+            const std::string key = XStringUtils::toLowerCase(tokens.at(i).substr(0,eq));
+            double value;
+            try{
+                value = std::stod(tokens.at(i).substr(eq + 1));
+            }catch(const std::exception&){
+                throw EngineException("SQL_STATISTICS_INVALID_VALUE: " + tokens.at(i));
+            }
+
+            if(column == nullptr && key == "rows"){
+                table->setRowCount(value);
+            }else if(column == nullptr && key == "rate"){
+                table->setRate(value);
+            }else if(key == "width"){
+                column == nullptr ? table->setWidth(value) : column->setWidth(value);
+            }else if(column != nullptr && key == "ndv"){
+                column->setDistinctCount(value);
+            }else if(column != nullptr && key == "min"){
+                minValue = value;
+                hasMin = true;
+            }else if(column != nullptr && key == "max"){
+                maxValue = value;
+                hasMax = true;
+            }else if(column != nullptr && key == "null_fraction"){
+                column->setNullFraction(value);
+            }else{
+                throw EngineException("SQL_STATISTICS_UNKNOWN_KEY: " + key);
+            }
+        }
+        if(hasMin && hasMax){
+            column->setMinMax(minValue,maxValue);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#include "../include/LocalStepDefinition.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+#include <algorithm>
+
+LocalStepDefinition LocalStepDefinition::parse(const std::string& step){
+    LocalStepDefinition result;
+    const size_t question = step.find('?');
+    const size_t open = step.find('(',question == std::string::npos ? 0 : question);
+    const size_t nameEnd = std::min(question,open);
+    result.name = XStringUtils::trim(step.substr(0,nameEnd));
+    if(result.name.empty()){
+        throw EngineException("SQL_EXECUTOR_INVALID_STEP: " + step);
+    }
+
+    if(question != std::string::npos){
+        const std::string attributes = step.substr(question + 1,open == std::string::npos ? std::string::npos : open - question - 1);
+        size_t begin = 0;
+        while(begin < attributes.size()){
+            size_t end = attributes.find(',',begin);
+            end = end == std::string::npos ? attributes.size() : end;
+            const std::string pair = attributes.substr(begin,end - begin);
+            const size_t equal = pair.find('=');
+            if(equal == std::string::npos){
+                throw EngineException("SQL_EXECUTOR_INVALID_STEP: " + step);
+            }
+            result.attributes[XStringUtils::trim(pair.substr(0,equal))] = XStringUtils::trim(pair.substr(equal + 1));
+            begin = end + 1;
+        }
+    }
+
+    if(open == std::string::npos){
+        return result;
+    }
+    // 参数值写在反引号内，可以包含逗号和括号
+    size_t pos = open + 1;
+    while(pos < step.size() && step.at(pos) != ')'){
+        const size_t equal = step.find('=',pos);
+        if(equal == std::string::npos || equal + 1 >= step.size() || step.at(equal + 1) != '`'){
+            throw EngineException("SQL_EXECUTOR_INVALID_STEP: " + step);
+        }
+        const size_t close = step.find('`',equal + 2);
+        if(close == std::string::npos){
+            throw EngineException("SQL_EXECUTOR_INVALID_STEP: " + step);
+        }
+        result.parameters[XStringUtils::trim(step.substr(pos,equal - pos))] = step.substr(equal + 2,close - equal - 2);
+        pos = close + 1;
+        if(pos < step.size() && step.at(pos) == ','){
+            pos++;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,223 @@
+#include "../include/LocalStreamAggregateOperator.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+    // 一批行跨越的桶超过这个数时拆成两半处理，避免时间跳变时环形缓冲区无限扩大
+    const size_t MAX_SLOTS = 1 << 16;
+
+    const size_t MIN_SLOTS = 4;
+
+    // 负的时间戳向下取整
+    int64_t floorDiv(int64_t value,int64_t width){
+        return value >= 0 ? value / width : -((-value + width - 1) / width);
+    }
+
+}
+
+LocalStreamAggregateOperator::LocalStreamAggregateOperator(const LocalStepDefinition& step,const std::string& selects,bool keepTime,bool holdBuckets) :
+    LocalOperator(step),aggregation("",selects),time(LocalExpression::parse(step.getParameter("time"))),
+    width(toMilliseconds(std::stoll(step.getParameter("interval")),step.getParameter("time_unit"))),keepTime(keepTime),holdBuckets(holdBuckets){
+    if(width <= 0){
+        throw EngineException("SQL_EXECUTOR_INVALID_INTERVAL: " + step.getParameter("interval"));
+    }
+    if(XStringUtils::isNotBlank(step.getParameter("lateness"))){
+        lateness = toMilliseconds(std::stoll(step.getParameter("lateness")),step.getParameter("time_unit"));
+        if(lateness < 0){
+            throw EngineException("SQL_EXECUTOR_INVALID_LATENESS: " + step.getParameter("lateness"));
+        }
+    }
+}
+
+int64_t LocalStreamAggregateOperator::toMilliseconds(int64_t interval,const std::string& unit){
+    const std::string myunit = XStringUtils::toLowerCase(XStringUtils::trim(unit));
+    if(myunit == "millisecond"){
+        return interval;
+    }
+    if(myunit == "minute"){
+        return interval * 60000;
+    }
+    if(myunit == "hour"){
+        return interval * 3600000;
+    }
+    return interval * 1000;
+}
+
+void LocalStreamAggregateOperator::grow(size_t span){
+    size_t grown = std::max(capacity,MIN_SLOTS);
+    while(grown < span){
+        grown <<= 1;
+    }
+    std::vector<LocalAggregate>& aggregates = aggregation.getAggregates();
+    // 原来收集迟到行的槽位变成普通槽位
+    for(size_t a = 0;a < aggregates.size();++a){
+        if(capacity > 0){
+            aggregates[a].reset(states[a],capacity,capacity + 1);
+        }
+        aggregates[a].resize(states[a],grown + 1);
+    }
+    filled.resize(grown + 1,0);
+    // 新的槽位号只可能比原来多 capacity，移动时不会覆盖未关闭的桶
+    if(capacity > 0){
+        for(int64_t bucket = first;bucket <= last;++bucket){
+            const size_t from = static_cast<size_t>(bucket) & (capacity - 1);
+            const size_t to = static_cast<size_t>(bucket) & (grown - 1);
+            if(from != to && filled[from]){
+                for(size_t a = 0;a < aggregates.size();++a){
+                    aggregates[a].move(states[a],from,to);
+                }
+                filled[to] = 1;
+                filled[from] = 0;
+            }
+        }
+    }
+    capacity = grown;
+}
+
+bool LocalStreamAggregateOperator::flush(size_t slot,size_t count,int64_t bucket){
+    std::vector<LocalAggregate>& aggregates = aggregation.getAggregates();
+    std::vector<int64_t> rows;
+    LocalColumn starts(step.getParameter("time"),LocalType::INT);
+    for(size_t i = 0;i < count;++i){
+        if(filled[slot + i]){
+            rows.push_back(i);
+            starts.getInts().push_back((bucket + static_cast<int64_t>(i)) * width);
+        }
+    }
+    if(count > 0 && rows.empty()){
+        return true;
+    }
+
+    const std::vector<std::string> names = aggregation.getGroupColumnNames();
+    LocalBatch groups(rows.size());
+    for(size_t a = 0;a < aggregates.size();++a){
+        LocalColumn column = count == 0 ? LocalColumn(names[a],LocalType::INT) : aggregates[a].result(states[a],names[a],slot,slot + count);
+        groups.addColumn(rows.size() == count ? std::move(column) : column.select(rows));
+        if(count > 0){
+            aggregates[a].reset(states[a],slot,slot + count);
+        }
+    }
+    std::fill(filled.begin() + slot,filled.begin() + slot + count,0);
+
+    std::shared_ptr<LocalBatch> projected = aggregation.project(groups);
+    std::shared_ptr<LocalBatch> result = projected;
+    if(keepTime){
+        result = std::make_shared<LocalBatch>(rows.size());
+        result->addColumn(std::move(starts));
+        for(const LocalColumn& column : projected->getColumns()){
+            result->addColumn(column);
+        }
+    }
+    return emit(result);
+}
+
+bool LocalStreamAggregateOperator::close(int64_t below){
+    if(!started || below <= first){
+        return true;
+    }
+    // 按槽位连续的一段输出，遇到环的末尾或满 batchSize 个桶时分段
+    const int64_t end = std::min(below,last + 1);
+    for(int64_t bucket = first;bucket < end;){
+        const size_t slot = static_cast<size_t>(bucket) & (capacity - 1);
+        const size_t count = std::min({static_cast<size_t>(end - bucket),capacity - slot,batchSize});
+        if(!flush(slot,count,bucket)){
+            return false;
+        }
+        bucket += static_cast<int64_t>(count);
+    }
+    first = below;
+    last = std::max(last,first - 1);
+    return true;
+}
+
+bool LocalStreamAggregateOperator::consume(const LocalBatch& batch){
+    const size_t rows = batch.getRows();
+    aggregation.bind(batch);
+    time->bind(batch);
+    LocalColumn evaluated;
+    const LocalColumn* column = &evaluated;
+    if(time->getKind() == LocalExpression::Kind::COLUMN){
+        column = &batch.getColumn(time->getColumn());
+    }else{
+        evaluated = time->evaluate(batch,step.getParameter("time"));
+    }
+
+    numbers.resize(rows);
+    int64_t minTime = std::numeric_limits<int64_t>::max(),maxTime = std::numeric_limits<int64_t>::min();
+    for(size_t row = 0;row < rows;++row){
+        if(column->isNull(row)){
+            continue;
+        }
+        const int64_t ms = column->getType() == LocalType::INT ? column->getInts()[row] : column->get(row).asInt();
+        numbers[row] = floorDiv(ms,width);
+        minTime = std::min(minTime,ms);
+        maxTime = std::max(maxTime,ms);
+    }
+    if(minTime > maxTime){
+        return true;
+    }
+
+    // 这一批中最早的时间之前已经可以关闭的桶先输出，再按这一批的跨度扩展环形缓冲区
+    if(started){
+        if(!holdBuckets && !close(floorDiv(std::max(watermark,minTime) - lateness,width))){
+            return false;
+        }
+    }else{
+        started = true;
+        // 第一批之前的桶也可以在 lateness 之内收到迟到的行
+        first = floorDiv(minTime - lateness,width);
+        last = first - 1;
+        watermark = minTime;
+    }
+    // 保留所有桶时比 first 早的桶也要放进环形缓冲区，扩展之后再前移 first
+    const int64_t lowest = holdBuckets ? std::min(first,floorDiv(minTime,width)) : first;
+    const size_t span = static_cast<size_t>(std::max(last,floorDiv(maxTime,width)) - lowest + 1);
+    if(span > MAX_SLOTS && rows > 1 && !holdBuckets){
+        return consume(*batch.slice(0,rows / 2)) && consume(*batch.slice(rows / 2,rows));
+    }
+    if(span > capacity){
+        grow(span);
+    }
+    first = lowest;
+
+    groups.resize(rows);
+    for(size_t row = 0;row < rows;++row){
+        if(column->isNull(row)){
+            groups[row] = static_cast<uint32_t>(capacity);
+        }else if(numbers[row] < first){
+            groups[row] = static_cast<uint32_t>(capacity);
+            lateRows++;
+        }else{
+            const size_t slot = static_cast<size_t>(numbers[row]) & (capacity - 1);
+            groups[row] = static_cast<uint32_t>(slot);
+            filled[slot] = 1;
+            last = std::max(last,numbers[row]);
+        }
+    }
+    std::vector<LocalAggregate>& aggregates = aggregation.getAggregates();
+    for(size_t a = 0;a < aggregates.size();++a){
+        aggregates[a].update(states[a],groups,batch);
+        aggregates[a].reset(states[a],capacity,capacity + 1);
+    }
+
+    watermark = std::max(watermark,maxTime);
+    return holdBuckets || close(floorDiv(watermark - lateness,width));
+}
+
+void LocalStreamAggregateOperator::run(){
+    states.resize(aggregation.getAggregates().size());
+    for(std::shared_ptr<const LocalBatch> batch = next();batch != nullptr;batch = next()){
+        if(!consume(*batch)){
+            return;
+        }
+    }
+    if(started && !close(last + 1)){
+        return;
+    }
+    // 没有输出过批次时写出一个空批次，把列布局传给下游
+    flush(0,0,0);
+}
@@ -0,0 +1,154 @@
+#include "../include/LocalTableFile.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+namespace {
+
+    // 按逗号切分一行，双引号内的逗号不切分，两个双引号表示一个双引号
+    bool splitLine(std::istream& in,std::vector<std::string>& fields,std::vector<bool>& quoted){
+        fields.clear();
+        quoted.clear();
+        std::string line;
+        if(!std::getline(in,line)){
+            return false;
+        }
+        std::string field;
+        bool inQuote = false,wasQuoted = false;
+        for(size_t i = 0;;++i){
+            if(i == line.size()){
+                if(!inQuote){
+                    break;
+                }
+                // 引号内的换行
+                std::string more;
+                if(!std::getline(in,more)){
+                    throw EngineException("SQL_EXECUTOR_UNTERMINATED_QUOTE: " + line);
+                }
+                field += '\n';
+                line += '\n' + more;
+                continue;
+            }
+            const char c = line[i];
+            if(inQuote){
+                if(c == '"' && i + 1 < line.size() && line[i + 1] == '"'){
+                    field += '"';
+                    i++;
+                }else if(c == '"'){
+                    inQuote = false;
+                }else{
+                    field += c;
+                }
+            }else if(c == '"'){
+                inQuote = true;
+                wasQuoted = true;
+            }else if(c == ','){
+                fields.push_back(field);
+                quoted.push_back(wasQuoted);
+                field.clear();
+                wasQuoted = false;
+            }else if(c != '\r'){
+                field += c;
+            }
+        }
+        fields.push_back(field);
+        quoted.push_back(wasQuoted);
+        return true;
+    }
+
+    std::string quote(const std::string& value){
+        if(value.find_first_of(",\"\n") == std::string::npos && !value.empty()){
+            return value;
+        }
+        std::string result = "\"";
+        for(const char c : value){
+            result += c == '"' ? "\"\"" : std::string(1,c);
+        }
+        return result + "\"";
+    }
+
+}
+
+std::vector<LocalColumn> LocalTableFile::readHeader(std::istream& in){
+    std::vector<std::string> fields;
+    std::vector<bool> quoted;
+    if(!splitLine(in,fields,quoted)){
+        throw EngineException("SQL_EXECUTOR_MISSING_TABLE_HEADER");
+    }
+    std::vector<LocalColumn> layout;
+    for(const std::string& field : fields){
+        const size_t colon = field.rfind(':');
+        const std::string name = XStringUtils::trim(field.substr(0,colon));
+        const std::string type = colon == std::string::npos ? "string" : XStringUtils::toLowerCase(XStringUtils::trim(field.substr(colon + 1)));
+        if(type == "int"){
+            layout.emplace_back(name,LocalType::INT);
+        }else if(type == "double"){
+            layout.emplace_back(name,LocalType::DOUBLE);
+        }else if(type == "string"){
+            layout.emplace_back(name,LocalType::STRING);
+        }else{
+            throw EngineException("SQL_EXECUTOR_UNKNOWN_COLUMN_TYPE: " + field);
+        }
+    }
+    return layout;
+}
+
+std::shared_ptr<LocalBatch> LocalTableFile::read(std::istream& in,const std::vector<LocalColumn>& layout,size_t rows){
+    std::vector<LocalColumn> columns = layout;
+    for(LocalColumn& column : columns){
+        column.reserve(rows);
+    }
+    std::vector<std::string> fields;
+    std::vector<bool> quoted;
+    size_t count = 0;
+    while(count < rows && splitLine(in,fields,quoted)){
+        if(fields.size() == 1 && fields[0].empty() && !quoted[0]){
+            continue;
+        }
+        if(fields.size() != columns.size()){
+            throw EngineException("SQL_EXECUTOR_COLUMN_COUNT_MISMATCH: expected " + std::to_string(columns.size()) +
+                                  ", got " + std::to_string(fields.size()));
+        }
+        for(size_t c = 0;c < columns.size();++c){
+            if(fields[c].empty() && !quoted[c]){
+                columns[c].appendNull();
+                continue;
+            }
+            switch(columns[c].getType()){
+                case LocalType::INT: columns[c].append(LocalValue(static_cast<int64_t>(std::stoll(fields[c])))); break;
+                case LocalType::DOUBLE: columns[c].append(LocalValue(std::stod(fields[c]))); break;
+                default: columns[c].append(LocalValue(fields[c]));
+            }
+        }
+        count++;
+    }
+    if(count == 0){
+        return nullptr;
+    }
+    std::shared_ptr<LocalBatch> batch = std::make_shared<LocalBatch>(count);
+    for(LocalColumn& column : columns){
+        batch->addColumn(std::move(column));
+    }
+    return batch;
+}
+
+void LocalTableFile::writeHeader(std::ostream& out,const LocalBatch& batch){
+    for(size_t c = 0;c < batch.getColumnCount();++c){
+        const LocalColumn& column = batch.getColumn(c);
+        out << (c > 0 ? "," : "") << quote(column.getName() + ":" + toString(column.getType()));
+    }
+    out << "\n";
+}
+
+void LocalTableFile::write(std::ostream& out,const LocalBatch& batch){
+    for(size_t row = 0;row < batch.getRows();++row){
+        for(size_t c = 0;c < batch.getColumnCount();++c){
+            const LocalColumn& column = batch.getColumn(c);
+            out << (c > 0 ? "," : "");
+            if(column.isNull(row)){
+                continue;
+            }
+            out << (column.getType() == LocalType::STRING ? quote(column.getStrings()[row]) : column.get(row).toString());
+        }
+        out << "\n";
+    }
+}
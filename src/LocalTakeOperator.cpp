@@ -0,0 +1,20 @@
+#include "../include/LocalTakeOperator.h"
+
+LocalTakeOperator::LocalTakeOperator(const LocalStepDefinition& step) :
+    LocalOperator(step),rows(std::stoll(step.getParameter("rows"))){
+}
+
+void LocalTakeOperator::run(){
+    // 取够之后不再读下一批，直接结束，execute 随即取消上游
+    for(int64_t taken = 0;taken < rows;){
+        std::shared_ptr<const LocalBatch> batch = next();
+        if(batch == nullptr){
+            return;
+        }
+        const int64_t count = batch->getRows();
+        if(!emit(taken + count > rows ? batch->slice(0,rows - taken) : batch)){
+            return;
+        }
+        taken += count;
+    }
+}
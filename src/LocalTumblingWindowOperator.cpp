@@ -0,0 +1,207 @@
+#include "../include/LocalTumblingWindowOperator.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace {
+
+    // 一批的行数不到这个数时各线程的分区在当前线程依次处理
+    const size_t PARALLEL_ROWS = 1024;
+
+    // 追加一个值，值比列的类型宽时把整列转换成较宽的类型
+    void appendValue(LocalColumn& column,const LocalValue& value){
+        if(value.isNull() || value.getType() == column.getType()){
+            column.append(value);
+        }else{
+            column.appendNull();
+            column.set(column.size() - 1,value);
+        }
+    }
+
+}
+
+LocalTumblingWindowOperator::LocalTumblingWindowOperator(const LocalStepDefinition& step) :
+    LocalWindowOperator(step,true),threads(std::max(1u,std::thread::hardware_concurrency())){
+    const std::string text = step.getParameter("inclusion");
+    if(XStringUtils::isNotBlank(text)){
+        std::shared_ptr<LocalExpression> parsed = LocalExpression::parse(text);
+        const LocalValue& value = parsed->getValue();
+        if(parsed->getKind() == LocalExpression::Kind::LITERAL && !value.isNull() && value.getType() == LocalType::INT){
+            if(value.asInt() < 1){
+                throw EngineException("SQL_EXECUTOR_INVALID_INCLUSION: " + text);
+            }
+            limit = static_cast<size_t>(value.asInt());
+        }else{
+            inclusion = compile(text);
+        }
+    }
+}
+
+size_t LocalTumblingWindowOperator::getStateBytesPerKey() const {
+    return LocalWindowState(getCalls(),getArgumentCount()).getBytesPerKey();
+}
+
+void LocalTumblingWindowOperator::clear(Worker& worker){
+    const std::vector<Call>& calls = getCalls();
+    worker.closed.clear();
+    for(size_t c = 0;c < calls.size();++c){
+        worker.closed.emplace_back(calls[c].text,LocalType::INT);
+    }
+    worker.closers.clear();
+}
+
+void LocalTumblingWindowOperator::prepareWorkers(){
+    if(workers.empty()){
+        workers.resize(threads);
+        for(size_t w = 0;w < threads;++w){
+            workers[w].index = w;
+            workers[w].state.reset(new LocalWindowState(getCalls(),getArgumentCount()));
+            clear(workers[w]);
+        }
+    }
+    const size_t keys = (getPartitionCount() + threads - 1) / threads;
+    for(Worker& worker : workers){
+        worker.state->grow(keys);
+        worker.rows.clear();
+        worker.batch = nullptr;
+    }
+    const size_t rows = work.getRows();
+    if(threads == 1){
+        workers[0].rows.resize(rows);
+        for(size_t row = 0;row < rows;++row){
+            workers[0].rows[row] = static_cast<int64_t>(row);
+        }
+        return;
+    }
+    for(size_t row = 0;row < rows;++row){
+        workers[partitionIds[row] % threads].rows.push_back(static_cast<int64_t>(row));
+    }
+    if(inclusion != nullptr){
+        for(Worker& worker : workers){
+            if(!worker.rows.empty()){
+                worker.batch = work.select(worker.rows);
+            }
+        }
+    }
+}
+
+void LocalTumblingWindowOperator::close(Worker& worker,uint32_t key,int64_t closer){
+    for(size_t c = 0;c < worker.closed.size();++c){
+        appendValue(worker.closed[c],worker.state->get(c,key));
+    }
+    worker.closers.push_back(closer);
+    worker.state->reset(key);
+}
+
+void LocalTumblingWindowOperator::process(Worker& worker){
+    LocalWindowState& state = *worker.state;
+    const std::vector<const LocalColumn*>& arguments = getArguments();
+    const size_t calls = getCalls().size();
+    // 只有一个线程时 rows 是全部行，第 i 个就是第 i 行
+    LocalBatch& batch = worker.batch == nullptr ? work : *worker.batch;
+    for(size_t i = 0;i < worker.rows.size();++i){
+        const size_t row = static_cast<size_t>(worker.rows[i]);
+        const uint32_t key = static_cast<uint32_t>(partitionIds[row] / threads);
+        if(inclusion != nullptr && state.getRows(key) > 0){
+            for(size_t c = 0;c < calls;++c){
+                setCall(batch,c,i,state.get(c,key,arguments,row));
+            }
+            if(!inclusion->evaluate(batch,i).isTrue()){
+                close(worker,key,worker.rows[i]);
+            }
+        }
+        state.append(key,arguments,row);
+        if(limit > 0 && state.getRows(key) == limit){
+            close(worker,key,worker.rows[i]);
+        }
+    }
+}
+
+bool LocalTumblingWindowOperator::emitClosed(){
+    size_t total = 0;
+    for(const Worker& worker : workers){
+        total += worker.closers.size();
+    }
+    if(total == 0){
+        return true;
+    }
+
+    LocalBatch windows(total);
+    if(workers.size() == 1){
+        for(LocalColumn& column : workers[0].closed){
+            windows.addColumn(std::move(column));
+        }
+    }else{
+        // 各线程的窗口已经按关闭的行号递增，按行号排序后依次取各线程的下一个窗口
+        std::vector<std::pair<int64_t, size_t>> order;
+        order.reserve(total);
+        for(const Worker& worker : workers){
+            for(int64_t closer : worker.closers){
+                order.emplace_back(closer,worker.index);
+            }
+        }
+        std::sort(order.begin(),order.end());
+        const std::vector<Call>& calls = getCalls();
+        for(size_t c = 0;c < calls.size();++c){
+            LocalColumn column(calls[c].text,LocalType::INT);
+            column.reserve(total);
+            std::vector<size_t> positions(workers.size(),0);
+            for(const std::pair<int64_t, size_t>& item : order){
+                appendValue(column,workers[item.second].closed[c].get(positions[item.second]++));
+            }
+            windows.addColumn(std::move(column));
+        }
+    }
+    for(Worker& worker : workers){
+        clear(worker);
+    }
+    return emitWindows(windows);
+}
+
+bool LocalTumblingWindowOperator::end(){
+    prepareWorkers();
+    if(threads == 1 || work.getRows() < PARALLEL_ROWS){
+        for(Worker& worker : workers){
+            process(worker);
+        }
+    }else{
+        std::vector<std::thread> pool;
+        for(Worker& worker : workers){
+            pool.emplace_back([this,&worker]{
+                try{
+                    process(worker);
+                }catch(...){
+                    worker.error = std::current_exception();
+                }
+            });
+        }
+        for(std::thread& thread : pool){
+            thread.join();
+        }
+        for(Worker& worker : workers){
+            if(worker.error){
+                std::exception_ptr error = worker.error;
+                worker.error = nullptr;
+                std::rethrow_exception(error);
+            }
+        }
+    }
+    return emitClosed();
+}
+
+bool LocalTumblingWindowOperator::finish(){
+    if(workers.empty()){
+        return true;
+    }
+    for(size_t key = 0;key < getPartitionCount();++key){
+        Worker& worker = workers[key % threads];
+        const uint32_t local = static_cast<uint32_t>(key / threads);
+        if(local < worker.state->size() && worker.state->getRows(local) > 0){
+            close(worker,local,static_cast<int64_t>(key));
+        }
+    }
+    return emitClosed();
+}
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <numeric>
+
+#include "../include/LocalWindowOperator.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "EngineException.h"
+#include "XStringUtils.h"
+
+namespace {
+
+    // 窗口函数列的列名前缀
+    const std::string CALL_PREFIX = "__window_";
+
+    std::string callColumn(size_t call){
+        return CALL_PREFIX + std::to_string(call);
+    }
+
+}
+
+LocalWindowOperator::LocalWindowOperator(const LocalStepDefinition& step,bool perWindow) : LocalOperator(step),perWindow(perWindow){
+    for(const std::string& item : SqlSyntaxUtils::splitExpressions(step.getParameter("selects"))){
+        const std::string alias = SqlSyntaxUtils::getExpressionAlias(item);
+        const std::string expr = XStringUtils::trim(SqlSyntaxUtils::removeExpressionAlias(item));
+        if(expr == "*" && perWindow){
+            throw EngineException("SQL_EXECUTOR_UNSUPPORTED_WINDOW_SELECT: *");
+        }
+        names.push_back(alias.empty() ? expr : alias);
+        selects.push_back(expr == "*" ? nullptr : compile(expr,perWindow));
+    }
+    if(XStringUtils::isNotBlank(step.getParameter("validity"))){
+        validity = compile(step.getParameter("validity"),perWindow);
+    }
+    const std::string keys = step.getParameter("keys");
+    if(XStringUtils::isNotBlank(keys)){
+        std::vector<std::shared_ptr<LocalExpression>> exprs;
+        std::vector<std::string> keyNames;
+        for(const std::string& key : SqlSyntaxUtils::splitExpressions(keys)){
+            keyNames.push_back(XStringUtils::trim(key));
+            exprs.push_back(LocalExpression::parse(keyNames.back()));
+        }
+        partitions = std::make_shared<LocalGroupTable>(exprs,keyNames);
+    }
+    for(const std::string& item : SqlSyntaxUtils::splitExpressions(step.getParameter("sorts"))){
+        std::string expr = XStringUtils::trim(item);
+        if(expr.empty()){
+            continue;
+        }
+        const size_t space = expr.find_last_of(" \t");
+        const std::string order = space == std::string::npos ? "" : XStringUtils::toLowerCase(expr.substr(space + 1));
+        descending.push_back(order == "desc");
+        if(order == "asc" || order == "desc"){
+            expr = XStringUtils::trim(expr.substr(0,space));
+        }
+        sorts.push_back(LocalExpression::parse(expr));
+    }
+}
+
+bool LocalWindowOperator::toFunction(const std::string& name,Function& function){
+    const std::string myname = XStringUtils::toLowerCase(XStringUtils::trim(name));
+    if(myname == "wsize"){
+        function = Function::SIZE;
+    }else if(myname == "wcount"){
+        function = Function::COUNT;
+    }else if(myname == "wsum"){
+        function = Function::SUM;
+    }else if(myname == "wavg"){
+        function = Function::AVG;
+    }else if(myname == "wmin"){
+        function = Function::MIN;
+    }else if(myname == "wmax"){
+        function = Function::MAX;
+    }else if(myname == "wlead"){
+        function = Function::LEAD;
+    }else if(myname == "wlag"){
+        function = Function::LAG;
+    }else{
+        return false;
+    }
+    return true;
+}
+
+bool LocalWindowOperator::referencesCalls(const LocalExpression& expr){
+    if(expr.getKind() == LocalExpression::Kind::COLUMN){
+        return expr.getText().compare(0,CALL_PREFIX.size(),CALL_PREFIX) == 0;
+    }
+    for(const std::shared_ptr<LocalExpression>& child : expr.getChildren()){
+        if(referencesCalls(*child)){
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<LocalExpression> LocalWindowOperator::compile(const std::string& text){
+    return compile(text,false);
+}
+
+std::shared_ptr<LocalExpression> LocalWindowOperator::compile(const std::string& text,bool lastRow){
+    std::shared_ptr<LocalExpression> expr = rewrite(LocalExpression::parse(text),lastRow);
+    expressions.push_back(expr);
+    return expr;
+}
+
+std::shared_ptr<LocalExpression> LocalWindowOperator::rewrite(const std::shared_ptr<LocalExpression>& expr,bool lastRow){
+    if(lastRow && expr->getKind() == LocalExpression::Kind::COLUMN){
+        std::shared_ptr<LocalExpression> call = std::make_shared<LocalExpression>(LocalExpression::Kind::CALL,"wlag");
+        call->addChild(expr);
+        return rewrite(call,false);
+    }
+    Function function;
+    if(expr->getKind() != LocalExpression::Kind::CALL || !toFunction(expr->getText(),function)){
+        for(size_t i = 0;i < expr->getChildren().size();++i){
+            expr->setChild(i,rewrite(expr->getChildren()[i],lastRow));
+        }
+        return expr;
+    }
+
+    const std::string text = expr->toString();
+    size_t index = 0;
+    while(index < calls.size() && calls[index].text != text){
+        ++index;
+    }
+    if(index == calls.size()){
+        Call call{function,text,-1};
+        if(function == Function::COUNT && expr->getChildren().empty()){
+            call.function = Function::SIZE;
+        }
+        if(call.function != Function::SIZE){
+            if(expr->getChildren().size() != 1){
+                throw EngineException("SQL_EXECUTOR_INVALID_WINDOW_FUNCTION: " + text);
+            }
+            // 字符串常量参数是列名
+            std::shared_ptr<LocalExpression> argument = expr->getChildren()[0];
+            const LocalValue& value = argument->getValue();
+            if(argument->getKind() == LocalExpression::Kind::LITERAL && !value.isNull() && value.getType() == LocalType::STRING){
+                argument = std::make_shared<LocalExpression>(LocalExpression::Kind::COLUMN,value.toString());
+            }
+            const std::string argumentText = argument->toString();
+            call.argument = 0;
+            while(static_cast<size_t>(call.argument) < arguments.size() && arguments[call.argument]->toString() != argumentText){
+                call.argument++;
+            }
+            if(static_cast<size_t>(call.argument) == arguments.size()){
+                arguments.push_back(argument);
+            }
+        }
+        calls.push_back(call);
+    }
+    return std::make_shared<LocalExpression>(LocalExpression::Kind::COLUMN,callColumn(index));
+}
+
+void LocalWindowOperator::prepare(const std::shared_ptr<const LocalBatch>& batch){
+    const size_t rows = batch->getRows();
+    inputColumns = batch->getColumnCount();
+    work = LocalBatch(rows);
+    for(const LocalColumn& column : batch->getColumns()){
+        work.addColumn(column);
+    }
+    for(size_t c = 0;c < calls.size();++c){
+        LocalColumn column(callColumn(c),LocalType::INT);
+        column.getInts().assign(rows,0);
+        work.addColumn(std::move(column));
+    }
+    for(const std::shared_ptr<LocalExpression>& expr : expressions){
+        expr->bind(work);
+    }
+
+    // 参数只引用输入的列，是列名时直接使用 work 中的列
+    evaluated.resize(arguments.size());
+    values.resize(arguments.size());
+    for(size_t a = 0;a < arguments.size();++a){
+        if(arguments[a]->getKind() == LocalExpression::Kind::COLUMN){
+            arguments[a]->bind(*batch);
+            values[a] = &work.getColumn(arguments[a]->getColumn());
+        }else{
+            evaluated[a] = arguments[a]->evaluate(*batch,"");
+            values[a] = &evaluated[a];
+        }
+    }
+
+    if(partitions != nullptr){
+        partitions->lookup(*batch,partitionIds);
+    }else{
+        partitionIds.assign(rows,0);
+    }
+    marked.clear();
+}
+
+bool LocalWindowOperator::flush(){
+    if(perWindow){
+        return true;
+    }
+    std::shared_ptr<LocalBatch> selected;
+    if(marked.size() != work.getRows()){
+        selected = work.select(marked);
+    }
+    marked.clear();
+    return output(selected == nullptr ? work : *selected);
+}
+
+bool LocalWindowOperator::emitWindows(LocalBatch& windows){
+    for(size_t c = 0;c < calls.size();++c){
+        windows.getColumn(c).setName(callColumn(c));
+    }
+    // selects 与 validity 只引用窗口函数列，按列名重新绑定到 windows
+    for(const std::shared_ptr<LocalExpression>& select : selects){
+        select->bind(windows);
+    }
+    if(validity != nullptr){
+        validity->bind(windows);
+    }
+    return output(windows);
+}
+
+bool LocalWindowOperator::output(const LocalBatch& candidates){
+    std::shared_ptr<LocalBatch> selected;
+    if(validity != nullptr){
+        if(kernel == nullptr || !kernel->accepts(candidates)){
+            kernel = std::make_shared<LocalFilterKernel>(validity,candidates);
+        }
+        std::vector<int64_t> rows;
+        kernel->select(candidates,rows);
+        if(rows.size() != candidates.getRows()){
+            selected = candidates.select(rows);
+        }
+    }
+
+    const LocalBatch& result = selected == nullptr ? candidates : *selected;
+    std::shared_ptr<LocalBatch> projected = std::make_shared<LocalBatch>(result.getRows());
+    for(size_t i = 0;i < selects.size();++i){
+        if(selects[i] == nullptr){
+            for(size_t c = 0;c < inputColumns;++c){
+                projected->addColumn(result.getColumn(c));
+            }
+        }else if(selects[i]->getKind() == LocalExpression::Kind::COLUMN){
+            LocalColumn column = result.getColumn(selects[i]->getColumn());
+            column.setName(names[i]);
+            projected->addColumn(std::move(column));
+        }else{
+            projected->addColumn(selects[i]->evaluate(result,names[i]));
+        }
+    }
+    return emit(projected);
+}
+
+std::shared_ptr<const LocalBatch> LocalWindowOperator::sortInput(){
+    std::vector<std::shared_ptr<const LocalBatch>> batches;
+    for(std::shared_ptr<const LocalBatch> batch = next();batch != nullptr;batch = next()){
+        batches.push_back(batch);
+    }
+    if(batches.empty()){
+        return nullptr;
+    }
+    std::shared_ptr<const LocalBatch> input = LocalBatch::concat(batches);
+    std::vector<LocalColumn> keys;
+    for(const std::shared_ptr<LocalExpression>& sort : sorts){
+        keys.push_back(sort->evaluate(*input,""));
+    }
+    std::vector<int64_t> order(input->getRows());
+    std::iota(order.begin(),order.end(),0);
+    std::stable_sort(order.begin(),order.end(),[&](int64_t left,int64_t right){
+        for(size_t k = 0;k < keys.size();++k){
+            const bool leftNull = keys[k].isNull(left),rightNull = keys[k].isNull(right);
+            if(leftNull || rightNull){
+                if(leftNull != rightNull){
+                    return leftNull;
+                }
+                continue;
+            }
+            const int result = LocalValue::compare(keys[k].get(left),keys[k].get(right));
+            if(result != 0){
+                return descending[k] ? result > 0 : result < 0;
+            }
+        }
+        return false;
+    });
+    return input->select(order);
+}
+
+bool LocalWindowOperator::process(const std::shared_ptr<const LocalBatch>& batch){
+    prepare(batch);
+    start();
+    for(size_t row = 0;row < batch->getRows();++row){
+        if(!consume(row)){
+            return false;
+        }
+    }
+    return end() && flush();
+}
+
+void LocalWindowOperator::run(){
+    if(!sorts.empty()){
+        // 排序需要全部输入，排好序后作为一个批次处理
+        std::shared_ptr<const LocalBatch> input = sortInput();
+        if(input != nullptr && !process(input)){
+            return;
+        }
+        finish();
+        return;
+    }
+    for(std::shared_ptr<const LocalBatch> batch = next();batch != nullptr;batch = next()){
+        if(!process(batch)){
+            return;
+        }
+    }
+    finish();
+}
@@ -0,0 +1,212 @@
+#include "../include/LocalWindowState.h"
+
+#include <algorithm>
+
+namespace {
+
+    LocalValue sumValue(LocalWindowOperator::Function function,int64_t count,int64_t ints,double doubles,bool fractional){
+        if(function == LocalWindowOperator::Function::COUNT){
+            return LocalValue(count);
+        }
+        if(count == 0){
+            return LocalValue();
+        }
+        if(function == LocalWindowOperator::Function::AVG){
+            return LocalValue((ints + doubles) / count);
+        }
+        return fractional ? LocalValue(ints + doubles) : LocalValue(ints);
+    }
+
+    // 把 argument 第 row 行的值写入 column 第 key 行，同为 INT 或 DOUBLE 的非空值直接写入
+    void assign(LocalColumn& column,size_t key,const LocalColumn& argument,size_t row){
+        if(!column.isNull(key) && !argument.isNull(row) && column.getType() == argument.getType()){
+            if(argument.getType() == LocalType::INT){
+                column.getInts()[key] = argument.getInts()[row];
+                return;
+            }
+            if(argument.getType() == LocalType::DOUBLE){
+                column.getDoubles()[key] = argument.getDoubles()[row];
+                return;
+            }
+        }
+        column.set(key,argument.get(row));
+    }
+
+}
+
+LocalWindowState::LocalWindowState(const std::vector<LocalWindowOperator::Call>& calls,size_t arguments) : calls(calls){
+    using Function = LocalWindowOperator::Function;
+    sumIndexes.assign(arguments,-1);
+    valueIndexes.assign(calls.size(),-1);
+    for(size_t c = 0;c < calls.size();++c){
+        switch(calls[c].function){
+            case Function::COUNT:
+            case Function::SUM:
+            case Function::AVG:
+                if(sumIndexes[calls[c].argument] < 0){
+                    sumIndexes[calls[c].argument] = static_cast<int>(counts.size());
+                    counts.emplace_back();
+                    ints.emplace_back();
+                    doubles.emplace_back();
+                    fractional.emplace_back();
+                }
+                break;
+            case Function::MIN:
+            case Function::MAX:
+            case Function::LEAD:
+            case Function::LAG:
+                valueIndexes[c] = static_cast<int>(values.size());
+                values.emplace_back(calls[c].text,LocalType::INT);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+size_t LocalWindowState::getBytesPerKey() const {
+    size_t bytes = sizeof(uint32_t) + counts.size() * (sizeof(int64_t) * 2 + sizeof(double) + sizeof(uint8_t));
+    for(const LocalColumn& column : values){
+        // 值与空值标记
+        bytes += sizeof(uint8_t);
+        switch(column.getType()){
+            case LocalType::INT: bytes += sizeof(int64_t); break;
+            case LocalType::DOUBLE: bytes += sizeof(double); break;
+            default: bytes += sizeof(std::string);
+        }
+    }
+    return bytes;
+}
+
+void LocalWindowState::grow(size_t keys){
+    if(keys <= sizes.size()){
+        return;
+    }
+    sizes.resize(keys,0);
+    for(size_t s = 0;s < counts.size();++s){
+        counts[s].resize(keys,0);
+        ints[s].resize(keys,0);
+        doubles[s].resize(keys,0);
+        fractional[s].resize(keys,0);
+    }
+    for(LocalColumn& column : values){
+        column.reserve(keys);
+        while(column.size() < keys){
+            column.appendNull();
+        }
+    }
+}
+
+void LocalWindowState::reset(uint32_t key){
+    sizes[key] = 0;
+    for(size_t s = 0;s < counts.size();++s){
+        counts[s][key] = 0;
+        ints[s][key] = 0;
+        doubles[s][key] = 0;
+        fractional[s][key] = 0;
+    }
+    for(LocalColumn& column : values){
+        column.set(key,LocalValue());
+    }
+}
+
+LocalValue LocalWindowState::better(size_t call,const LocalValue& current,const LocalValue& value) const {
+    if(current.isNull()){
+        return value;
+    }
+    const int cmp = LocalValue::compare(value,current);
+    return (calls[call].function == LocalWindowOperator::Function::MIN ? cmp < 0 : cmp > 0) ? value : current;
+}
+
+void LocalWindowState::append(uint32_t key,const std::vector<const LocalColumn*>& arguments,size_t row){
+    using Function = LocalWindowOperator::Function;
+    sizes[key]++;
+    for(size_t a = 0;a < sumIndexes.size();++a){
+        const LocalColumn& column = *arguments[a];
+        const int s = sumIndexes[a];
+        if(s < 0 || column.isNull(row)){
+            continue;
+        }
+        counts[s][key]++;
+        if(column.getType() == LocalType::INT){
+            ints[s][key] += column.getInts()[row];
+        }else{
+            doubles[s][key] += column.getType() == LocalType::DOUBLE ? column.getDoubles()[row] : column.get(row).asDouble();
+            fractional[s][key] = 1;
+        }
+    }
+    for(size_t c = 0;c < calls.size();++c){
+        if(valueIndexes[c] < 0){
+            continue;
+        }
+        LocalColumn& column = values[valueIndexes[c]];
+        const LocalColumn& argument = *arguments[calls[c].argument];
+        if(calls[c].function == Function::LAG || (calls[c].function == Function::LEAD && sizes[key] == 1)){
+            assign(column,key,argument,row);
+        }else if((calls[c].function == Function::MIN || calls[c].function == Function::MAX) && !argument.isNull(row)){
+            // 同为 INT 或 DOUBLE 时直接比较，不构造 LocalValue
+            if(!column.isNull(key) && column.getType() == argument.getType() && argument.getType() != LocalType::STRING){
+                const bool lower = calls[c].function == Function::MIN;
+                if(argument.getType() == LocalType::INT){
+                    int64_t& current = column.getInts()[key];
+                    const int64_t value = argument.getInts()[row];
+                    current = lower ? std::min(current,value) : std::max(current,value);
+                }else{
+                    double& current = column.getDoubles()[key];
+                    const double value = argument.getDoubles()[row];
+                    current = lower ? std::min(current,value) : std::max(current,value);
+                }
+                continue;
+            }
+            const LocalValue value = argument.get(row);
+            if(column.isNull(key)){
+                column.set(key,value);
+            }else{
+                const int cmp = LocalValue::compare(value,column.get(key));
+                if(calls[c].function == Function::MIN ? cmp < 0 : cmp > 0){
+                    column.set(key,value);
+                }
+            }
+        }
+    }
+}
+
+LocalValue LocalWindowState::get(size_t call,uint32_t key) const {
+    const LocalWindowOperator::Call& mycall = calls[call];
+    if(mycall.function == LocalWindowOperator::Function::SIZE){
+        return LocalValue(static_cast<int64_t>(sizes[key]));
+    }
+    if(valueIndexes[call] >= 0){
+        return values[valueIndexes[call]].get(key);
+    }
+    const int s = sumIndexes[mycall.argument];
+    return sumValue(mycall.function,counts[s][key],ints[s][key],doubles[s][key],fractional[s][key] != 0);
+}
+
+LocalValue LocalWindowState::get(size_t call,uint32_t key,const std::vector<const LocalColumn*>& arguments,size_t row) const {
+    using Function = LocalWindowOperator::Function;
+    const LocalWindowOperator::Call& mycall = calls[call];
+    if(mycall.function == Function::SIZE){
+        return LocalValue(static_cast<int64_t>(sizes[key]) + 1);
+    }
+    const LocalColumn& argument = *arguments[mycall.argument];
+    switch(mycall.function){
+        case Function::LEAD:
+            return sizes[key] == 0 ? argument.get(row) : values[valueIndexes[call]].get(key);
+        case Function::LAG:
+            return argument.get(row);
+        case Function::MIN:
+        case Function::MAX:
+            return argument.isNull(row) ? get(call,key) : better(call,values[valueIndexes[call]].get(key),argument.get(row));
+        default:
+            break;
+    }
+    if(argument.isNull(row)){
+        return get(call,key);
+    }
+    const int s = sumIndexes[mycall.argument];
+    const LocalValue value = argument.get(row);
+    const bool integral = value.getType() == LocalType::INT;
+    return sumValue(mycall.function,counts[s][key] + 1,ints[s][key] + (integral ? value.asInt() : 0),doubles[s][key] + (integral ? 0 : value.asDouble()),
+                    fractional[s][key] != 0 || !integral);
+}
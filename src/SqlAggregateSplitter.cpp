@@ -0,0 +1,85 @@
+#include "../include/SqlAggregateSplitter.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "XStringUtils.h"
+
+#include <algorithm>
+#include <vector>
+
+const std::string SqlAggregateSplitter::STATE_PREFIX = "partial_";
+
+namespace {
+
+    // 部分状态可以直接合并的聚合
+    bool isDecomposable(const std::string& name){
+        return name == "sum" || name == "count" || name == "min" || name == "max" || name == "avg";
+    }
+
+}
+
+bool SqlAggregateSplitter::split(const std::string& keys,const std::string& selects,const std::string& reserved,std::string& states){
+    std::vector<std::string> names;
+    for(const std::string& key : SqlSyntaxUtils::splitExpressions(keys)){
+        if(!SqlSyntaxUtils::isIdentifier(XStringUtils::trim(key))){
+            return false;
+        }
+        names.push_back(SqlSyntaxUtils::normalizeExpression(key));
+    }
+    if(SqlSyntaxUtils::isStateful(selects)){
+        return false;
+    }
+    // 不含聚合的 select 项在合并时只能取 key 的值
+    for(const std::string& item : SqlSyntaxUtils::splitExpressions(selects)){
+        const std::string expr = SqlSyntaxUtils::normalizeExpression(SqlSyntaxUtils::removeExpressionAlias(item));
+        bool aggregated = false;
+        for(const std::string& call : SqlSyntaxUtils::findFunctionCalls(expr)){
+            aggregated = aggregated || SqlSyntaxUtils::isAggregateFunction(call.substr(0,call.find('(')));
+        }
+        if(!aggregated && std::find(names.begin(),names.end(),expr) == names.end()){
+            return false;
+        }
+    }
+
+    std::vector<std::string> calls,seen;
+    for(const std::string& call : SqlSyntaxUtils::findFunctionCalls(selects)){
+        const std::string name = XStringUtils::toLowerCase(XStringUtils::trim(call.substr(0,call.find('('))));
+        if(!SqlSyntaxUtils::isAggregateFunction(name)){
+            continue;
+        }
+        const std::string argument = XStringUtils::trim(call.substr(call.find('(') + 1,call.rfind(')') - call.find('(') - 1));
+        if(!isDecomposable(name) || XStringUtils::toLowerCase(argument).rfind("distinct",0) == 0){
+            return false;
+        }
+        for(const std::string& inner : SqlSyntaxUtils::findFunctionCalls(argument)){
+            if(SqlSyntaxUtils::isAggregateFunction(inner.substr(0,inner.find('(')))){
+                return false;
+            }
+        }
+        const std::vector<std::string> parts = name == "avg" ?
+            std::vector<std::string>{"sum(" + argument + ")","count(" + argument + ")"} : std::vector<std::string>{XStringUtils::trim(call)};
+        for(const std::string& part : parts){
+            const std::string normalized = SqlSyntaxUtils::normalizeExpression(part);
+            bool duplicate = false;
+            for(const std::string& s : seen){
+                duplicate = duplicate || s == normalized;
+            }
+            if(!duplicate){
+                seen.push_back(normalized);
+                calls.push_back(part);
+            }
+        }
+    }
+    if(calls.empty()){
+        return false;
+    }
+
+    states.clear();
+    int next = 0;
+    for(const std::string& call : calls){
+        std::string name;
+        do{
+            name = STATE_PREFIX + std::to_string(next++);
+        }while(reserved.find(name) != std::string::npos);
+        states += (states.empty() ? "" : ", ") + call + " as " + name;
+    }
+    return true;
+}
@@ -0,0 +1,482 @@
+#include "../include/SqlCostEstimator.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "../include/SqlPredicateSimplifier.h"
+#include "../include/TableRelation.h"
+#include "XStringUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+SqlCostEstimator::SqlCostEstimator(std::shared_ptr<StatisticsCatalog> catalog) : catalog(catalog){}
+
+std::shared_ptr<StatisticsCatalog> SqlCostEstimator::getCatalog() const {
+    return catalog;
+}
+
+SqlStepEstimate SqlCostEstimator::record(int id,const SqlStepEstimate& estimate){
+    estimates[id] = estimate;
+    return estimate;
+}
+
+double SqlCostEstimator::joinSelectivity(int left,const std::string& leftKey,int right,const std::string& rightKey) const {
+    const SqlStepEstimate l = get(left),r = get(right);
+    return 1.0 / std::max(1.0,std::max(distinctCount(l.getStatistics(),leftKey,l.getRows()),
+                                       distinctCount(r.getStatistics(),rightKey,r.getRows())));
+}
+
+bool SqlCostEstimator::fitsInMemory(int id,double budget) const {
+    const SqlStepEstimate estimate = get(id);
+    return has(id) && estimate.isFromStatistics() && estimate.getBytes() <= budget;
+}
+
+bool SqlCostEstimator::isBroadcastJoin(SqlJoinType type,const std::shared_ptr<SqlRelation>& relation,int buildSpool,
+                                       const std::unordered_set<std::string>& hints,double budget) const {
+    if(type != SqlJoinType::JOIN && type != SqlJoinType::INNER && type != SqlJoinType::LEFT){
+        return false;
+    }
+    if(relation != nullptr){
+        if(hints.count(relation->getAlias()) > 0){
+            return true;
+        }
+        std::shared_ptr<TableRelation> table = std::dynamic_pointer_cast<TableRelation>(relation);
+        if(table != nullptr && hints.count(table->getName()) > 0){
+            return true;
+        }
+    }
+    return fitsInMemory(buildSpool,budget);
+}
+
+bool SqlCostEstimator::has(int id) const {
+    return estimates.find(id) != estimates.end();
+}
+
+SqlStepEstimate SqlCostEstimator::get(int id) const {
+    auto iter = estimates.find(id);
+    return iter == estimates.end() ? SqlStepEstimate() : iter->second;
+}
+
+SqlStepEstimate SqlCostEstimator::input(int id,const std::string& table){
+    std::shared_ptr<TableStatistics> statistics = catalog == nullptr ? nullptr : catalog->getTableStatistics(table);
+    double rows = DEFAULT_ROW_COUNT,width = DEFAULT_ROW_WIDTH;
+    if(statistics != nullptr){
+        if(statistics->getRowCount() >= 0){
+            rows = statistics->getRowCount();
+        }
+        if(statistics->getWidth() > 0){
+            width = statistics->getWidth();
+        }else if(!statistics->getColumns().empty()){
+            width = 0;
+            for(const auto& column : statistics->getColumns()){
+                width += column.second->getWidth() > 0 ? column.second->getWidth() : DEFAULT_COLUMN_WIDTH;
+            }
+        }
+    }
+    SqlStepEstimate estimate(rows,width,rows);
+    estimate.setStatistics(statistics);
+    estimate.setFromStatistics(statistics != nullptr && statistics->getRowCount() >= 0);
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::empty(int id){
+    SqlStepEstimate estimate(0,0,0);
+    estimate.setFromStatistics(true);
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::filter(int id,int input,const std::string& condition){
+    const SqlStepEstimate in = get(input);
+    SqlStepEstimate estimate(in.getRows() * selectivity(condition,in.getStatistics()),in.getWidth(),in.getCost() + in.getRows());
+    estimate.setStatistics(in.getStatistics());
+    estimate.setFromStatistics(in.isFromStatistics());
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::project(int id,int input,const std::string& selects){
+    const SqlStepEstimate in = get(input);
+    std::shared_ptr<TableStatistics> statistics = std::make_shared<TableStatistics>();
+    double width = 0;
+    for(const std::string& item : SqlSyntaxUtils::splitExpressions(selects)){
+        if("*" == item){
+            width += in.getWidth();
+            if(in.getStatistics() != nullptr){
+                for(const auto& column : in.getStatistics()->getColumns()){
+                    statistics->setColumn(column.first,column.second);
+                }
+            }
+            continue;
+        }
+        const std::string expr = SqlSyntaxUtils::removeExpressionAlias(item);
+        std::string alias = SqlSyntaxUtils::getExpressionAlias(item);
+        std::shared_ptr<ColumnStatistics> column = nullptr;
+        if(SqlSyntaxUtils::isIdentifier(expr) && in.getStatistics() != nullptr){
+            column = in.getStatistics()->getColumn(expr);
+        }
+        if(alias.empty()){
+            alias = expr.substr(expr.rfind('.') == std::string::npos ? 0 : expr.rfind('.') + 1);
+        }
+        if(column != nullptr){
+            statistics->setColumn(alias,column);
+        }
+        width += column != nullptr && column->getWidth() > 0 ? column->getWidth() : DEFAULT_COLUMN_WIDTH;
+    }
+    // 没有 GROUP BY 的全局聚合也由 Project 计算，不论输入多少行（包括没有行）都只输出一行
+    const double rows = SqlSyntaxUtils::hasAggregateCall(selects) ? 1 : in.getRows();
+    SqlStepEstimate estimate(rows,width,in.getCost() + in.getRows());
+    estimate.setStatistics(statistics);
+    estimate.setFromStatistics(in.isFromStatistics());
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::aggregate(int id,int input,const std::string& keys,const std::string& selects){
+    const SqlStepEstimate in = get(input);
+    double groups;
+    if(XStringUtils::isBlank(keys)){
+        // 没有 keys 的聚合步骤只有按时间桶的 StreamAggregate，每个桶一行；全局聚合见 project
+        groups = std::max(1.0,in.getRows() * DEFAULT_GROUP_RATIO);
+    }else{
+        groups = 1;
+        for(const std::string& key : SqlSyntaxUtils::splitExpressions(keys)){
+            groups *= distinctCount(in.getStatistics(),key,in.getRows());
+        }
+    }
+    groups = std::min(groups,in.getRows());
+
+    const double width = SqlSyntaxUtils::splitExpressions(selects).size() * DEFAULT_COLUMN_WIDTH;
+    // 哈希聚合每行一次探测和一次更新
+    SqlStepEstimate estimate(groups,width,in.getCost() + 2 * in.getRows());
+    estimate.setStatistics(in.getStatistics());
+    estimate.setFromStatistics(in.isFromStatistics());
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::window(int id,int input){
+    const SqlStepEstimate in = get(input);
+    SqlStepEstimate estimate(in.getRows(),in.getWidth(),in.getCost() + 2 * in.getRows());
+    estimate.setStatistics(in.getStatistics());
+    estimate.setFromStatistics(in.isFromStatistics());
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::join(int id,int left,int right,
+                                       const std::vector<std::string>& leftKeys,
+                                       const std::vector<std::string>& rightKeys,
+                                       const std::string& condition,
+                                       const std::string& joinType,
+                                       bool broadcast){
+    const SqlStepEstimate l = get(left),r = get(right);
+
+    std::shared_ptr<TableStatistics> statistics = std::make_shared<TableStatistics>();
+    for(const std::shared_ptr<TableStatistics>& side : {r.getStatistics(),l.getStatistics()}){
+        if(side != nullptr){
+            for(const auto& column : side->getColumns()){
+                statistics->setColumn(column.first,column.second);
+            }
+        }
+    }
+
+    double rows = l.getRows() * r.getRows(),cost;
+    if(!leftKeys.empty() && leftKeys.size() == rightKeys.size()){
+        for(size_t i = 0;i < leftKeys.size();++i){
+            rows /= std::max(1.0,std::max(distinctCount(l.getStatistics(),leftKeys.at(i),l.getRows()),
+                                          distinctCount(r.getStatistics(),rightKeys.at(i),r.getRows())));
+        }
+        if(XStringUtils::isNotBlank(condition)){
+            rows *= selectivity(condition,statistics);
+        }
+        // 分区连接两侧各分区一次再建表探测，广播连接只需建表和探测
+        cost = l.getCost() + r.getCost() + (broadcast ? 1 : 2) * (l.getRows() + r.getRows());
+    }else{
+        rows *= selectivity(condition,statistics);
+        cost = l.getCost() + r.getCost() + l.getRows() * r.getRows();
+    }
+
+    const std::string type = XStringUtils::toLowerCase(joinType);
+    if(type == "left"){
+        rows = std::max(rows,l.getRows());
+    }else if(type == "right"){
+        rows = std::max(rows,r.getRows());
+    }else if(type == "full" || type == "outer"){
+        rows = std::max(rows,l.getRows() + r.getRows());
+    }
+
+    SqlStepEstimate estimate(rows,l.getWidth() + r.getWidth(),cost + rows);
+    estimate.setStatistics(statistics);
+    estimate.setFromStatistics(l.isFromStatistics() && r.isFromStatistics());
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::intervalJoin(int id,int left,int right,
+                                               const std::vector<std::string>& leftKeys,
+                                               const std::vector<std::string>& rightKeys,
+                                               const std::string& residual,
+                                               const std::string& joinType){
+    const SqlStepEstimate l = get(left),r = get(right);
+    SqlStepEstimate estimate = join(id,left,right,leftKeys,rightKeys,residual,joinType);
+    estimate.setRows(estimate.getRows() * DEFAULT_RANGE_SELECTIVITY);
+    // 构建侧建哈希表（有 key）或按时间排序（没有 key），左侧每行查找一次
+    estimate.setCost(l.getCost() + r.getCost() + (leftKeys.empty() ? 1 : 2) * (l.getRows() + r.getRows()) + estimate.getRows());
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::asofJoin(int id,int left,int right,
+                                           const std::vector<std::string>& leftKeys,
+                                           const std::vector<std::string>& rightKeys){
+    const SqlStepEstimate l = get(left),r = get(right);
+    SqlStepEstimate estimate = join(id,left,right,leftKeys,rightKeys,"","left");
+    estimate.setRows(l.getRows());
+    estimate.setCost(l.getCost() + r.getCost() + (leftKeys.empty() ? 1 : 2) * (l.getRows() + r.getRows()) + l.getRows());
+    return record(id,estimate);
+}
+
+double SqlCostEstimator::bloomItems(int build,const std::vector<std::string>& keys) const {
+    const SqlStepEstimate in = get(build);
+    double items = 1;
+    for(const std::string& key : keys){
+        std::shared_ptr<ColumnStatistics> stats = in.getStatistics() == nullptr ? nullptr : in.getStatistics()->getColumn(XStringUtils::trim(key));
+        // 没有统计时按行数取上界，过滤器宁大勿小，否则实际误判率会超出设定
+        if(stats == nullptr || stats->getDistinctCount() <= 0){
+            return std::max(1.0,in.getRows());
+        }
+        items *= stats->getDistinctCount();
+    }
+    return std::max(1.0,std::min(items,in.getRows()));
+}
+
+double SqlCostEstimator::bloomSelectivity(int probe,const std::vector<std::string>& probeKeys,
+                                          int build,const std::vector<std::string>& buildKeys,double falsePositiveRate) const {
+    const SqlStepEstimate in = get(probe);
+    double probeItems = 1;
+    for(const std::string& key : probeKeys){
+        probeItems *= distinctCount(in.getStatistics(),key,in.getRows());
+    }
+    // 假设值域包含：构建侧的不同值都能在探测侧找到
+    const double matched = std::min(1.0,bloomItems(build,buildKeys) / std::max(1.0,std::min(probeItems,in.getRows())));
+    return matched + (1 - matched) * falsePositiveRate;
+}
+
+double SqlCostEstimator::bloomBits(double items,double falsePositiveRate){
+    return std::ceil(-items * std::log(falsePositiveRate) / (std::log(2.0) * std::log(2.0)));
+}
+
+int SqlCostEstimator::bloomHashes(double bits,double items){
+    return std::max(1,static_cast<int>(std::lround(bits / std::max(1.0,items) * std::log(2.0))));
+}
+
+SqlStepEstimate SqlCostEstimator::bloomBuild(int id,int build,const std::vector<std::string>& keys,double falsePositiveRate){
+    const SqlStepEstimate in = get(build);
+    const double bits = bloomBits(bloomItems(build,keys),falsePositiveRate);
+    SqlStepEstimate estimate(1,std::ceil(bits / 8),in.getCost() + in.getRows());
+    estimate.setFromStatistics(in.isFromStatistics());
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::bloomFilter(int id,int probe,const std::vector<std::string>& probeKeys,
+                                              int build,const std::vector<std::string>& buildKeys,double falsePositiveRate){
+    const SqlStepEstimate in = get(probe);
+    const double rows = in.getRows() * bloomSelectivity(probe,probeKeys,build,buildKeys,falsePositiveRate);
+    SqlStepEstimate estimate(rows,in.getWidth(),in.getCost() + in.getRows());
+    estimate.setStatistics(in.getStatistics());
+    estimate.setFromStatistics(in.isFromStatistics() && get(build).isFromStatistics());
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::take(int id,int input,int rows){
+    const SqlStepEstimate in = get(input);
+    const double taken = std::min(in.getRows(),static_cast<double>(rows));
+    SqlStepEstimate estimate(taken,in.getWidth(),in.getCost() + taken);
+    estimate.setStatistics(in.getStatistics());
+    estimate.setFromStatistics(in.isFromStatistics());
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::exchange(int id,int input){
+    const SqlStepEstimate in = get(input);
+    SqlStepEstimate estimate(in.getRows(),in.getWidth(),in.getCost() + in.getRows());
+    estimate.setStatistics(in.getStatistics());
+    estimate.setFromStatistics(in.isFromStatistics());
+    return record(id,estimate);
+}
+
+SqlStepEstimate SqlCostEstimator::output(int id,int input){
+    const SqlStepEstimate in = get(input);
+    SqlStepEstimate estimate(in.getRows(),in.getWidth(),in.getCost() + in.getRows());
+    estimate.setStatistics(in.getStatistics());
+    estimate.setFromStatistics(in.isFromStatistics());
+    return record(id,estimate);
+}
+
+double SqlCostEstimator::distinctCount(const std::shared_ptr<TableStatistics>& statistics,const std::string& column,double rows) const {
+    std::shared_ptr<ColumnStatistics> stats = statistics == nullptr ? nullptr : statistics->getColumn(XStringUtils::trim(column));
+    if(stats != nullptr && stats->getDistinctCount() > 0){
+        return std::min(stats->getDistinctCount(),std::max(1.0,rows));
+    }
+    return std::max(1.0,rows * DEFAULT_GROUP_RATIO);
+}
+
+double SqlCostEstimator::selectivity(const std::string& condition,const std::shared_ptr<TableStatistics>& statistics) const {
+    if(XStringUtils::isBlank(condition)){
+        return 1;
+    }
+    const std::vector<std::string> disjuncts = SqlSyntaxUtils::splitConditions(condition,"or");
+    if(disjuncts.size() > 1){
+        double miss = 1;
+        for(const std::string& disjunct : disjuncts){
+            miss *= 1 - selectivity(disjunct,statistics);
+        }
+        return 1 - miss;
+    }
+    const std::vector<std::string> conjuncts = SqlSyntaxUtils::splitConditions(condition,"and");
+    if(conjuncts.size() > 1){
+        double selected = 1;
+        for(const std::string& conjunct : conjuncts){
+            selected *= selectivity(conjunct,statistics);
+        }
+        return selected;
+    }
+    return predicateSelectivity(condition,statistics);
+}
+
+double SqlCostEstimator::predicateSelectivity(const std::string& predicate,const std::shared_ptr<TableStatistics>& statistics) const {
+    std::string p = XStringUtils::trim(predicate);
+    if(p.size() >= 2 && p.front() == '(' && p.back() == ')'){
+        int depth = 0;
+        bool wrapped = true;
+        for(size_t i = 0;i + 1 < p.size() && wrapped;++i){
+            depth += p.at(i) == '(' ? 1 : (p.at(i) == ')' ? -1 : 0);
+            wrapped = depth > 0;
+        }
+        if(wrapped){
+            return selectivity(p.substr(1,p.size() - 2),statistics);
+        }
+    }
+    const std::string lower = XStringUtils::toLowerCase(p);
+    if(lower.rfind("not ",0) == 0){
+        return 1 - selectivity(p.substr(4),statistics);
+    }
+    if(SqlPredicateSimplifier::isAlwaysTrue(lower)){
+        return 1;
+    }
+    if(SqlPredicateSimplifier::isAlwaysFalse(lower)){
+        return 0;
+    }
+
+    auto columnOf = [&statistics](const std::string& name) -> std::shared_ptr<ColumnStatistics> {
+        const std::string trimmed = XStringUtils::trim(name);
+        if(statistics == nullptr || !SqlSyntaxUtils::isIdentifier(trimmed)){
+            return nullptr;
+        }
+        return statistics->getColumn(trimmed);
+    };
+    auto nullFraction = [](const std::shared_ptr<ColumnStatistics>& column){
+        return column != nullptr && column->getNullFraction() >= 0 ? column->getNullFraction() : DEFAULT_NULL_FRACTION;
+    };
+    auto equality = [](const std::shared_ptr<ColumnStatistics>& column){
+        return column != nullptr && column->getDistinctCount() > 0 ? 1 / column->getDistinctCount() : DEFAULT_EQUALITY_SELECTIVITY;
+    };
+    auto notNull = [](const std::shared_ptr<ColumnStatistics>& column){
+        return column != nullptr && column->getNullFraction() >= 0 ? 1 - column->getNullFraction() : 1.0;
+    };
+    auto number = [](const std::string& text,double& value){
+        const std::string trimmed = XStringUtils::trim(text);
+        char* end = nullptr;
+        value = std::strtod(trimmed.c_str(),&end);
+        return !trimmed.empty() && end == trimmed.c_str() + trimmed.size();
+    };
+    auto range = [&](const std::shared_ptr<ColumnStatistics>& column,double from,double to){
+        if(column == nullptr || !column->hasMinMax() || column->getMax() <= column->getMin()){
+            return DEFAULT_RANGE_SELECTIVITY;
+        }
+        from = std::max(from,column->getMin());
+        to = std::min(to,column->getMax());
+        return to < from ? 0.0 : (to - from) / (column->getMax() - column->getMin()) * notNull(column);
+    };
+
+    size_t idx;
+    if(lower.size() > 8 && lower.compare(lower.size() - 8,8," is null") == 0){
+        return nullFraction(columnOf(p.substr(0,p.size() - 8)));
+    }
+    if(lower.size() > 12 && lower.compare(lower.size() - 12,12," is not null") == 0){
+        return 1 - nullFraction(columnOf(p.substr(0,p.size() - 12)));
+    }
+    if((idx = lower.find(" between ")) != std::string::npos){
+        const std::string bounds = p.substr(idx + 9);
+        const size_t andIdx = XStringUtils::toLowerCase(bounds).find(" and ");
+        double from,to;
+        const bool negated = lower.compare(idx >= 4 ? idx - 4 : 0,4," not") == 0;
+        std::shared_ptr<ColumnStatistics> column = columnOf(p.substr(0,negated ? idx - 4 : idx));
+        double selected = DEFAULT_SELECTIVITY;
+        if(andIdx != std::string::npos && number(bounds.substr(0,andIdx),from) && number(bounds.substr(andIdx + 5),to)){
+            selected = range(column,from,to);
+        }
+        return negated ? 1 - selected : selected;
+    }
+    if((idx = lower.find(" in (")) != std::string::npos && p.back() == ')'){
+        const bool negated = lower.compare(idx >= 4 ? idx - 4 : 0,4," not") == 0;
+        std::shared_ptr<ColumnStatistics> column = columnOf(p.substr(0,negated ? idx - 4 : idx));
+        const size_t values = SqlSyntaxUtils::splitExpressions(p.substr(idx + 5,p.size() - idx - 6)).size();
+        const double selected = std::min(1.0,values * equality(column));
+        return negated ? 1 - selected : selected;
+    }
+    if(lower.find(" like ") != std::string::npos){
+        return DEFAULT_SELECTIVITY;
+    }
+
+    // 比较运算：在引号和括号之外找第一个比较符
+    int depth = 0;
+    bool quoted = false;
+    for(size_t i = 0;i < p.size();++i){
+        const char c = p.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+        }
+        if(quoted){
+            continue;
+        }
+        depth += c == '(' ? 1 : (c == ')' ? -1 : 0);
+        if(depth != 0 || !(c == '=' || c == '!' || c == '<' || c == '>')){
+            continue;
+        }
+        const std::string two = p.substr(i,2);
+        std::string op = two == "==" || two == "!=" || two == "<>" || two == "<=" || two == ">=" ? two : std::string(1,c);
+        if(op == "!"){
+            break;
+        }
+        std::string left = p.substr(0,i),right = p.substr(i + op.size());
+        std::shared_ptr<ColumnStatistics> column = columnOf(left);
+        if(column == nullptr && columnOf(right) != nullptr){
+            column = columnOf(right);
+            std::swap(left,right);
+            op = op == "<" ? ">" : (op == ">" ? "<" : (op == "<=" ? ">=" : (op == ">=" ? "<=" : op)));
+        }
+        if(op == "=" || op == "=="){
+            return equality(column) * notNull(column);
+        }
+        if(op == "!=" || op == "<>"){
+            return (1 - equality(column)) * notNull(column);
+        }
+        double value;
+        if(!number(right,value)){
+            return DEFAULT_RANGE_SELECTIVITY;
+        }
+        if(op == ">" || op == ">="){
+            return range(column,value,HUGE_VAL);
+        }
+        return range(column,-HUGE_VAL,value);
+    }
+    return DEFAULT_SELECTIVITY;
+}
+
+int SqlCostEstimator::stepId(const std::string& step){
+    const size_t idx = step.find("id=d_");
+    if(idx == std::string::npos){
+        return -1;
+    }
+    return std::atoi(step.c_str() + idx + 5);
+}
+
+std::string SqlCostEstimator::explain(const std::string& step,const SqlStepEstimate& estimate){
+    return step + " [rows=" + std::to_string(std::llround(estimate.getRows())) +
+           ", width=" + std::to_string(std::llround(estimate.getWidth())) +
+           ", cost=" + std::to_string(std::llround(estimate.getCost())) + "]";
+}
@@ -1,9 +1,17 @@
 #include "../include/SqlDistributedPlanner.h"
 #include "../include/SqlRelation.h"
 #include <algorithm> 
+#include <cmath>
+#include <functional>
+#include <map>
+#include <set>
+#include <sstream>
 #include "../../exd-compute-lib-v2/source/exd/pervasive/iot/common/util/mutable/MutableInt.h"
 #include "../../exd-compute-lib-v2/source/exd/pervasive/iot/common/util/ClassDefinition.h"
 #include "../include/ProtocolRelation.h"
+#include "../include/SqlQueryRewriter.h"
+#include "../include/SqlAggregateSplitter.h"
+#include "../include/SqlSyntaxUtils.h"
 std::shared_ptr<SqlDistributedPlan> SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt){
     std::vector<std::shared_ptr<ClassDefinition>> cloudSteps;
     std::vector<std::shared_ptr<ClassDefinition>> edgeSteps;
@@ -11,20 +19,569 @@ std::shared_ptr<SqlDistributedPlan> SqlDistributedPlanner::plan(const std::share
     std::shared_ptr<MutableInt> currentId = std::make_shared<MutableInt>(-1);
     std::shared_ptr<MutableInt> lastSpool = std::make_shared<MutableInt>(-1);
 
-    plan(stmt,cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
+    std::vector<std::string> diagnostics;
+    estimator = std::make_shared<SqlCostEstimator>(catalog);
+    plan(SqlQueryRewriter::rewrite(stmt,diagnostics),cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
 
     std::vector<std::string> cloudPlan;
     for(auto step : cloudSteps){
         cloudPlan.push_back(step->toString());
     }
-
     std::vector<std::string> edgePlan;
     for(auto step : edgeSteps){
         edgePlan.push_back(step->toString());
     }
-    return std::make_shared<SqlDistributedPlan>(cloudPlan,edgePlan);
+    chooseCut(edgePlan,cloudPlan);
+
+    std::vector<SqlStepEstimate> cloudEstimates;
+    for(const std::string& step : cloudPlan){
+        cloudEstimates.push_back(estimator->get(SqlCostEstimator::stepId(step)));
+    }
+    std::vector<SqlStepEstimate> edgeEstimates;
+    for(const std::string& step : edgePlan){
+        edgeEstimates.push_back(estimator->get(SqlCostEstimator::stepId(step)));
+    }
+    std::shared_ptr<SqlDistributedPlan> result = std::make_shared<SqlDistributedPlan>(cloudPlan,edgePlan,diagnostics);
+    result->setCloudEstimates(cloudEstimates);
+    result->setEdgeEstimates(edgeEstimates);
+    result->setUploadBytesPerSecond(uploadBytesPerSecond(edgePlan,cloudPlan));
+    if(tiers.size() >= 2){
+        placeTiers(edgePlan,cloudPlan,currentId->getValue() + 1,result);
+    }
+    return result;
+}
+
+namespace {
+
+    // 步骤类名
+    std::string operatorOf(const std::string& step){
+        return step.substr(0,step.find('?'));
+    }
+
+    // 步骤属性 attribute（input / input2）引用的 spool，没有时返回 -1
+    int spoolOf(const std::string& step,const std::string& attribute){
+        const std::string key = "," + attribute + "=s_";
+        const size_t idx = step.find(key);
+        if(idx == std::string::npos || idx > step.find('(')){
+            return -1;
+        }
+        return std::atoi(step.c_str() + idx + key.size());
+    }
+
+    // 步骤 input、input2 引用的 spool
+    std::vector<int> inputSpools(const std::string& step){
+        std::vector<int> spools;
+        for(const char* attribute : {"input","input2"}){
+            const int spool = spoolOf(step,attribute);
+            if(spool >= 0){
+                spools.push_back(spool);
+            }
+        }
+        return spools;
+    }
+
+    // BloomFilter 参数 bloom 引用的 spool（BloomBuild 的输出），没有时返回 -1
+    int bloomSpoolOf(const std::string& step){
+        const std::string key = "bloom=`s_";
+        const size_t idx = step.find(key);
+        if(idx == std::string::npos || idx < step.find('(')){
+            return -1;
+        }
+        return std::atoi(step.c_str() + idx + key.size());
+    }
+
+    // 把 BloomFilter 参数 bloom 引用的 spool 改为 spool
+    std::string replaceBloomSpool(const std::string& step,int spool){
+        const std::string key = "bloom=`s_";
+        const size_t begin = step.find(key,step.find('(')) + key.size();
+        const size_t end = step.find_first_not_of("0123456789",begin);
+        return step.substr(0,begin) + std::to_string(spool) + step.substr(end);
+    }
+
+    // 把步骤属性 attribute 引用的 spool 改为 spool
+    std::string replaceSpool(const std::string& step,const std::string& attribute,int spool){
+        const std::string key = "," + attribute + "=s_";
+        const size_t begin = step.find(key) + key.size();
+        const size_t end = step.find_first_not_of("0123456789",begin);
+        return step.substr(0,begin) + std::to_string(spool) + step.substr(end);
+    }
+
+}
+
+void SqlDistributedPlanner::setEdgeMemoryBudget(double bytes){
+    this->edgeMemoryBudget = bytes;
+}
+
+double SqlDistributedPlanner::uploadBytes(const std::vector<std::string>& edgePlan,const std::vector<std::string>& cloudPlan) const {
+    if(cloudPlan.empty()){
+        return edgePlan.empty() || operatorOf(edgePlan.back()) == "Output" ? 0 : estimator->get(SqlCostEstimator::stepId(edgePlan.back())).getBytes();
+    }
+    std::set<int> produced,uploaded;
+    for(const std::string& step : edgePlan){
+        produced.insert(SqlCostEstimator::stepId(step));
+    }
+    double bytes = 0;
+    for(const std::string& step : cloudPlan){
+        // 数据都来自边缘，云端的输入同样需要整表上传
+        if(operatorOf(step) == "Input"){
+            bytes += estimator->get(SqlCostEstimator::stepId(step)).getBytes();
+            continue;
+        }
+        for(int spool : inputSpools(step)){
+            if(produced.count(spool) > 0 && uploaded.insert(spool).second){
+                bytes += estimator->get(spool).getBytes();
+            }
+        }
+    }
+    return bytes;
+}
+
+double SqlDistributedPlanner::uploadBytesPerSecond(const std::vector<std::string>& edgePlan,const std::vector<std::string>& cloudPlan) const {
+    // 估算的行数对应的时长：所有输入的总行数除以每秒产生的总行数
+    std::vector<std::string> steps = edgePlan;
+    steps.insert(steps.end(),cloudPlan.begin(),cloudPlan.end());
+    double rows = 0,rate = 0;
+    for(const std::string& step : steps){
+        if(operatorOf(step) != "Input"){
+            continue;
+        }
+        const SqlStepEstimate input = estimator->get(SqlCostEstimator::stepId(step));
+        rows += input.getRows();
+        rate += input.getStatistics() != nullptr && input.getStatistics()->getRate() > 0 ?
+                input.getStatistics()->getRate() : SqlCostEstimator::DEFAULT_ROW_RATE;
+    }
+    return rows > 0 ? uploadBytes(edgePlan,cloudPlan) * rate / rows : 0;
+}
+
+void SqlDistributedPlanner::pullToEdge(std::vector<std::string>& edgePlan,std::vector<std::string>& cloudPlan) const {
+    const int size = cloudPlan.size();
+    std::map<int,int> producer;
+    for(int i = 0;i < size;++i){
+        producer[SqlCostEstimator::stepId(cloudPlan.at(i))] = i;
+    }
+    // 每个云端步骤的云端下游
+    std::vector<std::vector<int>> consumers(size);
+    for(int i = 0;i < size;++i){
+        for(int spool : inputSpools(cloudPlan.at(i))){
+            if(producer.count(spool) > 0){
+                consumers.at(producer[spool]).push_back(i);
+            }
+        }
+    }
+
+    // 从云端的输入开始只有一个下游的 Filter / Project 链，拉回边缘的部分取上传字节最少的长度
+    std::vector<bool> pulled(size,false);
+    for(int i = 0;i < size;++i){
+        if(operatorOf(cloudPlan.at(i)) != "Input"){
+            continue;
+        }
+        std::vector<int> chain = {i};
+        while(consumers.at(chain.back()).size() == 1){
+            const int next = consumers.at(chain.back()).front();
+            const std::string name = operatorOf(cloudPlan.at(next));
+            if(name != "Filter" && name != "Project"){
+                break;
+            }
+            chain.push_back(next);
+        }
+        // 只拉回输入不减少上传的字节
+        double bestBytes = estimator->get(SqlCostEstimator::stepId(cloudPlan.at(i))).getBytes();
+        int best = 0;
+        for(int c = 1;c < static_cast<int>(chain.size());++c){
+            const double bytes = estimator->get(SqlCostEstimator::stepId(cloudPlan.at(chain.at(c)))).getBytes();
+            if(bytes < bestBytes){
+                bestBytes = bytes;
+                best = c;
+            }
+        }
+        for(int c = 0;best > 0 && c <= best;++c){
+            pulled.at(chain.at(c)) = true;
+        }
+    }
+
+    std::vector<std::string> cloud;
+    for(int i = 0;i < size;++i){
+        (pulled.at(i) ? edgePlan : cloud).push_back(cloudPlan.at(i));
+    }
+    cloudPlan = cloud;
+}
+
+void SqlDistributedPlanner::chooseCut(std::vector<std::string>& edgePlan,std::vector<std::string>& cloudPlan) const {
+    pullToEdge(edgePlan,cloudPlan);
+    if(cloudPlan.empty() && edgeMemoryBudget < 0){
+        return;
+    }
+    const int size = edgePlan.size();
+    std::map<int,int> producer;
+    for(int i = 0;i < size;++i){
+        producer[SqlCostEstimator::stepId(edgePlan.at(i))] = i;
+    }
+    // 每个边缘步骤的边缘下游，以及是否被云端步骤读取
+    std::vector<std::vector<int>> consumers(size);
+    std::vector<bool> uploaded(size,false);
+    for(int i = 0;i < size;++i){
+        for(int spool : inputSpools(edgePlan.at(i))){
+            if(producer.count(spool) > 0){
+                consumers.at(producer[spool]).push_back(i);
+            }
+        }
+    }
+    for(const std::string& step : cloudPlan){
+        for(int spool : inputSpools(step)){
+            if(producer.count(spool) > 0){
+                uploaded.at(producer[spool]) = true;
+            }
+        }
+    }
+
+    // 超出内存预算的步骤连同下游一起移到云端，输入始终留在边缘
+    std::vector<bool> moved(size,false);
+    for(int i = 0;i < size;++i){
+        const std::string name = operatorOf(edgePlan.at(i));
+        if(name != "Input" && edgeMemoryBudget >= 0 && requiredMemory(edgePlan.at(i)) > edgeMemoryBudget){
+            moved.at(i) = true;
+        }
+        for(int spool : inputSpools(edgePlan.at(i))){
+            if(producer.count(spool) > 0 && moved.at(producer[spool])){
+                moved.at(i) = true;
+            }
+        }
+    }
+
+    auto crossing = [&](const std::vector<bool>& cut){
+        double bytes = 0;
+        for(int i = 0;i < size;++i){
+            bool up = !cut.at(i) && uploaded.at(i);
+            for(int c : consumers.at(i)){
+                up = up || (!cut.at(i) && cut.at(c));
+            }
+            if(up){
+                bytes += estimator->get(SqlCostEstimator::stepId(edgePlan.at(i))).getBytes();
+            }
+        }
+        return bytes;
+    };
+    auto rowwise = [&](int i){
+        const std::string name = operatorOf(edgePlan.at(i));
+        return name == "Filter" || name == "Project" || name == "BloomFilter";
+    };
+
+    // 从切分点往回看只有一个下游的逐行步骤链，移到云端的部分取上传字节最少的长度
+    for(int i = size - 1;i >= 0;--i){
+        bool boundary = !moved.at(i) && rowwise(i) && (uploaded.at(i) || !consumers.at(i).empty());
+        for(int c : consumers.at(i)){
+            boundary = boundary && moved.at(c);
+        }
+        if(!boundary){
+            continue;
+        }
+        std::vector<int> chain = {i};
+        while(true){
+            const int spool = spoolOf(edgePlan.at(chain.back()),"input");
+            if(producer.count(spool) == 0){
+                break;
+            }
+            const int previous = producer[spool];
+            if(moved.at(previous) || !rowwise(previous) || uploaded.at(previous) || consumers.at(previous).size() != 1){
+                break;
+            }
+            chain.push_back(previous);
+        }
+        std::vector<bool> best = moved,candidate = moved;
+        double bestBytes = crossing(moved);
+        for(int c : chain){
+            candidate.at(c) = true;
+            const double bytes = crossing(candidate);
+            if(bytes < bestBytes){
+                bestBytes = bytes;
+                best = candidate;
+            }
+        }
+        moved = best;
+    }
+
+    std::vector<std::string> edge,cloud;
+    for(int i = 0;i < size;++i){
+        (moved.at(i) ? cloud : edge).push_back(edgePlan.at(i));
+    }
+    cloud.insert(cloud.end(),cloudPlan.begin(),cloudPlan.end());
+    edgePlan = edge;
+    cloudPlan = cloud;
+}
+
+void SqlDistributedPlanner::setTiers(const std::vector<SqlTierProfile>& tiers){
+    this->tiers = tiers;
+}
+
+SqlCpuClass SqlDistributedPlanner::requiredCpuClass(const std::string& name){
+    // 逐行处理的步骤任何设备都能运行，建哈希表、维护窗口需要中等算力，嵌套循环和模式匹配需要高算力
+    if(name == "NestedJoin" || name.rfind("Pattern",0) == 0){
+        return SqlCpuClass::HIGH;
+    }
+    if(name.find("Join") != std::string::npos || name.find("GroupBy") != std::string::npos ||
+       name.find("Window") != std::string::npos || name.find("Session") != std::string::npos || name == "BloomBuild"){
+        return SqlCpuClass::MEDIUM;
+    }
+    return SqlCpuClass::LOW;
+}
+
+double SqlDistributedPlanner::requiredMemory(const std::string& step) const {
+    const std::string name = operatorOf(step);
+    // 连接缓存构建侧，聚合与窗口按输出估算状态大小
+    if(name.find("Join") != std::string::npos){
+        return estimator->get(spoolOf(step,"input2")).getBytes();
+    }
+    if(name.find("GroupBy") != std::string::npos || name.find("Aggregate") != std::string::npos ||
+       name.find("Window") != std::string::npos || name.find("Session") != std::string::npos || name == "BloomBuild"){
+        return estimator->get(SqlCostEstimator::stepId(step)).getBytes();
+    }
+    return 0;
+}
+
+void SqlDistributedPlanner::placeTiers(const std::vector<std::string>& edgePlan,const std::vector<std::string>& cloudPlan,
+                int nextId,const std::shared_ptr<SqlDistributedPlan>& result){
+                    const int last = tiers.size() - 1;
+                    std::vector<std::vector<std::string>> plans(tiers.size());
+                    // spool 所在（可以被读取）的层
+                    std::map<int,int> tierOf;
+                    // 已经传到某一层的 spool 在该层上的 spool
+                    std::map<std::pair<int,int>,int> exchanged;
+
+                    // 在 from 层加一个把 spool 传到 to 层的 Exchange，返回 to 层上的 spool
+                    auto exchange = [&](int spool,int from,int to) -> int {
+                        const int id = nextId++;
+                        std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
+                        step->setClassName("Exchange");
+                        step->addAttribute("id","d_" + std::to_string(id));
+                        step->addAttribute("input","s_" + std::to_string(spool));
+                        step->addAttribute("output","s_" + std::to_string(id));
+                        step->addParameter("from",tiers.at(from).getName());
+                        step->addParameter("to",tiers.at(to).getName());
+                        estimator->exchange(id,spool);
+                        plans.at(from).push_back(step->toString());
+                        tierOf[id] = to;
+                        return id;
+                    };
+
+                    // 把 spool 逐层传到 tier，返回 tier 上可以读取的 spool
+                    std::function<int(int,int)> lift = [&](int spool,int tier) -> int {
+                        if(tierOf[spool] >= tier){
+                            return spool;
+                        }
+                        auto iter = exchanged.find(std::make_pair(spool,tier));
+                        if(iter != exchanged.end()){
+                            return iter->second;
+                        }
+                        const int id = exchange(lift(spool,tier - 1),tier - 1,tier);
+                        exchanged[std::make_pair(spool,tier)] = id;
+                        return id;
+                    };
+
+                    // 把较高层的 spool 逐层传回 tier：边缘的 BloomFilter 读取云端 BloomBuild 建好的过滤器
+                    std::function<int(int,int)> lower = [&](int spool,int tier) -> int {
+                        if(tierOf[spool] <= tier){
+                            return spool;
+                        }
+                        auto iter = exchanged.find(std::make_pair(spool,tier));
+                        if(iter != exchanged.end()){
+                            return iter->second;
+                        }
+                        const int id = exchange(lower(spool,tier + 1),tier + 1,tier);
+                        exchanged[std::make_pair(spool,tier)] = id;
+                        return id;
+                    };
+
+                    auto place = [&](std::string step,bool global){
+                        const std::string name = operatorOf(step);
+                        int tier = 0;
+                        for(const char* attribute : {"input","input2"}){
+                            const int spool = spoolOf(step,attribute);
+                            if(spool >= 0){
+                                tier = std::max(tier,tierOf[spool]);
+                            }
+                        }
+                        if(global){
+                            tier = last;
+                        }else if(name != "Input"){
+                            while(tier < last && !(tiers.at(tier).supports(name) &&
+                                                   tiers.at(tier).getCpuClass() >= requiredCpuClass(name) &&
+                                                   tiers.at(tier).fits(requiredMemory(step)))){
+                                tier++;
+                            }
+                        }
+                        for(const char* attribute : {"input","input2"}){
+                            const int spool = spoolOf(step,attribute);
+                            if(spool >= 0 && tierOf[spool] < tier){
+                                step = replaceSpool(step,attribute,lift(spool,tier));
+                            }
+                        }
+                        // 过滤器不影响 BloomFilter 所在的层，不在同一层时传过来
+                        const int bloom = bloomSpoolOf(step);
+                        if(bloom >= 0){
+                            const int readable = tierOf[bloom] > tier ? lower(bloom,tier) : lift(bloom,tier);
+                            if(readable != bloom){
+                                step = replaceBloomSpool(step,readable);
+                            }
+                        }
+                        plans.at(tier).push_back(step);
+                        tierOf[SqlCostEstimator::stepId(step)] = tier;
+                    };
+
+                    // 按依赖顺序放置：步骤读取的 spool 都已放置之后才放置它。边缘的 BloomFilter 读取云端 BloomBuild 的输出，
+                    // 推迟到 BloomBuild 之后；其余步骤保持边缘在前、云端在后的顺序
+                    std::vector<std::pair<std::string,bool>> pending;
+                    std::set<int> unplaced;
+                    for(const std::string& step : edgePlan){
+                        pending.emplace_back(step,false);
+                        unplaced.insert(SqlCostEstimator::stepId(step));
+                    }
+                    for(const std::string& step : cloudPlan){
+                        pending.emplace_back(step,true);
+                        unplaced.insert(SqlCostEstimator::stepId(step));
+                    }
+                    auto ready = [&](const std::string& step){
+                        std::vector<int> spools = inputSpools(step);
+                        spools.push_back(bloomSpoolOf(step));
+                        return std::none_of(spools.begin(),spools.end(),[&](int spool){ return unplaced.count(spool) > 0; });
+                    };
+                    while(!pending.empty()){
+                        auto iter = std::find_if(pending.begin(),pending.end(),[&](const std::pair<std::string,bool>& item){
+                            return ready(item.first);
+                        });
+                        if(iter == pending.end()){
+                            iter = pending.begin();
+                        }
+                        place(iter->first,iter->second);
+                        unplaced.erase(SqlCostEstimator::stepId(iter->first));
+                        pending.erase(iter);
+                    }
+
+                    std::vector<std::string> names;
+                    std::vector<std::vector<SqlStepEstimate>> estimates(tiers.size());
+                    for(size_t t = 0;t < tiers.size();++t){
+                        names.push_back(tiers.at(t).getName());
+                        for(const std::string& step : plans.at(t)){
+                            estimates.at(t).push_back(estimator->get(SqlCostEstimator::stepId(step)));
+                        }
+                    }
+                    result->setTierPlans(names,plans,estimates);
+                }
+
+void SqlDistributedPlanner::setStatisticsCatalog(std::shared_ptr<StatisticsCatalog> catalog){
+    this->catalog = catalog;
 }
 
+void SqlDistributedPlanner::setBroadcastBudget(double bytes){
+    this->broadcastBudget = bytes;
+}
+
+void SqlDistributedPlanner::addBroadcastHint(const std::string& relation){
+    broadcastHints.insert(relation);
+}
+
+void SqlDistributedPlanner::setBloomFalsePositiveRate(double rate){
+    this->bloomFalsePositiveRate = rate;
+}
+
+int SqlDistributedPlanner::planBloomFilter(const std::shared_ptr<SqlStatement>& stmt,SqlJoinType type,
+                const std::vector<std::string>& lefts,
+                const std::vector<std::string>& rights,
+                int leftSpool,int rightSpool,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt>& edgeRunnable,
+                std::shared_ptr<MutableInt>& currentId){
+                    // 只有左侧没有匹配的行不输出时才能提前丢弃
+                    if(type != SqlJoinType::JOIN && type != SqlJoinType::INNER && type != SqlJoinType::RIGHT){
+                        return leftSpool;
+                    }
+                    if(bloomFalsePositiveRate <= 0 || bloomFalsePositiveRate >= 1 || lefts.empty()){
+                        return leftSpool;
+                    }
+                    // 连接本身留在边缘时不需要过滤
+                    if(edgeRunnable->getValue() != 0 && stmt->isEdgeRunnable()){
+                        return leftSpool;
+                    }
+                    const bool leftOnEdge = std::any_of(edgeSteps.begin(),edgeSteps.end(),[leftSpool](const std::shared_ptr<ClassDefinition>& step){
+                        return SqlCostEstimator::stepId(step->toString()) == leftSpool;
+                    });
+                    if(!leftOnEdge){
+                        return leftSpool;
+                    }
+                    const double items = estimator->bloomItems(rightSpool,rights);
+                    const double bits = SqlCostEstimator::bloomBits(items,bloomFalsePositiveRate);
+                    const double saved = estimator->get(leftSpool).getBytes() *
+                                         (1 - estimator->bloomSelectivity(leftSpool,lefts,rightSpool,rights,bloomFalsePositiveRate));
+                    if(saved <= bits / 8){
+                        return leftSpool;
+                    }
+
+                    std::ostringstream rate;
+                    rate << bloomFalsePositiveRate;
+
+                    currentId->increment();
+                    const int bloomId = currentId->getValue();
+                    std::shared_ptr<ClassDefinition> build = std::make_shared<ClassDefinition>();
+                    build->setClassName("BloomBuild");
+                    build->addAttribute("id","d_" + std::to_string(bloomId));
+                    build->addAttribute("input","s_" + std::to_string(rightSpool));
+                    build->addAttribute("output","s_" + std::to_string(bloomId));
+                    build->addParameter("keys",ExpressionModelUtils::mergeTerms(rights));
+                    build->addParameter("items",std::to_string(std::llround(items)));
+                    build->addParameter("bits",std::to_string(std::llround(bits)));
+                    build->addParameter("hashes",std::to_string(SqlCostEstimator::bloomHashes(bits,items)));
+                    build->addParameter("fpp",rate.str());
+                    estimator->bloomBuild(bloomId,rightSpool,rights,bloomFalsePositiveRate);
+                    cloudSteps.push_back(build);
+
+                    // 过滤器从云端下发，过滤步骤直接放在边缘，不受 edgeRunnable 影响
+                    currentId->increment();
+                    std::shared_ptr<ClassDefinition> filter = std::make_shared<ClassDefinition>();
+                    filter->setClassName("BloomFilter");
+                    filter->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                    filter->addAttribute("input","s_" + std::to_string(leftSpool));
+                    filter->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                    filter->addParameter("bloom","s_" + std::to_string(bloomId));
+                    filter->addParameter("keys",ExpressionModelUtils::mergeTerms(lefts));
+                    estimator->bloomFilter(currentId->getValue(),leftSpool,lefts,rightSpool,rights,bloomFalsePositiveRate);
+                    edgeSteps.push_back(filter);
+
+                    return currentId->getValue();
+                }
+
+void SqlDistributedPlanner::planIntervalJoin(const std::shared_ptr<ClassDefinition>& step,const SqlJoinStep& join,
+                int id,int leftSpool,int rightSpool,const std::string& joinType){
+                    step->setClassName("IntervalJoin");
+                    if(!join.getLefts().empty()){
+                        step->addParameter("lefts",ExpressionModelUtils::mergeTerms(join.getLefts()));
+                        step->addParameter("rights",ExpressionModelUtils::mergeTerms(join.getRights()));
+                    }
+                    step->addParameter("left_time",join.getLeftTime());
+                    step->addParameter("right_time",join.getRightTime());
+                    step->addParameter("lower",join.getLower());
+                    step->addParameter("upper",join.getUpper());
+                    if(!join.getResidual().empty()){
+                        step->addParameter("residual",join.getResidual());
+                    }
+                    estimator->intervalJoin(id,leftSpool,rightSpool,join.getLefts(),join.getRights(),join.getResidual(),joinType);
+                }
+
+void SqlDistributedPlanner::planAsofJoin(const std::shared_ptr<ClassDefinition>& step,const SqlJoinStep& join,
+                int id,int leftSpool,int rightSpool){
+                    step->setClassName("AsofJoin");
+                    if(!join.getLefts().empty()){
+                        step->addParameter("lefts",ExpressionModelUtils::mergeTerms(join.getLefts()));
+                        step->addParameter("rights",ExpressionModelUtils::mergeTerms(join.getRights()));
+                    }
+                    step->addParameter("left_time",join.getLeftTime());
+                    step->addParameter("right_time",join.getRightTime());
+                    step->addParameter("match",join.getMatch());
+                    if(!join.getResidual().empty()){
+                        step->addParameter("residual",join.getResidual());
+                    }
+                    estimator->asofJoin(id,leftSpool,rightSpool,join.getLefts(),join.getRights());
+                }
+
  
 void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                 std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
@@ -32,6 +589,10 @@ void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                 std::shared_ptr<MutableInt> edgeRunnable,
                 std::shared_ptr<MutableInt> currentId,
                 std::shared_ptr<MutableInt> lastSpool){
+                    if(stmt->isAlwaysEmpty()){
+                        planEmpty(stmt,cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
+                        return;
+                    }
                     if(auto q = std::dynamic_pointer_cast<QueryRelation>(stmt->getFrom())){
                         plan(q->getStatement(),cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
                         lastSpool->set(currentId->getValue());
@@ -44,45 +605,64 @@ void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
                         step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
                         step->addParameter("name",table->getName());
+                        estimator->input(currentId->getValue(),table->getName());
 
                         addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,true);
 
                         lastSpool->set(currentId->getValue());
                     }
 
-                    if(XStringUtils::isNotBlank(stmt->getWhere())){
-                        currentId->increment();
-
-                        std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
-                        step->setClassName("Filter");
-                        step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
-                        step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
-                        step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
-                        step->addParameter("condition",stmt->getWhere());
-
-                        addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,true);
-
-                        lastSpool->set(currentId->getValue());
+                    if(XStringUtils::isNotBlank(stmt->getComputes())){
+                        planComputes(stmt,stmt->getComputes(),cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
                     }
 
+                    // 连接语句的 where 按关系拆开，只引用一个关系的条件下推到该关系的输入之后
+                    std::string where = stmt->getWhere();
+                    std::vector<std::string> filters = {where};
                     if(stmt->getJoin() != nullptr){
+                        filters = SqlJoinChain(stmt).pushdown(where);
+                    }else{
+                        where.clear();
+                    }
+                    if(XStringUtils::isNotBlank(filters.at(0))){
+                        planFilter(stmt,filters.at(0),true,cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
+                    }
+                    if(XStringUtils::isNotBlank(stmt->getFilteredComputes())){
+                        planComputes(stmt,stmt->getFilteredComputes(),cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
+                    }
+
+                    // 连接之后还有过滤或聚合时连接输出全部列
+                    const bool joinOutputsAll = XStringUtils::isNotBlank(where) || XStringUtils::isNotBlank(stmt->getGroupbys()) ||
+                                                (stmt->getInterval() != nullptr && stmt->getInterval()->getTimeAmount() > 0);
+                    const std::string selects = joinOutputsAll ? "*" : stmt->getSelects();
+                    if(stmt->getJoins().size() > 1){
+                        planJoins(stmt,selects,filters,cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
+                    }else if(stmt->getJoin() != nullptr){
                         std::shared_ptr<SqlJoinSpec> join =stmt->getJoin();
                         std::shared_ptr<MutableInt> fromSpool = std::make_shared<MutableInt>(lastSpool->getValue());
-                        if(auto q = std::dynamic_pointer_cast<QueryRelation>(join->getRelation())){
-                            plan(q->getStatement(),cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
-                        }else{
-                            currentId->increment();
-
-                            std::shared_ptr<TableRelation> table = std::dynamic_pointer_cast<TableRelation>(join->getRelation());
-                            std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
-                            step->setClassName("Input");
-                            step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
-                            step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
-                            step->addParameter("name",table->getName());
-
-                            addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,true);
+                        planRelation(stmt,join->getRelation(),cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
+                        if(XStringUtils::isNotBlank(filters.at(1))){
+                            planFilter(stmt,filters.at(1),true,cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
+                        }
 
-                            lastSpool->set(currentId->getValue());
+                        const std::string leftAlias = stmt->getFrom()->getAlias(),rightAlias = join->getRelation()->getAlias();
+                        std::vector<std::string> leftTerms ,rightTerms;
+                        const std::string joinType = XStringUtils::toLowerCase(toString(join->getType()));
+                        std::string residual;
+                        SqlJoinStep split;
+                        bool keyed = join->getType() != SqlJoinType::ASOF &&
+                                     ExpressionModelUtils::isReduceJoinCondition(join->getConditionExp(),leftAlias,rightAlias,leftTerms,rightTerms);
+                        if(!keyed){
+                            // 只要有等值条件就按 key 连接，其余条件作为 residual 只在 key 相等的行对上检查
+                            split = SqlJoinChain(stmt).steps({0,1}).at(0);
+                            keyed = !split.getLefts().empty();
+                            leftTerms = split.getLefts();
+                            rightTerms = split.getRights();
+                            residual = split.getResidual();
+                        }
+                        if(keyed && !split.isAsofJoin() && !split.isBandJoin()){
+                            fromSpool->set(planBloomFilter(stmt,join->getType(),leftTerms,rightTerms,fromSpool->getValue(),lastSpool->getValue(),
+                                                           cloudSteps,edgeSteps,edgeRunnable,currentId));
                         }
 
                         currentId->increment();
@@ -93,21 +673,36 @@ void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         step->addAttribute("input2","s_" + std::to_string(lastSpool->getValue()));
                         step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
 
-                        const std::string leftAlias = stmt->getFrom()->getAlias(),rightAlias = join->getRelation()->getAlias();
-                        std::vector<std::string> leftTerms ,rightTerms;
-                        const std::string joinType = XStringUtils::toLowerCase(toString(join->getType()));
-                        if(ExpressionModelUtils::isReduceJoinCondition(join->getConditionExp(),leftAlias,rightAlias,leftTerms,rightTerms)){
-                            step->setClassName("ReduceJoin");
-                            step->addParameter("selects",stmt->getSelects());
+                        if(split.isAsofJoin()){
+                            planAsofJoin(step,split,currentId->getValue(),fromSpool->getValue(),lastSpool->getValue());
+                            step->addParameter("selects",selects);
+                            step->addParameter("left_alias",leftAlias);
+                            step->addParameter("right_alias",rightAlias);
+                            step->addParameter("join_type",joinType);
+                        }else if(split.isBandJoin()){
+                            planIntervalJoin(step,split,currentId->getValue(),fromSpool->getValue(),lastSpool->getValue(),joinType);
+                            step->addParameter("selects",selects);
+                            step->addParameter("left_alias",leftAlias);
+                            step->addParameter("right_alias",rightAlias);
+                            step->addParameter("join_type",joinType);
+                        }else if(keyed){
+                            const bool broadcast = estimator->isBroadcastJoin(join->getType(),join->getRelation(),lastSpool->getValue(),broadcastHints,broadcastBudget);
+                            step->setClassName(broadcast ? "BroadcastHashJoin" : "ReduceJoin");
+                            step->addParameter("selects",selects);
                             step->addParameter("lefts",ExpressionModelUtils::mergeTerms(leftTerms));
                             step->addParameter("rights",ExpressionModelUtils::mergeTerms(rightTerms));
+                            if(!residual.empty()){
+                                step->addParameter("residual",residual);
+                            }
+                            estimator->join(currentId->getValue(),fromSpool->getValue(),lastSpool->getValue(),leftTerms,rightTerms,residual,joinType,broadcast);
                             step->addParameter("left_alias",leftAlias);
                             step->addParameter("right_alias",rightAlias);
                             step->addParameter("join_type",joinType);
                         }else{
                             step->setClassName("NestedJoin");
-                            step->addParameter("selects",stmt->getSelects());
+                            step->addParameter("selects",selects);
                             step->addParameter("condition",join->getCondition());
+                            estimator->join(currentId->getValue(),fromSpool->getValue(),lastSpool->getValue(),{},{},join->getCondition(),joinType);
                             step->addParameter("left_alias",leftAlias);
                             step->addParameter("right_alias",rightAlias);
                             step->addParameter("join_type",joinType);
@@ -116,14 +711,65 @@ void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,false);
 
                         lastSpool->set(currentId->getValue());
-                    }else if(XStringUtils::isNotBlank(stmt->getGroupbys()) || (stmt->getInterval() != nullptr && stmt->getInterval()->getTimeAmount() > 0)){
+                    }
+
+                    if(XStringUtils::isNotBlank(where)){
+                        planFilter(stmt,where,false,cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
+                    }
+
+                    if(XStringUtils::isNotBlank(stmt->getGroupbys()) || (stmt->getInterval() != nullptr && stmt->getInterval()->getTimeAmount() > 0)){
+                        // 聚合都能拆分时各边缘先按 key 或时间桶算出部分状态，每次刷新每组只上传一行，云端再合并。
+                        // 时间桶聚合的部分结果在时间列上输出桶的起点，云端按桶合并多个设备的结果，迟到的桶并入同一个桶的状态
+                        std::string states;
+                        if(edgeRunnable->getValue() != 0 &&
+                           SqlAggregateSplitter::split(stmt->getGroupbys(),stmt->getSelects(),stmt->getQuery() + " " + stmt->getSelects(),states)){
+                            currentId->increment();
+
+                            std::shared_ptr<ClassDefinition> partial = std::make_shared<ClassDefinition>();
+                            partial->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                            partial->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
+                            partial->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                            std::string partials = states;
+                            if(XStringUtils::isNotBlank(stmt->getGroupbys())){
+                                partials = stmt->getGroupbys() + ", " + states;
+                                partial->setClassName("PartialGroupBy");
+                                partial->addParameter("keys",stmt->getGroupbys());
+                                partial->addParameter("selects",partials);
+                            }else{
+                                partial->setClassName("PartialStreamAggregate");
+                                partial->addParameter("selects",partials);
+                                partial->addParameter("time",stmt->getInterval()->getInterval());
+                                partial->addParameter("interval",std::to_string(stmt->getInterval()->getTimeAmount()));
+                                partial->addParameter("time_unit",stmt->getInterval()->getTimeUnit());
+                            }
+                            estimator->aggregate(currentId->getValue(),lastSpool->getValue(),stmt->getGroupbys(),partials);
+
+                            addStep(stmt,partial,cloudSteps,edgeSteps,edgeRunnable,true);
+
+                            lastSpool->set(currentId->getValue());
+                            // 合并多个设备的部分状态只能在云端进行
+                            edgeRunnable->set(0);
+                        }
+
                         currentId->increment();
 
                         std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
                         step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
                         step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
                         step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
-                        if(XStringUtils::isNotBlank(stmt->getGroupbys())){
+                        if(!states.empty() && XStringUtils::isNotBlank(stmt->getGroupbys())){
+                            step->setClassName("FinalGroupBy");
+                            step->addParameter("keys",stmt->getGroupbys());
+                            step->addParameter("states",states);
+                            step->addParameter("selects",stmt->getSelects());
+                        }else if(!states.empty()){
+                            step->setClassName("FinalStreamAggregate");
+                            step->addParameter("states",states);
+                            step->addParameter("selects",stmt->getSelects());
+                            step->addParameter("time",stmt->getInterval()->getInterval());
+                            step->addParameter("interval",std::to_string(stmt->getInterval()->getTimeAmount()));
+                            step->addParameter("time_unit",stmt->getInterval()->getTimeUnit());
+                        }else if(XStringUtils::isNotBlank(stmt->getGroupbys())){
                             step->setClassName("GroupBy");
                             step->addParameter("keys",stmt->getGroupbys());
                             step->addParameter("selects",stmt->getSelects());
@@ -134,6 +780,7 @@ void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                             step->addParameter("interval",std::to_string(stmt->getInterval()->getTimeAmount()));
                             step->addParameter("time_unit",stmt->getInterval()->getTimeUnit());
                         }
+                        estimator->aggregate(currentId->getValue(),lastSpool->getValue(),stmt->getGroupbys(),stmt->getSelects());
 
                         addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,false);
 
@@ -148,6 +795,7 @@ void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                             hvstep->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
                             hvstep->addAttribute("output","s_" + std::to_string(currentId->getValue()));
                             hvstep->addParameter("condition",stmt->getHaving());
+                            estimator->filter(currentId->getValue(),lastSpool->getValue(),stmt->getHaving());
 
                             addStep(stmt,hvstep,cloudSteps,edgeSteps,edgeRunnable,false);
 
@@ -175,6 +823,8 @@ void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         }else if("sliding" == XStringUtils::toLowerCase(spec->getType())){
                             std::shared_ptr<SlidingWindowSpec> swspec = std::dynamic_pointer_cast<SlidingWindowSpec>(spec);
                             step->setClassName("Sliding"+ windowKind);
+                            // 标注每个窗口聚合在行移出窗口时的增量策略
+                            step->addParameter("aggregations",SqlSyntaxUtils::getWindowAggregations(stmt->getSelects()));
                             step->addParameter("inclusion",swspec->getInclusion());
                             step->addParameter("selects",stmt->getSelects());
                             step->addParameter("validity",swspec->getHaving());
@@ -185,11 +835,12 @@ void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                             step->addParameter("selects",stmt->getSelects());
                             step->addParameter("validity",twspec->getHaving());
                         }
+                        estimator->window(currentId->getValue(),lastSpool->getValue());
 
                         addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,false);
 
                         lastSpool->set(currentId->getValue());
-                    }else if(!stmt->isSelectAll()){
+                    }else if(!stmt->isSelectAll() && (stmt->getJoin() == nullptr || XStringUtils::isNotBlank(where))){
                         currentId->increment();
 
                         std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
@@ -198,6 +849,7 @@ void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
                         step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
                         step->addParameter("selects",stmt->getSelects());
+                        estimator->project(currentId->getValue(),lastSpool->getValue(),stmt->getSelects());
 
                         addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,false);
 
@@ -235,6 +887,7 @@ void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                             step->addAttribute("input", "s_" + std::to_string(lastSpool->getValue()));
                             step->addAttribute("output", "s_" + std::to_string(currentId->getValue()));
                             step->addParameter("rows", std::to_string(stmt->getLimit()));
+                            estimator->take(currentId->getValue(),lastSpool->getValue(),stmt->getLimit());
 
                             steps.push_back(step);
                             lastSpool->set(currentId->getValue());
@@ -254,11 +907,50 @@ void SqlDistributedPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
                         step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
                         step->addParameter("name",table->getName());
+                        estimator->output(currentId->getValue(),lastSpool->getValue());
 
                         addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,false);
                     }
                 }
 
+void SqlDistributedPlanner::planEmpty(const std::shared_ptr<SqlStatement>& stmt,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt> edgeRunnable,
+                std::shared_ptr<MutableInt> currentId,
+                std::shared_ptr<MutableInt> lastSpool){
+                    currentId->increment();
+
+                    std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
+                    step->setClassName("Empty");
+                    step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                    step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                    estimator->empty(currentId->getValue());
+                    if(!stmt->isSelectAll()){
+                        step->addParameter("selects",stmt->getSelects());
+                    }
+
+                    addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,true);
+
+                    lastSpool->set(currentId->getValue());
+
+                    if(stmt->getInto() != nullptr){
+                        currentId->increment();
+
+                        if(std::dynamic_pointer_cast<ProtocolRelation>(stmt->getInto())){
+                            throw std::runtime_error("protocol into not supported in distributed query");
+                        }
+                        std::shared_ptr<TableRelation> table = std::dynamic_pointer_cast<TableRelation>(stmt->getInto());
+                        std::shared_ptr<ClassDefinition> output = std::make_shared<ClassDefinition>();
+                        output->setClassName("Output");
+                        output->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                        output->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
+                        output->addParameter("name",table->getName());
+                        estimator->output(currentId->getValue(),lastSpool->getValue());
+
+                        addStep(stmt,output,cloudSteps,edgeSteps,edgeRunnable,false);
+                    }
+                }
    
 void SqlDistributedPlanner::addStep(const std::shared_ptr<SqlStatement>& stmt,
                     const std::shared_ptr<ClassDefinition>& step,
@@ -280,6 +972,148 @@ void SqlDistributedPlanner::addStep(const std::shared_ptr<SqlStatement>& stmt,
                         cloudSteps.push_back(step);
                     }
 
+void SqlDistributedPlanner::planComputes(const std::shared_ptr<SqlStatement>& stmt,
+                const std::string& computes,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt>& edgeRunnable,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool){
+                    currentId->increment();
+
+                    std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
+                    step->setClassName("Project");
+                    step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                    step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
+                    step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                    step->addParameter("selects","*, " + computes);
+                    estimator->project(currentId->getValue(),lastSpool->getValue(),"*, " + computes);
+
+                    addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,true);
+
+                    lastSpool->set(currentId->getValue());
+                }
+
+void SqlDistributedPlanner::planFilter(const std::shared_ptr<SqlStatement>& stmt,
+                const std::string& condition,
+                bool switchOverPushdown,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt>& edgeRunnable,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool){
+                    currentId->increment();
+
+                    std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
+                    step->setClassName("Filter");
+                    step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                    step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
+                    step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                    step->addParameter("condition",condition);
+                    estimator->filter(currentId->getValue(),lastSpool->getValue(),condition);
+
+                    addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,switchOverPushdown);
+
+                    lastSpool->set(currentId->getValue());
+                }
+
+void SqlDistributedPlanner::planRelation(const std::shared_ptr<SqlStatement>& stmt,
+                const std::shared_ptr<SqlRelation>& relation,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt>& edgeRunnable,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool){
+                    if(auto q = std::dynamic_pointer_cast<QueryRelation>(relation)){
+                        if(q->getStatement()){
+                            plan(q->getStatement(),cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
+                        }
+                        return;
+                    }
+                    currentId->increment();
+
+                    std::shared_ptr<TableRelation> table = std::dynamic_pointer_cast<TableRelation>(relation);
+                    std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
+                    step->setClassName("Input");
+                    step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                    step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                    step->addParameter("name",table->getName());
+                    estimator->input(currentId->getValue(),table->getName());
+
+                    addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,true);
+
+                    lastSpool->set(currentId->getValue());
+                }
+
+void SqlDistributedPlanner::planJoins(const std::shared_ptr<SqlStatement>& stmt,
+                const std::string& selects,
+                const std::vector<std::string>& filters,
+                std::vector<std::shared_ptr<ClassDefinition>>& cloudSteps,
+                std::vector<std::shared_ptr<ClassDefinition>>& edgeSteps,
+                std::shared_ptr<MutableInt>& edgeRunnable,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool){
+                    SqlJoinChain chain(stmt);
+                    // from 的输入已经规划好，其余关系按书写顺序规划输入
+                    std::vector<int> spools = {lastSpool->getValue()};
+                    for(size_t i = 1;i < chain.size();++i){
+                        planRelation(stmt,chain.getRelation(i),cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
+                        if(XStringUtils::isNotBlank(filters.at(i))){
+                            planFilter(stmt,filters.at(i),true,cloudSteps,edgeSteps,edgeRunnable,currentId,lastSpool);
+                        }
+                        spools.push_back(lastSpool->getValue());
+                    }
+
+                    const std::vector<int> order = chain.order(estimator,spools);
+                    const std::vector<SqlJoinStep> joins = chain.steps(order);
+                    int leftSpool = spools.at(order.at(0));
+                    for(size_t i = 0;i < joins.size();++i){
+                        const SqlJoinStep& join = joins.at(i);
+                        const int rightSpool = spools.at(join.getRelation());
+                        const std::string joinType = XStringUtils::toLowerCase(toString(join.getType()));
+                        if(!join.isAsofJoin() && !join.isBandJoin()){
+                            leftSpool = planBloomFilter(stmt,join.getType(),join.getLefts(),join.getRights(),leftSpool,rightSpool,
+                                                        cloudSteps,edgeSteps,edgeRunnable,currentId);
+                        }
+
+                        currentId->increment();
+
+                        std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
+                        step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                        step->addAttribute("input","s_" + std::to_string(leftSpool));
+                        step->addAttribute("input2","s_" + std::to_string(rightSpool));
+                        step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                        if(join.isAsofJoin()){
+                            planAsofJoin(step,join,currentId->getValue(),leftSpool,rightSpool);
+                        }else if(join.isBandJoin()){
+                            planIntervalJoin(step,join,currentId->getValue(),leftSpool,rightSpool,joinType);
+                        }else if(!join.getLefts().empty()){
+                            const bool broadcast = estimator->isBroadcastJoin(join.getType(),chain.getRelation(join.getRelation()),rightSpool,broadcastHints,broadcastBudget);
+                            step->setClassName(broadcast ? "BroadcastHashJoin" : "ReduceJoin");
+                            step->addParameter("lefts",ExpressionModelUtils::mergeTerms(join.getLefts()));
+                            step->addParameter("rights",ExpressionModelUtils::mergeTerms(join.getRights()));
+                            if(!join.getResidual().empty()){
+                                step->addParameter("residual",join.getResidual());
+                            }
+                            estimator->join(currentId->getValue(),leftSpool,rightSpool,join.getLefts(),join.getRights(),join.getResidual(),joinType,broadcast);
+                        }else{
+                            step->setClassName("NestedJoin");
+                            step->addParameter("condition",join.getCondition());
+                            estimator->join(currentId->getValue(),leftSpool,rightSpool,{},{},join.getCondition(),joinType);
+                        }
+                        // 中间结果保留全部列，最后一个连接才输出 selects
+                        step->addParameter("selects",i + 1 == joins.size() ? selects : "*");
+                        step->addParameter("left_alias",ExpressionModelUtils::mergeTerms(join.getLeftAliases()));
+                        step->addParameter("right_alias",join.getRightAlias());
+                        step->addParameter("join_type",joinType);
+
+                        addStep(stmt,step,cloudSteps,edgeSteps,edgeRunnable,false);
+
+                        leftSpool = currentId->getValue();
+                    }
+                    lastSpool->set(leftSpool);
+                }
+
 bool SqlDistributedPlanner::selectOnly(const std::shared_ptr<SqlStatement>& stmt){
     return XStringUtils::isBlank(stmt->getWhere()) && XStringUtils::isBlank(stmt->getGroupbys()) && stmt->getWindow() == nullptr;
 }
\ No newline at end of file
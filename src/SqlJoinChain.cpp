@@ -0,0 +1,320 @@
+#include "../include/SqlJoinChain.h"
+#include "../include/SqlJoinOrderer.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "../include/SqlPredicateSimplifier.h"
+#include "XStringUtils.h"
+
+SqlJoinChain::SqlJoinChain(const std::shared_ptr<SqlStatement>& stmt){
+    relations.push_back(stmt->getFrom());
+    types.push_back(SqlJoinType::NONE);
+    matches.push_back("");
+    for(auto& join : stmt->getJoins()){
+        relations.push_back(join->getRelation());
+        types.push_back(join->getType());
+        matches.push_back(join->getMatchCondition());
+        if(join->getType() != SqlJoinType::JOIN && join->getType() != SqlJoinType::INNER){
+            reorderable = false;
+        }
+    }
+    for(auto& relation : relations){
+        if(relation->getAlias().empty()){
+            reorderable = false;
+        }
+    }
+
+    nullable.assign(relations.size(),false);
+    for(size_t i = 1;i < relations.size();++i){
+        switch(types[i]){
+            case SqlJoinType::LEFT:
+            case SqlJoinType::ASOF:
+                nullable[i] = true;
+                break;
+            case SqlJoinType::RIGHT:
+                for(size_t r = 0;r < i;++r){
+                    nullable[r] = true;
+                }
+                break;
+            case SqlJoinType::OUTER:
+            case SqlJoinType::FULL:
+                for(size_t r = 0;r <= i;++r){
+                    nullable[r] = true;
+                }
+                break;
+            default:{}
+        }
+    }
+
+    for(size_t i = 1;i < relations.size();++i){
+        // 顶层含 or 时不能按 and 拆开
+        const std::string on = stmt->getJoins().at(i - 1)->getCondition();
+        const std::vector<std::string> parts = SqlSyntaxUtils::splitConditions(on,"or").size() > 1 ?
+            std::vector<std::string>{on} : SqlSyntaxUtils::splitConditions(on,"and");
+        for(auto& condition : parts){
+            std::vector<bool> referenced(relations.size(),false);
+            bool any = false;
+            for(size_t r = 0;r < relations.size();++r){
+                referenced[r] = SqlSyntaxUtils::referencesQualifier(condition,relations[r]->getAlias());
+                any = any || referenced[r];
+            }
+            // 没有带别名的列时无法判断引用了谁，只能放在书写位置上检查
+            if(!any){
+                for(size_t r = 0;r <= i;++r){
+                    referenced[r] = true;
+                }
+            }
+            conditions.push_back(XStringUtils::trim(condition));
+            owners.push_back(i);
+            references.push_back(referenced);
+        }
+    }
+}
+
+size_t SqlJoinChain::size() const {
+    return relations.size();
+}
+
+std::shared_ptr<SqlRelation> SqlJoinChain::getRelation(int relation) const {
+    return relations.at(relation);
+}
+
+bool SqlJoinChain::isReorderable() const {
+    return reorderable;
+}
+
+bool SqlJoinChain::qualified(const std::string& column,int& relation,std::string& name) const {
+    for(size_t i = 0;i < relations.size();++i){
+        const std::string prefix = relations[i]->getAlias() + ".";
+        if(!relations[i]->getAlias().empty() && column.rfind(prefix,0) == 0 && column.size() > prefix.size()){
+            relation = i;
+            name = column.substr(prefix.size());
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SqlJoinChain::equality(int condition,int& left,std::string& leftKey,int& right,std::string& rightKey) const {
+    std::string l,r;
+    if(!SqlSyntaxUtils::splitEquality(conditions.at(condition),l,r)){
+        return false;
+    }
+    return qualified(l,left,leftKey) && qualified(r,right,rightKey) && left != right;
+}
+
+namespace {
+
+    // 带符号偏移取反
+    std::string negate(const std::string& offset){
+        if(offset == "0"){
+            return offset;
+        }
+        return offset.front() == '-' ? offset.substr(1) : "-" + offset;
+    }
+
+    // 比较符两侧互换，>= 变为 <=
+    std::string flip(const std::string& op){
+        return (op.front() == '>' ? "<" : ">") + op.substr(1);
+    }
+
+}
+
+bool SqlJoinChain::band(int condition,int relation,const std::vector<bool>& joined,
+                        int& left,std::string& leftTime,std::string& rightTime,std::string& lower,std::string& upper) const {
+    std::string column,base,l,u,offset;
+    bool lowerBound;
+    if(!SqlSyntaxUtils::splitBand(conditions.at(condition),column,base,l,u)){
+        if(!SqlSyntaxUtils::splitBound(conditions.at(condition),column,base,offset,lowerBound)){
+            return false;
+        }
+        (lowerBound ? l : u) = offset;
+    }
+
+    int c,b;
+    std::string columnName,baseName;
+    if(!qualified(column,c,columnName) || !qualified(base,b,baseName) || c == b){
+        return false;
+    }
+    if(c == relation && joined[b]){
+        left = b;
+        leftTime = baseName;
+        rightTime = columnName;
+        lower = l;
+        upper = u;
+        return true;
+    }
+    if(b == relation && joined[c]){
+        // column - base 在 [l, u] 内即 base - column 在 [-u, -l] 内
+        left = c;
+        leftTime = columnName;
+        rightTime = baseName;
+        lower = u.empty() ? u : negate(u);
+        upper = l.empty() ? l : negate(l);
+        return true;
+    }
+    return false;
+}
+
+std::vector<std::string> SqlJoinChain::pushdown(std::string& where) const {
+    std::vector<std::string> filters(relations.size());
+    if(XStringUtils::isBlank(where)){
+        return filters;
+    }
+    const std::vector<std::string> parts = SqlSyntaxUtils::splitConditions(where,"or").size() > 1 ?
+        std::vector<std::string>{where} : SqlSyntaxUtils::splitConditions(where,"and");
+
+    std::string remaining;
+    for(auto& condition : parts){
+        int referenced = -1,count = 0;
+        for(size_t r = 0;r < relations.size();++r){
+            if(SqlSyntaxUtils::referencesQualifier(condition,relations[r]->getAlias())){
+                referenced = r;
+                count++;
+            }
+        }
+        if(count == 1 && !nullable[referenced] && !SqlSyntaxUtils::isStateful(condition)){
+            filters[referenced] = SqlSyntaxUtils::conjoin(filters[referenced],
+                SqlSyntaxUtils::replaceIdentifiers(condition,relations[referenced]->getAlias(),{}));
+        }else{
+            remaining = SqlSyntaxUtils::conjoin(remaining,condition);
+        }
+    }
+    where = remaining;
+    return filters;
+}
+
+std::vector<int> SqlJoinChain::order(const std::shared_ptr<SqlCostEstimator>& estimator,const std::vector<int>& spools) const {
+    std::vector<int> result;
+    for(size_t i = 0;i < relations.size();++i){
+        result.push_back(i);
+    }
+    if(!reorderable || relations.size() < 3){
+        return result;
+    }
+
+    std::vector<double> rows;
+    for(int spool : spools){
+        rows.push_back(estimator->get(spool).getRows());
+    }
+    SqlJoinOrderer orderer(rows);
+    for(size_t c = 0;c < conditions.size();++c){
+        int left,right;
+        std::string leftKey,rightKey;
+        if(equality(c,left,leftKey,right,rightKey)){
+            orderer.addPredicate(left,right,estimator->joinSelectivity(spools.at(left),leftKey,spools.at(right),rightKey));
+            continue;
+        }
+        std::vector<int> referenced;
+        for(size_t r = 0;r < relations.size();++r){
+            if(references[c][r]){
+                referenced.push_back(r);
+            }
+        }
+        if(referenced.size() == 2){
+            orderer.addPredicate(referenced[0],referenced[1],estimator->selectivity(conditions[c],nullptr));
+        }
+    }
+    return orderer.order();
+}
+
+std::vector<SqlJoinStep> SqlJoinChain::steps(const std::vector<int>& order) const {
+    std::vector<SqlJoinStep> result;
+    std::vector<bool> joined(relations.size(),false),used(conditions.size(),false);
+    std::vector<std::string> aliases;
+    joined[order.at(0)] = true;
+    aliases.push_back(relations.at(order.at(0))->getAlias());
+
+    for(size_t i = 1;i < order.size();++i){
+        const int relation = order[i];
+        SqlJoinStep step;
+        step.setRelation(relation);
+        step.setType(reorderable ? SqlJoinType::INNER : types.at(relation));
+        step.setLeftAliases(aliases);
+        step.setRightAlias(relations.at(relation)->getAlias());
+
+        joined[relation] = true;
+        std::string condition,residual;
+        std::vector<int> others;
+        for(size_t c = 0;c < conditions.size();++c){
+            if(used[c]){
+                continue;
+            }
+            bool applicable = reorderable ? true : owners[c] == relation;
+            for(size_t r = 0;r < relations.size() && reorderable;++r){
+                applicable = applicable && (!references[c][r] || joined[r]);
+            }
+            if(!applicable){
+                continue;
+            }
+            used[c] = true;
+            condition = SqlSyntaxUtils::conjoin(condition,conditions[c]);
+
+            int left,right;
+            std::string leftKey,rightKey;
+            const bool keyed = equality(c,left,leftKey,right,rightKey) &&
+                               (left == relation ? joined[right] : right == relation && joined[left]);
+            if(keyed){
+                if(left == relation){
+                    std::swap(left,right);
+                    std::swap(leftKey,rightKey);
+                }
+                step.addKeys(aliases.size() > 1 ? relations.at(left)->getAlias() + "." + leftKey : leftKey,rightKey);
+            }else{
+                others.push_back(c);
+            }
+        }
+
+        // 同一对时间列上的上下界组成区间条件，between 同时给出两个界
+        int bandLeft = -1;
+        std::string leftTime,rightTime,lower,upper;
+        std::vector<bool> banded(conditions.size(),false);
+        for(int c : others){
+            int left;
+            std::string l,r,lo,hi;
+            if(!band(c,relation,joined,left,l,r,lo,hi) || (bandLeft >= 0 && (left != bandLeft || l != leftTime || r != rightTime)) ||
+               (!lo.empty() && !lower.empty()) || (!hi.empty() && !upper.empty())){
+                continue;
+            }
+            bandLeft = left;
+            leftTime = l;
+            rightTime = r;
+            lower = lo.empty() ? lower : lo;
+            upper = hi.empty() ? upper : hi;
+            banded[c] = true;
+        }
+        const bool bounded = !lower.empty() && !upper.empty();
+        if(bounded){
+            step.setBand(aliases.size() > 1 ? relations.at(bandLeft)->getAlias() + "." + leftTime : leftTime,rightTime,lower,upper);
+        }
+        for(int c : others){
+            if(!bounded || !banded[c]){
+                residual = SqlSyntaxUtils::conjoin(residual,conditions[c]);
+            }
+        }
+
+        // ASOF 的匹配条件统一写成 左侧列 比较符 右侧列
+        std::string l,op,r;
+        if(SqlSyntaxUtils::splitComparison(matches.at(relation),l,op,r)){
+            int owner;
+            std::string name;
+            if(qualified(l,owner,name) && owner == relation){
+                std::swap(l,r);
+                op = flip(op);
+            }
+            std::string leftName = l,rightName = r;
+            if(qualified(l,owner,name)){
+                leftName = aliases.size() > 1 ? l : name;
+            }
+            if(qualified(r,owner,name)){
+                rightName = name;
+            }
+            step.setMatch(leftName,rightName,op);
+        }
+        // 没有任何条件时退化为笛卡尔积
+        step.setCondition(condition.empty() ? SqlPredicateSimplifier::ALWAYS_TRUE : condition);
+        step.setResidual(residual);
+
+        aliases.push_back(relations.at(relation)->getAlias());
+        result.push_back(step);
+    }
+    return result;
+}
@@ -0,0 +1,161 @@
+#include "../include/SqlJoinOrderer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+SqlJoinOrderer::SqlJoinOrderer(const std::vector<double>& rows) :
+    rows(rows),
+    selectivities(rows.size(),std::vector<double>(rows.size(),1.0)),
+    edges(rows.size(),std::vector<bool>(rows.size(),false)){
+}
+
+void SqlJoinOrderer::addPredicate(int left,int right,double selectivity){
+    if(left == right){
+        return;
+    }
+    selectivities[left][right] *= selectivity;
+    selectivities[right][left] *= selectivity;
+    edges[left][right] = true;
+    edges[right][left] = true;
+}
+
+double SqlJoinOrderer::extend(const std::vector<bool>& relations,double cardinality,int relation) const {
+    double result = cardinality * rows.at(relation);
+    for(size_t i = 0;i < relations.size();++i){
+        if(relations[i]){
+            result *= selectivities[i][relation];
+        }
+    }
+    return result;
+}
+
+bool SqlJoinOrderer::connected(const std::vector<bool>& relations,int relation) const {
+    for(size_t i = 0;i < relations.size();++i){
+        if(relations[i] && edges[i][relation]){
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SqlJoinOrderer::hasNeighbour(const std::vector<bool>& relations) const {
+    for(size_t r = 0;r < relations.size();++r){
+        if(!relations[r] && connected(relations,r)){
+            return true;
+        }
+    }
+    return false;
+}
+
+double SqlJoinOrderer::cost(const std::vector<int>& order) const {
+    std::vector<bool> relations(rows.size(),false);
+    double cardinality = 1,total = 0;
+    for(size_t i = 0;i < order.size();++i){
+        cardinality = extend(relations,cardinality,order[i]);
+        relations[order[i]] = true;
+        if(i > 0){
+            total += cardinality;
+        }
+    }
+    return total;
+}
+
+std::vector<int> SqlJoinOrderer::order() const {
+    std::vector<int> result = static_cast<int>(rows.size()) <= DP_LIMIT ? dynamicOrder() : greedyOrder();
+    // 前两个关系互换不影响代价，较小的一侧放在右边作为构建侧
+    if(result.size() > 1 && rows.at(result[0]) < rows.at(result[1])){
+        std::swap(result[0],result[1]);
+    }
+    return result;
+}
+
+std::vector<int> SqlJoinOrderer::dynamicOrder() const {
+    const int n = rows.size();
+    const int full = (1 << n) - 1;
+    std::vector<double> cardinality(full + 1,0),best(full + 1,std::numeric_limits<double>::infinity());
+    std::vector<int> last(full + 1,-1);
+    for(int i = 0;i < n;++i){
+        cardinality[1 << i] = rows[i];
+        best[1 << i] = 0;
+        last[1 << i] = i;
+    }
+
+    std::vector<bool> relations(n,false);
+    for(int mask = 1;mask <= full;++mask){
+        if(last[mask] < 0){
+            continue;
+        }
+        for(int i = 0;i < n;++i){
+            relations[i] = (mask >> i) & 1;
+        }
+        const bool neighbour = hasNeighbour(relations);
+        for(int r = 0;r < n;++r){
+            if(relations[r] || (neighbour && !connected(relations,r))){
+                continue;
+            }
+            const int next = mask | (1 << r);
+            const double rowsAfter = extend(relations,cardinality[mask],r);
+            if(best[mask] + rowsAfter < best[next]){
+                cardinality[next] = rowsAfter;
+                best[next] = best[mask] + rowsAfter;
+                last[next] = r;
+            }
+        }
+    }
+
+    std::vector<int> result(n);
+    for(int mask = full,i = n - 1;i >= 0;--i){
+        result[i] = last[mask];
+        mask &= ~(1 << last[mask]);
+    }
+    return result;
+}
+
+std::vector<int> SqlJoinOrderer::greedyOrder() const {
+    const int n = rows.size();
+    std::vector<bool> relations(n,false);
+    std::vector<int> result;
+
+    // 从连接后结果最小的一对关系开始
+    int first = 0,second = n > 1 ? 1 : -1;
+    double smallest = std::numeric_limits<double>::infinity();
+    for(int i = 0;i < n;++i){
+        for(int j = i + 1;j < n;++j){
+            const double pair = rows[i] * rows[j] * selectivities[i][j];
+            if(edges[i][j] && pair < smallest){
+                smallest = pair;
+                first = i;
+                second = j;
+            }
+        }
+    }
+    double cardinality = rows[first];
+    relations[first] = true;
+    result.push_back(first);
+    if(second >= 0){
+        cardinality = extend(relations,cardinality,second);
+        relations[second] = true;
+        result.push_back(second);
+    }
+
+    while(static_cast<int>(result.size()) < n){
+        const bool neighbour = hasNeighbour(relations);
+        int chosen = -1;
+        double chosenRows = std::numeric_limits<double>::infinity();
+        for(int r = 0;r < n;++r){
+            if(relations[r] || (neighbour && !connected(relations,r))){
+                continue;
+            }
+            const double rowsAfter = extend(relations,cardinality,r);
+            if(rowsAfter < chosenRows){
+                chosenRows = rowsAfter;
+                chosen = r;
+            }
+        }
+        cardinality = chosenRows;
+        relations[chosen] = true;
+        result.push_back(chosen);
+    }
+    return result;
+}
@@ -0,0 +1,881 @@
+#include "../include/SqlPredicateSimplifier.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "XStringUtils.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+const std::string SqlPredicateSimplifier::ALWAYS_TRUE = "true";
+const std::string SqlPredicateSimplifier::ALWAYS_FALSE = "false";
+
+namespace {
+
+    enum class TokenType { NUMBER, STRING, WORD, OPERATOR, OPEN, CLOSE, COMMA };
+
+    struct Token {
+        TokenType type;
+        std::string text;
+    };
+
+    // 化简过程中遇到不认识的语法时抛出，调用方据此放弃化简
+    class UnsupportedSyntax : public std::runtime_error {
+        public:
+            explicit UnsupportedSyntax(const std::string& message) : std::runtime_error(message){}
+    };
+
+    enum class NodeKind { LITERAL, ATOM, CALL, NEGATE, ARITH, COMPARE, BETWEEN, IN, IS_NULL, LIKE, NOT, AND, OR };
+
+    enum class LiteralType { NUMBER, STRING, BOOL, NIL };
+
+    struct Node {
+        NodeKind kind;
+        std::string text;   // 字面量原文、列名、函数名或运算符
+        LiteralType literal = LiteralType::NIL;
+        bool integral = false;
+        long long ivalue = 0;
+        double dvalue = 0;
+        bool negated = false;
+        std::vector<std::shared_ptr<Node>> children;
+    };
+
+    typedef std::shared_ptr<Node> NodePtr;
+
+    bool isDigit(char c){
+        return c >= '0' && c <= '9';
+    }
+
+    bool isWordStart(char c){
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    bool isWordPart(char c){
+        return isWordStart(c) || isDigit(c) || c == '.';
+    }
+
+    std::vector<Token> tokenize(const std::string& expr){
+        std::vector<Token> tokens;
+        const int len = expr.size();
+        int i = 0;
+        while(i < len){
+            const char c = expr.at(i);
+            if(SqlSyntaxUtils::isWhiteSpace(c)){
+                i++;
+            }else if(c == '\'' || c == '"'){
+                int end = i + 1;
+                while(end < len && expr.at(end) != c){
+                    end += expr.at(end) == '\\' ? 2 : 1;
+                }
+                if(end >= len){
+                    throw UnsupportedSyntax("unterminated string");
+                }
+                tokens.push_back({TokenType::STRING,expr.substr(i,end + 1 - i)});
+                i = end + 1;
+            }else if(isDigit(c) || (c == '.' && i + 1 < len && isDigit(expr.at(i + 1)))){
+                int end = i;
+                while(end < len && (isDigit(expr.at(end)) || expr.at(end) == '.')){
+                    end++;
+                }
+                if(end < len && (expr.at(end) == 'e' || expr.at(end) == 'E')){
+                    end++;
+                    if(end < len && (expr.at(end) == '+' || expr.at(end) == '-')){
+                        end++;
+                    }
+                    while(end < len && isDigit(expr.at(end))){
+                        end++;
+                    }
+                }
+                if(end < len && isWordPart(expr.at(end))){
+                    throw UnsupportedSyntax("number followed by word");
+                }
+                tokens.push_back({TokenType::NUMBER,expr.substr(i,end - i)});
+                i = end;
+            }else if(isWordStart(c) || (c == ':' && i + 2 < len && expr.at(i + 1) == ':' && isWordStart(expr.at(i + 2)))){
+                int end = c == ':' ? i + 2 : i;
+                while(end < len && isWordPart(expr.at(end))){
+                    end++;
+                }
+                tokens.push_back({TokenType::WORD,expr.substr(i,end - i)});
+                i = end;
+            }else if(c == '('){
+                tokens.push_back({TokenType::OPEN,"("});
+                i++;
+            }else if(c == ')'){
+                tokens.push_back({TokenType::CLOSE,")"});
+                i++;
+            }else if(c == ','){
+                tokens.push_back({TokenType::COMMA,","});
+                i++;
+            }else{
+                const std::string two = expr.substr(i,2);
+                if(two == "==" || two == "!=" || two == "<>" || two == "<=" || two == ">="){
+                    tokens.push_back({TokenType::OPERATOR,two});
+                    i += 2;
+                }else if(two == "->"){
+                    throw UnsupportedSyntax("assignment");
+                }else if(c == '=' || c == '<' || c == '>' || c == '+' || c == '-' || c == '*' || c == '/' || c == '%'){
+                    tokens.push_back({TokenType::OPERATOR,std::string(1,c)});
+                    i++;
+                }else{
+                    throw UnsupportedSyntax(std::string("unknown character ") + c);
+                }
+            }
+        }
+        return tokens;
+    }
+
+    bool isComparison(const std::string& op){
+        return op == "=" || op == "==" || op == "!=" || op == "<>" || op == "<" || op == "<=" || op == ">" || op == ">=";
+    }
+
+    NodePtr makeNode(NodeKind kind, const std::string& text){
+        NodePtr node = std::make_shared<Node>();
+        node->kind = kind;
+        node->text = text;
+        return node;
+    }
+
+    NodePtr makeBool(bool value){
+        NodePtr node = makeNode(NodeKind::LITERAL,value ? SqlPredicateSimplifier::ALWAYS_TRUE : SqlPredicateSimplifier::ALWAYS_FALSE);
+        node->literal = LiteralType::BOOL;
+        node->ivalue = value ? 1 : 0;
+        return node;
+    }
+
+    NodePtr makeNumber(double value){
+        NodePtr node = makeNode(NodeKind::LITERAL,"");
+        node->literal = LiteralType::NUMBER;
+        // 15 位有效数字能还原出同一个值时用较短的写法，否则按 max_digits10 位输出，折叠不改变结果
+        std::ostringstream out;
+        out.precision(15);
+        out << value;
+        if(std::strtod(out.str().c_str(),nullptr) != value){
+            out.str("");
+            out.precision(std::numeric_limits<double>::max_digits10);
+            out << value;
+        }
+        node->text = out.str();
+        node->dvalue = value;
+        return node;
+    }
+
+    NodePtr makeInteger(long long value){
+        NodePtr node = makeNode(NodeKind::LITERAL,std::to_string(value));
+        node->literal = LiteralType::NUMBER;
+        node->integral = true;
+        node->ivalue = value;
+        node->dvalue = static_cast<double>(value);
+        return node;
+    }
+
+    bool isBool(const NodePtr& node, bool value){
+        return node->kind == NodeKind::LITERAL && node->literal == LiteralType::BOOL && (node->ivalue != 0) == value;
+    }
+
+    bool isNumber(const NodePtr& node){
+        return node->kind == NodeKind::LITERAL && node->literal == LiteralType::NUMBER;
+    }
+
+    class Parser {
+        private:
+            const std::vector<Token>& tokens;
+            size_t pos = 0;
+
+            bool isWord(const std::string& word) const {
+                return pos < tokens.size() && tokens.at(pos).type == TokenType::WORD &&
+                       XStringUtils::toLowerCase(tokens.at(pos).text) == word;
+            }
+
+            bool isType(TokenType type) const {
+                return pos < tokens.size() && tokens.at(pos).type == type;
+            }
+
+            void expect(TokenType type){
+                if(!isType(type)){
+                    throw UnsupportedSyntax("unexpected token");
+                }
+                pos++;
+            }
+
+            NodePtr parseOr(){
+                NodePtr first = parseAnd();
+                if(!isWord("or")){
+                    return first;
+                }
+                NodePtr node = makeNode(NodeKind::OR,"or");
+                node->children.push_back(first);
+                while(isWord("or")){
+                    pos++;
+                    node->children.push_back(parseAnd());
+                }
+                return node;
+            }
+
+            NodePtr parseAnd(){
+                NodePtr first = parseNot();
+                if(!isWord("and")){
+                    return first;
+                }
+                NodePtr node = makeNode(NodeKind::AND,"and");
+                node->children.push_back(first);
+                while(isWord("and")){
+                    pos++;
+                    node->children.push_back(parseNot());
+                }
+                return node;
+            }
+
+            NodePtr parseNot(){
+                if(isWord("not")){
+                    pos++;
+                    NodePtr node = makeNode(NodeKind::NOT,"not");
+                    node->children.push_back(parseNot());
+                    return node;
+                }
+                return parseComparison();
+            }
+
+            NodePtr parseComparison(){
+                NodePtr left = parseAdditive();
+                NodePtr node;
+                bool negated = false;
+                if(isWord("not")){
+                    negated = true;
+                    pos++;
+                }
+                if(!negated && isType(TokenType::OPERATOR) && isComparison(tokens.at(pos).text)){
+                    node = makeNode(NodeKind::COMPARE,tokens.at(pos++).text);
+                    node->children.push_back(left);
+                    node->children.push_back(parseAdditive());
+                }else if(isWord("between")){
+                    pos++;
+                    node = makeNode(NodeKind::BETWEEN,"between");
+                    node->children.push_back(left);
+                    node->children.push_back(parseAdditive());
+                    if(!isWord("and")){
+                        throw UnsupportedSyntax("between without and");
+                    }
+                    pos++;
+                    node->children.push_back(parseAdditive());
+                }else if(isWord("in")){
+                    pos++;
+                    node = makeNode(NodeKind::IN,"in");
+                    node->children.push_back(left);
+                    expect(TokenType::OPEN);
+                    node->children.push_back(parseOr());
+                    while(isType(TokenType::COMMA)){
+                        pos++;
+                        node->children.push_back(parseOr());
+                    }
+                    expect(TokenType::CLOSE);
+                }else if(isWord("like")){
+                    pos++;
+                    node = makeNode(NodeKind::LIKE,"like");
+                    node->children.push_back(left);
+                    node->children.push_back(parseAdditive());
+                }else if(!negated && isWord("is")){
+                    pos++;
+                    node = makeNode(NodeKind::IS_NULL,"is");
+                    if(isWord("not")){
+                        negated = true;
+                        pos++;
+                    }
+                    if(!isWord("null")){
+                        throw UnsupportedSyntax("is without null");
+                    }
+                    pos++;
+                    node->children.push_back(left);
+                }else if(negated){
+                    throw UnsupportedSyntax("dangling not");
+                }else{
+                    return left;
+                }
+                node->negated = negated;
+                if(isType(TokenType::OPERATOR) && isComparison(tokens.at(pos).text)){
+                    throw UnsupportedSyntax("chained comparison");
+                }
+                return node;
+            }
+
+            NodePtr parseAdditive(){
+                NodePtr node = parseMultiplicative();
+                while(isType(TokenType::OPERATOR) && (tokens.at(pos).text == "+" || tokens.at(pos).text == "-")){
+                    NodePtr arith = makeNode(NodeKind::ARITH,tokens.at(pos++).text);
+                    arith->children.push_back(node);
+                    arith->children.push_back(parseMultiplicative());
+                    node = arith;
+                }
+                return node;
+            }
+
+            NodePtr parseMultiplicative(){
+                NodePtr node = parseUnary();
+                while(isType(TokenType::OPERATOR) &&
+                      (tokens.at(pos).text == "*" || tokens.at(pos).text == "/" || tokens.at(pos).text == "%")){
+                    NodePtr arith = makeNode(NodeKind::ARITH,tokens.at(pos++).text);
+                    arith->children.push_back(node);
+                    arith->children.push_back(parseUnary());
+                    node = arith;
+                }
+                return node;
+            }
+
+            NodePtr parseUnary(){
+                if(isType(TokenType::OPERATOR) && tokens.at(pos).text == "-"){
+                    pos++;
+                    NodePtr node = makeNode(NodeKind::NEGATE,"-");
+                    node->children.push_back(parseUnary());
+                    return node;
+                }
+                if(isType(TokenType::OPERATOR) && tokens.at(pos).text == "+"){
+                    pos++;
+                    return parseUnary();
+                }
+                return parsePrimary();
+            }
+
+            NodePtr parsePrimary(){
+                if(pos >= tokens.size()){
+                    throw UnsupportedSyntax("unexpected end");
+                }
+                const Token& token = tokens.at(pos);
+                if(token.type == TokenType::OPEN){
+                    pos++;
+                    NodePtr node = parseOr();
+                    expect(TokenType::CLOSE);
+                    return node;
+                }
+                if(token.type == TokenType::NUMBER){
+                    pos++;
+                    NodePtr node = makeNode(NodeKind::LITERAL,token.text);
+                    node->literal = LiteralType::NUMBER;
+                    node->integral = token.text.find_first_of(".eE") == std::string::npos;
+                    try{
+                        node->dvalue = std::stod(token.text);
+                        node->ivalue = node->integral ? std::stoll(token.text) : 0;
+                    }catch(const std::exception&){
+                        throw UnsupportedSyntax("number out of range");
+                    }
+                    return node;
+                }
+                if(token.type == TokenType::STRING){
+                    pos++;
+                    NodePtr node = makeNode(NodeKind::LITERAL,token.text);
+                    node->literal = LiteralType::STRING;
+                    return node;
+                }
+                if(token.type != TokenType::WORD){
+                    throw UnsupportedSyntax("unexpected token");
+                }
+
+                const std::string word = XStringUtils::toLowerCase(token.text);
+                if(word == "true" || word == "false"){
+                    pos++;
+                    return makeBool(word == "true");
+                }
+                if(word == "null"){
+                    pos++;
+                    NodePtr node = makeNode(NodeKind::LITERAL,"null");
+                    node->literal = LiteralType::NIL;
+                    return node;
+                }
+                pos++;
+                if(isType(TokenType::OPEN)){
+                    pos++;
+                    NodePtr node = makeNode(NodeKind::CALL,token.text);
+                    if(!isType(TokenType::CLOSE)){
+                        node->children.push_back(parseOr());
+                        while(isType(TokenType::COMMA)){
+                            pos++;
+                            node->children.push_back(parseOr());
+                        }
+                    }
+                    expect(TokenType::CLOSE);
+                    return node;
+                }
+                if(token.text.rfind("::",0) != 0 && !SqlSyntaxUtils::isIdentifier(token.text)){
+                    throw UnsupportedSyntax("keyword in operand position");
+                }
+                return makeNode(NodeKind::ATOM,token.text);
+            }
+
+        public:
+            explicit Parser(const std::vector<Token>& tokens) : tokens(tokens){}
+
+            NodePtr parse(){
+                NodePtr node = parseOr();
+                if(pos != tokens.size()){
+                    throw UnsupportedSyntax("trailing tokens");
+                }
+                return node;
+            }
+    };
+
+    int precedence(const NodePtr& node){
+        switch(node->kind){
+            case NodeKind::OR: return 1;
+            case NodeKind::AND: return 2;
+            case NodeKind::NOT: return 3;
+            case NodeKind::COMPARE:
+            case NodeKind::BETWEEN:
+            case NodeKind::IN:
+            case NodeKind::IS_NULL:
+            case NodeKind::LIKE: return 4;
+            case NodeKind::ARITH: return node->text == "+" || node->text == "-" ? 5 : 6;
+            case NodeKind::NEGATE: return 7;
+            default: return 8;
+        }
+    }
+
+    std::string print(const NodePtr& node, int minPrecedence);
+
+    std::string printList(const std::vector<NodePtr>& nodes, size_t from, const std::string& separator, int minPrecedence){
+        std::string text;
+        for(size_t i = from;i < nodes.size();++i){
+            text += (i == from ? "" : separator) + print(nodes.at(i),minPrecedence);
+        }
+        return text;
+    }
+
+    std::string print(const NodePtr& node, int minPrecedence){
+        const int prec = precedence(node);
+        const std::string neg = node->negated ? "not " : "";
+        std::string text;
+        switch(node->kind){
+            case NodeKind::LITERAL:
+            case NodeKind::ATOM:
+                text = node->text;
+                break;
+            case NodeKind::CALL:
+                text = node->text + "(" + printList(node->children,0,", ",1) + ")";
+                break;
+            case NodeKind::NEGATE:
+                text = "-" + print(node->children.at(0),8);
+                break;
+            case NodeKind::ARITH:
+                text = print(node->children.at(0),prec) + " " + node->text + " " + print(node->children.at(1),prec + 1);
+                break;
+            case NodeKind::COMPARE:
+                text = print(node->children.at(0),5) + " " + node->text + " " + print(node->children.at(1),5);
+                break;
+            case NodeKind::BETWEEN:
+                text = print(node->children.at(0),5) + " " + neg + "between " +
+                       print(node->children.at(1),5) + " and " + print(node->children.at(2),5);
+                break;
+            case NodeKind::IN:
+                text = print(node->children.at(0),5) + " " + neg + "in (" + printList(node->children,1,", ",1) + ")";
+                break;
+            case NodeKind::IS_NULL:
+                text = print(node->children.at(0),5) + " is " + neg + "null";
+                break;
+            case NodeKind::LIKE:
+                text = print(node->children.at(0),5) + " " + neg + "like " + print(node->children.at(1),5);
+                break;
+            case NodeKind::NOT:
+                text = "not " + print(node->children.at(0),3);
+                break;
+            case NodeKind::AND:
+                text = printList(node->children,0," and ",3);
+                break;
+            case NodeKind::OR:
+                text = printList(node->children,0," or ",2);
+                break;
+        }
+        return prec < minPrecedence ? "(" + text + ")" : text;
+    }
+
+    NodePtr foldArithmetic(const NodePtr& node){
+        const NodePtr& l = node->children.at(0);
+        const NodePtr& r = node->children.at(1);
+        if(!isNumber(l) || !isNumber(r)){
+            return node;
+        }
+        const std::string& op = node->text;
+        if(l->integral && r->integral){
+            long long value = 0;
+            if(op == "+" && !__builtin_add_overflow(l->ivalue,r->ivalue,&value)){
+                return makeInteger(value);
+            }
+            if(op == "-" && !__builtin_sub_overflow(l->ivalue,r->ivalue,&value)){
+                return makeInteger(value);
+            }
+            if(op == "*" && !__builtin_mul_overflow(l->ivalue,r->ivalue,&value)){
+                return makeInteger(value);
+            }
+            // 整数除法和取模的语义由引擎决定，只折叠结果没有歧义的情况
+            if((op == "/" || op == "%") && r->ivalue > 0 && l->ivalue >= 0){
+                if(op == "%"){
+                    return makeInteger(l->ivalue % r->ivalue);
+                }
+                if(l->ivalue % r->ivalue == 0){
+                    return makeInteger(l->ivalue / r->ivalue);
+                }
+            }
+            return node;
+        }
+        double value;
+        if(op == "+"){
+            value = l->dvalue + r->dvalue;
+        }else if(op == "-"){
+            value = l->dvalue - r->dvalue;
+        }else if(op == "*"){
+            value = l->dvalue * r->dvalue;
+        }else if(op == "/" && r->dvalue != 0){
+            value = l->dvalue / r->dvalue;
+        }else{
+            return node;
+        }
+        return std::isfinite(value) ? makeNumber(value) : node;
+    }
+
+    // 比较两个字面量，无法判断时返回 -2
+    int compareLiterals(const NodePtr& l, const NodePtr& r){
+        if(l->kind != NodeKind::LITERAL || r->kind != NodeKind::LITERAL || l->literal != r->literal){
+            return -2;
+        }
+        if(l->literal == LiteralType::NUMBER){
+            if(l->integral && r->integral){
+                return l->ivalue < r->ivalue ? -1 : (l->ivalue > r->ivalue ? 1 : 0);
+            }
+            return l->dvalue < r->dvalue ? -1 : (l->dvalue > r->dvalue ? 1 : 0);
+        }
+        if(l->literal == LiteralType::BOOL){
+            return l->ivalue == r->ivalue ? 0 : 2;
+        }
+        if(l->literal == LiteralType::STRING){
+            // 字符串只判断相等，且引号风格必须一致
+            if(l->text.at(0) != r->text.at(0) || l->text.find('\\') != std::string::npos || r->text.find('\\') != std::string::npos){
+                return -2;
+            }
+            return l->text == r->text ? 0 : 2;
+        }
+        return -2;
+    }
+
+    // 根据比较结果求值，cmp 为 2 表示只知道不相等
+    int evaluateComparison(const std::string& op, int cmp){
+        if(cmp == -2){
+            return -1;
+        }
+        if(op == "=" || op == "=="){
+            return cmp == 0 ? 1 : 0;
+        }
+        if(op == "!=" || op == "<>"){
+            return cmp == 0 ? 0 : 1;
+        }
+        if(cmp == 2){
+            return -1;
+        }
+        if(op == "<"){
+            return cmp < 0 ? 1 : 0;
+        }
+        if(op == "<="){
+            return cmp <= 0 ? 1 : 0;
+        }
+        if(op == ">"){
+            return cmp > 0 ? 1 : 0;
+        }
+        return cmp >= 0 ? 1 : 0;
+    }
+
+    std::string mirror(const std::string& op){
+        if(op == "<"){
+            return ">";
+        }
+        if(op == "<="){
+            return ">=";
+        }
+        if(op == ">"){
+            return "<";
+        }
+        if(op == ">="){
+            return "<=";
+        }
+        return op;
+    }
+
+    std::string negate(const std::string& op){
+        if(op == "="){
+            return "!=";
+        }
+        if(op == "!=" || op == "<>"){
+            return "=";
+        }
+        if(op == "<"){
+            return ">=";
+        }
+        if(op == "<="){
+            return ">";
+        }
+        if(op == ">"){
+            return "<=";
+        }
+        if(op == ">="){
+            return "<";
+        }
+        return "";
+    }
+
+    NodePtr fold(const NodePtr& node);
+
+    NodePtr foldNot(const NodePtr& node){
+        const NodePtr child = node->children.at(0);
+        if(child->kind == NodeKind::LITERAL && child->literal == LiteralType::BOOL){
+            return makeBool(child->ivalue == 0);
+        }
+        if(child->kind == NodeKind::NOT){
+            return child->children.at(0);
+        }
+        if(child->kind == NodeKind::COMPARE && !negate(child->text).empty()){
+            NodePtr inverted = makeNode(NodeKind::COMPARE,negate(child->text));
+            inverted->children = child->children;
+            return inverted;
+        }
+        if(child->kind == NodeKind::BETWEEN || child->kind == NodeKind::IN ||
+           child->kind == NodeKind::LIKE || child->kind == NodeKind::IS_NULL){
+            NodePtr inverted = makeNode(child->kind,child->text);
+            inverted->children = child->children;
+            inverted->negated = !child->negated;
+            return inverted;
+        }
+        return node;
+    }
+
+    NodePtr foldComparison(const NodePtr& node){
+        const int value = evaluateComparison(node->text,compareLiterals(node->children.at(0),node->children.at(1)));
+        if(value >= 0){
+            return makeBool(value == 1);
+        }
+        // 常量统一放到比较右侧
+        if(node->children.at(0)->kind == NodeKind::LITERAL && node->children.at(1)->kind != NodeKind::LITERAL &&
+           node->text != "=="){
+            NodePtr swapped = makeNode(NodeKind::COMPARE,mirror(node->text));
+            swapped->children.push_back(node->children.at(1));
+            swapped->children.push_back(node->children.at(0));
+            return swapped;
+        }
+        return node;
+    }
+
+    // 拆分 base、base + n 或 base - n（base 为列名，n 为数值常量），offset 为带符号的 n
+    bool splitOffset(const NodePtr& node, std::string& base, double& offset){
+        if(node->kind == NodeKind::ATOM){
+            base = node->text;
+            offset = 0;
+            return true;
+        }
+        if(node->kind != NodeKind::ARITH || (node->text != "+" && node->text != "-")){
+            return false;
+        }
+        const NodePtr& l = node->children.at(0);
+        const NodePtr& r = node->children.at(1);
+        if(l->kind == NodeKind::ATOM && isNumber(r)){
+            base = l->text;
+            offset = node->text == "+" ? r->dvalue : -r->dvalue;
+            return true;
+        }
+        if(node->text == "+" && isNumber(l) && r->kind == NodeKind::ATOM){
+            base = r->text;
+            offset = l->dvalue;
+            return true;
+        }
+        return false;
+    }
+
+    NodePtr foldBetween(const NodePtr& node){
+        const int lower = compareLiterals(node->children.at(1),node->children.at(2));
+        if(isNumber(node->children.at(1)) && lower == 1 && !node->negated){
+            return makeBool(false);
+        }
+        // 上下界是同一列加不同的常量时比较两个常量
+        std::string lowBase,highBase;
+        double lowOffset = 0,highOffset = 0;
+        if(!node->negated && splitOffset(node->children.at(1),lowBase,lowOffset) && splitOffset(node->children.at(2),highBase,highOffset) &&
+           lowBase == highBase && lowOffset > highOffset){
+            return makeBool(false);
+        }
+        const int low = evaluateComparison(">=",compareLiterals(node->children.at(0),node->children.at(1)));
+        const int high = evaluateComparison("<=",compareLiterals(node->children.at(0),node->children.at(2)));
+        if(low >= 0 && high >= 0){
+            return makeBool((low == 1 && high == 1) != node->negated);
+        }
+        return node;
+    }
+
+    NodePtr foldIn(const NodePtr& node){
+        bool found = false;
+        for(size_t i = 1;i < node->children.size();++i){
+            const int value = evaluateComparison("=",compareLiterals(node->children.at(0),node->children.at(i)));
+            if(value < 0){
+                return node;
+            }
+            found = found || value == 1;
+        }
+        return makeBool(found != node->negated);
+    }
+
+    // 单列上（或两列之差上）数值区间或等值条件互相矛盾
+    bool hasContradiction(const std::vector<NodePtr>& conjuncts){
+        struct Range {
+            bool hasLower = false, lowerInclusive = false, hasUpper = false, upperInclusive = false;
+            double lower = 0, upper = 0;
+            NodePtr text;
+        };
+        std::map<std::string, Range> ranges;
+        std::unordered_set<std::string> texts;
+        for(const NodePtr& c : conjuncts){
+            texts.insert(print(c,1));
+        }
+        for(const NodePtr& c : conjuncts){
+            if(c->kind == NodeKind::NOT && texts.count(print(c->children.at(0),1))){
+                return true;
+            }
+            if(c->kind != NodeKind::COMPARE || c->children.at(0)->kind != NodeKind::ATOM){
+                continue;
+            }
+            const NodePtr& value = c->children.at(1);
+            const std::string& op = c->text;
+            std::string key = c->children.at(0)->text,base;
+            double v = 0;
+            if(value->kind == NodeKind::LITERAL && value->literal == LiteralType::NUMBER){
+                v = value->dvalue;
+            }else if(value->kind != NodeKind::LITERAL && splitOffset(value,base,v)){
+                // column op base + n 约束的是 column - base 的区间
+                key += " - " + base;
+            }else if(value->kind == NodeKind::LITERAL && value->literal == LiteralType::STRING && (op == "=" || op == "==")){
+                Range& range = ranges[key];
+                if(range.text != nullptr && compareLiterals(value,range.text) == 2){
+                    return true;
+                }
+                range.text = value;
+                continue;
+            }else{
+                continue;
+            }
+            Range& range = ranges[key];
+            if(op == ">" || op == ">=" || op == "=" || op == "=="){
+                const bool inclusive = op != ">";
+                if(!range.hasLower || v > range.lower || (v == range.lower && !inclusive)){
+                    range.lower = v;
+                    range.lowerInclusive = inclusive;
+                    range.hasLower = true;
+                }
+            }
+            if(op == "<" || op == "<=" || op == "=" || op == "=="){
+                const bool inclusive = op != "<";
+                if(!range.hasUpper || v < range.upper || (v == range.upper && !inclusive)){
+                    range.upper = v;
+                    range.upperInclusive = inclusive;
+                    range.hasUpper = true;
+                }
+            }
+            if(range.hasLower && range.hasUpper &&
+               (range.lower > range.upper ||
+                (range.lower == range.upper && !(range.lowerInclusive && range.upperInclusive)))){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    NodePtr foldLogic(const NodePtr& node){
+        const bool isAnd = node->kind == NodeKind::AND;
+        std::vector<NodePtr> children;
+        std::unordered_set<std::string> seen;
+        std::vector<NodePtr> pending(node->children.begin(),node->children.end());
+        for(size_t i = 0;i < pending.size();++i){
+            const NodePtr& child = pending.at(i);
+            if(child->kind == node->kind){
+                // 展平同类嵌套，保持原有顺序
+                pending.insert(pending.begin() + i + 1,child->children.begin(),child->children.end());
+                continue;
+            }
+            if(isBool(child,isAnd)){
+                continue;
+            }
+            if(isBool(child,!isAnd)){
+                return makeBool(!isAnd);
+            }
+            if(seen.insert(print(child,1)).second){
+                children.push_back(child);
+            }
+        }
+        if(isAnd && hasContradiction(children)){
+            return makeBool(false);
+        }
+        if(children.empty()){
+            return makeBool(isAnd);
+        }
+        if(children.size() == 1){
+            return children.at(0);
+        }
+        NodePtr folded = makeNode(node->kind,node->text);
+        folded->children = children;
+        return folded;
+    }
+
+    NodePtr fold(const NodePtr& node){
+        for(NodePtr& child : node->children){
+            child = fold(child);
+        }
+        switch(node->kind){
+            case NodeKind::NEGATE:
+                if(isNumber(node->children.at(0))){
+                    const NodePtr& child = node->children.at(0);
+                    return child->integral ? makeInteger(-child->ivalue) : makeNumber(-child->dvalue);
+                }
+                return node;
+            case NodeKind::ARITH:
+                return foldArithmetic(node);
+            case NodeKind::COMPARE:
+                return foldComparison(node);
+            case NodeKind::BETWEEN:
+                return foldBetween(node);
+            case NodeKind::IN:
+                return foldIn(node);
+            case NodeKind::IS_NULL:
+                if(node->children.at(0)->kind == NodeKind::LITERAL){
+                    return makeBool((node->children.at(0)->literal == LiteralType::NIL) != node->negated);
+                }
+                return node;
+            case NodeKind::NOT:
+                return foldNot(node);
+            case NodeKind::AND:
+            case NodeKind::OR:
+                return foldLogic(node);
+            default:
+                return node;
+        }
+    }
+}
+
+SqlPredicateSimplifier::SqlPredicateSimplifier(){}
+
+std::string SqlPredicateSimplifier::simplify(const std::string& condition){
+    if(XStringUtils::isBlank(condition)){
+        return condition;
+    }
+    try{
+        const std::vector<Token> tokens = tokenize(condition);
+        NodePtr node = fold(Parser(tokens).parse());
+        // not 之下还可能出现新的可折叠形状，再整理一轮
+        node = fold(node);
+        return print(node,1);
+    }catch(const UnsupportedSyntax&){
+        return condition;
+    }
+}
+
+bool SqlPredicateSimplifier::isAlwaysTrue(const std::string& condition){
+    return ALWAYS_TRUE == XStringUtils::toLowerCase(XStringUtils::trim(condition));
+}
+
+bool SqlPredicateSimplifier::isAlwaysFalse(const std::string& condition){
+    return ALWAYS_FALSE == XStringUtils::toLowerCase(XStringUtils::trim(condition));
+}
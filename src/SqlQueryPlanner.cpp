@@ -1,24 +1,81 @@
 #include "../include/SqlQueryPlanner.h"
 #include "../include/ProtocolRelation.h"
+#include "../include/SqlQueryRewriter.h"
+#include "../include/SqlSyntaxUtils.h"
 std::shared_ptr<SqlPlan> SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt){
     std::vector<std::shared_ptr<ClassDefinition>> steps;
     std::shared_ptr<MutableInt> currentId = std::make_shared<MutableInt>(-1);
     std::shared_ptr<MutableInt> lastSpool = std::make_shared<MutableInt>(-1);
 
-    plan(stmt,steps,currentId,lastSpool);
+    std::vector<std::string> diagnostics;
+    estimator = std::make_shared<SqlCostEstimator>(catalog);
+    plan(SqlQueryRewriter::rewrite(stmt,diagnostics),steps,currentId,lastSpool);
 
     std::vector<std::string> plan;
+    std::vector<SqlStepEstimate> estimates;
     for(auto step : steps){
         plan.push_back(step->toString());
+        estimates.push_back(estimator->get(SqlCostEstimator::stepId(plan.back())));
     }
 
-    return std::make_shared<SqlPlan>(plan);
+    std::shared_ptr<SqlPlan> result = std::make_shared<SqlPlan>(plan,diagnostics);
+    result->setEstimates(estimates);
+    return result;
 }
+
+void SqlQueryPlanner::setStatisticsCatalog(std::shared_ptr<StatisticsCatalog> catalog){
+    this->catalog = catalog;
+}
+
+void SqlQueryPlanner::setBroadcastBudget(double bytes){
+    this->broadcastBudget = bytes;
+}
+
+void SqlQueryPlanner::addBroadcastHint(const std::string& relation){
+    broadcastHints.insert(relation);
+}
+
+void SqlQueryPlanner::planIntervalJoin(const std::shared_ptr<ClassDefinition>& step,const SqlJoinStep& join,
+                int id,int leftSpool,int rightSpool,const std::string& joinType){
+                    step->setClassName("IntervalJoin");
+                    if(!join.getLefts().empty()){
+                        step->addParameter("lefts",ExpressionModelUtils::mergeTerms(join.getLefts()));
+                        step->addParameter("rights",ExpressionModelUtils::mergeTerms(join.getRights()));
+                    }
+                    step->addParameter("left_time",join.getLeftTime());
+                    step->addParameter("right_time",join.getRightTime());
+                    step->addParameter("lower",join.getLower());
+                    step->addParameter("upper",join.getUpper());
+                    if(!join.getResidual().empty()){
+                        step->addParameter("residual",join.getResidual());
+                    }
+                    estimator->intervalJoin(id,leftSpool,rightSpool,join.getLefts(),join.getRights(),join.getResidual(),joinType);
+                }
+
+void SqlQueryPlanner::planAsofJoin(const std::shared_ptr<ClassDefinition>& step,const SqlJoinStep& join,
+                int id,int leftSpool,int rightSpool){
+                    step->setClassName("AsofJoin");
+                    if(!join.getLefts().empty()){
+                        step->addParameter("lefts",ExpressionModelUtils::mergeTerms(join.getLefts()));
+                        step->addParameter("rights",ExpressionModelUtils::mergeTerms(join.getRights()));
+                    }
+                    step->addParameter("left_time",join.getLeftTime());
+                    step->addParameter("right_time",join.getRightTime());
+                    step->addParameter("match",join.getMatch());
+                    if(!join.getResidual().empty()){
+                        step->addParameter("residual",join.getResidual());
+                    }
+                    estimator->asofJoin(id,leftSpool,rightSpool,join.getLefts(),join.getRights());
+                }
   
 void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                 std::vector<std::shared_ptr<ClassDefinition>>& steps,
                 std::shared_ptr<MutableInt>& currentId,
                 std::shared_ptr<MutableInt>& lastSpool){
+                    if(stmt->isAlwaysEmpty()){
+                        planEmpty(stmt,steps,currentId,lastSpool);
+                        return;
+                    }
                    
                     if(auto q = std::dynamic_pointer_cast<QueryRelation>(stmt->getFrom())){
                         if(q && q->getStatement()){
@@ -33,47 +90,44 @@ void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
                         step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
                         step->addParameter("name",table->getName());
+                        estimator->input(currentId->getValue(),table->getName());
 
                         steps.push_back(step);
 
                         lastSpool->set(currentId->getValue());
                     }
 
-                    if(XStringUtils::isNotBlank(stmt->getWhere())){
-                        currentId->increment();
-
-                        std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
-                        step->setClassName("Filter");
-                        step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
-                        step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
-                        step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
-                        step->addParameter("condition",stmt->getWhere());
-
-                        steps.push_back(step);
-
-                        lastSpool->set(currentId->getValue());
+                    if(XStringUtils::isNotBlank(stmt->getComputes())){
+                        planComputes(stmt->getComputes(),steps,currentId,lastSpool);
                     }
 
+                    // 连接语句的 where 按关系拆开，只引用一个关系的条件下推到该关系的输入之后
+                    std::string where = stmt->getWhere();
+                    std::vector<std::string> filters = {where};
                     if(stmt->getJoin() != nullptr){
+                        filters = SqlJoinChain(stmt).pushdown(where);
+                    }else{
+                        where.clear();
+                    }
+                    if(XStringUtils::isNotBlank(filters.at(0))){
+                        planFilter(filters.at(0),steps,currentId,lastSpool);
+                    }
+                    if(XStringUtils::isNotBlank(stmt->getFilteredComputes())){
+                        planComputes(stmt->getFilteredComputes(),steps,currentId,lastSpool);
+                    }
+
+                    // 连接之后还有过滤或聚合时连接输出全部列
+                    const bool joinOutputsAll = XStringUtils::isNotBlank(where) || XStringUtils::isNotBlank(stmt->getGroupbys()) ||
+                                                (stmt->getInterval() != nullptr && stmt->getInterval()->getTimeAmount() > 0);
+                    const std::string selects = joinOutputsAll ? "*" : stmt->getSelects();
+                    if(stmt->getJoins().size() > 1){
+                        planJoins(stmt,selects,filters,steps,currentId,lastSpool);
+                    }else if(stmt->getJoin() != nullptr){
                         std::shared_ptr<SqlJoinSpec> join =stmt->getJoin();
                         std::shared_ptr<MutableInt> fromSpool = std::make_shared<MutableInt>(lastSpool->getValue());
-                        if(auto q = std::dynamic_pointer_cast<QueryRelation>(join->getRelation())){
-                            if(q && q->getStatement()){
-                                plan(q->getStatement(),steps,currentId,lastSpool);
-                            }
-                        }else{
-                            currentId->increment();
-
-                            std::shared_ptr<TableRelation> table = std::dynamic_pointer_cast<TableRelation>(join->getRelation());
-                            std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
-                            step->setClassName("Input");
-                            step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
-                            step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
-                            step->addParameter("name",table->getName());
-
-                            steps.push_back(step);
-
-                            lastSpool->set(currentId->getValue());
+                        planRelation(join->getRelation(),steps,currentId,lastSpool);
+                        if(XStringUtils::isNotBlank(filters.at(1))){
+                            planFilter(filters.at(1),steps,currentId,lastSpool);
                         }
 
                         currentId->increment();
@@ -93,18 +147,48 @@ void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         }
                         std::vector<std::string> leftTerms ,rightTerms;
                         const std::string joinType = XStringUtils::toLowerCase(toString(join->getType()));
-                        if(ExpressionModelUtils::isReduceJoinCondition(join->getConditionExp(),leftAlias,rightAlias,leftTerms,rightTerms)){
-                            step->setClassName("ReduceJoin");
-                            step->addParameter("selects",stmt->getSelects());
+                        std::string residual;
+                        SqlJoinStep split;
+                        bool keyed = join->getType() != SqlJoinType::ASOF &&
+                                     ExpressionModelUtils::isReduceJoinCondition(join->getConditionExp(),leftAlias,rightAlias,leftTerms,rightTerms);
+                        if(!keyed){
+                            // 只要有等值条件就按 key 连接，其余条件作为 residual 只在 key 相等的行对上检查
+                            split = SqlJoinChain(stmt).steps({0,1}).at(0);
+                            keyed = !split.getLefts().empty();
+                            leftTerms = split.getLefts();
+                            rightTerms = split.getRights();
+                            residual = split.getResidual();
+                        }
+                        if(split.isAsofJoin()){
+                            planAsofJoin(step,split,currentId->getValue(),fromSpool->getValue(),lastSpool->getValue());
+                            step->addParameter("selects",selects);
+                            step->addParameter("left_alias",leftAlias);
+                            step->addParameter("right_alias",rightAlias);
+                            step->addParameter("join_type",joinType);
+                        }else if(split.isBandJoin()){
+                            planIntervalJoin(step,split,currentId->getValue(),fromSpool->getValue(),lastSpool->getValue(),joinType);
+                            step->addParameter("selects",selects);
+                            step->addParameter("left_alias",leftAlias);
+                            step->addParameter("right_alias",rightAlias);
+                            step->addParameter("join_type",joinType);
+                        }else if(keyed){
+                            const bool broadcast = estimator->isBroadcastJoin(join->getType(),join->getRelation(),lastSpool->getValue(),broadcastHints,broadcastBudget);
+                            step->setClassName(broadcast ? "BroadcastHashJoin" : "ReduceJoin");
+                            step->addParameter("selects",selects);
                             step->addParameter("lefts",ExpressionModelUtils::mergeTerms(leftTerms));
                             step->addParameter("rights",ExpressionModelUtils::mergeTerms(rightTerms));
+                            if(!residual.empty()){
+                                step->addParameter("residual",residual);
+                            }
+                            estimator->join(currentId->getValue(),fromSpool->getValue(),lastSpool->getValue(),leftTerms,rightTerms,residual,joinType,broadcast);
                             step->addParameter("left_alias",leftAlias);
                             step->addParameter("right_alias",rightAlias);
                             step->addParameter("join_type",joinType);
                         }else{
                             step->setClassName("NestedJoin");
-                            step->addParameter("selects",stmt->getSelects());
+                            step->addParameter("selects",selects);
                             step->addParameter("condition",join->getCondition());
+                            estimator->join(currentId->getValue(),fromSpool->getValue(),lastSpool->getValue(),{},{},join->getCondition(),joinType);
                             step->addParameter("left_alias",leftAlias);
                             step->addParameter("right_alias",rightAlias);
                             step->addParameter("join_type",joinType);
@@ -113,7 +197,13 @@ void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         steps.push_back(step);
 
                         lastSpool->set(currentId->getValue());
-                    }else if(XStringUtils::isNotBlank(stmt->getGroupbys()) || (stmt->getInterval() != nullptr && stmt->getInterval()->getTimeAmount() > 0)){
+                    }
+
+                    if(XStringUtils::isNotBlank(where)){
+                        planFilter(where,steps,currentId,lastSpool);
+                    }
+
+                    if(XStringUtils::isNotBlank(stmt->getGroupbys()) || (stmt->getInterval() != nullptr && stmt->getInterval()->getTimeAmount() > 0)){
                         currentId->increment();
 
                         std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
@@ -131,6 +221,7 @@ void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                             step->addParameter("interval",std::to_string(stmt->getInterval()->getTimeAmount()));
                             step->addParameter("time_unit",stmt->getInterval()->getTimeUnit());
                         }
+                        estimator->aggregate(currentId->getValue(),lastSpool->getValue(),stmt->getGroupbys(),stmt->getSelects());
 
                         steps.push_back(step);
 
@@ -144,6 +235,7 @@ void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                             hvstep->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
                             hvstep->addAttribute("output","s_" + std::to_string(currentId->getValue()));
                             hvstep->addParameter("condition",stmt->getHaving());
+                            estimator->filter(currentId->getValue(),lastSpool->getValue(),stmt->getHaving());
 
                             steps.push_back(hvstep);
 
@@ -171,6 +263,8 @@ void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         }else if("sliding" == XStringUtils::toLowerCase(spec->getType())){
                             std::shared_ptr<SlidingWindowSpec> swspec = std::dynamic_pointer_cast<SlidingWindowSpec>(spec);
                             step->setClassName("Sliding"+ windowKind);
+                            // 标注每个窗口聚合在行移出窗口时的增量策略
+                            step->addParameter("aggregations",SqlSyntaxUtils::getWindowAggregations(stmt->getSelects()));
                             step->addParameter("inclusion",swspec->getInclusion());
                             step->addParameter("selects",stmt->getSelects());
                             step->addParameter("validity",swspec->getHaving());
@@ -181,11 +275,12 @@ void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                             step->addParameter("selects",stmt->getSelects());
                             step->addParameter("validity",twspec->getHaving());
                         }
+                        estimator->window(currentId->getValue(),lastSpool->getValue());
 
                         steps.push_back(step);
 
                         lastSpool->set(currentId->getValue());
-                    }else if(!stmt->isSelectAll()){
+                    }else if(!stmt->isSelectAll() && (stmt->getJoin() == nullptr || XStringUtils::isNotBlank(where))){
                         currentId->increment();
 
                         std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
@@ -194,6 +289,7 @@ void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
                         step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
                         step->addParameter("selects",stmt->getSelects());
+                        estimator->project(currentId->getValue(),lastSpool->getValue(),stmt->getSelects());
 
                         steps.push_back(step);
 
@@ -231,6 +327,7 @@ void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                             step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
                             step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
                             step->addParameter("rows",std::to_string(stmt->getLimit()));
+                            estimator->take(currentId->getValue(),lastSpool->getValue(),stmt->getLimit());
 
                             steps.push_back(step);
 
@@ -252,6 +349,7 @@ void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
                         step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
                         step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
                         step->addParameter("name",table->getName());
+                        estimator->output(currentId->getValue(),lastSpool->getValue());
 
                         steps.push_back(step);
                     }
@@ -261,7 +359,170 @@ void SqlQueryPlanner::plan(const std::shared_ptr<SqlStatement>& stmt,
 
 
 
+void SqlQueryPlanner::planEmpty(const std::shared_ptr<SqlStatement>& stmt,
+                std::vector<std::shared_ptr<ClassDefinition>>& steps,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool){
+                    currentId->increment();
+
+                    std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
+                    step->setClassName("Empty");
+                    step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                    step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                    estimator->empty(currentId->getValue());
+                    if(!stmt->isSelectAll()){
+                        step->addParameter("selects",stmt->getSelects());
+                    }
+
+                    steps.push_back(step);
+
+                    lastSpool->set(currentId->getValue());
+
+                    if(stmt->getInto() != nullptr){
+                        currentId->increment();
+
+                        if(std::dynamic_pointer_cast<ProtocolRelation>(stmt->getInto())){
+                            throw std::runtime_error("protocol into not supported yet, please add");
+                        }
+
+                        std::shared_ptr<TableRelation> table = std::dynamic_pointer_cast<TableRelation>(stmt->getInto());
+                        std::shared_ptr<ClassDefinition> output = std::make_shared<ClassDefinition>();
+                        output->setClassName("Output");
+                        output->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                        output->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
+                        output->addParameter("name",table->getName());
+                        estimator->output(currentId->getValue(),lastSpool->getValue());
+
+                        steps.push_back(output);
+                    }
+                }
  
+void SqlQueryPlanner::planComputes(const std::string& computes,
+                std::vector<std::shared_ptr<ClassDefinition>>& steps,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool){
+                    currentId->increment();
+
+                    std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
+                    step->setClassName("Project");
+                    step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                    step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
+                    step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                    step->addParameter("selects","*, " + computes);
+                    estimator->project(currentId->getValue(),lastSpool->getValue(),"*, " + computes);
+
+                    steps.push_back(step);
+
+                    lastSpool->set(currentId->getValue());
+                }
+
+void SqlQueryPlanner::planFilter(const std::string& condition,
+                std::vector<std::shared_ptr<ClassDefinition>>& steps,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool){
+                    currentId->increment();
+
+                    std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
+                    step->setClassName("Filter");
+                    step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                    step->addAttribute("input","s_" + std::to_string(lastSpool->getValue()));
+                    step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                    step->addParameter("condition",condition);
+                    estimator->filter(currentId->getValue(),lastSpool->getValue(),condition);
+
+                    steps.push_back(step);
+
+                    lastSpool->set(currentId->getValue());
+                }
+
+void SqlQueryPlanner::planRelation(const std::shared_ptr<SqlRelation>& relation,
+                std::vector<std::shared_ptr<ClassDefinition>>& steps,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool){
+                    if(auto q = std::dynamic_pointer_cast<QueryRelation>(relation)){
+                        if(q->getStatement()){
+                            plan(q->getStatement(),steps,currentId,lastSpool);
+                        }
+                        return;
+                    }
+                    currentId->increment();
+
+                    std::shared_ptr<TableRelation> table = std::dynamic_pointer_cast<TableRelation>(relation);
+                    std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
+                    step->setClassName("Input");
+                    step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                    step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                    step->addParameter("name",table->getName());
+                    estimator->input(currentId->getValue(),table->getName());
+
+                    steps.push_back(step);
+
+                    lastSpool->set(currentId->getValue());
+                }
+
+void SqlQueryPlanner::planJoins(const std::shared_ptr<SqlStatement>& stmt,
+                const std::string& selects,
+                const std::vector<std::string>& filters,
+                std::vector<std::shared_ptr<ClassDefinition>>& steps,
+                std::shared_ptr<MutableInt>& currentId,
+                std::shared_ptr<MutableInt>& lastSpool){
+                    SqlJoinChain chain(stmt);
+                    // from 的输入已经规划好，其余关系按书写顺序规划输入
+                    std::vector<int> spools = {lastSpool->getValue()};
+                    for(size_t i = 1;i < chain.size();++i){
+                        planRelation(chain.getRelation(i),steps,currentId,lastSpool);
+                        if(XStringUtils::isNotBlank(filters.at(i))){
+                            planFilter(filters.at(i),steps,currentId,lastSpool);
+                        }
+                        spools.push_back(lastSpool->getValue());
+                    }
+
+                    const std::vector<int> order = chain.order(estimator,spools);
+                    const std::vector<SqlJoinStep> joins = chain.steps(order);
+                    int leftSpool = spools.at(order.at(0));
+                    for(size_t i = 0;i < joins.size();++i){
+                        const SqlJoinStep& join = joins.at(i);
+                        const int rightSpool = spools.at(join.getRelation());
+                        const std::string joinType = XStringUtils::toLowerCase(toString(join.getType()));
+
+                        currentId->increment();
+
+                        std::shared_ptr<ClassDefinition> step = std::make_shared<ClassDefinition>();
+                        step->addAttribute("id","d_" + std::to_string(currentId->getValue()));
+                        step->addAttribute("input","s_" + std::to_string(leftSpool));
+                        step->addAttribute("input2","s_" + std::to_string(rightSpool));
+                        step->addAttribute("output","s_" + std::to_string(currentId->getValue()));
+                        if(join.isAsofJoin()){
+                            planAsofJoin(step,join,currentId->getValue(),leftSpool,rightSpool);
+                        }else if(join.isBandJoin()){
+                            planIntervalJoin(step,join,currentId->getValue(),leftSpool,rightSpool,joinType);
+                        }else if(!join.getLefts().empty()){
+                            const bool broadcast = estimator->isBroadcastJoin(join.getType(),chain.getRelation(join.getRelation()),rightSpool,broadcastHints,broadcastBudget);
+                            step->setClassName(broadcast ? "BroadcastHashJoin" : "ReduceJoin");
+                            step->addParameter("lefts",ExpressionModelUtils::mergeTerms(join.getLefts()));
+                            step->addParameter("rights",ExpressionModelUtils::mergeTerms(join.getRights()));
+                            if(!join.getResidual().empty()){
+                                step->addParameter("residual",join.getResidual());
+                            }
+                            estimator->join(currentId->getValue(),leftSpool,rightSpool,join.getLefts(),join.getRights(),join.getResidual(),joinType,broadcast);
+                        }else{
+                            step->setClassName("NestedJoin");
+                            step->addParameter("condition",join.getCondition());
+                            estimator->join(currentId->getValue(),leftSpool,rightSpool,{},{},join.getCondition(),joinType);
+                        }
+                        // 中间结果保留全部列，最后一个连接才输出 selects
+                        step->addParameter("selects",i + 1 == joins.size() ? selects : "*");
+                        step->addParameter("left_alias",ExpressionModelUtils::mergeTerms(join.getLeftAliases()));
+                        step->addParameter("right_alias",join.getRightAlias());
+                        step->addParameter("join_type",joinType);
+
+                        steps.push_back(step);
+
+                        leftSpool = currentId->getValue();
+                    }
+                    lastSpool->set(leftSpool);
+                }
+
 bool SqlQueryPlanner::selectOnly(std::shared_ptr<SqlStatement> stmt){
     return XStringUtils::isBlank(stmt->getWhere()) && XStringUtils::isBlank(stmt->getGroupbys()) && stmt->getWindow() == nullptr;
 }
\ No newline at end of file
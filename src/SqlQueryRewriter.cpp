@@ -0,0 +1,477 @@
+#include "../include/SqlQueryRewriter.h"
+#include "../include/SqlSyntaxUtils.h"
+#include "../include/SqlPredicateSimplifier.h"
+#include "XStringUtils.h"
+
+SqlQueryRewriter::SqlQueryRewriter(){}
+
+std::shared_ptr<SqlStatement> SqlQueryRewriter::rewrite(const std::shared_ptr<SqlStatement>& stmt){
+    std::vector<std::string> diagnostics;
+    return rewrite(stmt,diagnostics);
+}
+
+std::shared_ptr<SqlStatement> SqlQueryRewriter::rewrite(const std::shared_ptr<SqlStatement>& stmt,
+                                                        std::vector<std::string>& diagnostics){
+    if(stmt == nullptr){
+        return stmt;
+    }
+    int eliminated = 0;
+    std::shared_ptr<SqlStatement> result = eliminateCommonSubexpressions(optimize(stmt),eliminated);
+    if(eliminated > 0){
+        diagnostics.push_back("cse_eliminated_evaluations=" + std::to_string(eliminated));
+    }
+    return result;
+}
+
+std::shared_ptr<SqlStatement> SqlQueryRewriter::optimize(const std::shared_ptr<SqlStatement>& stmt){
+    return simplifyPredicates(mergeSubquery(rewriteRelations(stmt,optimize)));
+}
+
+std::shared_ptr<SqlStatement> SqlQueryRewriter::rewriteRelations(
+    const std::shared_ptr<SqlStatement>& stmt,
+    const std::function<std::shared_ptr<SqlStatement>(const std::shared_ptr<SqlStatement>&)>& rewriter){
+    std::shared_ptr<SqlStatement> result = stmt;
+
+    if(auto q = std::dynamic_pointer_cast<QueryRelation>(stmt->getFrom())){
+        if(q->getStatement()){
+            std::shared_ptr<SqlStatement> sub = rewriter(q->getStatement());
+            if(sub != q->getStatement()){
+                std::shared_ptr<QueryRelation> relation = std::make_shared<QueryRelation>();
+                relation->setStatement(sub);
+                relation->setAlias(q->getAlias());
+
+                result = stmt->clone();
+                result->setFrom(relation);
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<SqlJoinSpec>> joins = result->getJoins();
+    bool changed = false;
+    for(size_t i = 0;i < joins.size();++i){
+        std::shared_ptr<SqlJoinSpec> join = joins.at(i);
+        if(auto q = std::dynamic_pointer_cast<QueryRelation>(join->getRelation())){
+            if(q->getStatement()){
+                std::shared_ptr<SqlStatement> sub = rewriter(q->getStatement());
+                if(sub != q->getStatement()){
+                    std::shared_ptr<QueryRelation> relation = std::make_shared<QueryRelation>();
+                    relation->setStatement(sub);
+                    relation->setAlias(q->getAlias());
+
+                    std::shared_ptr<SqlJoinSpec> spec = std::make_shared<SqlJoinSpec>();
+                    spec->setRelation(relation);
+                    spec->setType(join->getType());
+                    spec->setCondition(join->getCondition());
+                    spec->getConditionExp()->setLeftRightAlias(result->getFrom()->getAlias(),relation->getAlias());
+
+                    joins[i] = spec;
+                    changed = true;
+                }
+            }
+        }
+    }
+    if(changed){
+        if(result == stmt){
+            result = stmt->clone();
+        }
+        result->setJoins(joins);
+    }
+    return result;
+}
+
+std::shared_ptr<SqlStatement> SqlQueryRewriter::mergeSubquery(const std::shared_ptr<SqlStatement>& stmt){
+    std::shared_ptr<QueryRelation> relation = std::dynamic_pointer_cast<QueryRelation>(stmt->getFrom());
+    if(!relation || !relation->getStatement() || stmt->getJoin() != nullptr){
+        return stmt;
+    }
+
+    std::shared_ptr<SqlStatement> inner = relation->getStatement();
+    if(inner->getJoin() != nullptr || inner->getWindow() != nullptr || inner->getLimit() > 0 || inner->getInto() != nullptr){
+        return stmt;
+    }
+    if(isAggregate(inner)){
+        return mergeIntoAggregate(stmt,relation);
+    }
+    // 没有 GROUP BY 的全局聚合输出的是聚合结果，外层条件不能下推成聚合之前的过滤
+    if(SqlSyntaxUtils::hasAggregateCall(inner->getSelects())){
+        return stmt;
+    }
+    return mergeIntoProjection(stmt,relation);
+}
+
+std::shared_ptr<SqlStatement> SqlQueryRewriter::mergeIntoAggregate(const std::shared_ptr<SqlStatement>& stmt,
+                                                                   const std::shared_ptr<QueryRelation>& relation){
+    std::shared_ptr<SqlStatement> inner = relation->getStatement();
+    if(isAggregate(stmt) || stmt->getWindow() != nullptr){
+        return stmt;
+    }
+    if(XStringUtils::isBlank(stmt->getWhere()) && !stmt->isSelectAll()){
+        return stmt;
+    }
+    if(SqlSyntaxUtils::isStateful(stmt->getWhere())){
+        return stmt;
+    }
+
+    // 外层 where 引用的是聚合结果的列名，直接并入 having，只需去掉子查询别名前缀
+    std::shared_ptr<SqlStatement> merged = inner->clone();
+    if(XStringUtils::isNotBlank(stmt->getWhere())){
+        const std::string condition = SqlSyntaxUtils::replaceIdentifiers(stmt->getWhere(),relation->getAlias(),{});
+        merged->setHaving(SqlSyntaxUtils::conjoin(inner->getHaving(),condition));
+    }
+
+    if(stmt->isSelectAll()){
+        merged->setInto(stmt->getInto());
+        merged->setLimit(stmt->getLimit());
+        merged->setQuery(stmt->getQuery());
+        return merged;
+    }
+
+    // 外层还有投影，保留一层只做 Project
+    std::shared_ptr<QueryRelation> mergedRelation = std::make_shared<QueryRelation>();
+    mergedRelation->setStatement(merged);
+    mergedRelation->setAlias(relation->getAlias());
+
+    std::shared_ptr<SqlStatement> outer = std::make_shared<SqlStatement>();
+    outer->setFrom(mergedRelation);
+    outer->setInto(stmt->getInto());
+    outer->setSelects(stmt->getSelects());
+    outer->setLimit(stmt->getLimit());
+    outer->setQuery(stmt->getQuery());
+    return outer;
+}
+
+std::shared_ptr<SqlStatement> SqlQueryRewriter::mergeIntoProjection(const std::shared_ptr<SqlStatement>& stmt,
+                                                                    const std::shared_ptr<QueryRelation>& relation){
+    std::shared_ptr<SqlStatement> inner = relation->getStatement();
+    const std::string qualifier = relation->getAlias();
+    if(SqlSyntaxUtils::isStateful(inner->getWhere()) || SqlSyntaxUtils::isStateful(stmt->getWhere())){
+        return stmt;
+    }
+
+    // 子查询输出列名 -> 子查询中的表达式
+    std::unordered_map<std::string, std::string> columns;
+    bool pruneOnly = true;
+    if("*" != inner->getSelects()){
+        for(const std::string& item : SqlSyntaxUtils::splitExpressions(inner->getSelects())){
+            if(SqlSyntaxUtils::isStateful(item)){
+                return stmt;
+            }
+            const std::string expr = SqlSyntaxUtils::removeExpressionAlias(item);
+            std::string alias = SqlSyntaxUtils::getExpressionAlias(item);
+            if(alias.empty()){
+                if(!SqlSyntaxUtils::isIdentifier(expr)){
+                    // 引擎生成的列名外层无法引用
+                    pruneOnly = false;
+                    continue;
+                }
+                alias = expr.substr(expr.rfind('.') == std::string::npos ? 0 : expr.rfind('.') + 1);
+            }
+            columns[alias] = expr;
+            if(expr != alias){
+                pruneOnly = false;
+            }
+        }
+    }
+
+    // 聚合、窗口和 having 都按列名工作，只有子查询仅做列裁剪时才能直接上提
+    const bool aggregate = isAggregate(stmt) || stmt->getWindow() != nullptr;
+    if((aggregate || XStringUtils::isNotBlank(stmt->getHaving())) && !pruneOnly){
+        return stmt;
+    }
+    if(stmt->getWindow() != nullptr){
+        std::shared_ptr<SqlWindowSpec> spec = stmt->getWindow();
+        for(const std::string& text : {spec->getKeys(),spec->getSorts(),spec->getHaving()}){
+            if(SqlSyntaxUtils::replaceIdentifiers(text,qualifier,{}) != text){
+                return stmt;
+            }
+        }
+    }
+    if(stmt->getInterval() != nullptr){
+        const std::string time = stmt->getInterval()->getInterval();
+        if(SqlSyntaxUtils::replaceIdentifiers(time,qualifier,{}) != time){
+            return stmt;
+        }
+    }
+
+    std::string selects = "*" == stmt->getSelects() ? inner->getSelects() : composeSelects(stmt->getSelects(),qualifier,columns);
+    if(selects.empty()){
+        return stmt;
+    }
+
+    std::shared_ptr<SqlStatement> merged = std::make_shared<SqlStatement>();
+    merged->setFrom(inner->getFrom());
+    merged->setInto(stmt->getInto());
+    merged->setWindow(stmt->getWindow());
+    merged->setInterval(stmt->getInterval());
+    merged->setSelects(selects);
+    if(XStringUtils::isNotBlank(stmt->getGroupbys())){
+        merged->setGroupbys(SqlSyntaxUtils::replaceIdentifiers(stmt->getGroupbys(),qualifier,columns));
+    }
+    const std::string where = SqlSyntaxUtils::conjoin(inner->getWhere(),
+                                                      SqlSyntaxUtils::replaceIdentifiers(stmt->getWhere(),qualifier,columns));
+    if(XStringUtils::isNotBlank(where)){
+        merged->setWhere(where);
+    }
+    if(XStringUtils::isNotBlank(stmt->getHaving())){
+        merged->setHaving(stmt->getHaving());
+    }
+    merged->setLimit(stmt->getLimit());
+    merged->setQuery(stmt->getQuery());
+    return merged;
+}
+
+std::string SqlQueryRewriter::composeSelects(const std::string& selects,
+                                             const std::string& qualifier,
+                                             const std::unordered_map<std::string, std::string>& columns){
+    std::string composed;
+    for(const std::string& item : SqlSyntaxUtils::splitExpressions(selects)){
+        const std::string expr = SqlSyntaxUtils::removeExpressionAlias(item);
+        const std::string alias = SqlSyntaxUtils::getExpressionAlias(item);
+        const std::string replaced = SqlSyntaxUtils::replaceIdentifiers(expr,qualifier,columns);
+
+        std::string next;
+        if(!alias.empty()){
+            next = replaced + " as " + alias;
+        }else if(SqlSyntaxUtils::isIdentifier(expr)){
+            // 保持输出列名不变
+            const std::string name = expr.rfind(qualifier + ".",0) == 0 ? expr.substr(qualifier.size() + 1) : expr;
+            next = replaced == name ? name : replaced + " as " + name;
+        }else if(replaced == expr){
+            next = expr;
+        }else{
+            // 无别名的表达式改写后引擎生成的列名会变
+            return "";
+        }
+        composed += (composed.empty() ? "" : ", ") + next;
+    }
+    return composed;
+}
+
+bool SqlQueryRewriter::isAggregate(const std::shared_ptr<SqlStatement>& stmt){
+    return XStringUtils::isNotBlank(stmt->getGroupbys()) ||
+           (stmt->getInterval() != nullptr && stmt->getInterval()->getTimeAmount() > 0);
+}
+
+std::shared_ptr<SqlStatement> SqlQueryRewriter::simplifyPredicates(const std::shared_ptr<SqlStatement>& stmt){
+    const std::string where = SqlPredicateSimplifier::simplify(stmt->getWhere());
+    const std::string having = SqlPredicateSimplifier::simplify(stmt->getHaving());
+    // 没有 GROUP BY 的全局聚合在输入为空时仍然输出一行（如 count 为 0），保留计划由恒假的 Filter 滤掉全部行，
+    // 只有 HAVING 恒假时才整个为空
+    const bool global = !isAggregate(stmt) && SqlSyntaxUtils::hasAggregateCall(stmt->getSelects());
+    const bool empty = stmt->isAlwaysEmpty() || SqlPredicateSimplifier::isAlwaysFalse(having) ||
+                       (!global && (isEmptyInput(stmt) || SqlPredicateSimplifier::isAlwaysFalse(where)));
+    if(where == stmt->getWhere() && having == stmt->getHaving() && empty == stmt->isAlwaysEmpty()){
+        return stmt;
+    }
+
+    std::shared_ptr<SqlStatement> result = stmt->clone();
+    if(SqlPredicateSimplifier::isAlwaysTrue(where)){
+        result->removeWhere();
+    }else if(XStringUtils::isNotBlank(where)){
+        result->setWhere(where);
+    }
+    if(SqlPredicateSimplifier::isAlwaysTrue(having)){
+        result->removeHaving();
+    }else if(XStringUtils::isNotBlank(having)){
+        result->setHaving(having);
+    }
+    result->setAlwaysEmpty(empty);
+    return result;
+}
+
+bool SqlQueryRewriter::isEmptyInput(const std::shared_ptr<SqlStatement>& stmt){
+    std::shared_ptr<QueryRelation> left = std::dynamic_pointer_cast<QueryRelation>(stmt->getFrom());
+    // 沿连接链从左到右传递：外连接保留一侧的行，内连接任一侧为空或连接条件恒假即为空
+    bool empty = left && left->getStatement() && left->getStatement()->isAlwaysEmpty();
+    for(auto& join : stmt->getJoins()){
+        std::shared_ptr<QueryRelation> right = std::dynamic_pointer_cast<QueryRelation>(join->getRelation());
+        const bool rightEmpty = right && right->getStatement() && right->getStatement()->isAlwaysEmpty();
+        switch(join->getType()){
+            case SqlJoinType::LEFT:
+            case SqlJoinType::ASOF:
+                break;
+            case SqlJoinType::RIGHT:
+                empty = rightEmpty;
+                break;
+            case SqlJoinType::OUTER:
+            case SqlJoinType::FULL:
+                empty = empty && rightEmpty;
+                break;
+            default:
+                empty = empty || rightEmpty || SqlPredicateSimplifier::isAlwaysFalse(SqlPredicateSimplifier::simplify(join->getCondition()));
+        }
+    }
+    return empty;
+}
+
+std::shared_ptr<SqlStatement> SqlQueryRewriter::eliminateCommonSubexpressions(const std::shared_ptr<SqlStatement>& stmt,
+                                                                              int& eliminated){
+    std::shared_ptr<SqlStatement> result = rewriteRelations(stmt,[&eliminated](const std::shared_ptr<SqlStatement>& sub){
+        return eliminateCommonSubexpressions(sub,eliminated);
+    });
+    return extractComputes(result,eliminated);
+}
+
+std::shared_ptr<SqlStatement> SqlQueryRewriter::extractComputes(const std::shared_ptr<SqlStatement>& stmt, int& eliminated){
+    if(stmt->isAlwaysEmpty() || stmt->getJoin() != nullptr || stmt->getWindow() != nullptr || stmt->isSelectAll() ||
+       XStringUtils::isNotBlank(stmt->getComputes()) || XStringUtils::isNotBlank(stmt->getFilteredComputes())){
+        return stmt;
+    }
+    std::string where = stmt->getWhere(),groupbys = stmt->getGroupbys(),having = stmt->getHaving();
+    if(SqlSyntaxUtils::isStateful(where) || SqlSyntaxUtils::isStateful(stmt->getSelects()) || SqlSyntaxUtils::isStateful(groupbys)){
+        return stmt;
+    }
+
+    // 无别名的 select 项由引擎生成列名，改写后列名会变，不参与提取
+    std::vector<std::string> items = SqlSyntaxUtils::splitExpressions(stmt->getSelects());
+    std::vector<std::string> exprs,aliases;
+    for(const std::string& item : items){
+        aliases.push_back(SqlSyntaxUtils::getExpressionAlias(item));
+        exprs.push_back(aliases.back().empty() ? item : SqlSyntaxUtils::removeExpressionAlias(item));
+    }
+
+    const std::string original = stmt->getQuery() + " " + stmt->getSelects() + " " + where + " " + groupbys + " " + having;
+    // where 引用的计算列在过滤之前求值，其余的只在通过过滤的行上求值
+    std::vector<std::string> computes,filteredComputes;
+    std::vector<std::pair<std::string, std::string>> replaced;
+    int count = 0,next = 0;
+    while(true){
+        std::vector<std::string> order;
+        std::unordered_map<std::string, int> counts;
+        std::unordered_map<std::string, std::string> texts;
+        std::unordered_set<std::string> filtering;
+        auto collect = [&](const std::string& text,bool filter){
+            // case 分支只在条件成立时求值，其中的调用不能提前计算；where 中 and / or 之后的操作数可能被短路，
+            // 其中的调用留在条件里，只有每行都会求值的调用才在过滤之前计算
+            const std::string masked = filter ? SqlSyntaxUtils::maskGuardedExpressions(text) : SqlSyntaxUtils::maskCaseExpressions(text);
+            size_t from = 0;
+            for(const std::string& call : SqlSyntaxUtils::findFunctionCalls(masked)){
+                const size_t pos = masked.find(call,from);
+                from = pos + 1;
+                if(text.compare(pos,call.size(),call) != 0){
+                    continue;
+                }
+                const std::string name = call.substr(0,call.find('('));
+                const std::string key = SqlSyntaxUtils::normalizeExpression(call);
+                // 聚合由后续步骤计算，无参函数（now() 等）每次求值结果可能不同
+                if(SqlSyntaxUtils::isAggregateFunction(name) || key.size() == name.size() + 2){
+                    continue;
+                }
+                if(counts[key]++ == 0){
+                    order.push_back(key);
+                    texts[key] = call;
+                }
+                if(filter){
+                    filtering.insert(key);
+                }
+            }
+        };
+        collect(where,true);
+        collect(groupbys,false);
+        for(size_t i = 0;i < exprs.size();++i){
+            if(!aliases.at(i).empty()){
+                collect(exprs.at(i),false);
+            }
+        }
+
+        std::string best;
+        for(const std::string& key : order){
+            if(counts[key] >= 2 && key.size() > best.size()){
+                best = key;
+            }
+        }
+        if(best.empty()){
+            break;
+        }
+
+        std::string name;
+        do{
+            name = "cse_" + std::to_string(next++);
+        }while(original.find(name) != std::string::npos);
+
+        const std::string& call = texts[best];
+        const bool hoisted = filtering.count(best) > 0;
+        // 只在通过过滤的行上计算的列在 where 中还不存在
+        if(hoisted){
+            where = SqlSyntaxUtils::replaceFunctionCall(where,call,name);
+        }
+        groupbys = SqlSyntaxUtils::replaceFunctionCall(groupbys,call,name);
+        for(size_t i = 0;i < exprs.size();++i){
+            if(!aliases.at(i).empty()){
+                exprs.at(i) = SqlSyntaxUtils::replaceFunctionCall(exprs.at(i),call,name);
+            }
+        }
+        (hoisted ? computes : filteredComputes).push_back(XStringUtils::trim(call) + " as " + name);
+        replaced.push_back(std::make_pair(call,name));
+        count += counts[best] - 1;
+    }
+
+    // having 在聚合结果上求值，与 select 相同的聚合直接引用别名
+    int havingCount = 0;
+    if(XStringUtils::isNotBlank(having) && isAggregate(stmt)){
+        std::string rewritten = having;
+        for(const auto& pair : replaced){
+            rewritten = SqlSyntaxUtils::replaceFunctionCall(rewritten,pair.first,pair.second);
+        }
+        for(size_t i = 0;i < exprs.size();++i){
+            const std::vector<std::string> calls = SqlSyntaxUtils::findFunctionCalls(exprs.at(i));
+            if(aliases.at(i).empty() || calls.empty() || calls.at(0) != XStringUtils::trim(exprs.at(i)) ||
+               !SqlSyntaxUtils::isAggregateFunction(calls.at(0).substr(0,calls.at(0).find('(')))){
+                continue;
+            }
+            for(const std::string& call : SqlSyntaxUtils::findFunctionCalls(rewritten)){
+                if(SqlSyntaxUtils::normalizeExpression(call) == SqlSyntaxUtils::normalizeExpression(exprs.at(i))){
+                    havingCount++;
+                }
+            }
+            rewritten = SqlSyntaxUtils::replaceFunctionCall(rewritten,exprs.at(i),aliases.at(i));
+        }
+        // 计算列在聚合之后已经不存在，having 里仍有行级引用时保持原样
+        bool dangling = false;
+        for(const auto& pair : replaced){
+            dangling = dangling || SqlSyntaxUtils::referencesIdentifier(rewritten,pair.second);
+        }
+        if(dangling){
+            havingCount = 0;
+        }else{
+            having = rewritten;
+        }
+    }
+
+    if(computes.empty() && filteredComputes.empty() && havingCount == 0){
+        return stmt;
+    }
+
+    std::string selects;
+    for(size_t i = 0;i < exprs.size();++i){
+        selects += (i == 0 ? "" : ", ") + (aliases.at(i).empty() ? exprs.at(i) : exprs.at(i) + " as " + aliases.at(i));
+    }
+
+    std::shared_ptr<SqlStatement> result = stmt->clone();
+    result->setSelects(selects);
+    if(XStringUtils::isNotBlank(where)){
+        result->setWhere(where);
+    }
+    if(XStringUtils::isNotBlank(groupbys)){
+        result->setGroupbys(groupbys);
+    }
+    if(XStringUtils::isNotBlank(having)){
+        result->setHaving(having);
+    }
+    if(!computes.empty()){
+        std::string text;
+        for(const std::string& compute : computes){
+            text += (text.empty() ? "" : ", ") + compute;
+        }
+        result->setComputes(text);
+    }
+    if(!filteredComputes.empty()){
+        std::string text;
+        for(const std::string& compute : filteredComputes){
+            text += (text.empty() ? "" : ", ") + compute;
+        }
+        result->setFilteredComputes(text);
+    }
+    eliminated += count + havingCount;
+    return result;
+}
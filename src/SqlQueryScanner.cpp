@@ -24,7 +24,7 @@
  
 const std::unordered_set<std::string> SqlQueryScanner::BEGIN_WORDS = {"insert","select"};
 const std::unordered_set<std::string> SqlQueryScanner::SELECT_WORDS = {"into","from"};
-const std::unordered_set<std::string> SqlQueryScanner::FROM_WORDS = {"left","right","full","inner","outer","join","where","group","interval","window","session","limit"};
+const std::unordered_set<std::string> SqlQueryScanner::FROM_WORDS = {"left","right","full","inner","outer","join","asof","where","group","interval","window","session","limit"};
 
 const std::unordered_set<std::string> SqlQueryScanner::WHERE_WORDS= {"group","interval","window","session","limit"};
 const std::unordered_set<std::string> SqlQueryScanner::GROUP_BY_WORDS = {"having","limit"};
@@ -35,7 +35,9 @@ const std::unordered_set<std::string> SqlQueryScanner::HAVING_WORDS = {"limit"};
 
 const std::unordered_set<std::string> SqlQueryScanner::OUTER_WORDS = {"outer","join"};
 const std::unordered_set<std::string> SqlQueryScanner::JOIN_WORDS = {"on"};
-const std::unordered_set<std::string> SqlQueryScanner::JOIN_ON_WORDS = {"where","group","interval","window","session","limit"};
+const std::unordered_set<std::string> SqlQueryScanner::JOIN_ON_WORDS = {"left","right","full","inner","outer","join","asof","match_condition","where","group","interval","window","session","limit"};
+// 连接链之后允许出现的子句
+const std::unordered_set<std::string> SqlQueryScanner::JOIN_END_WORDS = {"where","group","interval","limit"};
 
 const std::unordered_set<std::string> SqlQueryScanner::WINDOW_KINDS = {"pattern","sliding","tumbling"};
 const std::unordered_set<std::string> SqlQueryScanner::PATTERN_ON_WORDS = {"until"};
@@ -152,7 +154,7 @@ std::shared_ptr<SqlStatement> SqlQueryScanner::scan(){
     SqlJoinType joinType;
     word = readOneOfWords(FROM_WORDS,"from");
     joinType = SqlSyntaxUtils::getJoinType(word);
-    if(joinType != SqlJoinType::NONE){
+    while(joinType != SqlJoinType::NONE){
         switch(joinType){
             case SqlJoinType::JOIN:
                 joinType = SqlJoinType::INNER;
@@ -160,6 +162,9 @@ std::shared_ptr<SqlStatement> SqlQueryScanner::scan(){
             case SqlJoinType::INNER:
                 readOneWord("join","inner");
                 break;
+            case SqlJoinType::ASOF:
+                readOneWord("join","asof");
+                break;
             case SqlJoinType::OUTER:
                 readOneWord("join","outer");
                 joinType = SqlJoinType::FULL;
@@ -176,7 +181,18 @@ std::shared_ptr<SqlStatement> SqlQueryScanner::scan(){
         std::shared_ptr<SqlRelation> joinRel = readRelation(JOIN_WORDS,SqlFragment::JOIN);
         readOneWord("on","join");
 
-        if(stmt->getSelectExpList() != nullptr){
+        // 连接条件按别名区分关系，同一连接链中的别名不能重复
+        const std::string relAlias = XStringUtils::toLowerCase(joinRel->getAlias());
+        bool duplicated = !relAlias.empty() && relAlias == XStringUtils::toLowerCase(stmt->getFrom()->getAlias());
+        for(auto& previous : stmt->getJoins()){
+            duplicated = duplicated || (!relAlias.empty() && relAlias == XStringUtils::toLowerCase(previous->getRelation()->getAlias()));
+        }
+        if(duplicated){
+            throw StatementParseException(std::string("SQL_SYNTAX_DUPLICATE_JOIN_ALIAS: ") + joinRel->getAlias());
+        }
+
+        // 多路连接时左右别名只能描述第一个连接，后续连接的条件由规划器按别名解析
+        if(stmt->getSelectExpList() != nullptr && stmt->getJoins().empty()){
             stmt->getSelectExpList()->setLeftRightAlias(stmt->getFrom()->getAlias(),joinRel->getAlias());
 
         }
@@ -186,13 +202,20 @@ std::shared_ptr<SqlStatement> SqlQueryScanner::scan(){
         joinSpec->setType(joinType);
         joinSpec->setCondition(readExprs(JOIN_ON_WORDS,SqlFragment::JOIN_ON));
         joinSpec->getConditionExp()->setLeftRightAlias(stmt->getFrom()->getAlias(),joinRel->getAlias());
-        stmt->setJoin(joinSpec);
+        if(joinType == SqlJoinType::ASOF){
+            readAsofMatch(joinSpec);
+        }
+        stmt->addJoin(joinSpec);
 
         if(isTerminated()){
             return finalize(stmt,shared_from_this());
         }
 
-        throw StatementParseException(std::string("SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: ") + readWord());
+        word = readWord();
+        joinType = SqlSyntaxUtils::getJoinType(word);
+        if(joinType == SqlJoinType::NONE && JOIN_END_WORDS.count(XStringUtils::toLowerCase(word)) == 0){
+            throw StatementParseException(std::string("SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: ") + word);
+        }
     }
     if("where" == XStringUtils::toLowerCase(word)){
         stmt->setWhere(readExprs(WHERE_WORDS,SqlFragment::WHERE));
@@ -239,6 +262,9 @@ std::shared_ptr<SqlStatement> SqlQueryScanner::scan(){
             word = readOneOfWords(HAVING_WORDS,"having");
         }
     }else if("window" == XStringUtils::toLowerCase(word) || "session" == XStringUtils::toLowerCase(word)){
+        if(!stmt->getJoins().empty()){
+            throw StatementParseException(std::string("SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: ") + word);
+        }
         inspec = true;
         specParentheseEnd = -1;
 
@@ -321,6 +347,31 @@ std::shared_ptr<SqlStatement> SqlQueryScanner::scan(){
     return finalize(stmt,shared_from_this());
 }
 
+void SqlQueryScanner::readAsofMatch(const std::shared_ptr<SqlJoinSpec>& joinSpec){
+    // on 中只能是等值的 key
+    const std::string on = joinSpec->getCondition();
+    std::string left,right;
+    for(auto& condition : SqlSyntaxUtils::splitConditions(on,"or").size() > 1 ? std::vector<std::string>{on} : SqlSyntaxUtils::splitConditions(on,"and")){
+        if(!SqlSyntaxUtils::splitEquality(condition,left,right)){
+            throw StatementParseException(std::string("SQL_SYNTAX_INVALID_ASOF_JOIN_KEY: ") + condition);
+        }
+    }
+
+    readOneWord("match_condition","asof_join_on");
+    const std::string match = readExprs(JOIN_ON_WORDS,SqlFragment::MATCH_CONDITION);
+    std::string op;
+    if(match.size() < 2 || match.front() != '(' || match.back() != ')' ||
+       !SqlSyntaxUtils::splitComparison(match.substr(1,match.size() - 2),left,op,right)){
+        throw StatementParseException(std::string("SQL_SYNTAX_INVALID_MATCH_CONDITION: ") + match);
+    }
+    // 一侧必须是 asof 连接的关系的列
+    const std::string prefix = joinSpec->getRelation()->getAlias() + ".";
+    if((left.rfind(prefix,0) == 0) == (right.rfind(prefix,0) == 0)){
+        throw StatementParseException(std::string("SQL_SYNTAX_INVALID_MATCH_CONDITION: ") + match);
+    }
+    joinSpec->setMatchCondition(left + " " + op + " " + right);
+}
+
 std::shared_ptr<SqlStatement> SqlQueryScanner::finalize(std::shared_ptr<SqlStatement> stmt,std::shared_ptr<SqlQueryScanner> scanner){
     const int endPosition = scanner->getSubqueryEndPosition() > 0 ? scanner->getSubqueryEndPosition() : scanner->getCurrentPosition();
     const std::string query  = XStringUtils::trim(scanner->getRawQueryString().substr(scanner->getBeginPosition(),endPosition- scanner->getBeginPosition()));
@@ -444,10 +495,12 @@ SqlQueryScanner::ReadResult SqlQueryScanner::read(std::unordered_set<std::string
                 word = XStringUtils::toLowerCase(XStringUtils::trim(query.substr(i + 1, widx - i)));
                 
                 v = word.at(0);
-                if (v == PARENTHESE_CLOSE && (inspec || insubquery)) {
-                    if (parentheseNestDepth != 0) {
-                        throw StatementParseException("SQL_SYNTAX_UNEXPECTED_PARENTHESE_CLOSE");
-                    }
+                // 空白之后紧跟的括号同样计入嵌套层数
+                if (v == PARENTHESE_OPEN) {
+                    parentheseNestDepth++;
+                } else if (v == PARENTHESE_CLOSE && parentheseNestDepth > 0) {
+                    parentheseNestDepth--;
+                } else if (v == PARENTHESE_CLOSE && (inspec || insubquery)) {
                     if (inspec) {
                         specParentheseEnd = widx;
                     } else if (insubquery) {
@@ -1,5 +1,6 @@
 #include "SqlStatement.h"
 #include "QueryRelation.h"
+#include "XStringUtils.h"
 
 SqlStatement::SqlStatement(){
     
@@ -15,11 +16,26 @@ void SqlStatement::setFrom(std::shared_ptr<SqlRelation> rel){
 }
 
 std::shared_ptr<SqlJoinSpec> SqlStatement::getJoin(){
-    return this->join;
+    return this->joins.empty() ? nullptr : this->joins.front();
 }
 
 void SqlStatement::setJoin(std::shared_ptr<SqlJoinSpec> spec){
-    this->join = spec;
+    this->joins.clear();
+    if(spec != nullptr){
+        this->joins.push_back(spec);
+    }
+}
+
+const std::vector<std::shared_ptr<SqlJoinSpec>>& SqlStatement::getJoins(){
+    return this->joins;
+}
+
+void SqlStatement::setJoins(const std::vector<std::shared_ptr<SqlJoinSpec>>& joins){
+    this->joins = joins;
+}
+
+void SqlStatement::addJoin(std::shared_ptr<SqlJoinSpec> spec){
+    this->joins.push_back(spec);
 }
 
 std::shared_ptr<SqlRelation> SqlStatement::getInto(){
@@ -95,6 +111,10 @@ void SqlStatement::setWhere(std::string where){
     }
 }
 
+void SqlStatement::removeWhere(){
+    this->where = std::make_shared<ExpressionContainer>();
+}
+
 std::string SqlStatement::getHaving(){
     return this->having->getCacheData()->toString();
 }
@@ -107,6 +127,34 @@ void SqlStatement::setHaving(std::string having){
     }
 }
 
+void SqlStatement::removeHaving(){
+    this->having = std::make_shared<ExpressionContainer>();
+}
+
+std::string SqlStatement::getComputes(){
+    return this->computes->getCacheData()->toString();
+}
+
+void SqlStatement::setComputes(std::string computes){
+    try{
+        this->computes->require(std::make_shared<StringData>(computes),"empty compute expression");
+    }catch(const EngineException& e){
+        throw EngineException(std::string("SQL_SYNTAX_COMPUTE_") + e.what());
+    }
+}
+
+std::string SqlStatement::getFilteredComputes(){
+    return this->filteredComputes->getCacheData()->toString();
+}
+
+void SqlStatement::setFilteredComputes(std::string computes){
+    try{
+        this->filteredComputes->require(std::make_shared<StringData>(computes),"empty compute expression");
+    }catch(const EngineException& e){
+        throw EngineException(std::string("SQL_SYNTAX_COMPUTE_") + e.what());
+    }
+}
+
 int SqlStatement::getLimit(){
     return this->limit;
 }
@@ -171,3 +219,43 @@ bool SqlStatement::isEdgeRunnable(){
     }
     return true;
 }
+
+bool SqlStatement::isAlwaysEmpty(){
+    return this->alwaysEmpty;
+}
+
+void SqlStatement::setAlwaysEmpty(bool alwaysEmpty){
+    this->alwaysEmpty = alwaysEmpty;
+}
+
+std::shared_ptr<SqlStatement> SqlStatement::clone(){
+    std::shared_ptr<SqlStatement> stmt = std::make_shared<SqlStatement>();
+    stmt->setFrom(this->from);
+    stmt->setInto(this->into);
+    stmt->setJoins(this->joins);
+    stmt->setWindow(this->window);
+    stmt->setInterval(this->interval);
+    stmt->setSelects(this->getSelects());
+    if(XStringUtils::isNotBlank(this->getGroupbys())){
+        stmt->setGroupbys(this->getGroupbys());
+    }
+    if(XStringUtils::isNotBlank(this->getWhere())){
+        stmt->setWhere(this->getWhere());
+    }
+    if(XStringUtils::isNotBlank(this->getHaving())){
+        stmt->setHaving(this->getHaving());
+    }
+    if(XStringUtils::isNotBlank(this->getComputes())){
+        stmt->setComputes(this->getComputes());
+    }
+    if(XStringUtils::isNotBlank(this->getFilteredComputes())){
+        stmt->setFilteredComputes(this->getFilteredComputes());
+    }
+    if(this->joins.size() == 1 && stmt->getSelectExpList() != nullptr){
+        stmt->getSelectExpList()->setLeftRightAlias(this->from->getAlias(),this->joins.front()->getRelation()->getAlias());
+    }
+    stmt->setLimit(this->limit);
+    stmt->setAlwaysEmpty(this->alwaysEmpty);
+    stmt->setQuery(this->query);
+    return stmt;
+}
@@ -1,6 +1,9 @@
 #include "../include/SqlSyntaxUtils.h"
 
 #include "XStringUtils.h"
+
+#include <algorithm>
+
 SqlSyntaxUtils::SqlSyntaxUtils(){}
 
 bool SqlSyntaxUtils::isWhiteSpace(char c){
@@ -9,7 +12,8 @@ bool SqlSyntaxUtils::isWhiteSpace(char c){
 
 bool SqlSyntaxUtils::isReservedKeyword(const std::string& word){
     std::string myword = XStringUtils::toLowerCase(word);
-    if( myword == "by" ||
+    if( myword == "asof" ||
+        myword == "by" ||
         myword == "every" ||
         myword == "from" ||
         myword == "full" ||
@@ -21,6 +25,7 @@ bool SqlSyntaxUtils::isReservedKeyword(const std::string& word){
         myword == "join" ||
         myword == "left" ||
         myword == "limit" ||
+        myword == "match_condition" ||
         myword == "on" ||
         myword == "order" ||
         myword == "outer" ||
@@ -111,6 +116,8 @@ SqlJoinType SqlSyntaxUtils::getJoinType(const std::string& word){
         return SqlJoinType::RIGHT;
     }else if(myword == "full"){
         return SqlJoinType::FULL;
+    }else if(myword == "asof"){
+        return SqlJoinType::ASOF;
     }else{
         return SqlJoinType::NONE;
     }
@@ -127,4 +134,581 @@ SqlWindowType SqlSyntaxUtils::getWindowType(const std::string& word){
     }else{
         return SqlWindowType::NONE;
     } 
-}
\ No newline at end of file
+}
+
+std::vector<std::string> SqlSyntaxUtils::splitExpressions(const std::string& exprs){
+    std::vector<std::string> items;
+    const int len = exprs.size();
+    int depth = 0,begin = 0;
+    bool quoted = false;
+    char c;
+    for(int i = 0;i < len;++i){
+        c = exprs.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+        }else if(quoted){
+            continue;
+        }else if(c == '\\'){
+            ++i;
+        }else if(c == '('){
+            depth++;
+        }else if(c == ')'){
+            depth--;
+        }else if(c == ',' && depth == 0){
+            items.push_back(XStringUtils::trim(exprs.substr(begin,i - begin)));
+            begin = i + 1;
+        }
+    }
+    const std::string last = XStringUtils::trim(exprs.substr(begin));
+    if(!last.empty() || !items.empty()){
+        items.push_back(last);
+    }
+    return items;
+}
+
+std::string SqlSyntaxUtils::getExpressionAlias(const std::string& item){
+    int idx = -1,next = findTopLevelWord(item,"as",0);
+    while(next >= 0){
+        idx = next;
+        next = findTopLevelWord(item,"as",idx + 2);
+    }
+    if(idx <= 0){
+        return "";
+    }
+    const std::string alias = XStringUtils::trim(item.substr(idx + 2));
+    return isIdentifier(alias) ? alias : "";
+}
+
+std::string SqlSyntaxUtils::removeExpressionAlias(const std::string& item){
+    const std::string alias = getExpressionAlias(item);
+    if(alias.empty()){
+        return XStringUtils::trim(item);
+    }
+    int idx = -1,next = findTopLevelWord(item,"as",0);
+    while(next >= 0){
+        idx = next;
+        next = findTopLevelWord(item,"as",idx + 2);
+    }
+    return XStringUtils::trim(item.substr(0,idx));
+}
+
+bool SqlSyntaxUtils::isIdentifier(const std::string& word){
+    const int len = word.size();
+    if(len == 0){
+        return false;
+    }
+    char c = word.at(0);
+    if(!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')){
+        return false;
+    }
+    for(int i = 1;i < len;++i){
+        c = word.at(i);
+        if(!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.')){
+            return false;
+        }
+    }
+    const std::string myword = XStringUtils::toLowerCase(word);
+    return !(myword == "and" || myword == "or" || myword == "not" || myword == "null" ||
+             myword == "true" || myword == "false" || myword == "between" || myword == "as" ||
+             myword == "in" || myword == "is" || myword == "like");
+}
+
+std::string SqlSyntaxUtils::replaceIdentifiers(const std::string& expr,
+                                               const std::string& qualifier,
+                                               const std::unordered_map<std::string, std::string>& replacements){
+    std::string result;
+    const int len = expr.size();
+    const std::string prefix = qualifier.empty() ? "" : qualifier + ".";
+    bool quoted = false;
+    char c;
+    for(int i = 0;i < len;++i){
+        c = expr.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+            result += c;
+            continue;
+        }
+        if(quoted || !((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')){
+            result += c;
+            continue;
+        }
+
+        int end = i;
+        while(end < len){
+            c = expr.at(end);
+            if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.'){
+                end++;
+                continue;
+            }
+            break;
+        }
+        std::string word = expr.substr(i,end - i);
+
+        // 变量（::name）、函数名以及数字的一部分（1e5）都不是列名
+        int next = end;
+        while(next < len && isWhiteSpace(expr.at(next))){
+            next++;
+        }
+        const bool isVariable = i > 0 && expr.at(i - 1) == ':';
+        const bool isFunction = next < len && expr.at(next) == '(';
+        const bool isNumberPart = i > 0 && expr.at(i - 1) >= '0' && expr.at(i - 1) <= '9';
+        if(isVariable || isFunction || isNumberPart || !isIdentifier(word)){
+            result += word;
+            i = end - 1;
+            continue;
+        }
+
+        if(!prefix.empty() && word.rfind(prefix,0) == 0 && word.size() > prefix.size()){
+            word = word.substr(prefix.size());
+        }
+        auto iter = replacements.find(word);
+        if(iter == replacements.end()){
+            result += word;
+        }else if(isIdentifier(iter->second)){
+            result += iter->second;
+        }else{
+            result += "(" + iter->second + ")";
+        }
+        i = end - 1;
+    }
+    return result;
+}
+
+std::string SqlSyntaxUtils::conjoin(const std::string& left, const std::string& right){
+    const std::string l = XStringUtils::trim(left),r = XStringUtils::trim(right);
+    if(l.empty()){
+        return r;
+    }
+    if(r.empty()){
+        return l;
+    }
+    return (findTopLevelWord(l,"or",0) >= 0 ? "(" + l + ")" : l) + " and " +
+           (findTopLevelWord(r,"or",0) >= 0 ? "(" + r + ")" : r);
+}
+
+bool SqlSyntaxUtils::isStateful(const std::string& expr){
+    bool quoted = false;
+    const int len = expr.size();
+    for(int i = 0;i + 1 < len;++i){
+        const char c = expr.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+        }else if(!quoted && ((c == ':' && expr.at(i + 1) == ':') || (c == '-' && expr.at(i + 1) == '>'))){
+            return true;
+        }
+    }
+    return false;
+}
+
+int SqlSyntaxUtils::findTopLevelWord(const std::string& expr, const std::string& word, int from){
+    const int len = expr.size(),wlen = word.size();
+    int depth = 0;
+    bool quoted = false;
+    char c;
+    for(int i = 0;i < len;++i){
+        c = expr.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+        }else if(quoted){
+            continue;
+        }else if(c == '('){
+            depth++;
+        }else if(c == ')'){
+            depth--;
+        }else if(depth == 0 && i >= from && i + wlen <= len &&
+                 (i == 0 || isWhiteSpace(expr.at(i - 1)) || expr.at(i - 1) == ')') &&
+                 (i + wlen == len || isWhiteSpace(expr.at(i + wlen)) || expr.at(i + wlen) == '(') &&
+                 XStringUtils::toLowerCase(expr.substr(i,wlen)) == word){
+            return i;
+        }
+    }
+    return -1;
+}
+
+std::vector<std::string> SqlSyntaxUtils::splitConditions(const std::string& expr, const std::string& word){
+    std::vector<std::string> parts;
+    int begin = 0,from = 0,idx;
+    while((idx = findTopLevelWord(expr,word,from)) >= 0){
+        from = idx + word.size();
+        // between 的上下界之间的 and 不是条件连接符
+        if(word == "and"){
+            const std::string part = expr.substr(begin,idx - begin);
+            int between = -1,next = findTopLevelWord(part,"between",0);
+            while(next >= 0){
+                between = next;
+                next = findTopLevelWord(part,"between",between + 7);
+            }
+            if(between >= 0 && findTopLevelWord(part,"and",between) < 0){
+                continue;
+            }
+        }
+        parts.push_back(XStringUtils::trim(expr.substr(begin,idx - begin)));
+        begin = from;
+    }
+    const std::string last = XStringUtils::trim(expr.substr(begin));
+    if(!last.empty() || !parts.empty()){
+        parts.push_back(last);
+    }
+    return parts;
+}
+
+bool SqlSyntaxUtils::referencesIdentifier(const std::string& expr, const std::string& name){
+    return replaceIdentifiers(expr,"",{{name,name + "()"}}) != expr;
+}
+
+bool SqlSyntaxUtils::referencesQualifier(const std::string& expr, const std::string& qualifier){
+    return !qualifier.empty() && replaceIdentifiers(expr,qualifier,{}) != expr;
+}
+
+bool SqlSyntaxUtils::splitEquality(const std::string& condition, std::string& left, std::string& right){
+    const int len = condition.size();
+    int idx = -1;
+    bool quoted = false;
+    for(int i = 0;i < len;++i){
+        const char c = condition.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+        }else if(!quoted && c == '='){
+            // ==、!=、<=、>= 都不是单个等号
+            const char prev = i > 0 ? condition.at(i - 1) : ' ';
+            const char next = i + 1 < len ? condition.at(i + 1) : ' ';
+            if(idx >= 0 || prev == '=' || prev == '!' || prev == '<' || prev == '>' || next == '='){
+                return false;
+            }
+            idx = i;
+        }
+    }
+    if(idx < 0){
+        return false;
+    }
+    const std::string l = XStringUtils::trim(condition.substr(0,idx)),r = XStringUtils::trim(condition.substr(idx + 1));
+    if(!isIdentifier(l) || !isIdentifier(r)){
+        return false;
+    }
+    left = l;
+    right = r;
+    return true;
+}
+
+bool SqlSyntaxUtils::splitComparison(const std::string& condition, std::string& left, std::string& op, std::string& right){
+    const size_t idx = condition.find_first_of("<>");
+    if(idx == std::string::npos){
+        return false;
+    }
+    const std::string o = idx + 1 < condition.size() && condition.at(idx + 1) == '=' ? condition.substr(idx,2) : condition.substr(idx,1);
+    const std::string l = XStringUtils::trim(condition.substr(0,idx)),r = XStringUtils::trim(condition.substr(idx + o.size()));
+    if(!isIdentifier(l) || !isIdentifier(r)){
+        return false;
+    }
+    left = l;
+    op = o;
+    right = r;
+    return true;
+}
+
+bool SqlSyntaxUtils::splitOffset(const std::string& expr, std::string& base, std::string& offset){
+    const std::string myexpr = XStringUtils::trim(expr);
+    if(isIdentifier(myexpr)){
+        base = myexpr;
+        offset = "0";
+        return true;
+    }
+    const size_t idx = myexpr.find_first_of("+-",1);
+    if(idx == std::string::npos){
+        return false;
+    }
+    const std::string b = XStringUtils::trim(myexpr.substr(0,idx)),n = XStringUtils::trim(myexpr.substr(idx + 1));
+    if(!isIdentifier(b) || n.empty() || n.find_first_not_of("0123456789.") != std::string::npos ||
+       n.find('.') != n.rfind('.') || n.front() == '.'){
+        return false;
+    }
+    base = b;
+    offset = myexpr.at(idx) == '-' ? "-" + n : n;
+    return true;
+}
+
+bool SqlSyntaxUtils::splitBand(const std::string& condition, std::string& column, std::string& base,
+                               std::string& lower, std::string& upper){
+    const int between = findTopLevelWord(condition,"between",0);
+    if(between < 0){
+        return false;
+    }
+    const std::string c = XStringUtils::trim(condition.substr(0,between));
+    const std::string bounds = condition.substr(between + 7);
+    const int idx = findTopLevelWord(bounds,"and",0);
+    if(!isIdentifier(c) || idx < 0){
+        return false;
+    }
+    std::string lowerBase,upperBase,l,u;
+    if(!splitOffset(bounds.substr(0,idx),lowerBase,l) || !splitOffset(bounds.substr(idx + 3),upperBase,u) || lowerBase != upperBase){
+        return false;
+    }
+    column = c;
+    base = lowerBase;
+    lower = l;
+    upper = u;
+    return true;
+}
+
+bool SqlSyntaxUtils::splitBound(const std::string& condition, std::string& column, std::string& base,
+                                std::string& offset, bool& lowerBound){
+    const int len = condition.size();
+    int idx = -1,comparisons = 0;
+    bool quoted = false;
+    for(int i = 0;i < len;++i){
+        const char c = condition.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+        }else if(!quoted && (c == '<' || c == '>' || c == '=' || c == '!')){
+            comparisons++;
+            if(idx < 0){
+                idx = i;
+            }
+        }
+    }
+    // 只接受一个 >= 或 <=
+    if(comparisons != 2 || idx + 1 >= len || condition.at(idx + 1) != '=' || (condition.at(idx) != '<' && condition.at(idx) != '>')){
+        return false;
+    }
+    const bool greater = condition.at(idx) == '>';
+    const std::string l = XStringUtils::trim(condition.substr(0,idx)),r = XStringUtils::trim(condition.substr(idx + 2));
+    if(isIdentifier(l) && splitOffset(r,base,offset)){
+        column = l;
+        lowerBound = greater;
+        return true;
+    }
+    if(isIdentifier(r) && splitOffset(l,base,offset)){
+        column = r;
+        lowerBound = !greater;
+        return true;
+    }
+    return false;
+}
+
+bool SqlSyntaxUtils::isAggregateFunction(const std::string& name){
+    const std::string myname = XStringUtils::toLowerCase(XStringUtils::trim(name));
+    return myname == "count" || myname == "sum" || myname == "avg" || myname == "min" || myname == "max" ||
+           myname == "first" || myname == "last" || myname == "stddev" || myname == "variance" || myname == "median";
+}
+
+bool SqlSyntaxUtils::hasAggregateCall(const std::string& expr){
+    for(const std::string& call : findFunctionCalls(expr)){
+        if(isAggregateFunction(call.substr(0,call.find('(')))){
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> SqlSyntaxUtils::findFunctionCalls(const std::string& expr){
+    std::vector<std::string> calls;
+    const int len = expr.size();
+    bool quoted = false;
+    int nameEnd;
+    for(int i = 0;i < len;++i){
+        const char c = expr.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+            continue;
+        }
+        if(quoted){
+            continue;
+        }
+        const int end = findCallEnd(expr,i,nameEnd);
+        if(end > 0){
+            calls.push_back(expr.substr(i,end + 1 - i));
+        }
+        if(nameEnd > i){
+            i = nameEnd - 1;
+        }
+    }
+    return calls;
+}
+
+std::string SqlSyntaxUtils::normalizeExpression(const std::string& expr){
+    std::string normalized;
+    bool quoted = false;
+    for(const char c : expr){
+        if(c == '\''){
+            quoted = !quoted;
+        }
+        if(quoted || !isWhiteSpace(c)){
+            normalized += c;
+        }
+    }
+    return normalized;
+}
+
+std::string SqlSyntaxUtils::replaceFunctionCall(const std::string& expr, const std::string& target, const std::string& name){
+    const std::string normalized = normalizeExpression(target);
+    std::string result;
+    const int len = expr.size();
+    bool quoted = false;
+    int nameEnd;
+    for(int i = 0;i < len;++i){
+        const char c = expr.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+        }
+        if(quoted || c == '\''){
+            result += c;
+            continue;
+        }
+        const int end = findCallEnd(expr,i,nameEnd);
+        if(end > 0 && normalizeExpression(expr.substr(i,end + 1 - i)) == normalized){
+            result += name;
+            i = end;
+        }else if(nameEnd > i){
+            result += expr.substr(i,nameEnd - i);
+            i = nameEnd - 1;
+        }else{
+            result += c;
+        }
+    }
+    return result;
+}
+
+std::string SqlSyntaxUtils::maskCaseExpressions(const std::string& expr){
+    std::string result = expr;
+    const int len = expr.size();
+    int depth = 0,wend;
+    bool quoted = false;
+    char c;
+    auto isWordChar = [](char ch){
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_';
+    };
+    for(int i = 0;i < len;++i){
+        c = expr.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+        }else if(!quoted && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') &&
+                 (i == 0 || !isWordChar(expr.at(i - 1)))){
+            wend = i;
+            while(wend < len && isWordChar(expr.at(wend))){
+                wend++;
+            }
+            const std::string word = XStringUtils::toLowerCase(expr.substr(i,wend - i));
+            const bool inside = depth > 0 || word == "case";
+            if(word == "case"){
+                depth++;
+            }else if(word == "end" && depth > 0){
+                depth--;
+            }
+            if(inside){
+                result.replace(i,wend - i,wend - i,' ');
+            }
+            i = wend - 1;
+            continue;
+        }
+        if(depth > 0){
+            result[i] = ' ';
+        }
+    }
+    return result;
+}
+
+std::string SqlSyntaxUtils::maskGuardedExpressions(const std::string& expr){
+    std::string result = maskCaseExpressions(expr);
+    const int len = result.size();
+    int wend,betweens = 0;
+    bool quoted = false;
+    char c;
+    auto isWordChar = [](char ch){
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_';
+    };
+    for(int i = 0;i < len;++i){
+        c = result.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+        }else if(!quoted && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') &&
+                 (i == 0 || !isWordChar(result.at(i - 1)))){
+            wend = i;
+            while(wend < len && isWordChar(result.at(wend))){
+                wend++;
+            }
+            const std::string word = XStringUtils::toLowerCase(result.substr(i,wend - i));
+            if(word == "between"){
+                betweens++;
+            }else if(word == "and" && betweens > 0){
+                betweens--;
+            }else if(word == "and" || word == "or"){
+                result.replace(i,len - i,len - i,' ');
+                break;
+            }
+            i = wend - 1;
+        }
+    }
+    return result;
+}
+
+std::string SqlSyntaxUtils::getWindowAggregations(const std::string& selects){
+    std::vector<std::string> seen;
+    std::string result;
+    for(const std::string& call : findFunctionCalls(selects)){
+        const std::string name = XStringUtils::toLowerCase(XStringUtils::trim(call.substr(0,call.find('('))));
+        std::string strategy;
+        if(name == "wcount" || name == "wsum" || name == "wavg"){
+            strategy = "subtract";
+        }else if(name == "wmin" || name == "wmax"){
+            strategy = "two_stacks";
+        }else{
+            continue;
+        }
+        const std::string normalized = normalizeExpression(call);
+        if(std::find(seen.begin(),seen.end(),normalized) != seen.end()){
+            continue;
+        }
+        seen.push_back(normalized);
+        result += (result.empty() ? "" : ", ") + normalized + ":" + strategy;
+    }
+    return result;
+}
+
+int SqlSyntaxUtils::findCallEnd(const std::string& expr, int begin, int& nameEnd){
+    nameEnd = begin;
+    const int len = expr.size();
+    char c = expr.at(begin);
+    if(!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')){
+        return -1;
+    }
+    if(begin > 0){
+        c = expr.at(begin - 1);
+        if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.' || c == ':'){
+            return -1;
+        }
+    }
+    while(nameEnd < len){
+        c = expr.at(nameEnd);
+        if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.'){
+            nameEnd++;
+            continue;
+        }
+        break;
+    }
+    int i = nameEnd;
+    while(i < len && isWhiteSpace(expr.at(i))){
+        i++;
+    }
+    if(i >= len || expr.at(i) != '('){
+        return -1;
+    }
+
+    int depth = 0;
+    bool quoted = false;
+    for(;i < len;++i){
+        c = expr.at(i);
+        if(c == '\''){
+            quoted = !quoted;
+        }else if(quoted){
+            continue;
+        }else if(c == '('){
+            depth++;
+        }else if(c == ')'){
+            depth--;
+            if(depth == 0){
+                return i;
+            }
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,988 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include "../include/LocalExecutor.h"
+#include "../include/LocalExpression.h"
+#include "../include/LocalFilterKernel.h"
+#include "../include/LocalFilterOperator.h"
+#include "../include/LocalGroupTable.h"
+#include "../include/LocalNestedJoinOperator.h"
+#include "../include/LocalPatternWindowOperator.h"
+#include "../include/LocalRadixHashTable.h"
+#include "../include/LocalStatisticsCatalog.h"
+#include "../include/LocalSlidingWindowOperator.h"
+#include "../include/LocalStreamAggregateOperator.h"
+#include "../include/LocalTakeOperator.h"
+#include "../include/LocalTableFile.h"
+#include "../include/LocalTumblingWindowOperator.h"
+#include "../include/SqlDistributedPlanner.h"
+#include "../include/SqlQueryParser.h"
+#include "../include/SqlQueryPlanner.h"
+#include "../include/SqlSyntaxUtils.h"
+
+namespace {
+
+    std::shared_ptr<const LocalBatch> makeBatch(const std::vector<std::string>& names,const std::vector<std::vector<LocalValue>>& rows){
+        std::shared_ptr<LocalBatch> batch = std::make_shared<LocalBatch>(rows.size());
+        for(size_t c = 0;c < names.size();++c){
+            std::vector<LocalValue> values;
+            for(auto& row : rows){
+                values.push_back(row.at(c));
+            }
+            batch->addColumn(LocalColumn::fromValues(names[c],values));
+        }
+        return batch;
+    }
+
+    // every row as "v1|v2|...", null printed as "null"
+    std::vector<std::string> toRows(const std::vector<std::shared_ptr<const LocalBatch>>& batches,bool sorted = true){
+        std::vector<std::string> rows;
+        for(auto& batch : batches){
+            for(size_t r = 0;r < batch->getRows();++r){
+                std::string row;
+                for(size_t c = 0;c < batch->getColumnCount();++c){
+                    const LocalValue value = batch->getColumn(c).get(r);
+                    row += (c > 0 ? "|" : "") + (value.isNull() ? std::string("null") : value.toString());
+                }
+                rows.push_back(row);
+            }
+        }
+        if(sorted){
+            std::sort(rows.begin(),rows.end());
+        }
+        return rows;
+    }
+
+    std::vector<std::string> columnNames(const std::vector<std::shared_ptr<const LocalBatch>>& batches){
+        std::vector<std::string> names;
+        for(auto& column : batches.at(0)->getColumns()){
+            names.push_back(column.getName());
+        }
+        return names;
+    }
+
+    LocalExecutor makeExecutor(){
+        LocalExecutor executor;
+        executor.setBatchSize(3);
+        executor.addTable("t1",{
+            makeBatch({"a","b","name"},{{1,10,"x"},{2,20,"y"},{1,5,"z"},{4,1.5,"x"}}),
+            makeBatch({"a","b","name"},{{5,LocalValue(),"y"},{6,7,"w"},{2,3,LocalValue()}})
+        });
+        executor.addTable("t2",{
+            makeBatch({"id","c"},{{1,"one"},{2,"two"},{2,"deux"},{3,"three"}})
+        });
+        return executor;
+    }
+
+    std::vector<std::string> run(LocalExecutor& executor,const std::string& sql,bool sorted = true){
+        SqlQueryParser parser;
+        SqlQueryPlanner planner;
+        return toRows(executor.execute(*planner.plan(parser.parse(sql))),sorted);
+    }
+
+}
+
+TEST(LocalExecutorTest, Expression) {
+    std::shared_ptr<const LocalBatch> batch = makeBatch({"a","b","s"},{{1,2.5,"abc"},{LocalValue(),4,"xbz"}});
+    const auto eval = [&](const std::string& expr,size_t row){
+        std::shared_ptr<LocalExpression> e = LocalExpression::parse(expr);
+        e->bind(*batch);
+        return e->evaluate(*batch,row);
+    };
+
+    EXPECT_EQ(eval("a + 2 * 3",0).asInt(), 7);
+    EXPECT_EQ(eval("a + 2 * 3",0).getType(), LocalType::INT);
+    EXPECT_DOUBLE_EQ(eval("(a + b) / 2",0).asDouble(), 1.75);
+    EXPECT_TRUE(eval("b between 2 and 3 and s in ('abc', 'def')",0).isTrue());
+    EXPECT_FALSE(eval("b not between 2 and 3",0).isTrue());
+    EXPECT_TRUE(eval("s like 'a%'",0).isTrue());
+    EXPECT_TRUE(eval("s like '_b_'",1).isTrue());
+    EXPECT_TRUE(eval("abs(-a) == 1 and upper(s) = 'ABC'",0).isTrue());
+
+    // null propagates through comparisons but "false and null" is false and "true or null" is true
+    EXPECT_TRUE(eval("a > 0",1).isNull());
+    EXPECT_FALSE(eval("a > 0 and b > 10",1).isNull());
+    EXPECT_TRUE(eval("a > 0 or b > 3",1).isTrue());
+    EXPECT_TRUE(eval("a is null and coalesce(a, 9) = 9",1).isTrue());
+
+    EXPECT_THROW(LocalExpression::parse("a > "), EngineException);
+    EXPECT_THROW(eval("missing + 1",0), EngineException);
+    EXPECT_THROW(eval("sum(a)",0), EngineException);
+}
+
+TEST(LocalExecutorTest, FilterKernel) {
+    // 150 rows so every kernel has full 64-row words and a scalar tail
+    std::vector<std::vector<LocalValue>> rows;
+    for(int i = 0;i < 150;++i){
+        rows.push_back({i % 7 == 0 ? LocalValue() : LocalValue(static_cast<int64_t>(i % 50 - 20)),
+                        i * 0.75 - 30,
+                        static_cast<int64_t>(i % 9),
+                        i % 11 == 0 ? LocalValue() : LocalValue(i * 0.5 - 20),
+                        i % 13 == 0 ? LocalValue() : LocalValue("s" + std::to_string(i % 5))});
+    }
+    std::shared_ptr<const LocalBatch> batch = makeBatch({"a","b","c","d","s"},rows);
+
+    const std::vector<std::string> conditions = {
+        "a > 3", "a >= 3", "a < -2", "a <= 0", "a = 5", "a != 5", "3 < a", "b > 10", "b <= -4.5", "b = 0",
+        "a > 2.5", "a >= 2.5", "a < 2.5", "a <= 2.5", "a = 2.5", "a != 2.5", "a between 1.5 and 4.5",
+        "a between -5 and 5", "b not between -10 and 10.25", "a in (1, 2, 3.5, 7)", "a not in (1, 2, null)",
+        "s in ('s1', 's3')", "s not in ('s1')", "s = 's2'", "s > 's2'", "s between 's1' and 's3'",
+        "a is null", "d is not null", "a > c", "b < d", "a = c", "s != 's0' and a > 0", "a > 0 or d > 0",
+        "not (a > 0 and d < 5)", "a + c > 10", "a > 0 and abs(b) < 20", "a > 's'", "a < d",
+        "c between a and 5", "c between a and c", "not (c between 0 and a)", "b between d and b", "b not between d and b"
+    };
+    for(const std::string& text : conditions){
+        std::shared_ptr<LocalExpression> condition = LocalExpression::parse(text);
+        LocalFilterKernel kernel(condition,*batch);
+        std::vector<int64_t> expected;
+        for(size_t row = 0;row < batch->getRows();++row){
+            if(condition->evaluate(*batch,row).isTrue()){
+                expected.push_back(row);
+            }
+        }
+        for(auto set : {LocalFilterKernel::InstructionSet::SCALAR,LocalFilterKernel::InstructionSet::SSE42,LocalFilterKernel::InstructionSet::AVX2}){
+            kernel.setInstructionSet(set);
+            std::vector<int64_t> selected;
+            kernel.select(*batch,selected);
+            EXPECT_EQ(selected, expected) << text << " with " << LocalFilterKernel::toString(kernel.getInstructionSet());
+        }
+    }
+
+    // column comparisons compile to vector nodes, anything else is evaluated row by row
+    std::shared_ptr<LocalExpression> condition = LocalExpression::parse("b > 80 and c between 1 and 4 or a + 1 > 2");
+    LocalFilterKernel kernel(condition,*batch);
+    ASSERT_EQ(kernel.getRoot()->op, LocalFilterKernel::Node::Op::OR);
+    EXPECT_EQ(kernel.getRoot()->children[0]->children[0]->op, LocalFilterKernel::Node::Op::COMPARE);
+    EXPECT_EQ(kernel.getRoot()->children[0]->children[1]->op, LocalFilterKernel::Node::Op::BETWEEN);
+    EXPECT_EQ(kernel.getRoot()->children[1]->op, LocalFilterKernel::Node::Op::ROW);
+    EXPECT_TRUE(kernel.accepts(*batch));
+    EXPECT_FALSE(kernel.accepts(*makeBatch({"a","b","c","d","s"},{{1.5,1,1,1,"x"}})));
+}
+
+TEST(LocalExecutorTest, FilterProjectTake) {
+    LocalExecutor executor = makeExecutor();
+
+    EXPECT_EQ(run(executor,"SELECT a, b + 1 as c FROM t1 WHERE a > 1"),
+              (std::vector<std::string>{"2|21","2|4","4|2.5","5|null","6|8"}));
+    EXPECT_EQ(run(executor,"SELECT * FROM t1 WHERE name = 'x'"),
+              (std::vector<std::string>{"1|10|x","4|1.5|x"}));
+    EXPECT_EQ(run(executor,"SELECT a FROM t1 WHERE b > 2 LIMIT 3",false),
+              (std::vector<std::string>{"1","2","1"}));
+    // pushed down limit_count on a single step
+    EXPECT_EQ(run(executor,"SELECT * FROM t1 LIMIT 2",false).size(), 2);
+}
+
+TEST(LocalExecutorTest, TakeCancellation) {
+    // Take returns once it has enough rows although its input is never closed, and cancels the input
+    std::shared_ptr<LocalSpool> filtered = std::make_shared<LocalSpool>(),taken = std::make_shared<LocalSpool>();
+    LocalTakeOperator take(LocalStepDefinition::parse("Take?input=s_2,output=s_3(rows=`5`)"));
+    take.addInput(filtered);
+    take.setOutput(taken);
+    const int reader = taken->subscribe();
+    for(int i = 0;i < 3;++i){
+        filtered->push(makeBatch({"a"},{{4 * i},{4 * i + 1},{4 * i + 2},{4 * i + 3}}));
+    }
+    take.execute();
+    std::vector<std::shared_ptr<const LocalBatch>> batches;
+    for(std::shared_ptr<const LocalBatch> batch = taken->pop(reader);batch != nullptr;batch = taken->pop(reader)){
+        batches.push_back(batch);
+    }
+    EXPECT_EQ(toRows(batches,false), (std::vector<std::string>{"0","1","2","3","4"}));
+    EXPECT_TRUE(filtered->isCancelled());
+    EXPECT_FALSE(filtered->push(makeBatch({"a"},{{12}})));
+
+    // an upstream step writing to the cancelled spool stops without reading its own input to the end
+    std::shared_ptr<LocalSpool> source = std::make_shared<LocalSpool>();
+    LocalFilterOperator filter(LocalStepDefinition::parse("Filter?input=s_1,output=s_2(condition=`a > 0`)"));
+    filter.addInput(source);
+    filter.setOutput(filtered);
+    source->push(makeBatch({"a"},{{1}}));
+    filter.execute();
+    EXPECT_TRUE(source->isCancelled());
+
+    // a satisfied limit_count does the same
+    std::shared_ptr<LocalSpool> input = std::make_shared<LocalSpool>(),output = std::make_shared<LocalSpool>();
+    LocalFilterOperator limited(LocalStepDefinition::parse("Filter?input=s_1,output=s_2(condition=`a > 0`,limit_count=`2`)"));
+    limited.addInput(input);
+    limited.setOutput(output);
+    const int limitedReader = output->subscribe();
+    input->push(makeBatch({"a"},{{1},{0},{2},{3}}));
+    limited.execute();
+    EXPECT_EQ(toRows({output->pop(limitedReader)},false), (std::vector<std::string>{"1","2"}));
+    EXPECT_EQ(output->pop(limitedReader), nullptr);
+    EXPECT_TRUE(input->isCancelled());
+
+    // end to end, LIMIT over a long table finishes with the first rows
+    LocalExecutor executor;
+    std::vector<std::shared_ptr<const LocalBatch>> table;
+    for(int i = 0;i < 20000;++i){
+        table.push_back(makeBatch({"a","b"},{{i,i % 7},{i,i % 5}}));
+    }
+    executor.addTable("big",table);
+    EXPECT_EQ(run(executor,"SELECT a FROM big WHERE b > 1 LIMIT 3",false), (std::vector<std::string>{"2","2","3"}));
+}
+
+TEST(LocalExecutorTest, Aggregation) {
+    LocalExecutor executor = makeExecutor();
+
+    EXPECT_EQ(run(executor,"SELECT a, sum(b) as s, count(*) as n FROM t1 GROUP BY a HAVING sum(b) > 2"),
+              (std::vector<std::string>{"1|15|2","2|23|2","6|7|1"}));
+    EXPECT_EQ(run(executor,"SELECT a, avg(b) as m, count(b) as n, max(name) as x FROM t1 GROUP BY a"),
+              (std::vector<std::string>{"1|7.5|2|z","2|11.5|2|y","4|1.5|1|x","5|null|0|y","6|7|1|w"}));
+    EXPECT_EQ(run(executor,"SELECT count(*) as n, count(distinct a) as d, min(b) as lo FROM t1"),
+              (std::vector<std::string>{"7|5|1.5"}));
+    // a global aggregate over no rows still returns one row
+    EXPECT_EQ(run(executor,"SELECT count(*) as n, sum(b) as s FROM t1 WHERE a > 100"),
+              (std::vector<std::string>{"0|null"}));
+    // also when the condition folds to false while planning
+    EXPECT_EQ(run(executor,"SELECT count(*) as n, sum(b) as s FROM t1 WHERE 1 = 0"),
+              (std::vector<std::string>{"0|null"}));
+    EXPECT_EQ(run(executor,"SELECT count(*) as n FROM (SELECT a, b FROM t1 WHERE a > 5 and a < 3) t"),
+              (std::vector<std::string>{"0"}));
+
+    std::vector<std::shared_ptr<const LocalBatch>> events;
+    for(int i = 0;i < 25;++i){
+        events.push_back(makeBatch({"ts","v"},{{static_cast<int64_t>(1000 * i),i}}));
+    }
+    executor.addTable("events",events);
+    EXPECT_EQ(run(executor,"SELECT sum(v) as s, count(*) as n FROM events INTERVAL BY ts EVERY 10 SECOND",false),
+              (std::vector<std::string>{"45|10","145|10","110|5"}));
+}
+
+TEST(LocalExecutorTest, StreamAggregate) {
+    const std::string selects = "sum(v) as s, count(*) as n, max(name) as m, median(v) as md";
+    // a bucket is emitted as soon as a later one starts, before the input ends
+    {
+        std::shared_ptr<LocalSpool> input = std::make_shared<LocalSpool>(),output = std::make_shared<LocalSpool>();
+        LocalStreamAggregateOperator aggregate(LocalStepDefinition::parse("StreamAggregate?input=s_1,output=s_2(interval=`1`,time=`ts`,time_unit=`second`,selects=`" +
+                                                                          selects + "`)"),selects,true);
+        aggregate.addInput(input);
+        aggregate.setOutput(output);
+        const int reader = output->subscribe();
+        std::thread worker([&]{ aggregate.execute(); });
+        input->push(makeBatch({"ts","v","name"},{{100,1,"a"},{900,2,"c"},{1500,3,"b"}}));
+        std::shared_ptr<const LocalBatch> first = output->pop(reader);
+        EXPECT_FALSE(output->isClosed());
+        input->push(makeBatch({"ts","v","name"},{{1999,4,"a"},{LocalValue(),5,"z"},{7000,6,"d"}}));
+        input->close();
+        worker.join();
+        std::vector<std::shared_ptr<const LocalBatch>> batches{first};
+        for(std::shared_ptr<const LocalBatch> batch = output->pop(reader);batch != nullptr;batch = output->pop(reader)){
+            batches.push_back(batch);
+        }
+        EXPECT_EQ(toRows({first}), (std::vector<std::string>{"0|3|2|c|1.5"}));
+        EXPECT_EQ(toRows(batches,false), (std::vector<std::string>{"0|3|2|c|1.5","1000|7|2|b|3.5","7000|6|1|d|6"}));
+        EXPECT_EQ(columnNames(batches), (std::vector<std::string>{"ts","s","n","m","md"}));
+    }
+
+    // 20000 events over 2000 buckets, shuffled within a few buckets, against a full per-bucket aggregation
+    std::vector<std::vector<LocalValue>> events;
+    for(int i = 0;i < 20000;++i){
+        const int64_t ts = 1000 + i * 7 - (i % 5 == 0 ? (i % 23) * 10 : 0);
+        events.push_back({ts,static_cast<int64_t>(i % 100),"n" + std::to_string(i % 37)});
+    }
+    const auto expected = [&](int64_t lateness,size_t& late){
+        std::map<int64_t, std::vector<std::vector<LocalValue>>> buckets;
+        int64_t watermark = std::numeric_limits<int64_t>::min();
+        late = 0;
+        for(auto& event : events){
+            const int64_t ts = event[0].asInt();
+            // a row is late once the watermark has passed the end of its bucket
+            if(watermark != std::numeric_limits<int64_t>::min() && ts / 70 < (watermark - lateness) / 70){
+                late++;
+                continue;
+            }
+            watermark = std::max(watermark,ts);
+            buckets[ts / 70].push_back(event);
+        }
+        std::vector<std::string> rows;
+        for(auto& bucket : buckets){
+            int64_t sum = 0;
+            std::string max;
+            std::vector<int64_t> values;
+            for(auto& event : bucket.second){
+                sum += event[1].asInt();
+                max = std::max(max,event[2].toString());
+                values.push_back(event[1].asInt());
+            }
+            std::sort(values.begin(),values.end());
+            const double median = values.size() % 2 == 1 ? values[values.size() / 2] : (values[values.size() / 2 - 1] + values[values.size() / 2]) / 2.0;
+            rows.push_back(std::to_string(bucket.first * 70) + "|" + std::to_string(sum) + "|" + std::to_string(bucket.second.size()) + "|" + max + "|" +
+                           LocalValue(median).toString());
+        }
+        return rows;
+    };
+    for(int64_t lateness : {0,200,1000}){
+        std::shared_ptr<LocalSpool> input = std::make_shared<LocalSpool>(),output = std::make_shared<LocalSpool>();
+        LocalStreamAggregateOperator aggregate(LocalStepDefinition::parse("StreamAggregate?input=s_1,output=s_2(interval=`70`,time=`ts`,time_unit=`millisecond`,"
+                                                                          "lateness=`" + std::to_string(lateness) + "`,selects=`" + selects + "`)"),selects,true);
+        aggregate.addInput(input);
+        aggregate.setOutput(output);
+        aggregate.setBatchSize(50);
+        const int reader = output->subscribe();
+        // one event per batch keeps the watermark exact
+        for(auto& event : events){
+            input->push(makeBatch({"ts","v","name"},{event}));
+        }
+        input->close();
+        aggregate.execute();
+        std::vector<std::shared_ptr<const LocalBatch>> batches;
+        for(std::shared_ptr<const LocalBatch> batch = output->pop(reader);batch != nullptr;batch = output->pop(reader)){
+            batches.push_back(batch);
+        }
+        size_t late = 0;
+        EXPECT_EQ(toRows(batches,false), expected(lateness,late)) << "lateness " << lateness;
+        EXPECT_EQ(aggregate.getLateRows(), late) << "lateness " << lateness;
+        // only the buckets within the lateness stay open
+        EXPECT_LE(aggregate.getCapacity(), lateness == 1000 ? 32u : 8u) << "lateness " << lateness;
+    }
+    EXPECT_THROW(LocalStreamAggregateOperator(LocalStepDefinition::parse("StreamAggregate?input=s_1,output=s_2(interval=`1`,time=`ts`,"
+                                                                         "lateness=`-1`,selects=`count(*) as n`)"),"count(*) as n",false), EngineException);
+
+    // the cloud merge keeps every bucket open: a second device's partials for buckets the first device already passed still count
+    LocalExecutor merger;
+    merger.addTable("partials",{
+        makeBatch({"st","partial_0","partial_1"},{{0,5,1},{30000,7,1},{90000,1,1}}),
+        makeBatch({"st","partial_0","partial_1"},{{0,100,2},{30000,200,1},{60000,3,1}}),
+        makeBatch({"st","partial_0","partial_1"},{{-30000,4,1}})
+    });
+    EXPECT_EQ(toRows(merger.execute(std::vector<std::string>{
+                  "Input?id=d_1,output=s_1(name=`partials`)",
+                  "FinalStreamAggregate?id=d_2,input=s_1,output=s_2(interval=`30`,selects=`sum(b) as s, count(b) as n`,"
+                  "states=`sum(b) as partial_0, count(b) as partial_1`,time=`st`,time_unit=`second`)"}),false),
+              (std::vector<std::string>{"4|1","105|3","207|2","3|1","1|1"}));
+}
+
+TEST(LocalExecutorTest, SlidingWindow) {
+    LocalExecutor executor = makeExecutor();
+    EXPECT_EQ(run(executor,"SELECT a, b, wsum('b') as s, wmin('b') as lo, wlag('name') as n from t1 WINDOW OVER (SLIDING ON 2 HAVING wsize() > 0 )",false),
+              (std::vector<std::string>{"1|10|10|10|x","2|20|30|10|y","1|5|25|5|z","4|1.5|6.5|1.5|x","5|null|1.5|1.5|y","6|7|7|7|w","2|3|10|3|null"}));
+    EXPECT_EQ(run(executor,"SELECT a, wcount('b') as c, wavg('b') as m from t1 WINDOW OVER (SLIDING ON wsize() <= 3 HAVING wcount('b') == 3 )",false),
+              (std::vector<std::string>{"1|3|11.6666666666667","4|3|8.83333333333333"}));
+
+    // keyed events with nulls, mixed integer and quarter values, against recomputing every window from scratch
+    std::vector<std::vector<LocalValue>> events;
+    for(int i = 0;i < 3000;++i){
+        const LocalValue v = i % 11 == 0 ? LocalValue() : i % 3 == 0 ? LocalValue(static_cast<int64_t>(i % 17 - 8)) : LocalValue((i % 29 - 14) * 0.25);
+        events.push_back({static_cast<int64_t>(i * 3 + i % 7),"k" + std::to_string(i % 4),v});
+    }
+    const std::string selects = "k, wsize() as n, wcount('v') as c, wsum('v') as s, wavg(v) as m, wmin('v') as lo, wmax('v') as hi, "
+                                "wlead('v') as f, wlag('v') as l, wmax('v') - wmin('v') as spread";
+    const auto expected = [&](const std::function<bool(const std::vector<std::vector<LocalValue>>&)>& keep){
+        std::map<std::string, std::vector<std::vector<LocalValue>>> windows;
+        std::vector<std::string> rows;
+        for(auto& event : events){
+            std::vector<std::vector<LocalValue>>& window = windows[event[1].toString()];
+            window.push_back(event);
+            while(window.size() > 1 && !keep(window)){
+                window.erase(window.begin());
+            }
+            LocalValue sum,lo,hi;
+            int64_t count = 0;
+            for(auto& row : window){
+                const LocalValue& v = row[2];
+                if(v.isNull()){
+                    continue;
+                }
+                count++;
+                sum = sum.isNull() ? v : v.getType() == LocalType::INT && sum.getType() == LocalType::INT ? LocalValue(sum.asInt() + v.asInt()) : LocalValue(sum.asDouble() + v.asDouble());
+                lo = lo.isNull() || LocalValue::compare(v,lo) < 0 ? v : lo;
+                hi = hi.isNull() || LocalValue::compare(v,hi) > 0 ? v : hi;
+            }
+            const auto text = [](const LocalValue& value){ return value.isNull() ? std::string("null") : value.toString(); };
+            rows.push_back(event[1].toString() + "|" + std::to_string(window.size()) + "|" + std::to_string(count) + "|" + text(sum) + "|" +
+                           text(count == 0 ? LocalValue() : LocalValue(sum.asDouble() / count)) + "|" + text(lo) + "|" + text(hi) + "|" +
+                           text(window.front()[2]) + "|" + text(window.back()[2]) + "|" +
+                           text(count == 0 ? LocalValue() : hi.getType() == LocalType::INT && lo.getType() == LocalType::INT ? LocalValue(hi.asInt() - lo.asInt()) :
+                                                            LocalValue(hi.asDouble() - lo.asDouble())));
+        }
+        return rows;
+    };
+    const auto slide = [&](const std::string& inclusion){
+        std::shared_ptr<LocalSpool> input = std::make_shared<LocalSpool>(),output = std::make_shared<LocalSpool>();
+        LocalSlidingWindowOperator window(LocalStepDefinition::parse("SlidingWindow?input=s_1,output=s_2(inclusion=`" + inclusion + "`,keys=`k`,selects=`" +
+                                                                     selects + "`,aggregations=`" + SqlSyntaxUtils::getWindowAggregations(selects) + "`)"));
+        window.addInput(input);
+        window.setOutput(output);
+        const int reader = output->subscribe();
+        for(size_t begin = 0;begin < events.size();begin += 7){
+            input->push(makeBatch({"ts","k","v"},std::vector<std::vector<LocalValue>>(events.begin() + begin,events.begin() + std::min(events.size(),begin + 7))));
+        }
+        input->close();
+        window.execute();
+        std::vector<std::shared_ptr<const LocalBatch>> batches;
+        for(std::shared_ptr<const LocalBatch> batch = output->pop(reader);batch != nullptr;batch = output->pop(reader)){
+            batches.push_back(batch);
+        }
+        EXPECT_EQ(window.getStrategy("wsum('v')"), LocalSlidingWindowOperator::Strategy::SUBTRACT);
+        EXPECT_EQ(window.getStrategy("wmax('v')"), LocalSlidingWindowOperator::Strategy::TWO_STACKS);
+        EXPECT_EQ(window.getStrategy("wlag('v')"), LocalSlidingWindowOperator::Strategy::NONE);
+        return toRows(batches,false);
+    };
+    EXPECT_EQ(slide("25"), expected([](const std::vector<std::vector<LocalValue>>& window){ return window.size() <= 25; }));
+    EXPECT_EQ(slide("ts - wlead('ts') < 200"), expected([](const std::vector<std::vector<LocalValue>>& window){
+        return window.back()[0].asInt() - window.front()[0].asInt() < 200;
+    }));
+
+    EXPECT_THROW(LocalSlidingWindowOperator(LocalStepDefinition::parse("SlidingWindow?input=s_1,output=s_2(inclusion=`5`,selects=`wmin('v') as lo`,"
+                                                                       "aggregations=`wmin('v'):subtract`)")), EngineException);
+    EXPECT_THROW(LocalSlidingWindowOperator(LocalStepDefinition::parse("SlidingWindow?input=s_1,output=s_2(inclusion=`0`,selects=`wsize() as n`)")), EngineException);
+
+    // out-of-order input is sorted before the windows are formed, nulls first
+    EXPECT_EQ(run(executor,"SELECT a, b, wsum('b') as s from t1 WINDOW OVER (SLIDING ON 2 PARTITION BY a ORDER BY b )",false),
+              (std::vector<std::string>{"5|null|null","4|1.5|1.5","2|3|3","1|5|5","6|7|7","1|10|15","2|20|23"}));
+    EXPECT_EQ(run(executor,"SELECT a, b, wlead('b') as f from t1 WINDOW OVER (SLIDING ON 2 PARTITION BY a ORDER BY b desc )",false),
+              (std::vector<std::string>{"5|null|null","2|20|20","1|10|10","6|7|7","1|5|10","2|3|20","4|1.5|1.5"}));
+}
+
+TEST(LocalExecutorTest, PatternWindow) {
+    LocalExecutor executor = makeExecutor();
+    EXPECT_EQ(run(executor,"SELECT a, wlag('b') as b, wsize() as n from t1 WINDOW OVER (PATTERN ON b < 10 UNTIL wsize() == 2 HAVING wsize() == 2 )",false),
+              (std::vector<std::string>{"4|1.5|2","2|3|2"}));
+
+    // 200 vehicles, each opening a window above 100 and closing it below 40 or after 6 rows, against a map of per-vehicle objects
+    std::vector<std::vector<LocalValue>> events;
+    for(int i = 0;i < 20000;++i){
+        const int speed = (i * 37 + i / 200 * 11) % 160;
+        events.push_back({static_cast<int64_t>(i),"v" + std::to_string(i % 200),i % 13 == 0 ? LocalValue() : speed % 3 == 0 ? LocalValue(speed) : LocalValue(speed + 0.5)});
+    }
+    const std::string selects = "k, wsize() as n, wcount('speed') as c, wsum('speed') as s, wavg('speed') as m, wmin('speed') as lo, "
+                                "wmax('speed') as hi, wlead('ts') as t0, wlag('ts') as t1";
+    struct Pattern{
+        bool open = false;
+        std::vector<std::vector<LocalValue>> rows;
+    };
+    const auto expected = [&](bool closeOnSize){
+        std::map<std::string, Pattern> patterns;
+        std::vector<std::string> rows;
+        for(auto& event : events){
+            Pattern& pattern = patterns[event[1].toString()];
+            const LocalValue& speed = event[2];
+            if(!pattern.open){
+                if(speed.isNull() || speed.asDouble() <= 100){
+                    continue;
+                }
+                pattern.open = true;
+                pattern.rows.clear();
+            }
+            pattern.rows.push_back(event);
+            if(!(closeOnSize ? pattern.rows.size() >= 6 || (!speed.isNull() && speed.asDouble() < 40) : !speed.isNull() && speed.asDouble() < 40)){
+                continue;
+            }
+            pattern.open = false;
+            if(pattern.rows.size() < 2){
+                continue;
+            }
+            LocalValue sum,lo,hi;
+            int64_t count = 0;
+            for(auto& row : pattern.rows){
+                const LocalValue& v = row[2];
+                if(v.isNull()){
+                    continue;
+                }
+                count++;
+                sum = sum.isNull() ? v : v.getType() == LocalType::INT && sum.getType() == LocalType::INT ? LocalValue(sum.asInt() + v.asInt()) : LocalValue(sum.asDouble() + v.asDouble());
+                lo = lo.isNull() || LocalValue::compare(v,lo) < 0 ? v : lo;
+                hi = hi.isNull() || LocalValue::compare(v,hi) > 0 ? v : hi;
+            }
+            const auto text = [](const LocalValue& value){ return value.isNull() ? std::string("null") : value.toString(); };
+            rows.push_back(event[1].toString() + "|" + std::to_string(pattern.rows.size()) + "|" + std::to_string(count) + "|" + text(sum) + "|" +
+                           text(count == 0 ? LocalValue() : LocalValue(sum.asDouble() / count)) + "|" + text(lo) + "|" + text(hi) + "|" +
+                           text(pattern.rows.front()[0]) + "|" + text(pattern.rows.back()[0]));
+        }
+        return rows;
+    };
+    const auto match = [&](const std::string& enter,const std::string& exit,size_t& keys){
+        std::shared_ptr<LocalSpool> input = std::make_shared<LocalSpool>(),output = std::make_shared<LocalSpool>();
+        LocalPatternWindowOperator pattern(LocalStepDefinition::parse("PatternWindow?input=s_1,output=s_2(enter=`" + enter + "`,exit=`" + exit + "`,keys=`k`,selects=`" +
+                                                                      selects + "`,validity=`wsize() >= 2`)"));
+        pattern.addInput(input);
+        pattern.setOutput(output);
+        const int reader = output->subscribe();
+        for(size_t begin = 0;begin < events.size();begin += 64){
+            input->push(makeBatch({"ts","k","speed"},std::vector<std::vector<LocalValue>>(events.begin() + begin,events.begin() + std::min(events.size(),begin + 64))));
+        }
+        input->close();
+        pattern.execute();
+        std::vector<std::shared_ptr<const LocalBatch>> batches;
+        for(std::shared_ptr<const LocalBatch> batch = output->pop(reader);batch != nullptr;batch = output->pop(reader)){
+            batches.push_back(batch);
+        }
+        keys = pattern.getKeyCount();
+        // state machine byte, window size, one count / sum group for speed and min / max / lead / lag values
+        EXPECT_LE(pattern.getStateBytesPerKey(), 80u);
+        return toRows(batches,false);
+    };
+    size_t keys = 0;
+    // both conditions on the row alone are evaluated column-wise per batch
+    const std::vector<std::string> closed = expected(false);
+    EXPECT_GT(closed.size(), 500u);
+    EXPECT_EQ(match("speed > 100","speed < 40",keys), closed);
+    EXPECT_EQ(keys, 200u);
+    // conditions using window functions are evaluated row by row
+    EXPECT_EQ(match("wsize() == 0 and speed > 100","wsize() >= 6 or speed < 40",keys), expected(true));
+
+    EXPECT_THROW(LocalPatternWindowOperator(LocalStepDefinition::parse("PatternWindow?input=s_1,output=s_2(enter=`true`,selects=`wsize() as n`)")), EngineException);
+}
+
+TEST(LocalExecutorTest, TumblingWindow) {
+    LocalExecutor executor = makeExecutor();
+    // the plain column a takes the last row of each window, the last window is closed at the end of the input
+    EXPECT_EQ(run(executor,"SELECT a, wsize() as n, wsum('b') as s from t1 WINDOW OVER (TUMBLING ON wsize() <= 3 HAVING wcount('b') > 1 )",false),
+              (std::vector<std::string>{"1|3|35","6|3|8.5"}));
+
+    // 200 vehicles split into windows of 5 rows or while the speed sum stays below 400, against per-vehicle row lists
+    std::vector<std::vector<LocalValue>> events;
+    for(int i = 0;i < 30000;++i){
+        const int speed = (i * 37 + i / 200 * 11) % 160;
+        events.push_back({static_cast<int64_t>(i),"v" + std::to_string(i % 200 + i / 7000),i % 13 == 0 ? LocalValue() : speed % 3 == 0 ? LocalValue(speed) : LocalValue(speed + 0.5)});
+    }
+    const std::string selects = "k, ts, wsize() as n, wcount('speed') as c, wsum('speed') as s, wavg('speed') as m, wmin('speed') as lo, "
+                                "wmax('speed') as hi, wlead('ts') as t0";
+    const auto expected = [&](size_t limit){
+        std::map<std::string, std::vector<std::vector<LocalValue>>> windows;
+        std::vector<std::string> keys;
+        std::vector<std::string> rows;
+        const auto text = [](const LocalValue& value){ return value.isNull() ? std::string("null") : value.toString(); };
+        const auto sum = [](const std::vector<std::vector<LocalValue>>& window,int64_t& count){
+            LocalValue total;
+            count = 0;
+            for(auto& row : window){
+                const LocalValue& v = row[2];
+                if(!v.isNull()){
+                    count++;
+                    total = total.isNull() ? v : v.getType() == LocalType::INT && total.getType() == LocalType::INT ? LocalValue(total.asInt() + v.asInt())
+                                                                                                                    : LocalValue(total.asDouble() + v.asDouble());
+                }
+            }
+            return total;
+        };
+        const auto close = [&](std::vector<std::vector<LocalValue>>& window){
+            int64_t count = 0;
+            const LocalValue s = sum(window,count);
+            LocalValue lo,hi;
+            for(auto& row : window){
+                const LocalValue& v = row[2];
+                lo = v.isNull() || (!lo.isNull() && LocalValue::compare(v,lo) >= 0) ? lo : v;
+                hi = v.isNull() || (!hi.isNull() && LocalValue::compare(v,hi) <= 0) ? hi : v;
+            }
+            rows.push_back(text(window.back()[1]) + "|" + text(window.back()[0]) + "|" + std::to_string(window.size()) + "|" + std::to_string(count) + "|" +
+                           text(s) + "|" + text(count == 0 ? LocalValue() : LocalValue(s.asDouble() / count)) + "|" + text(lo) + "|" + text(hi) + "|" +
+                           text(window.front()[0]));
+            window.clear();
+        };
+        for(auto& event : events){
+            const std::string key = event[1].toString();
+            if(windows.find(key) == windows.end()){
+                keys.push_back(key);
+            }
+            std::vector<std::vector<LocalValue>>& window = windows[key];
+            if(limit == 0 && !window.empty()){
+                window.push_back(event);
+                int64_t count = 0;
+                const LocalValue s = sum(window,count);
+                window.pop_back();
+                if(s.isNull() || s.asDouble() >= 400){
+                    close(window);
+                }
+            }
+            window.push_back(event);
+            if(limit > 0 && window.size() == limit){
+                close(window);
+            }
+        }
+        for(const std::string& key : keys){
+            if(!windows[key].empty()){
+                close(windows[key]);
+            }
+        }
+        return rows;
+    };
+    const auto match = [&](const std::string& inclusion,size_t threads){
+        std::shared_ptr<LocalSpool> input = std::make_shared<LocalSpool>(),output = std::make_shared<LocalSpool>();
+        LocalTumblingWindowOperator tumbling(LocalStepDefinition::parse("TumblingWindow?input=s_1,output=s_2(inclusion=`" + inclusion + "`,keys=`k`,selects=`" +
+                                                                        selects + "`)"));
+        tumbling.setThreads(threads);
+        tumbling.addInput(input);
+        tumbling.setOutput(output);
+        const int reader = output->subscribe();
+        // batches large enough to be split across threads, and a small one processed inline
+        for(size_t begin = 0;begin < events.size();begin += begin == 0 ? 100 : 2000){
+            const size_t end = std::min(events.size(),begin + (begin == 0 ? 100 : 2000));
+            input->push(makeBatch({"ts","k","speed"},std::vector<std::vector<LocalValue>>(events.begin() + begin,events.begin() + end)));
+        }
+        input->close();
+        tumbling.execute();
+        std::vector<std::shared_ptr<const LocalBatch>> batches;
+        for(std::shared_ptr<const LocalBatch> batch = output->pop(reader);batch != nullptr;batch = output->pop(reader)){
+            batches.push_back(batch);
+        }
+        // window size, one count / sum group for speed and min / max / lead / lag values
+        EXPECT_LE(tumbling.getStateBytesPerKey(), 100u);
+        return toRows(batches,false);
+    };
+    const std::vector<std::string> counted = expected(5);
+    EXPECT_GT(counted.size(), 5000u);
+    EXPECT_EQ(match("5",1), counted);
+    EXPECT_EQ(match("5",4), counted);
+    const std::vector<std::string> summed = expected(0);
+    EXPECT_GT(summed.size(), 5000u);
+    EXPECT_EQ(match("wsum('speed') < 400",1), summed);
+    EXPECT_EQ(match("wsum('speed') < 400",4), summed);
+
+    EXPECT_THROW(LocalTumblingWindowOperator(LocalStepDefinition::parse("TumblingWindow?input=s_1,output=s_2(inclusion=`0`,selects=`wsize() as n`)")), EngineException);
+    EXPECT_THROW(LocalTumblingWindowOperator(LocalStepDefinition::parse("TumblingWindow?input=s_1,output=s_2(inclusion=`5`,selects=`*`)")), EngineException);
+}
+
+TEST(LocalExecutorTest, GroupTable) {
+    std::vector<uint32_t> groups;
+
+    // single integer keys, a null key gets its own group
+    LocalGroupTable ints({LocalExpression::parse("k")},{"k"});
+    ints.lookup(*makeBatch({"k"},{{7},{7},{LocalValue()},{3},{7}}),groups);
+    EXPECT_EQ(ints.getMode(), LocalGroupTable::Mode::INT);
+    EXPECT_EQ(groups, (std::vector<uint32_t>{0,0,1,2,0}));
+    // a double column switches to the generic encoding without renumbering, 3 and 3.0 stay distinct
+    ints.lookup(*makeBatch({"k"},{{3.5},{3},{LocalValue()},{3}}),groups);
+    EXPECT_EQ(ints.getMode(), LocalGroupTable::Mode::GENERIC);
+    EXPECT_EQ(groups, (std::vector<uint32_t>{3,4,1,4}));
+    std::shared_ptr<LocalBatch> keys = std::make_shared<LocalBatch>(5);
+    keys->addColumn(ints.getKeyColumn(0,0,5));
+    EXPECT_EQ(toRows({keys},false), (std::vector<std::string>{"7","null","3","3.5","3"}));
+
+    // single string keys are dictionary encoded
+    LocalGroupTable strings({LocalExpression::parse("vin")},{"vin"});
+    strings.lookup(*makeBatch({"vin"},{{"LVIN00000000000001"},{"B"},{"LVIN00000000000001"},{LocalValue()}}),groups);
+    EXPECT_EQ(strings.getMode(), LocalGroupTable::Mode::STRING);
+    EXPECT_EQ(groups, (std::vector<uint32_t>{0,1,0,2}));
+    EXPECT_EQ(strings.getKeyColumn(0,0,3).get(0).toString(), "LVIN00000000000001");
+    EXPECT_TRUE(strings.getKeyColumn(0,0,3).isNull(2));
+
+    // several keys, enough groups to grow the table a few times
+    LocalGroupTable pairs({LocalExpression::parse("a"),LocalExpression::parse("b % 3")},{"a","m"});
+    std::vector<std::vector<LocalValue>> rows;
+    for(int i = 0;i < 5000;++i){
+        rows.push_back({i % 2000,i});
+    }
+    pairs.lookup(*makeBatch({"a","b"},rows),groups);
+    EXPECT_EQ(pairs.getMode(), LocalGroupTable::Mode::GENERIC);
+    EXPECT_EQ(pairs.size(), 5000);
+    EXPECT_GE(pairs.getCapacity() * 3, pairs.size() * 4);
+    pairs.lookup(*makeBatch({"a","b"},{{1999,3998},{1999,3999}}),groups);
+    EXPECT_EQ(groups, (std::vector<uint32_t>{5000,3999}));
+    EXPECT_EQ(pairs.getKeyColumn(1,5000,5001).get(0).asInt(), 2);
+
+    // aggregates over batches whose inferred types differ
+    LocalExecutor executor = makeExecutor();
+    executor.addTable("mixed",{
+        makeBatch({"k","v"},{{"a",1},{"b",4},{"a",LocalValue()}}),
+        makeBatch({"k","v"},{{"a",2.5},{"b","x"}})
+    });
+    EXPECT_EQ(run(executor,"SELECT k, min(v) as lo, max(v) as hi, first(v) as f, last(v) as l, count(v) as n FROM mixed GROUP BY k"),
+              (std::vector<std::string>{"a|1|2.5|1|2.5|2","b|4|x|4|x|2"}));
+    EXPECT_THROW(run(executor,"SELECT k, sum(v) as s FROM mixed GROUP BY k"), EngineException);
+}
+
+TEST(LocalExecutorTest, Join) {
+    LocalExecutor executor = makeExecutor();
+
+    EXPECT_EQ(run(executor,"SELECT x.a, y.c FROM t1 x JOIN t2 y ON x.a = y.id"),
+              (std::vector<std::string>{"1|one","1|one","2|deux","2|deux","2|two","2|two"}));
+    EXPECT_EQ(run(executor,"SELECT x.a, y.c FROM t1 x LEFT JOIN t2 y ON x.a = y.id WHERE x.b < 10"),
+              (std::vector<std::string>{"1|one","2|deux","2|two","4|null","6|null"}));
+    EXPECT_EQ(run(executor,"SELECT x.a, y.id FROM t2 y RIGHT JOIN t1 x ON y.id = x.a AND y.c = 'one'"),
+              (std::vector<std::string>{"1|1","1|1","2|null","2|null","4|null","5|null","6|null"}));
+    EXPECT_EQ(run(executor,"SELECT x.a, y.id FROM t1 x FULL JOIN t2 y ON x.a = y.id AND y.c != 'two'"),
+              (std::vector<std::string>{"1|1","1|1","2|2","2|2","4|null","5|null","6|null","null|2","null|3"}));
+    // no equality keys: every pair is checked
+    EXPECT_EQ(run(executor,"SELECT x.a, y.id FROM t1 x JOIN t2 y ON x.a > y.id + 3"),
+              (std::vector<std::string>{"5|1","6|1","6|2","6|2"}));
+    EXPECT_EQ(run(executor,"SELECT x.a, y.id FROM t1 x LEFT JOIN t2 y ON x.a > y.id + 4 WHERE x.a > 3"),
+              (std::vector<std::string>{"4|null","5|null","6|1"}));
+}
+
+TEST(LocalExecutorTest, RadixHashTable) {
+    // duplicate and null keys on both sides, integral doubles match integers
+    std::vector<std::vector<LocalValue>> buildRows,probeRows;
+    for(int i = 0;i < 1200;++i){
+        buildRows.push_back({i % 7 == 0 ? LocalValue() : LocalValue(static_cast<int64_t>(i % 400)),"k" + std::to_string(i % 200)});
+    }
+    for(int i = 0;i < 300;++i){
+        probeRows.push_back({i % 5 == 0 ? LocalValue(i * 2 + 0.5) : LocalValue(static_cast<double>(i * 2)),"k" + std::to_string((i * 2 + i % 3) % 200)});
+    }
+    std::shared_ptr<const LocalBatch> buildBatch = makeBatch({"id","name"},buildRows);
+    std::shared_ptr<const LocalBatch> probeBatch = makeBatch({"id","name"},probeRows);
+
+    for(const std::vector<size_t>& keys : std::vector<std::vector<size_t>>{{0},{1},{0,1}}){
+        std::vector<const LocalColumn*> buildKeys,probeKeys;
+        for(size_t c : keys){
+            buildKeys.push_back(&buildBatch->getColumn(c));
+            probeKeys.push_back(&probeBatch->getColumn(c));
+        }
+        std::vector<std::string> expected;
+        for(size_t l = 0;l < probeRows.size();++l){
+            for(size_t r = 0;r < buildRows.size();++r){
+                bool equal = true;
+                for(size_t c : keys){
+                    equal = equal && !buildRows[r][c].isNull() && buildRows[r][c] == probeRows[l][c];
+                }
+                if(equal){
+                    expected.push_back(std::to_string(l) + "|" + std::to_string(r));
+                }
+            }
+        }
+        std::sort(expected.begin(),expected.end());
+        ASSERT_FALSE(expected.empty());
+
+        // a tiny partition budget forces many partitions, the default fits everything in one
+        for(size_t partitionBytes : {static_cast<size_t>(1024),LocalRadixHashTable::defaultPartitionBytes()}){
+            LocalRadixHashTable table(partitionBytes);
+            table.build(buildKeys);
+            std::vector<int64_t> leftRows,rightRows;
+            table.probe(probeKeys,leftRows,rightRows);
+            std::vector<std::string> pairs;
+            for(size_t i = 0;i < leftRows.size();++i){
+                pairs.push_back(std::to_string(leftRows[i]) + "|" + std::to_string(rightRows[i]));
+            }
+            std::sort(pairs.begin(),pairs.end());
+            EXPECT_EQ(pairs, expected) << keys.size() << " keys, " << table.getPartitionCount() << " partitions";
+            if(partitionBytes == 1024){
+                EXPECT_GT(table.getPartitionCount(), 16);
+            }
+        }
+    }
+}
+
+TEST(LocalExecutorTest, NestedJoin) {
+    // enough pairs for several blocks per probe batch, nulls on both sides
+    std::vector<std::vector<LocalValue>> leftRows,rightRows;
+    for(int i = 0;i < 700;++i){
+        leftRows.push_back({i % 11 == 0 ? LocalValue() : LocalValue(static_cast<int64_t>(i % 97)),"n" + std::to_string(i % 5)});
+    }
+    for(int i = 0;i < 400;++i){
+        rightRows.push_back({i % 13 == 0 ? LocalValue() : LocalValue(i * 0.25),"n" + std::to_string(i % 7)});
+    }
+    const auto expected = [&](const std::function<bool(const std::vector<LocalValue>&,const std::vector<LocalValue>&)>& matches,bool keepLeft){
+        std::vector<std::string> rows;
+        for(auto& l : leftRows){
+            bool matched = false;
+            for(auto& r : rightRows){
+                if(matches(l,r)){
+                    matched = true;
+                    rows.push_back((l[0].isNull() ? std::string("null") : l[0].toString()) + "|" + r[0].toString());
+                }
+            }
+            if(!matched && keepLeft){
+                rows.push_back((l[0].isNull() ? std::string("null") : l[0].toString()) + "|null");
+            }
+        }
+        std::sort(rows.begin(),rows.end());
+        return rows;
+    };
+    const auto run = [&](const std::string& type,const std::string& condition,size_t threads){
+        std::shared_ptr<LocalSpool> left = std::make_shared<LocalSpool>(),right = std::make_shared<LocalSpool>(),output = std::make_shared<LocalSpool>();
+        LocalNestedJoinOperator join(LocalStepDefinition::parse("NestedJoin?input=s_1,input2=s_2,output=s_3(join_type=`" + type +
+                                                                "`,left_alias=`x`,right_alias=`y`,condition=`" + condition + "`,selects=`x.v, y.v`)"));
+        join.addInput(left);
+        join.addInput(right);
+        join.setOutput(output);
+        join.setBatchSize(100);
+        join.setThreads(threads);
+        const int reader = output->subscribe();
+        for(size_t begin = 0;begin < leftRows.size();begin += 300){
+            left->push(makeBatch({"v","k"},std::vector<std::vector<LocalValue>>(leftRows.begin() + begin,leftRows.begin() + std::min(leftRows.size(),begin + 300))));
+        }
+        right->push(makeBatch({"v","k"},rightRows));
+        left->close();
+        right->close();
+        join.execute();
+        std::vector<std::shared_ptr<const LocalBatch>> batches;
+        for(std::shared_ptr<const LocalBatch> batch = output->pop(reader);batch != nullptr;batch = output->pop(reader)){
+            batches.push_back(batch);
+        }
+        return toRows(batches);
+    };
+
+    const std::vector<std::string> less = expected([](auto& l,auto& r){ return !l[0].isNull() && !r[0].isNull() && l[0].asDouble() < r[0].asDouble(); },false);
+    const std::vector<std::string> arithmetic = expected([](auto& l,auto& r){
+        return !l[0].isNull() && !r[0].isNull() && l[0].asDouble() * 2 == r[0].asDouble() + 1 && l[1] != r[1];
+    },true);
+    ASSERT_FALSE(less.empty());
+    for(size_t threads : {1,4}){
+        EXPECT_EQ(run("inner","x.v < y.v",threads), less) << threads << " threads";
+        EXPECT_EQ(run("left","x.v * 2 = y.v + 1 AND x.k != y.k",threads), arithmetic) << threads << " threads";
+    }
+    EXPECT_THROW(run("inner","x.v < y.missing",4), EngineException);
+}
+
+TEST(LocalExecutorTest, IntervalJoin) {
+    LocalExecutor executor;
+    executor.addTable("s",{makeBatch({"a","ts"},{{1,1000},{1,2000},{2,1000},{3,LocalValue()},{LocalValue(),1000}})});
+    executor.addTable("t",{makeBatch({"a","ts","b"},{{1,950,"p"},{1,1100,"q"},{1,2100,"r"},{1,2101,"x"},{2,1200,"y"},{2,900,"z"},{3,1000,"w"}})});
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    const auto stepOf = [&](const std::string& sql){
+        return planner.plan(parser.parse(sql))->getPlan().back();
+    };
+
+    // keys plus a band, both bounds inclusive
+    const std::string keyed = "SELECT s.a, t.b FROM s JOIN t ON s.a = t.a and t.ts between s.ts - 100 and s.ts + 100";
+    ASSERT_EQ(stepOf(keyed).rfind("IntervalJoin?",0), 0);
+    EXPECT_EQ(run(executor,keyed), (std::vector<std::string>{"1|p","1|q","1|r","2|z"}));
+
+    // no keys: the build side is searched by time
+    const std::string band = "SELECT s.a, t.b FROM s JOIN t ON t.ts between s.ts and s.ts + 100";
+    ASSERT_EQ(stepOf(band).rfind("IntervalJoin?",0), 0);
+    EXPECT_EQ(run(executor,band), (std::vector<std::string>{"1|q","1|r","1|w","2|q","2|w","null|q","null|w"}));
+
+    // the residual is checked on the band pairs, unmatched left rows are kept
+    const std::string left = "SELECT s.a, t.b FROM s LEFT JOIN t ON s.a = t.a and t.ts >= s.ts - 100 and t.ts <= s.ts + 100 and t.b != 'p'";
+    ASSERT_EQ(stepOf(left).rfind("IntervalJoin?",0), 0);
+    EXPECT_EQ(run(executor,left), (std::vector<std::string>{"1|q","1|r","2|z","3|null","null|null"}));
+}
+
+TEST(LocalExecutorTest, AsofJoin) {
+    LocalExecutor executor;
+    executor.addTable("can",{makeBatch({"vin","ts"},{{1,100},{1,250},{1,50},{2,300},{3,100}})});
+    executor.addTable("gps",{makeBatch({"vin","ts","lat"},{{1,200,20},{1,100,10},{1,250,25},{2,400,40},{LocalValue(),100,99}})});
+    const std::string sql = "SELECT c.ts, g.lat FROM can c ASOF JOIN gps g ON c.vin = g.vin MATCH_CONDITION(";
+
+    // every left row once, with the nearest right row on the matching side or nulls
+    EXPECT_EQ(run(executor,sql + "c.ts >= g.ts)"), (std::vector<std::string>{"100|10","100|null","250|25","300|null","50|null"}));
+    EXPECT_EQ(run(executor,sql + "g.ts < c.ts)"), (std::vector<std::string>{"100|null","100|null","250|20","300|null","50|null"}));
+    EXPECT_EQ(run(executor,sql + "c.ts <= g.ts)"), (std::vector<std::string>{"100|10","100|null","250|25","300|40","50|10"}));
+    EXPECT_EQ(run(executor,sql + "c.ts < g.ts)"), (std::vector<std::string>{"100|20","100|null","250|null","300|40","50|10"}));
+}
+
+TEST(LocalExecutorTest, BloomFilter) {
+    LocalExecutor executor;
+    executor.setBatchSize(3);
+    executor.addTable("orders",{makeBatch({"id","customer"},{{10,1},{11,2},{12,3},{13,5},{14,LocalValue()},{15,1.0}})});
+    executor.addTable("customers",{makeBatch({"id","region"},{{1,3},{1,3},{2,3},{3,1},{4,3}})});
+
+    // the bloom filter keeps every matching key and drops null keys
+    const std::vector<std::string> steps = {
+        "Input?id=d_0,output=s_0(name=`orders`)",
+        "Input?id=d_1,output=s_1(name=`customers`)",
+        "BloomBuild?id=d_2,input=s_1,output=s_2(bits=`4096`,hashes=`5`,keys=`id`)",
+        "BloomFilter?id=d_3,input=s_0,output=s_3(bloom=`s_2`,keys=`customer`)"};
+    const std::vector<std::string> kept = toRows(executor.execute(steps));
+    for(const std::string& row : {"10|1","11|2","12|3","15|1"}){
+        EXPECT_NE(std::find(kept.begin(),kept.end(),row), kept.end()) << row;
+    }
+    EXPECT_EQ(std::find(kept.begin(),kept.end(),"14|null"), kept.end());
+    EXPECT_LE(kept.size(), 5);
+
+    // an empty build side drops everything
+    executor.addTable("none",{makeBatch({"id"},{})});
+    EXPECT_TRUE(toRows(executor.execute({"Input?id=d_0,output=s_0(name=`orders`)","Input?id=d_1,output=s_1(name=`none`)",
+        "BloomBuild?id=d_2,input=s_1,output=s_2(bits=`64`,hashes=`2`,keys=`id`)",
+        "BloomFilter?id=d_3,input=s_0,output=s_3(bloom=`s_2`,keys=`customer`)"})).empty());
+
+    // the distributed plan filters on the edge with a filter built on the cloud, which comes later in the plan
+    std::shared_ptr<LocalStatisticsCatalog> catalog = std::make_shared<LocalStatisticsCatalog>();
+    catalog->parse("table orders rows=1000000 width=32\n"
+                   "column orders customer ndv=50000\n"
+                   "table customers rows=50000 width=64\n"
+                   "column customers id ndv=50000\n"
+                   "column customers region ndv=10\n");
+    SqlQueryParser parser;
+    SqlDistributedPlanner planner;
+    planner.setStatisticsCatalog(catalog);
+    planner.setBroadcastBudget(0);
+    const std::string sql = "SELECT o.id, c.n FROM orders o JOIN (SELECT id, count(*) as n FROM customers WHERE region = 3 GROUP BY id) c ON o.customer = c.id";
+    std::shared_ptr<SqlDistributedPlan> plan = planner.plan(parser.parse(sql));
+    ASSERT_EQ(plan->getEdgePlan().back().rfind("BloomFilter?",0), 0);
+    std::vector<std::string> distributed = plan->getEdgePlan();
+    distributed.insert(distributed.end(),plan->getCloudPlan().begin(),plan->getCloudPlan().end());
+    EXPECT_EQ(toRows(executor.execute(distributed)), (std::vector<std::string>{"10|2","11|1","15|2"}));
+    EXPECT_EQ(toRows(executor.execute(distributed)), run(executor,sql));
+}
+
+TEST(LocalExecutorTest, Exchange) {
+    LocalExecutor executor = makeExecutor();
+    SqlQueryParser parser;
+    SqlDistributedPlanner planner;
+    planner.setTiers({SqlTierProfile("ecu",64 * 1024,SqlCpuClass::LOW),SqlTierProfile("gateway",64 * 1024 * 1024,SqlCpuClass::MEDIUM),
+                      SqlTierProfile("cloud",-1,SqlCpuClass::HIGH)});
+
+    // the tier plans run as one pipeline, Exchange passes the batches between them unchanged
+    const std::string sql = "SELECT a, sum(b) as s FROM t1 WHERE a > 1 GROUP BY a";
+    std::shared_ptr<SqlDistributedPlan> plan = planner.plan(parser.parse(sql));
+    std::vector<std::string> steps;
+    for(const std::vector<std::string>& tier : plan->getTierPlans()){
+        steps.insert(steps.end(),tier.begin(),tier.end());
+    }
+    ASSERT_EQ(std::count_if(steps.begin(),steps.end(),[](const std::string& step){ return step.rfind("Exchange?",0) == 0; }), 2);
+    EXPECT_EQ(toRows(executor.execute(steps)), run(executor,sql));
+    EXPECT_EQ(toRows(executor.execute(steps)).size(), 4);
+}
+
+TEST(LocalExecutorTest, Empty) {
+    LocalExecutor executor = makeExecutor();
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+
+    // a statement folded to false reads nothing and returns no rows with the select layout
+    std::shared_ptr<SqlPlan> plan = planner.plan(parser.parse("SELECT a, b * 2 as c FROM t1 WHERE 1 = 0"));
+    ASSERT_EQ(plan->getPlan().size(), 1);
+    ASSERT_EQ(plan->getPlan()[0].rfind("Empty?",0), 0);
+    const std::vector<std::shared_ptr<const LocalBatch>> batches = executor.execute(*plan);
+    EXPECT_TRUE(toRows(batches).empty());
+    EXPECT_EQ(columnNames(batches), (std::vector<std::string>{"a","c"}));
+
+    EXPECT_TRUE(run(executor,"SELECT a, sum(b) as s FROM t1 WHERE a > 5 and a < 3 GROUP BY a").empty());
+    EXPECT_TRUE(run(executor,"SELECT x.a, y.c FROM t1 x JOIN (SELECT id, c FROM t2 WHERE 1 > 2) y ON x.a = y.id").empty());
+    EXPECT_TRUE(run(executor,"SELECT a, count(*) as n FROM t1 GROUP BY a HAVING 1 = 0").empty());
+}
+
+TEST(LocalExecutorTest, DistributedPlan) {
+    LocalExecutor executor = makeExecutor();
+    SqlQueryParser parser;
+    SqlDistributedPlanner planner;
+
+    // spool names are unique across the edge and cloud plans, so both halves run as one pipeline
+    std::shared_ptr<SqlDistributedPlan> plan = planner.plan(parser.parse("SELECT a, avg(b) as m, count(*) as n FROM t1 GROUP BY a"));
+    ASSERT_EQ(plan->getEdgePlan().back().rfind("PartialGroupBy?",0), 0);
+    std::vector<std::string> steps = plan->getEdgePlan();
+    steps.insert(steps.end(),plan->getCloudPlan().begin(),plan->getCloudPlan().end());
+    EXPECT_EQ(toRows(executor.execute(steps)),
+              (std::vector<std::string>{"1|7.5|2","2|11.5|2","4|1.5|1","5|null|1","6|7|1"}));
+    EXPECT_EQ(columnNames(executor.execute(steps)), (std::vector<std::string>{"a","m","n"}));
+}
+
+TEST(LocalExecutorTest, Files) {
+    const std::string directory = ::testing::TempDir();
+    {
+        std::ofstream file(directory + "/readings.csv");
+        file << "vin:string,speed:double,rpm:int\n"
+             << "A1,82.5,3000\n"
+             << "\"B,2\",40,\n"
+             << "A1,95,4200\n";
+    }
+    LocalExecutor executor(directory);
+    executor.setBatchSize(2);
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+
+    EXPECT_EQ(toRows(executor.execute(*planner.plan(parser.parse("SELECT vin, max(speed) as top FROM readings GROUP BY vin")))),
+              (std::vector<std::string>{"A1|95","B,2|40"}));
+
+    EXPECT_TRUE(executor.execute(*planner.plan(parser.parse("SELECT vin, rpm INTO fast FROM readings WHERE speed > 50 OR rpm IS NULL"))).empty());
+    std::ifstream file(directory + "/fast.csv");
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_EQ(content.str(), "vin:string,rpm:int\nA1,3000\n\"B,2\",\nA1,4200\n");
+    std::remove((directory + "/readings.csv").c_str());
+    std::remove((directory + "/fast.csv").c_str());
+
+    EXPECT_THROW(executor.execute(*planner.plan(parser.parse("SELECT * FROM missing"))), EngineException);
+}
@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+#include "../include/SqlQueryParser.h"
+#include "../include/SqlQueryPlanner.h"
+#include "../include/SqlDistributedPlanner.h"
+#include "../include/SqlCostEstimator.h"
+#include "../include/LocalStatisticsCatalog.h"
+
+static std::shared_ptr<LocalStatisticsCatalog> makeCatalog(){
+    std::shared_ptr<LocalStatisticsCatalog> catalog = std::make_shared<LocalStatisticsCatalog>();
+    catalog->parse(
+        "# vehicle signals\n"
+        "table t1 rows=100000 width=32\n"
+        "column t1 a ndv=100 min=0 max=1000 null_fraction=0 width=8\n"
+        "column t1 speed ndv=240 min=0 max=240 null_fraction=0.2\n"
+        "\n"
+        "table models rows=50\n"
+        "column models a ndv=50 width=8\n"
+        "\n"
+        "table orders rows=1000000 width=32\n"
+        "column orders customer ndv=50000\n"
+        "table customers rows=50000 width=64\n"
+        "column customers id ndv=50000\n"
+        "column customers region ndv=10\n"
+        "table regions rows=10 width=16\n"
+        "column regions id ndv=10\n");
+    return catalog;
+}
+
+TEST(SqlCostEstimatorTest, LocalCatalog) {
+    std::shared_ptr<LocalStatisticsCatalog> catalog = makeCatalog();
+    std::shared_ptr<TableStatistics> t1 = catalog->getTableStatistics("t1");
+    ASSERT_NE(t1, nullptr);
+    EXPECT_DOUBLE_EQ(t1->getRowCount(), 100000);
+    EXPECT_DOUBLE_EQ(t1->getWidth(), 32);
+    ASSERT_NE(t1->getColumn("t.speed"), nullptr);
+    EXPECT_DOUBLE_EQ(t1->getColumn("speed")->getNullFraction(), 0.2);
+    EXPECT_TRUE(t1->getColumn("a")->hasMinMax());
+    EXPECT_EQ(catalog->getTableStatistics("t2"), nullptr);
+
+    EXPECT_THROW(catalog->parse("column t1"), EngineException);
+    EXPECT_THROW(catalog->parse("table t1 rows=abc"), EngineException);
+    EXPECT_THROW(catalog->parse("table t1 colour=1"), EngineException);
+    EXPECT_THROW(catalog->load("/nonexistent/statistics.txt"), EngineException);
+}
+
+TEST(SqlCostEstimatorTest, Selectivity) {
+    std::shared_ptr<LocalStatisticsCatalog> catalog = makeCatalog();
+    SqlCostEstimator estimator(catalog);
+    std::shared_ptr<TableStatistics> t1 = catalog->getTableStatistics("t1");
+
+    EXPECT_DOUBLE_EQ(estimator.selectivity("a = 3", t1), 0.01);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("3 = a", t1), 0.01);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("a > 750", t1), 0.25);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("250 > a", t1), 0.25);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("a between 100 and 300", t1), 0.2);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("a in (1, 2, 3)", t1), 0.03);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("speed is null", t1), 0.2);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("a > 750 and a = 3", t1), 0.0025);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("(a = 3 or a = 4)", t1), 1 - 0.99 * 0.99);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("not a > 750", t1), 0.75);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("false", t1), 0);
+
+    // defaults apply without statistics
+    EXPECT_DOUBLE_EQ(estimator.selectivity("b = 3", t1), SqlCostEstimator::DEFAULT_EQUALITY_SELECTIVITY);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("b > 3", nullptr), SqlCostEstimator::DEFAULT_RANGE_SELECTIVITY);
+    EXPECT_DOUBLE_EQ(estimator.selectivity("b like 'x%'", nullptr), SqlCostEstimator::DEFAULT_SELECTIVITY);
+}
+
+TEST(SqlCostEstimatorTest, Explain) {
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    planner.setStatisticsCatalog(makeCatalog());
+
+    std::shared_ptr<SqlPlan> plan = planner.plan(parser.parse("SELECT a, sum(speed) as s FROM t1 WHERE a > 750 GROUP BY a"));
+    ASSERT_EQ(plan->getPlan().size(), 3);
+    ASSERT_EQ(plan->getEstimates().size(), 3);
+    EXPECT_DOUBLE_EQ(plan->getEstimates()[0].getRows(), 100000);
+    EXPECT_DOUBLE_EQ(plan->getEstimates()[1].getRows(), 25000);
+    EXPECT_DOUBLE_EQ(plan->getEstimates()[2].getRows(), 100);
+
+    std::vector<std::string> lines = plan->explain();
+    ASSERT_EQ(lines.size(), 3);
+    EXPECT_EQ(lines[0], "Input?id=d_0,output=s_0(name=`t1`) [rows=100000, width=32, cost=100000]");
+    EXPECT_EQ(lines[1], "Filter?id=d_1,input=s_0,output=s_1(condition=`a > 750`) [rows=25000, width=32, cost=200000]");
+    EXPECT_EQ(lines[2], "GroupBy?id=d_2,input=s_1,output=s_2(keys=`a`,selects=`a, sum(speed) as s`) [rows=100, width=16, cost=250000]");
+
+    plan = planner.plan(parser.parse("SELECT t.a, m.a FROM t1 t JOIN models m ON t.a = m.a"));
+    ASSERT_EQ(plan->getEstimates().size(), 3);
+    EXPECT_DOUBLE_EQ(plan->getEstimates()[1].getRows(), 50);
+    EXPECT_DOUBLE_EQ(plan->getEstimates()[2].getRows(), 100000 * 50 / 100.0);
+
+    // a global aggregate is one row whatever its input, even a filter that removes every row
+    plan = planner.plan(parser.parse("SELECT count(*) as n, sum(speed) as s FROM t1 WHERE a > 750"));
+    ASSERT_EQ(plan->getEstimates().size(), 3);
+    EXPECT_DOUBLE_EQ(plan->getEstimates()[1].getRows(), 25000);
+    EXPECT_DOUBLE_EQ(plan->getEstimates()[2].getRows(), 1);
+    plan = planner.plan(parser.parse("SELECT count(*) as n FROM t1 WHERE 1 = 0"));
+    EXPECT_DOUBLE_EQ(plan->getEstimates().back().getRows(), 1);
+    plan = planner.plan(parser.parse("SELECT a + 1 as b FROM t1 WHERE a > 750"));
+    EXPECT_DOUBLE_EQ(plan->getEstimates().back().getRows(), 25000);
+
+    // tables without statistics use the default row count
+    plan = SqlQueryPlanner().plan(parser.parse("SELECT * FROM t9 LIMIT 10"));
+    ASSERT_EQ(plan->getEstimates().size(), 1);
+    EXPECT_DOUBLE_EQ(plan->getEstimates()[0].getRows(), SqlCostEstimator::DEFAULT_ROW_COUNT);
+}
+
+TEST(SqlCostEstimatorTest, BroadcastJoin) {
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    planner.setStatisticsCatalog(makeCatalog());
+
+    // the build side (models, 50 rows) fits in the default budget
+    std::shared_ptr<SqlPlan> plan = planner.plan(parser.parse("SELECT t.a, m.a FROM t1 t JOIN models m ON t.a = m.a"));
+    ASSERT_EQ(plan->getPlan().size(), 3);
+    EXPECT_EQ(plan->getPlan()[2], "BroadcastHashJoin?id=d_2,input=s_0,input2=s_1,output=s_2(join_type=`inner`,left_alias=`t`,lefts=`a`,right_alias=`m`,rights=`a`,selects=`t.a, m.a`)");
+
+    plan = planner.plan(parser.parse("SELECT t.a, m.a FROM t1 t LEFT JOIN models m ON t.a = m.a"));
+    EXPECT_EQ(plan->getPlan()[2].rfind("BroadcastHashJoin?", 0), 0);
+
+    // a right join keeps every build-side row, so it is never broadcast
+    plan = planner.plan(parser.parse("SELECT t.a, m.a FROM t1 t RIGHT JOIN models m ON t.a = m.a"));
+    EXPECT_EQ(plan->getPlan()[2].rfind("ReduceJoin?", 0), 0);
+
+    // the build side exceeds the budget
+    planner.setBroadcastBudget(1024);
+    plan = planner.plan(parser.parse("SELECT m.a, t.a FROM models m JOIN t1 t ON m.a = t.a"));
+    EXPECT_EQ(plan->getPlan()[2].rfind("ReduceJoin?", 0), 0);
+    plan = planner.plan(parser.parse("SELECT t.a, m.a FROM t1 t JOIN models m ON t.a = m.a"));
+    EXPECT_EQ(plan->getPlan()[2].rfind("BroadcastHashJoin?", 0), 0);
+
+    // without statistics the size is unknown, unless a hint names the relation
+    plan = planner.plan(parser.parse("SELECT t.a, u.a FROM t1 t JOIN t9 u ON t.a = u.a"));
+    EXPECT_EQ(plan->getPlan()[2].rfind("ReduceJoin?", 0), 0);
+    planner.addBroadcastHint("t9");
+    plan = planner.plan(parser.parse("SELECT t.a, u.a FROM t1 t JOIN t9 u ON t.a = u.a"));
+    EXPECT_EQ(plan->getPlan()[2].rfind("BroadcastHashJoin?", 0), 0);
+
+    // broadcasting skips the shuffle of both inputs
+    SqlQueryPlanner reduce;
+    reduce.setStatisticsCatalog(makeCatalog());
+    EXPECT_LT(plan->getEstimates()[2].getCost(),
+              reduce.plan(parser.parse("SELECT t.a, u.a FROM t1 t JOIN t9 u ON t.a = u.a"))->getEstimates()[2].getCost());
+
+    SqlDistributedPlanner distributed;
+    distributed.setStatisticsCatalog(makeCatalog());
+    distributed.addBroadcastHint("m");
+    std::shared_ptr<SqlDistributedPlan> dplan = distributed.plan(parser.parse("SELECT t.a, m.a FROM t9 t JOIN t8 m ON t.a = m.a"));
+    ASSERT_EQ(dplan->getEdgePlan().size(), 3);
+    EXPECT_EQ(dplan->getEdgePlan()[2].rfind("BroadcastHashJoin?", 0), 0);
+}
+
+TEST(SqlCostEstimatorTest, ResidualJoin) {
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    planner.setStatisticsCatalog(makeCatalog());
+    planner.setBroadcastBudget(0);
+
+    // hashing on the equi key is linear, the nested loop would compare every pair
+    std::shared_ptr<SqlPlan> keyed = planner.plan(parser.parse("SELECT o.id FROM orders o JOIN customers c ON o.customer = c.id and o.ts > c.ts"));
+    std::shared_ptr<SqlPlan> nested = planner.plan(parser.parse("SELECT o.id FROM orders o JOIN customers c ON o.customer > c.id and o.ts > c.ts"));
+    ASSERT_EQ(keyed->getPlan().size(), 3);
+    EXPECT_EQ(keyed->getPlan()[2].rfind("ReduceJoin?", 0), 0);
+    EXPECT_EQ(nested->getPlan()[2].rfind("NestedJoin?", 0), 0);
+    EXPECT_LT(keyed->getEstimates()[2].getCost() * 1000, nested->getEstimates()[2].getCost());
+
+    // a band is merged instead of compared pair by pair
+    std::shared_ptr<SqlPlan> band = planner.plan(parser.parse("SELECT o.id FROM orders o JOIN customers c ON o.customer > c.id and c.ts between o.ts - 10 and o.ts + 10"));
+    EXPECT_EQ(band->getPlan()[2].rfind("IntervalJoin?", 0), 0);
+    EXPECT_LT(band->getEstimates()[2].getCost(), nested->getEstimates()[2].getCost());
+
+    // the residual further reduces the matched pairs
+    std::shared_ptr<SqlPlan> equi = planner.plan(parser.parse("SELECT o.id FROM orders o JOIN customers c ON o.customer = c.id"));
+    EXPECT_LT(keyed->getEstimates()[2].getRows(), equi->getEstimates()[2].getRows());
+}
+
+TEST(SqlCostEstimatorTest, JoinOrder) {
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    planner.setStatisticsCatalog(makeCatalog());
+
+    // customers x regions stays at 50000 rows, joining orders first would produce 1000000
+    std::shared_ptr<SqlPlan> plan = planner.plan(parser.parse(
+        "SELECT o.id, c.name, r.name FROM orders o JOIN customers c ON o.customer = c.id JOIN regions r ON c.region = r.id"));
+    ASSERT_EQ(plan->getPlan().size(), 5);
+    EXPECT_EQ(plan->getPlan()[3], "BroadcastHashJoin?id=d_3,input=s_1,input2=s_2,output=s_3(join_type=`inner`,left_alias=`c`,lefts=`region`,right_alias=`r`,rights=`id`,selects=`*`)");
+    EXPECT_EQ(plan->getPlan()[4], "ReduceJoin?id=d_4,input=s_3,input2=s_0,output=s_4(join_type=`inner`,left_alias=`c,r`,lefts=`c.id`,right_alias=`o`,rights=`customer`,selects=`o.id, c.name, r.name`)");
+    EXPECT_DOUBLE_EQ(plan->getEstimates()[3].getRows(), 50000);
+    EXPECT_DOUBLE_EQ(plan->getEstimates()[4].getRows(), 1000000);
+
+    // left joins are never reordered
+    plan = planner.plan(parser.parse(
+        "SELECT o.id FROM orders o LEFT JOIN customers c ON o.customer = c.id JOIN regions r ON c.region = r.id"));
+    ASSERT_EQ(plan->getPlan().size(), 5);
+    EXPECT_EQ(plan->getPlan()[3].rfind("BroadcastHashJoin?id=d_3,input=s_0,input2=s_1,", 0), 0);
+}
+
+TEST(SqlCostEstimatorTest, BloomFilter) {
+    SqlQueryParser parser;
+    SqlDistributedPlanner planner;
+    planner.setStatisticsCatalog(makeCatalog());
+    planner.setBroadcastBudget(0);
+
+    // the aggregated build side lands on the cloud, so the probe side is filtered on the edge before upload
+    const std::string sql = "SELECT o.id, c.n FROM orders o JOIN (SELECT id, count(*) as n FROM customers WHERE region = 3 GROUP BY id) c ON o.customer = c.id";
+    std::shared_ptr<SqlDistributedPlan> plan = planner.plan(parser.parse(sql));
+    ASSERT_EQ(plan->getEdgePlan().size(), 5);
+    ASSERT_EQ(plan->getCloudPlan().size(), 3);
+    EXPECT_EQ(plan->getEdgePlan()[4], "BloomFilter?id=d_6,input=s_0,output=s_6(bloom=`s_5`,keys=`customer`)");
+    EXPECT_EQ(plan->getCloudPlan()[1], "BloomBuild?id=d_5,input=s_4,output=s_5(bits=`47926`,fpp=`0.01`,hashes=`7`,items=`5000`,keys=`id`)");
+    EXPECT_EQ(plan->getCloudPlan()[2].rfind("ReduceJoin?id=d_7,input=s_6,input2=s_4,", 0), 0);
+
+    // 5000 of 50000 customers match, the rest pass at the false positive rate
+    EXPECT_DOUBLE_EQ(plan->getEdgeEstimates()[4].getRows(), 1000000 * (0.1 + 0.9 * 0.01));
+    EXPECT_DOUBLE_EQ(plan->getCloudEstimates()[1].getBytes(), 5991);
+
+    // a lower rate costs a larger filter
+    planner.setBloomFalsePositiveRate(0.001);
+    plan = planner.plan(parser.parse(sql));
+    EXPECT_EQ(plan->getCloudPlan()[1], "BloomBuild?id=d_5,input=s_4,output=s_5(bits=`71888`,fpp=`0.001`,hashes=`10`,items=`5000`,keys=`id`)");
+
+    planner.setBloomFalsePositiveRate(0);
+    plan = planner.plan(parser.parse(sql));
+    EXPECT_EQ(plan->getEdgePlan().size(), 4);
+    EXPECT_EQ(plan->getCloudPlan().size(), 2);
+    planner.setBloomFalsePositiveRate(SqlCostEstimator::DEFAULT_BLOOM_FALSE_POSITIVE_RATE);
+
+    // unmatched rows of a left join are still emitted
+    plan = planner.plan(parser.parse("SELECT o.id, c.n FROM orders o LEFT JOIN (SELECT id, count(*) as n FROM customers WHERE region = 3 GROUP BY id) c ON o.customer = c.id"));
+    EXPECT_EQ(plan->getEdgePlan().size(), 4);
+
+    // every order has a customer, the filter would not remove anything
+    plan = planner.plan(parser.parse("SELECT o.id, count(*) FROM orders o JOIN customers c ON o.customer = c.id GROUP BY o.id"));
+    EXPECT_EQ(plan->getEdgePlan().size(), 2);
+    EXPECT_EQ(plan->getCloudPlan()[0].rfind("ReduceJoin?", 0), 0);
+
+    EXPECT_DOUBLE_EQ(SqlCostEstimator::bloomBits(1000, 0.01), 9586);
+    EXPECT_EQ(SqlCostEstimator::bloomHashes(9586, 1000), 7);
+}
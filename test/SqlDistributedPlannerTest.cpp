@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
+#include <set>
 #include "../include/SqlQueryParser.h"
 #include "../include/SqlDistributedPlanner.h"
 #include "../include/SqlDistributedPlan.h"
 #include "../include/SqlStatement.h"
+#include "../include/SqlTierProfile.h"
+#include "../include/SqlCostEstimator.h"
+#include "../include/LocalStatisticsCatalog.h"
 
 // ========== EdgePlanBasics ==========
 TEST(SqlDistributedPlannerTest, EdgePlanBasics) {
@@ -32,22 +36,31 @@ TEST(SqlDistributedPlannerTest, CloudPlanBasics) {
 
     auto stmt = parser->parse("SELECT a, sum(b), max(c) from t1 where a > 5 group by a");
     auto plan = planner->plan(stmt);
-    EXPECT_EQ(plan->getEdgePlan().size(), 2);
+    EXPECT_EQ(plan->getEdgePlan().size(), 3);
     EXPECT_EQ(plan->getCloudPlan().size(), 1);
     EXPECT_EQ(plan->getEdgePlan()[0], "Input?id=d_0,output=s_0(name=`t1`)");
     EXPECT_EQ(plan->getEdgePlan()[1], "Filter?id=d_1,input=s_0,output=s_1(condition=`a > 5`)");
+    EXPECT_EQ(plan->getEdgePlan()[2],
+              "PartialGroupBy?id=d_2,input=s_1,output=s_2(keys=`a`,selects=`a, sum(b) as partial_0, max(c) as partial_1`)");
     EXPECT_EQ(plan->getCloudPlan()[0],
-              "GroupBy?id=d_2,input=s_1,output=s_2(keys=`a`,selects=`a, sum(b), max(c)`)");
+              "FinalGroupBy?id=d_3,input=s_2,output=s_3(keys=`a`,selects=`a, sum(b), max(c)`,states=`sum(b) as partial_0, max(c) as partial_1`)");
 
     stmt = parser->parse("SELECT a, sum(b) as b, max(c) from t1 group by a having b > 3");
     plan = planner->plan(stmt);
-    EXPECT_EQ(plan->getEdgePlan().size(), 1);
+    EXPECT_EQ(plan->getEdgePlan().size(), 2);
     EXPECT_EQ(plan->getCloudPlan().size(), 2);
     EXPECT_EQ(plan->getEdgePlan()[0], "Input?id=d_0,output=s_0(name=`t1`)");
     EXPECT_EQ(plan->getCloudPlan()[0],
-              "GroupBy?id=d_1,input=s_0,output=s_1(keys=`a`,selects=`a, sum(b) as b, max(c)`)");
+              "FinalGroupBy?id=d_2,input=s_1,output=s_2(keys=`a`,selects=`a, sum(b) as b, max(c)`,states=`sum(b) as partial_0, max(c) as partial_1`)");
     EXPECT_EQ(plan->getCloudPlan()[1],
-              "Filter?id=d_2,input=s_1,output=s_2(condition=`b > 3`)");
+              "Filter?id=d_3,input=s_2,output=s_3(condition=`b > 3`)");
+
+    // aggregates without a mergeable partial state run on the cloud in one step
+    stmt = parser->parse("SELECT a, count(distinct b) from t1 group by a");
+    plan = planner->plan(stmt);
+    EXPECT_EQ(plan->getEdgePlan().size(), 1);
+    EXPECT_EQ(plan->getCloudPlan()[0],
+              "GroupBy?id=d_1,input=s_0,output=s_1(keys=`a`,selects=`a, count(distinct b)`)");
 }
 
 
@@ -78,11 +91,10 @@ TEST(SqlDistributedPlannerTest, EdgeSubquery) {
 
     auto stmt = parser->parse("select a, b " "from  (select a, b, c from t1) t");
     auto plan = planner->plan(stmt);
-    EXPECT_EQ(plan->getEdgePlan().size(), 3);
+    EXPECT_EQ(plan->getEdgePlan().size(), 2);
     EXPECT_EQ(plan->getCloudPlan().size(), 0);
     EXPECT_EQ(plan->getEdgePlan().at(0), "Input?id=d_0,output=s_0(name=`t1`)");
-    EXPECT_EQ(plan->getEdgePlan().at(1), "Project?id=d_1,input=s_0,output=s_1(selects=`a, b, c`)");
-    EXPECT_EQ(plan->getEdgePlan().at(2), "Project?id=d_2,input=s_1,output=s_2(selects=`a, b`)");
+    EXPECT_EQ(plan->getEdgePlan().at(1), "Project?id=d_1,input=s_0,output=s_1(selects=`a, b`)");
 
     stmt = parser->parse("select a, b, c from  (select a, b, c from t1) t");
     plan = planner->plan(stmt);
@@ -93,12 +105,10 @@ TEST(SqlDistributedPlannerTest, EdgeSubquery) {
 
     stmt = parser->parse("select a, b from  (select a, b, c from t1) t limit 1000");
     plan = planner->plan(stmt);
-    EXPECT_EQ(plan->getEdgePlan().size(), 4);
+    EXPECT_EQ(plan->getEdgePlan().size(), 2);
     EXPECT_EQ(plan->getCloudPlan().size(), 0);
-    EXPECT_EQ(plan->getEdgePlan().at(0), "Input?id=d_0,output=s_0(name=`t1`)");
-    EXPECT_EQ(plan->getEdgePlan().at(1), "Project?id=d_1,input=s_0,output=s_1(selects=`a, b, c`)");
-    EXPECT_EQ(plan->getEdgePlan().at(2), "Project?id=d_2,input=s_1,output=s_2(selects=`a, b`)");
-    EXPECT_EQ(plan->getEdgePlan().at(3), "Take?id=d_3,input=s_2,output=s_3(rows=`1000`)");
+    EXPECT_EQ(plan->getEdgePlan().at(0), "Input?id=d_0,output=s_0(limit_count=`1000`,max_num_readers=`1`,name=`t1`)");
+    EXPECT_EQ(plan->getEdgePlan().at(1), "Project?id=d_1,input=s_0,output=s_1(selects=`a, b`)");
 
     stmt = parser->parse(
         "SELECT time, sig FROM (SELECT time, ::lst_sig -> sig as lst_sig, sig FROM t1 WHERE sig != null)"
@@ -115,13 +125,12 @@ TEST(SqlDistributedPlannerTest, EdgeSubquery) {
     stmt = parser->parse(
         "INSERT INTO t2 SELECT a, b, c FROM  (select a, b, c, d from t1) t WHERE d == 'k' and c > 3");
     plan = planner->plan(stmt);
-    EXPECT_EQ(plan->getEdgePlan().size(), 5);
+    EXPECT_EQ(plan->getEdgePlan().size(), 4);
     EXPECT_EQ(plan->getCloudPlan().size(), 0);
     EXPECT_EQ(plan->getEdgePlan().at(0), "Input?id=d_0,output=s_0(name=`t1`)");
-    EXPECT_EQ(plan->getEdgePlan().at(1), "Project?id=d_1,input=s_0,output=s_1(selects=`a, b, c, d`)");
-    EXPECT_EQ(plan->getEdgePlan().at(2), "Filter?id=d_2,input=s_1,output=s_2(condition=`d == 'k' and c > 3`)");
-    EXPECT_EQ(plan->getEdgePlan().at(3), "Project?id=d_3,input=s_2,output=s_3(selects=`a, b, c`)");
-    EXPECT_EQ(plan->getEdgePlan().at(4), "Output?id=d_4,input=s_3(name=`t2`)");
+    EXPECT_EQ(plan->getEdgePlan().at(1), "Filter?id=d_1,input=s_0,output=s_1(condition=`d == 'k' and c > 3`)");
+    EXPECT_EQ(plan->getEdgePlan().at(2), "Project?id=d_2,input=s_1,output=s_2(selects=`a, b, c`)");
+    EXPECT_EQ(plan->getEdgePlan().at(3), "Output?id=d_3,input=s_2(name=`t2`)");
 }
 
 TEST(SqlDistributedPlannerTest, CloudSubquery) {
@@ -131,15 +140,14 @@ TEST(SqlDistributedPlannerTest, CloudSubquery) {
         "SELECT a, sum(b) as b INTO t2 FROM (select a, b, c from t1 where b > 5) t "
         "WHERE a = 4 GROUP BY a HAVING b > 100");
     auto plan = planner->plan(stmt);
-    EXPECT_EQ(plan->getEdgePlan().size(), 4);
+    EXPECT_EQ(plan->getEdgePlan().size(), 3);
     EXPECT_EQ(plan->getCloudPlan().size(), 3);
     EXPECT_EQ(plan->getEdgePlan().at(0), "Input?id=d_0,output=s_0(name=`t1`)");
-    EXPECT_EQ(plan->getEdgePlan().at(1), "Filter?id=d_1,input=s_0,output=s_1(condition=`b > 5`)");
-    EXPECT_EQ(plan->getEdgePlan().at(2), "Project?id=d_2,input=s_1,output=s_2(selects=`a, b, c`)");
-    EXPECT_EQ(plan->getEdgePlan().at(3), "Filter?id=d_3,input=s_2,output=s_3(condition=`a = 4`)");
-    EXPECT_EQ(plan->getCloudPlan().at(0), "GroupBy?id=d_4,input=s_3,output=s_4(keys=`a`,selects=`a, sum(b) as b`)");
-    EXPECT_EQ(plan->getCloudPlan().at(1), "Filter?id=d_5,input=s_4,output=s_5(condition=`b > 100`)");
-    EXPECT_EQ(plan->getCloudPlan().at(2), "Output?id=d_6,input=s_5(name=`t2`)");
+    EXPECT_EQ(plan->getEdgePlan().at(1), "Filter?id=d_1,input=s_0,output=s_1(condition=`b > 5 and a = 4`)");
+    EXPECT_EQ(plan->getEdgePlan().at(2), "PartialGroupBy?id=d_2,input=s_1,output=s_2(keys=`a`,selects=`a, sum(b) as partial_0`)");
+    EXPECT_EQ(plan->getCloudPlan().at(0), "FinalGroupBy?id=d_3,input=s_2,output=s_3(keys=`a`,selects=`a, sum(b) as b`,states=`sum(b) as partial_0`)");
+    EXPECT_EQ(plan->getCloudPlan().at(1), "Filter?id=d_4,input=s_3,output=s_4(condition=`b > 100`)");
+    EXPECT_EQ(plan->getCloudPlan().at(2), "Output?id=d_5,input=s_4(name=`t2`)");
 }
 
 TEST(SqlDistributedPlannerTest, EdgeWindow) {
@@ -152,7 +160,7 @@ TEST(SqlDistributedPlannerTest, EdgeWindow) {
     EXPECT_EQ(plan->getEdgePlan().size(), 2);
     EXPECT_EQ(plan->getCloudPlan().size(), 0);
     EXPECT_EQ(plan->getEdgePlan().at(0), "Input?id=d_0,output=s_0(name=`t`)");
-    EXPECT_EQ(plan->getEdgePlan().at(1), "SlidingWindow?id=d_1,input=s_0,output=s_1(inclusion=`20`,selects=`time, wsum('b') as b`,validity=`wsize() == 20`)");
+    EXPECT_EQ(plan->getEdgePlan().at(1), "SlidingWindow?id=d_1,input=s_0,output=s_1(aggregations=`wsum('b'):subtract`,inclusion=`20`,selects=`time, wsum('b') as b`,validity=`wsize() == 20`)");
 
     stmt = parser->parse(
         "SELECT time, wsum('b') as b from t WINDOW OVER (TUMBLING ON time - wlead('time') < 10000 HAVING wsize() > 10 )");
@@ -215,3 +223,269 @@ TEST(SqlDistributedPlannerTest, EdgeLimitOptimization) {
     EXPECT_EQ(plan->getCloudPlan().size(), 0);
     EXPECT_EQ(plan->getEdgePlan().at(0), "Input?id=d_0,output=s_0(limit_count=`200`,max_num_readers=`1`,name=`t1`)");
 }
+
+// ========== CommonSubexpression ==========
+TEST(SqlDistributedPlannerTest, CommonSubexpression) {
+    std::shared_ptr<SqlQueryParser> parser = std::make_shared<SqlQueryParser>();
+    std::shared_ptr<SqlDistributedPlanner> planner = std::make_shared<SqlDistributedPlanner>();
+
+    auto stmt = parser->parse("SELECT a, max(abs(b)) as m FROM t1 WHERE abs(b) > 1 GROUP BY a");
+    auto plan = planner->plan(stmt);
+    EXPECT_EQ(plan->getEdgePlan().size(), 4);
+    EXPECT_EQ(plan->getCloudPlan().size(), 1);
+    EXPECT_EQ(plan->getEdgePlan().at(1), "Project?id=d_1,input=s_0,output=s_1(selects=`*, abs(b) as cse_0`)");
+    EXPECT_EQ(plan->getEdgePlan().at(2), "Filter?id=d_2,input=s_1,output=s_2(condition=`cse_0 > 1`)");
+    EXPECT_EQ(plan->getEdgePlan().at(3), "PartialGroupBy?id=d_3,input=s_2,output=s_3(keys=`a`,selects=`a, max(cse_0) as partial_0`)");
+    EXPECT_EQ(plan->getCloudPlan().at(0), "FinalGroupBy?id=d_4,input=s_3,output=s_4(keys=`a`,selects=`a, max(cse_0) as m`,states=`max(cse_0) as partial_0`)");
+    ASSERT_EQ(plan->getDiagnostics().size(), 1);
+    EXPECT_EQ(plan->getDiagnostics().at(0), "cse_eliminated_evaluations=1");
+}
+
+// ========== MultiwayJoin ==========
+TEST(SqlDistributedPlannerTest, MultiwayJoin) {
+    std::shared_ptr<SqlQueryParser> parser = std::make_shared<SqlQueryParser>();
+    std::shared_ptr<SqlDistributedPlanner> planner = std::make_shared<SqlDistributedPlanner>();
+
+    auto stmt = parser->parse("SELECT s.a, t.b, u.c from s JOIN t ON s.a = t.a JOIN u ON t.b = u.b");
+    auto plan = planner->plan(stmt);
+    ASSERT_EQ(plan->getEdgePlan().size() + plan->getCloudPlan().size(), 5);
+    std::vector<std::string> steps = plan->getEdgePlan();
+    steps.insert(steps.end(), plan->getCloudPlan().begin(), plan->getCloudPlan().end());
+    EXPECT_EQ(steps.at(3), "ReduceJoin?id=d_3,input=s_0,input2=s_1,output=s_3(join_type=`inner`,left_alias=`s`,lefts=`a`,right_alias=`t`,rights=`a`,selects=`*`)");
+    EXPECT_EQ(steps.at(4), "ReduceJoin?id=d_4,input=s_3,input2=s_2,output=s_4(join_type=`inner`,left_alias=`s,t`,lefts=`t.b`,right_alias=`u`,rights=`b`,selects=`s.a, t.b, u.c`)");
+}
+
+TEST(SqlDistributedPlannerTest, JoinPredicatePushdown) {
+    std::shared_ptr<SqlQueryParser> parser = std::make_shared<SqlQueryParser>();
+    std::shared_ptr<SqlDistributedPlanner> planner = std::make_shared<SqlDistributedPlanner>();
+
+    auto stmt = parser->parse("SELECT s.a, t.b from s JOIN t ON s.a = t.a where s.b > 1 and s.d + t.d > 3");
+    auto plan = planner->plan(stmt);
+    std::vector<std::string> steps = plan->getEdgePlan();
+    steps.insert(steps.end(), plan->getCloudPlan().begin(), plan->getCloudPlan().end());
+    ASSERT_EQ(steps.size(), 6);
+    EXPECT_EQ(steps.at(1), "Filter?id=d_1,input=s_0,output=s_1(condition=`b > 1`)");
+    EXPECT_EQ(steps.at(3), "ReduceJoin?id=d_3,input=s_1,input2=s_2,output=s_3(join_type=`inner`,left_alias=`s`,lefts=`a`,right_alias=`t`,rights=`a`,selects=`*`)");
+    EXPECT_EQ(steps.at(4), "Filter?id=d_4,input=s_3,output=s_4(condition=`s.d + t.d > 3`)");
+    EXPECT_EQ(steps.at(5), "Project?id=d_5,input=s_4,output=s_5(selects=`s.a, t.b`)");
+}
+
+// ========== TwoPhaseAggregate ==========
+TEST(SqlDistributedPlannerTest, TwoPhaseAggregate) {
+    std::shared_ptr<SqlQueryParser> parser = std::make_shared<SqlQueryParser>();
+    std::shared_ptr<SqlDistributedPlanner> planner = std::make_shared<SqlDistributedPlanner>();
+
+    // avg is carried as sum and count, shared with the other aggregates on the same argument
+    auto plan = planner->plan(parser->parse("SELECT a, avg(b) as m, sum(b) as s, count(*) as n FROM t1 GROUP BY a"));
+    ASSERT_EQ(plan->getEdgePlan().size(), 2);
+    ASSERT_EQ(plan->getCloudPlan().size(), 1);
+    EXPECT_EQ(plan->getEdgePlan().at(1),
+              "PartialGroupBy?id=d_1,input=s_0,output=s_1(keys=`a`,selects=`a, sum(b) as partial_0, count(b) as partial_1, count(*) as partial_2`)");
+    EXPECT_EQ(plan->getCloudPlan().at(0),
+              "FinalGroupBy?id=d_2,input=s_1,output=s_2(keys=`a`,selects=`a, avg(b) as m, sum(b) as s, count(*) as n`,"
+              "states=`sum(b) as partial_0, count(b) as partial_1, count(*) as partial_2`)");
+
+    // state names avoid columns of the query
+    plan = planner->plan(parser->parse("SELECT a, sum(partial_0) as s FROM t1 GROUP BY a"));
+    EXPECT_EQ(plan->getEdgePlan().at(1), "PartialGroupBy?id=d_1,input=s_0,output=s_1(keys=`a`,selects=`a, sum(partial_0) as partial_1`)");
+
+    // computed keys, other aggregates and nested aggregates are not split
+    for(const std::string& sql : {"SELECT a + 1 as k, sum(b) as s FROM t1 GROUP BY a + 1",
+                                  "SELECT a, median(b) as m FROM t1 GROUP BY a",
+                                  "SELECT a, sum(max(b)) as m FROM t1 GROUP BY a"}){
+        plan = planner->plan(parser->parse(sql));
+        ASSERT_EQ(plan->getCloudPlan().size(), 1) << sql;
+        EXPECT_EQ(plan->getCloudPlan().at(0).rfind("GroupBy?", 0), 0) << sql;
+    }
+
+    // after a cloud join the input is already uploaded
+    plan = planner->plan(parser->parse("SELECT o.id, count(*) as n FROM orders o JOIN customers c ON o.customer = c.id GROUP BY o.id"));
+    EXPECT_EQ(plan->getCloudPlan().back().rfind("GroupBy?", 0), 0);
+}
+
+// ========== TwoPhaseStreamAggregate ==========
+TEST(SqlDistributedPlannerTest, TwoPhaseStreamAggregate) {
+    std::shared_ptr<SqlQueryParser> parser = std::make_shared<SqlQueryParser>();
+    std::shared_ptr<SqlDistributedPlanner> planner = std::make_shared<SqlDistributedPlanner>();
+
+    // every device uploads one row of partial states per bucket, the cloud merges the buckets of all devices
+    auto plan = planner->plan(parser->parse("SELECT sum(b) as s, avg(c) as m FROM t1 WHERE a > 5 INTERVAL BY st EVERY 30 SECOND HAVING m > 10"));
+    ASSERT_EQ(plan->getEdgePlan().size(), 3);
+    ASSERT_EQ(plan->getCloudPlan().size(), 2);
+    EXPECT_EQ(plan->getEdgePlan().at(2),
+              "PartialStreamAggregate?id=d_2,input=s_1,output=s_2(interval=`30`,selects=`sum(b) as partial_0, sum(c) as partial_1, count(c) as partial_2`,time=`st`,time_unit=`second`)");
+    EXPECT_EQ(plan->getCloudPlan().at(0),
+              "FinalStreamAggregate?id=d_3,input=s_2,output=s_3(interval=`30`,selects=`sum(b) as s, avg(c) as m`,"
+              "states=`sum(b) as partial_0, sum(c) as partial_1, count(c) as partial_2`,time=`st`,time_unit=`second`)");
+    EXPECT_EQ(plan->getCloudPlan().at(1), "Filter?id=d_4,input=s_3,output=s_4(condition=`m > 10`)");
+
+    // a plain column has no partial state, the whole aggregate stays on the edge
+    plan = planner->plan(parser->parse("SELECT a, sum(b) as s FROM t1 INTERVAL BY st EVERY 30 SECOND"));
+    EXPECT_EQ(plan->getCloudPlan().size(), 0);
+    EXPECT_EQ(plan->getEdgePlan().at(1).rfind("StreamAggregate?", 0), 0);
+
+    plan = planner->plan(parser->parse("SELECT median(b) as m FROM t1 INTERVAL BY st EVERY 30 SECOND"));
+    EXPECT_EQ(plan->getCloudPlan().size(), 0);
+}
+
+// ========== MultiTier ==========
+TEST(SqlDistributedPlannerTest, MultiTier) {
+    std::shared_ptr<SqlQueryParser> parser = std::make_shared<SqlQueryParser>();
+    std::shared_ptr<SqlDistributedPlanner> planner = std::make_shared<SqlDistributedPlanner>();
+    SqlTierProfile ecu("ecu", 64 * 1024, SqlCpuClass::LOW);
+    SqlTierProfile gateway("gateway", 64 * 1024 * 1024, SqlCpuClass::MEDIUM);
+    SqlTierProfile cloud("cloud", -1, SqlCpuClass::HIGH);
+    planner->setTiers({ecu, gateway, cloud});
+
+    // the ECU only filters, the hash aggregation needs the gateway
+    auto plan = planner->plan(parser->parse("SELECT a, sum(b) as s FROM t1 WHERE a > 5 GROUP BY a"));
+    ASSERT_EQ(plan->getTiers(), std::vector<std::string>({"ecu", "gateway", "cloud"}));
+    ASSERT_EQ(plan->getTierPlans().size(), 3);
+    EXPECT_EQ(plan->getTierPlans().at(0), std::vector<std::string>({
+        "Input?id=d_0,output=s_0(name=`t1`)",
+        "Filter?id=d_1,input=s_0,output=s_1(condition=`a > 5`)",
+        "Exchange?id=d_4,input=s_1,output=s_4(from=`ecu`,to=`gateway`)"}));
+    EXPECT_EQ(plan->getTierPlans().at(1), std::vector<std::string>({
+        "PartialGroupBy?id=d_2,input=s_4,output=s_2(keys=`a`,selects=`a, sum(b) as partial_0`)",
+        "Exchange?id=d_5,input=s_2,output=s_5(from=`gateway`,to=`cloud`)"}));
+    EXPECT_EQ(plan->getTierPlans().at(2), std::vector<std::string>({
+        "FinalGroupBy?id=d_3,input=s_5,output=s_3(keys=`a`,selects=`a, sum(b) as s`,states=`sum(b) as partial_0`)"}));
+    EXPECT_EQ(plan->getEdgePlan(), plan->getTierPlans().front());
+    EXPECT_EQ(plan->getCloudPlan(), plan->getTierPlans().back());
+    EXPECT_EQ(plan->getTierEstimates().at(1).size(), 2);
+    EXPECT_EQ(plan->explain().at(3).rfind("gateway: PartialGroupBy?", 0), 0);
+
+    // the aggregation fits a capable ECU, the data still passes every tier on its way up
+    ecu.setCpuClass(SqlCpuClass::MEDIUM);
+    ecu.setMemoryBudget(-1);
+    planner->setTiers({ecu, gateway, cloud});
+    plan = planner->plan(parser->parse("SELECT a, sum(b) as s FROM t1 GROUP BY a"));
+    ASSERT_EQ(plan->getTierPlans().at(0).size(), 3);
+    EXPECT_EQ(plan->getTierPlans().at(0).at(2), "Exchange?id=d_3,input=s_1,output=s_3(from=`ecu`,to=`gateway`)");
+    EXPECT_EQ(plan->getTierPlans().at(1), std::vector<std::string>({"Exchange?id=d_4,input=s_3,output=s_4(from=`gateway`,to=`cloud`)"}));
+    EXPECT_EQ(plan->getTierPlans().at(2).at(0).rfind("FinalGroupBy?id=d_2,input=s_4,", 0), 0);
+
+    // an operator missing from the gateway profile moves on to the cloud
+    gateway.addOperator("Filter");
+    ecu.setCpuClass(SqlCpuClass::LOW);
+    planner->setTiers({ecu, gateway, cloud});
+    plan = planner->plan(parser->parse("SELECT a, sum(b) as s FROM t1 GROUP BY a"));
+    EXPECT_EQ(plan->getTierPlans().at(0).size(), 2);
+    EXPECT_EQ(plan->getTierPlans().at(1).size(), 1);
+    ASSERT_EQ(plan->getTierPlans().at(2).size(), 2);
+    EXPECT_EQ(plan->getTierPlans().at(2).at(0), "PartialGroupBy?id=d_1,input=s_4,output=s_1(keys=`a`,selects=`a, sum(b) as partial_0`)");
+
+    // without tiers the plan keeps the two fixed sides
+    planner->setTiers({});
+    plan = planner->plan(parser->parse("SELECT a, sum(b) as s FROM t1 GROUP BY a"));
+    EXPECT_TRUE(plan->getTiers().empty());
+    EXPECT_EQ(plan->getEdgePlan().size(), 2);
+}
+
+// ========== UploadCut ==========
+TEST(SqlDistributedPlannerTest, UploadCut) {
+    SqlQueryParser parser;
+    SqlDistributedPlanner planner;
+
+    // computing the shared expression on the edge would widen every uploaded row
+    std::shared_ptr<SqlDistributedPlan> plan = planner.plan(parser.parse("SELECT a, count(distinct abs(b)) as n, max(abs(b)) as m FROM t1 GROUP BY a"));
+    ASSERT_EQ(plan->getEdgePlan().size(), 1);
+    ASSERT_EQ(plan->getCloudPlan().size(), 2);
+    EXPECT_EQ(plan->getCloudPlan()[0], "Project?id=d_1,input=s_0,output=s_1(selects=`*, abs(b) as cse_0`)");
+    EXPECT_DOUBLE_EQ(plan->getCloudEstimates()[0].getWidth(), SqlCostEstimator::DEFAULT_ROW_WIDTH + SqlCostEstimator::DEFAULT_COLUMN_WIDTH);
+    // every input row is uploaded at the default rate
+    EXPECT_DOUBLE_EQ(plan->getUploadBytesPerSecond(), SqlCostEstimator::DEFAULT_ROW_WIDTH * SqlCostEstimator::DEFAULT_ROW_RATE);
+
+    // a selective filter behind the projection makes the pair worth keeping on the edge
+    plan = planner.plan(parser.parse("SELECT a, count(distinct abs(b)) as n, max(abs(b)) as m FROM t1 WHERE abs(b) > 3 GROUP BY a"));
+    ASSERT_EQ(plan->getEdgePlan().size(), 3);
+    EXPECT_EQ(plan->getEdgePlan()[1], "Project?id=d_1,input=s_0,output=s_1(selects=`*, abs(b) as cse_0`)");
+    EXPECT_LT(plan->getUploadBytesPerSecond(), SqlCostEstimator::DEFAULT_ROW_WIDTH * SqlCostEstimator::DEFAULT_ROW_RATE);
+
+    // the rate comes from the statistics
+    std::shared_ptr<LocalStatisticsCatalog> catalog = std::make_shared<LocalStatisticsCatalog>();
+    catalog->parse("table t1 rows=100000 width=32 rate=50");
+    EXPECT_DOUBLE_EQ(catalog->getTableStatistics("t1")->getRate(), 50);
+    planner.setStatisticsCatalog(catalog);
+    plan = planner.plan(parser.parse("SELECT a, count(distinct speed) as n FROM t1 GROUP BY a"));
+    EXPECT_DOUBLE_EQ(plan->getUploadBytesPerSecond(), 32 * 50);
+
+    // an edge join whose build side exceeds the edge memory moves to the cloud with its inputs uploaded
+    planner.setStatisticsCatalog(nullptr);
+    planner.setEdgeMemoryBudget(64 * 1024);
+    plan = planner.plan(parser.parse("SELECT o.id, c.name FROM orders o JOIN customers c ON o.cid = c.id"));
+    ASSERT_EQ(plan->getEdgePlan().size(), 2);
+    ASSERT_EQ(plan->getCloudPlan().size(), 1);
+    EXPECT_EQ(plan->getCloudPlan()[0].rfind("ReduceJoin?id=d_2,input=s_0,input2=s_1,", 0), 0);
+    EXPECT_DOUBLE_EQ(plan->getUploadBytesPerSecond(), 2 * SqlCostEstimator::DEFAULT_ROW_WIDTH * SqlCostEstimator::DEFAULT_ROW_RATE);
+
+    // results of an edge-only plan are uploaded as they are produced
+    planner.setEdgeMemoryBudget(-1);
+    plan = planner.plan(parser.parse("SELECT a, b FROM t1"));
+    EXPECT_EQ(plan->getCloudPlan().size(), 0);
+    EXPECT_DOUBLE_EQ(plan->getUploadBytesPerSecond(), 2 * SqlCostEstimator::DEFAULT_COLUMN_WIDTH * SqlCostEstimator::DEFAULT_ROW_RATE);
+
+    // an input planned after the switch-over is pulled back to the edge with the filter that shrinks it
+    plan = planner.plan(parser.parse("SELECT x.a, t.c FROM (SELECT a, count(distinct b) as n FROM s GROUP BY a) x JOIN t ON x.a = t.a WHERE t.speed > 100"));
+    EXPECT_EQ(plan->getEdgePlan(), std::vector<std::string>({
+        "Input?id=d_0,output=s_0(name=`s`)",
+        "Input?id=d_2,output=s_2(name=`t`)",
+        "Filter?id=d_3,input=s_2,output=s_3(condition=`speed > 100`)"}));
+    ASSERT_EQ(plan->getCloudPlan().size(), 2);
+    EXPECT_EQ(plan->getCloudPlan()[1].rfind("ReduceJoin?id=d_4,input=s_1,input2=s_3,", 0), 0);
+    // s is uploaded whole and t after the filter, both at the default rate
+    EXPECT_DOUBLE_EQ(plan->getUploadBytesPerSecond(),
+                     SqlCostEstimator::DEFAULT_ROW_WIDTH * SqlCostEstimator::DEFAULT_ROW_RATE * (1 + SqlCostEstimator::DEFAULT_RANGE_SELECTIVITY));
+
+    // without a filter the input stays in the cloud and is still counted as uploaded
+    plan = planner.plan(parser.parse("SELECT x.a, t.c FROM (SELECT a, count(distinct b) as n FROM s GROUP BY a) x JOIN t ON x.a = t.a"));
+    EXPECT_EQ(plan->getEdgePlan().size(), 1);
+    EXPECT_DOUBLE_EQ(plan->getUploadBytesPerSecond(), 2 * SqlCostEstimator::DEFAULT_ROW_WIDTH * SqlCostEstimator::DEFAULT_ROW_RATE);
+}
+
+// ========== MultiTierBloomFilter ==========
+TEST(SqlDistributedPlannerTest, MultiTierBloomFilter) {
+    std::shared_ptr<LocalStatisticsCatalog> catalog = std::make_shared<LocalStatisticsCatalog>();
+    catalog->parse(
+        "table orders rows=1000000 width=32\n"
+        "column orders customer ndv=50000\n"
+        "table customers rows=50000 width=64\n"
+        "column customers id ndv=50000\n"
+        "column customers region ndv=10\n");
+    std::shared_ptr<SqlQueryParser> parser = std::make_shared<SqlQueryParser>();
+    std::shared_ptr<SqlDistributedPlanner> planner = std::make_shared<SqlDistributedPlanner>();
+    planner->setStatisticsCatalog(catalog);
+    planner->setBroadcastBudget(0);
+    SqlTierProfile ecu("ecu", 64 * 1024, SqlCpuClass::LOW);
+    SqlTierProfile gateway("gateway", 64 * 1024 * 1024, SqlCpuClass::MEDIUM);
+    SqlTierProfile cloud("cloud", -1, SqlCpuClass::HIGH);
+    planner->setTiers({ecu, gateway, cloud});
+
+    auto plan = planner->plan(parser->parse("SELECT o.id, c.n FROM orders o JOIN (SELECT id, count(*) as n FROM customers WHERE region = 3 GROUP BY id) c ON o.customer = c.id"));
+    ASSERT_EQ(plan->getTierPlans().size(), 3);
+    // the filter built on the cloud is carried down tier by tier to the ECU that probes with it
+    EXPECT_EQ(plan->getTierPlans().at(0).at(4), "BloomFilter?id=d_6,input=s_0,output=s_6(bloom=`s_11`,keys=`customer`)");
+    EXPECT_EQ(plan->getTierPlans().at(1).at(2), "Exchange?id=d_11,input=s_10,output=s_11(from=`gateway`,to=`ecu`)");
+    EXPECT_EQ(plan->getTierPlans().at(2).at(1).rfind("BloomBuild?id=d_5,input=s_4,output=s_5(", 0), 0);
+    EXPECT_EQ(plan->getTierPlans().at(2).at(2), "Exchange?id=d_10,input=s_5,output=s_10(from=`cloud`,to=`gateway`)");
+    EXPECT_EQ(plan->getTierPlans().at(2).at(3).rfind("ReduceJoin?id=d_7,input=s_13,input2=s_4,", 0), 0);
+
+    // every spool a step reads is written by some step of the tier plans
+    std::set<std::string> written;
+    for(const std::vector<std::string>& steps : plan->getTierPlans()){
+        for(const std::string& step : steps){
+            written.insert(step.substr(step.find(",output=s_") + 8, step.find('(') - step.find(",output=s_") - 8));
+        }
+    }
+    for(const std::vector<std::string>& steps : plan->getTierPlans()){
+        for(const std::string& step : steps){
+            for(const std::string key : {",input=s_", ",input2=s_", "bloom=`s_"}){
+                const size_t idx = step.find(key);
+                if(idx != std::string::npos){
+                    const size_t begin = idx + key.size() - 2;
+                    EXPECT_EQ(written.count(step.substr(begin, step.find_first_of(",(`", begin) - begin)), 1) << step;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "../include/SqlJoinOrderer.h"
+
+TEST(SqlJoinOrdererTest, Chain) {
+    // a - b - c, where b joins c into very few rows
+    SqlJoinOrderer orderer({1000, 100, 10});
+    orderer.addPredicate(0, 1, 0.01);
+    orderer.addPredicate(1, 2, 0.001);
+
+    std::vector<int> order = orderer.order();
+    EXPECT_EQ(order, std::vector<int>({1, 2, 0}));
+    EXPECT_DOUBLE_EQ(orderer.cost(order), 1 + 10);
+    EXPECT_LT(orderer.cost(order), orderer.cost({0, 1, 2}));
+}
+
+TEST(SqlJoinOrdererTest, AvoidsCrossProducts) {
+    // a and c are small but not connected, so they are only joined through b
+    SqlJoinOrderer orderer({10, 100000, 10});
+    orderer.addPredicate(0, 1, 0.0001);
+    orderer.addPredicate(1, 2, 0.0001);
+
+    std::vector<int> order = orderer.order();
+    ASSERT_EQ(order.size(), 3);
+    EXPECT_NE(order[2], 1);
+    EXPECT_EQ(order[0], 1);
+}
+
+TEST(SqlJoinOrdererTest, Disconnected) {
+    // nothing connects c, so it is joined last as a cross product
+    SqlJoinOrderer orderer({100, 100, 5});
+    orderer.addPredicate(0, 1, 0.01);
+
+    std::vector<int> order = orderer.order();
+    ASSERT_EQ(order.size(), 3);
+    EXPECT_EQ(order[2], 2);
+    EXPECT_DOUBLE_EQ(orderer.cost(order), 100 + 500);
+}
+
+TEST(SqlJoinOrdererTest, Greedy) {
+    // a star around relation 0, too many relations for the exhaustive search
+    std::vector<double> rows = {1000000};
+    for(int i = 1;i <= SqlJoinOrderer::DP_LIMIT + 2;++i){
+        rows.push_back(i * 10);
+    }
+    SqlJoinOrderer orderer(rows);
+    for(int i = 1;i < static_cast<int>(rows.size());++i){
+        orderer.addPredicate(0, i, 1.0 / (i * 10));
+    }
+
+    std::vector<int> order = orderer.order();
+    ASSERT_EQ(order.size(), rows.size());
+    EXPECT_EQ(order[0], 0);
+    std::vector<int> sorted = order;
+    std::sort(sorted.begin(), sorted.end());
+    for(int i = 0;i < static_cast<int>(sorted.size());++i){
+        EXPECT_EQ(sorted[i], i);
+    }
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "../include/SqlPredicateSimplifier.h"
+
+TEST(SqlPredicateSimplifierTest, ConstantFolding) {
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("speed > 60 + 20"), "speed > 80");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("speed > 2 * (30 + 10) - 1"), "speed > 79");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("speed > 1.5 * 2"), "speed > 3");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("speed > 7 / 2"), "speed > 7 / 2");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("speed > -(3 + 2)"), "speed > -5");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a + 1 + 2 > 0"), "a + 1 + 2 > 0");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("abs(a - 2 * 3) < 10"), "abs(a - 6) < 10");
+    // folded doubles keep every digit needed to read back the same value
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("speed > 0.1 + 0.2"), "speed > 0.30000000000000004");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("speed > 0.25 + 0.5"), "speed > 0.75");
+}
+
+TEST(SqlPredicateSimplifierTest, Tautology) {
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("1 = 1 and speed > 60 + 20"), "speed > 80");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("true and (a > 1 or b < 2)"), "a > 1 or b < 2");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a > 1 or 2 > 1"), "true");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("'k' = 'k'"), "true");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("3 between 1 and 5 and a = 1"), "a = 1");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("3 in (1, 2, 3)"), "true");
+    EXPECT_TRUE(SqlPredicateSimplifier::isAlwaysTrue(SqlPredicateSimplifier::simplify("TRUE")));
+}
+
+TEST(SqlPredicateSimplifierTest, Contradiction) {
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("1 = 2 and a > 1"), "false");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a > 5 and a < 3"), "false");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a > 5 and a <= 5"), "false");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a = 1 and b > 0 and a = 2"), "false");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("d == 'k' and d == 'j'"), "false");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a > 1 and not a > 1"), "false");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a between 10 and 5"), "false");
+    // bounds against the same column shifted by constants
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("t.ts >= s.ts + 50 and t.ts <= s.ts - 50"), "false");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("t.ts > s.ts and t.ts < s.ts"), "false");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("t.ts between s.ts + 10 and s.ts - 10"), "false");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("t.ts >= s.ts - 50 and t.ts <= s.ts + 50"), "t.ts >= s.ts - 50 and t.ts <= s.ts + 50");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("t.ts >= s.ts + 50 and t.ts <= u.ts - 50"), "t.ts >= s.ts + 50 and t.ts <= u.ts - 50");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a >= 5 and a <= 5"), "a >= 5 and a <= 5");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a > 5 or a < 3"), "a > 5 or a < 3");
+    EXPECT_TRUE(SqlPredicateSimplifier::isAlwaysFalse(SqlPredicateSimplifier::simplify("false or 1 > 2")));
+}
+
+TEST(SqlPredicateSimplifierTest, Normalize) {
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("(a > 1 and (b > 2 and c > 3))"), "a > 1 and b > 2 and c > 3");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a > 1 AND a > 1"), "a > 1");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("60 < speed"), "speed > 60");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("not not a = 1"), "a = 1");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("not (a >= 1)"), "a < 1");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("not a in (1, 2)"), "a not in (1, 2)");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a is not null and not b is null"), "a is not null and b is not null");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("(a = 1 or b = 2) and c = 3"), "(a = 1 or b = 2) and c = 3");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a - (b - c) > 0"), "a - (b - c) > 0");
+}
+
+TEST(SqlPredicateSimplifierTest, Unsupported) {
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a > 5 and a['where'] = 3"), "a > 5 and a['where'] = 3");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("::x -> a and 1 = 1"), "::x -> a and 1 = 1");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify("a > 10s"), "a > 10s");
+    EXPECT_EQ(SqlPredicateSimplifier::simplify(""), "");
+}
@@ -227,6 +227,103 @@ TEST(SqlQueryParserTest, Join) {
     EXPECT_EQ(join->getCondition(), "s.b = t.c");
 }
 
+TEST(SqlQueryParserTest, MultiwayJoin) {
+    SqlQueryParser parser;
+    std::shared_ptr<SqlStatement> stmt;
+
+    // three-way inner join
+    stmt = parser.parse("SELECT s.a, t.b, u.c from s join t on s.a = t.a join u on t.b = u.b");
+    ASSERT_EQ(stmt->getJoins().size(), 2);
+    EXPECT_EQ(stmt->getJoin(), stmt->getJoins()[0]);
+    EXPECT_EQ(stmt->getJoins()[0]->getRelation()->getAlias(), "t");
+    EXPECT_EQ(stmt->getJoins()[0]->getCondition(), "s.a = t.a");
+    EXPECT_EQ(stmt->getJoins()[1]->getRelation()->getAlias(), "u");
+    EXPECT_EQ(stmt->getJoins()[1]->getCondition(), "t.b = u.b");
+
+    // mixed join types and a subquery in the middle of the chain
+    stmt = parser.parse("SELECT s.a, t.b, u.c, v.d from s left join (select * from t2) t on s.a = t.a and s.b > 1 "
+                        "inner join u on t.b = u.b right outer join v v on v.d = s.d");
+    ASSERT_EQ(stmt->getJoins().size(), 3);
+    EXPECT_EQ(XStringUtils::toLowerCase(toString(stmt->getJoins()[0]->getType())), "left");
+    EXPECT_EQ(stmt->getJoins()[0]->getCondition(), "s.a = t.a and s.b > 1");
+    EXPECT_EQ(std::dynamic_pointer_cast<QueryRelation>(stmt->getJoins()[0]->getRelation())->getStatement()->getQuery(), "select * from t2");
+    EXPECT_EQ(XStringUtils::toLowerCase(toString(stmt->getJoins()[1]->getType())), "inner");
+    EXPECT_EQ(XStringUtils::toLowerCase(toString(stmt->getJoins()[2]->getType())), "right");
+    EXPECT_EQ(stmt->getJoins()[2]->getCondition(), "v.d = s.d");
+
+    // the clone keeps the whole chain
+    EXPECT_EQ(stmt->clone()->getJoins().size(), 3);
+
+    try {
+        parser.parse("SELECT s.a from s join t on s.a = t.a join t on s.b = t.b");
+        FAIL() << "Expected StatementParseException: SQL_SYNTAX_DUPLICATE_JOIN_ALIAS: t";
+    } catch (const EngineException& e) {
+        EXPECT_EQ(std::string(e.what()), "SQL_SYNTAX_DUPLICATE_JOIN_ALIAS: t");
+    }
+
+    // where / group by / having / limit may follow the last join
+    stmt = parser.parse("SELECT s.a, count(*) as c from s join t on s.a = t.a join u on t.b = u.b "
+                        "where s.b > 1 and t.c = u.c group by s.a having c > 2 limit 10");
+    ASSERT_EQ(stmt->getJoins().size(), 2);
+    EXPECT_EQ(stmt->getJoins()[1]->getCondition(), "t.b = u.b");
+    EXPECT_EQ(stmt->getWhere(), "s.b > 1 and t.c = u.c");
+    EXPECT_EQ(stmt->getGroupbys(), "s.a");
+    EXPECT_EQ(stmt->getHaving(), "c > 2");
+    EXPECT_EQ(stmt->getLimit(), 10);
+
+    try {
+        parser.parse("SELECT s.a from s join t on s.a = t.a join u on t.b = u.b order by s.a");
+        FAIL() << "Expected StatementParseException: SQL_SYNTAX_INVALID_KEYWORD_PLACEMENT: ORDER";
+    } catch (const EngineException& e) {
+        EXPECT_EQ(std::string(e.what()), "SQL_SYNTAX_INVALID_KEYWORD_PLACEMENT: ORDER");
+    }
+}
+
+TEST(SqlQueryParserTest, AsofJoin) {
+    SqlQueryParser parser;
+    std::shared_ptr<SqlStatement> stmt;
+
+    stmt = parser.parse("SELECT c.ts, g.lat from can c ASOF JOIN gps g ON c.vin = g.vin MATCH_CONDITION(c.ts >= g.ts) where c.speed > 10");
+    ASSERT_EQ(stmt->getJoins().size(), 1);
+    EXPECT_EQ(XStringUtils::toLowerCase(toString(stmt->getJoin()->getType())), "asof");
+    EXPECT_EQ(stmt->getJoin()->getCondition(), "c.vin = g.vin");
+    EXPECT_EQ(stmt->getJoin()->getMatchCondition(), "c.ts >= g.ts");
+    EXPECT_EQ(stmt->getWhere(), "c.speed > 10");
+
+    // an as-of join can follow other joins
+    stmt = parser.parse("SELECT c.ts from can c join ev e on c.vin = e.vin asof join gps g on c.vin = g.vin match_condition (g.ts<c.ts)");
+    ASSERT_EQ(stmt->getJoins().size(), 2);
+    EXPECT_EQ(stmt->getJoins()[1]->getMatchCondition(), "g.ts < c.ts");
+
+    try {
+        parser.parse("SELECT c.ts from can c asof join gps g on c.vin > g.vin match_condition(c.ts >= g.ts)");
+        FAIL() << "Expected StatementParseException: SQL_SYNTAX_INVALID_ASOF_JOIN_KEY: c.vin > g.vin";
+    } catch (const EngineException& e) {
+        EXPECT_EQ(std::string(e.what()), "SQL_SYNTAX_INVALID_ASOF_JOIN_KEY: c.vin > g.vin");
+    }
+
+    try {
+        parser.parse("SELECT c.ts from can c asof join gps g on c.vin = g.vin match_condition(c.ts >= c.te)");
+        FAIL() << "Expected StatementParseException: SQL_SYNTAX_INVALID_MATCH_CONDITION: (c.ts >= c.te)";
+    } catch (const EngineException& e) {
+        EXPECT_EQ(std::string(e.what()), "SQL_SYNTAX_INVALID_MATCH_CONDITION: (c.ts >= c.te)");
+    }
+
+    try {
+        parser.parse("SELECT c.ts from can c asof join gps g on c.vin = g.vin");
+        FAIL() << "Expected StatementParseException: SQL_SYNTAX_MISSING_MATCH_CONDITION_AFTER_ASOF_JOIN_ON";
+    } catch (const EngineException& e) {
+        EXPECT_EQ(std::string(e.what()), "SQL_SYNTAX_MISSING_MATCH_CONDITION_AFTER_ASOF_JOIN_ON");
+    }
+
+    try {
+        parser.parse("SELECT c.ts from can c join gps g on c.vin = g.vin match_condition(c.ts >= g.ts)");
+        FAIL() << "Expected EngineException: SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: match_condition";
+    } catch (const EngineException& e) {
+        EXPECT_EQ(std::string(e.what()), "SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: match_condition");
+    }
+}
+
 TEST(SqlQueryParserTest, Window) {
     SqlQueryParser parser;
     std::shared_ptr<SqlStatement> stmt;
@@ -767,18 +864,25 @@ TEST(SqlQueryParserTest, AliasNamingError) {
 
 TEST(SqlQueryParserTest, TestJoinUnsupportedKeywords) {
     SqlQueryParser parser;
+    std::shared_ptr<SqlStatement> stmt;
+
+    stmt = parser.parse("SELECT s.a, s.b, t.c from s left join t on s.b = t.b where s.b = 3");
+    EXPECT_EQ(stmt->getWhere(), "s.b = 3");
+
+    stmt = parser.parse("select * from (SELECT s.a, count(*) as c from s left join t on s.b = t.b group by s.a) t");
+    EXPECT_EQ(std::dynamic_pointer_cast<QueryRelation>(stmt->getFrom())->getStatement()->getGroupbys(), "s.a");
 
     try {
-        parser.parse("SELECT s.a, s.b, t.c from s left join t on s.b = t.b where s.b = 3");
-        FAIL() << "Expected EngineException: SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: where";
+        parser.parse("SELECT s.a, s.b, t.c from s left join t on s.b = t.b window over (sliding on 20)");
+        FAIL() << "Expected EngineException: SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: window";
     } catch (const EngineException& e) {
-        EXPECT_EQ(std::string(e.what()), "SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: where");
+        EXPECT_EQ(std::string(e.what()), "SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: window");
     }
 
     try {
-        parser.parse("select * from (SELECT s.a, s.b, t.c from s left join t on s.b = t.b group by s.a) t");
-        FAIL() << "Expected EngineException: SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: group";
+        parser.parse("SELECT s.a, s.b, t.c from s join t on s.b = t.b where s.a > 1 session over (sliding on 20)");
+        FAIL() << "Expected EngineException: SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: session";
     } catch (const EngineException& e) {
-        EXPECT_EQ(std::string(e.what()), "SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: group");
+        EXPECT_EQ(std::string(e.what()), "SQL_SYNTAX_WORDS_AFTER_JOIN_NOT_YET_SUPPORTED: session");
     }
 }
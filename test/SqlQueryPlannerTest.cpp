@@ -99,10 +99,9 @@ TEST(SqlQueryPlannerTest, Subquery) {
 
     stmt = parser.parse("select a, b from (select a, b, c from t1) t ");
     plan = planner.plan(stmt)->getPlan();
-    ASSERT_EQ(plan.size(), 3);
+    ASSERT_EQ(plan.size(), 2);
     EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`t1`)");
-    EXPECT_EQ(plan[1], "Project?id=d_1,input=s_0,output=s_1(selects=`a, b, c`)");
-    EXPECT_EQ(plan[2], "Project?id=d_2,input=s_1,output=s_2(selects=`a, b`)");
+    EXPECT_EQ(plan[1], "Project?id=d_1,input=s_0,output=s_1(selects=`a, b`)");
 
     stmt = parser.parse("select a, b, c from (select a, b, c from t1) t ");
     plan = planner.plan(stmt)->getPlan();
@@ -112,11 +111,9 @@ TEST(SqlQueryPlannerTest, Subquery) {
 
     stmt = parser.parse("select a, b from (select a, b, c from t1) t limit 1000");
     plan = planner.plan(stmt)->getPlan();
-    ASSERT_EQ(plan.size(), 4);
-    EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`t1`)");
-    EXPECT_EQ(plan[1], "Project?id=d_1,input=s_0,output=s_1(selects=`a, b, c`)");
-    EXPECT_EQ(plan[2], "Project?id=d_2,input=s_1,output=s_2(selects=`a, b`)");
-    EXPECT_EQ(plan[3], "Take?id=d_3,input=s_2,output=s_3(rows=`1000`)");
+    ASSERT_EQ(plan.size(), 2);
+    EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(limit_count=`1000`,max_num_readers=`1`,name=`t1`)");
+    EXPECT_EQ(plan[1], "Project?id=d_1,input=s_0,output=s_1(selects=`a, b`)");
 
     stmt = parser.parse(""
                  "SELECT time, sig\n"
@@ -141,12 +138,11 @@ TEST(SqlQueryPlannerTest, Subquery) {
                  "  FROM  (select a, b, c, d from t1) t "
                  "  WHERE d == 'k' and c > 3");
     plan = planner.plan(stmt)->getPlan();
-    EXPECT_EQ(plan.size(), 5);
+    EXPECT_EQ(plan.size(), 4);
     EXPECT_EQ(plan.at(0), "Input?id=d_0,output=s_0(name=`t1`)");
-    EXPECT_EQ(plan.at(1), "Project?id=d_1,input=s_0,output=s_1(selects=`a, b, c, d`)");
-    EXPECT_EQ(plan.at(2), "Filter?id=d_2,input=s_1,output=s_2(condition=`d == 'k' and c > 3`)");
-    EXPECT_EQ(plan.at(3), "Project?id=d_3,input=s_2,output=s_3(selects=`a, b, c`)");
-    EXPECT_EQ(plan.at(4), "Output?id=d_4,input=s_3(name=`t2`)");
+    EXPECT_EQ(plan.at(1), "Filter?id=d_1,input=s_0,output=s_1(condition=`d == 'k' and c > 3`)");
+    EXPECT_EQ(plan.at(2), "Project?id=d_2,input=s_1,output=s_2(selects=`a, b, c`)");
+    EXPECT_EQ(plan.at(3), "Output?id=d_3,input=s_2(name=`t2`)");
     
     //full subquery test case with into, where, having, group by
     stmt = parser.parse(
@@ -160,17 +156,181 @@ TEST(SqlQueryPlannerTest, Subquery) {
              "HAVING b > 100"
             );
     plan = planner.plan(stmt)->getPlan();
-    EXPECT_EQ(plan.size(), 7);
+    EXPECT_EQ(plan.size(), 5);
     EXPECT_EQ(plan.at(0), "Input?id=d_0,output=s_0(name=`t1`)");
-    EXPECT_EQ(plan.at(1), "Filter?id=d_1,input=s_0,output=s_1(condition=`b > 5`)");
-    EXPECT_EQ(plan.at(2), "Project?id=d_2,input=s_1,output=s_2(selects=`a, b, c`)");
-    EXPECT_EQ(plan.at(3), "Filter?id=d_3,input=s_2,output=s_3(condition=`a = 4`)");
-    EXPECT_EQ(plan.at(4), "GroupBy?id=d_4,input=s_3,output=s_4(keys=`a`,selects=`a, sum(b) as b`)");
-    EXPECT_EQ(plan.at(5), "Filter?id=d_5,input=s_4,output=s_5(condition=`b > 100`)");
-    EXPECT_EQ(plan.at(6), "Output?id=d_6,input=s_5(name=`t2`)");
+    EXPECT_EQ(plan.at(1), "Filter?id=d_1,input=s_0,output=s_1(condition=`b > 5 and a = 4`)");
+    EXPECT_EQ(plan.at(2), "GroupBy?id=d_2,input=s_1,output=s_2(keys=`a`,selects=`a, sum(b) as b`)");
+    EXPECT_EQ(plan.at(3), "Filter?id=d_3,input=s_2,output=s_3(condition=`b > 100`)");
+    EXPECT_EQ(plan.at(4), "Output?id=d_4,input=s_3(name=`t2`)");
+
+}
+
+TEST(SqlQueryPlannerTest, ViewMerging) {
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    std::shared_ptr<SqlStatement> stmt;
+    std::vector<std::string> plan;
+
+    // three generated levels collapse into one pipeline
+    stmt = parser.parse(
+        "SELECT x, y FROM ("
+        "  SELECT a as x, b * 2 as y, c FROM ("
+        "    SELECT a, b, c FROM t1 WHERE c > 0"
+        "  ) s"
+        ") t WHERE t.x < 5 or c = 2");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`t1`)");
+    EXPECT_EQ(plan[1], "Filter?id=d_1,input=s_0,output=s_1(condition=`c > 0 and (a < 5 or c = 2)`)");
+    EXPECT_EQ(plan[2], "Project?id=d_2,input=s_1,output=s_2(selects=`a as x, (b * 2) as y`)");
+
+    // outer filter over an inner group by becomes having
+    stmt = parser.parse("SELECT * FROM (SELECT a, sum(b) as b FROM t1 GROUP BY a HAVING b > 3) t WHERE t.a != 7");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`t1`)");
+    EXPECT_EQ(plan[1], "GroupBy?id=d_1,input=s_0,output=s_1(keys=`a`,selects=`a, sum(b) as b`)");
+    EXPECT_EQ(plan[2], "Filter?id=d_2,input=s_1,output=s_2(condition=`b > 3 and a != 7`)");
+
+    stmt = parser.parse("SELECT b FROM (SELECT a, sum(b) as b FROM t1 GROUP BY a) t WHERE a != 7");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 4);
+    EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`t1`)");
+    EXPECT_EQ(plan[1], "GroupBy?id=d_1,input=s_0,output=s_1(keys=`a`,selects=`a, sum(b) as b`)");
+    EXPECT_EQ(plan[2], "Filter?id=d_2,input=s_1,output=s_2(condition=`a != 7`)");
+    EXPECT_EQ(plan[3], "Project?id=d_3,input=s_2,output=s_3(selects=`b`)");
+
+    // group by over a renaming projection keeps the subquery
+    stmt = parser.parse("SELECT x, sum(y) as y FROM (SELECT a as x, b as y FROM t1) t GROUP BY x HAVING y > 1");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 4);
+    EXPECT_EQ(plan[1], "Project?id=d_1,input=s_0,output=s_1(selects=`a as x, b as y`)");
+
+    // a global aggregate without group by is not a projection, the outer filter stays above it
+    stmt = parser.parse("SELECT * FROM (SELECT sum(b) as sb FROM s) x WHERE x.sb > 50");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`s`)");
+    EXPECT_EQ(plan[1], "Project?id=d_1,input=s_0,output=s_1(selects=`sum(b) as sb`)");
+    EXPECT_EQ(plan[2], "Filter?id=d_2,input=s_1,output=s_2(condition=`x.sb > 50`)");
+}
+
+
+TEST(SqlQueryPlannerTest, PredicateSimplification) {
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    std::shared_ptr<SqlStatement> stmt;
+    std::vector<std::string> plan;
 
+    stmt = parser.parse("SELECT a, speed FROM t1 WHERE 1 = 1 and speed > 60 + 20");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[1], "Filter?id=d_1,input=s_0,output=s_1(condition=`speed > 80`)");
+
+    stmt = parser.parse("SELECT * FROM t1 WHERE true and 2 > 1");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 1);
+    EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`t1`)");
+
+    stmt = parser.parse("INSERT INTO t2 SELECT a, sum(b) as b FROM t1 WHERE a > 5 and a < 3 GROUP BY a");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 2);
+    EXPECT_EQ(plan[0], "Empty?id=d_0,output=s_0(selects=`a, sum(b) as b`)");
+    EXPECT_EQ(plan[1], "Output?id=d_1,input=s_0(name=`t2`)");
+
+    // an always-empty subquery empties the whole pipeline
+    stmt = parser.parse("SELECT a, sum(b) as b FROM (SELECT a, b FROM t1 WHERE 1 > 2) t GROUP BY a HAVING b > 3");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 1);
+    EXPECT_EQ(plan[0], "Empty?id=d_0,output=s_0(selects=`a, sum(b) as b`)");
+
+    // a global aggregate still returns one row over no input
+    stmt = parser.parse("SELECT count(*) as n, sum(b) as s FROM t1 WHERE 1 = 0");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[1], "Filter?id=d_1,input=s_0,output=s_1(condition=`false`)");
+    stmt = parser.parse("SELECT count(*) as n FROM (SELECT a, b FROM t1 WHERE 1 > 2) t");
+    EXPECT_NE(planner.plan(stmt)->getPlan().back().rfind("Empty?",0), 0);
 }
 
+TEST(SqlQueryPlannerTest, CommonSubexpression) {
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    std::shared_ptr<SqlStatement> stmt;
+    std::shared_ptr<SqlPlan> result;
+    std::vector<std::string> plan;
+
+    stmt = parser.parse("SELECT json_extract(payload,'$.gps.lat') as lat, b FROM t1 WHERE json_extract(payload, '$.gps.lat') > 30");
+    result = planner.plan(stmt);
+    plan = result->getPlan();
+    ASSERT_EQ(plan.size(), 4);
+    EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`t1`)");
+    EXPECT_EQ(plan[1], "Project?id=d_1,input=s_0,output=s_1(selects=`*, json_extract(payload, '$.gps.lat') as cse_0`)");
+    EXPECT_EQ(plan[2], "Filter?id=d_2,input=s_1,output=s_2(condition=`cse_0 > 30`)");
+    EXPECT_EQ(plan[3], "Project?id=d_3,input=s_2,output=s_3(selects=`cse_0 as lat, b`)");
+    ASSERT_EQ(result->getDiagnostics().size(), 1);
+    EXPECT_EQ(result->getDiagnostics()[0], "cse_eliminated_evaluations=1");
+
+    stmt = parser.parse("SELECT a, avg(abs(b - c)) as d FROM t1 WHERE abs(b - c) > 1 GROUP BY a HAVING avg(abs(b - c)) > 5");
+    result = planner.plan(stmt);
+    plan = result->getPlan();
+    ASSERT_EQ(plan.size(), 5);
+    EXPECT_EQ(plan[1], "Project?id=d_1,input=s_0,output=s_1(selects=`*, abs(b - c) as cse_0`)");
+    EXPECT_EQ(plan[2], "Filter?id=d_2,input=s_1,output=s_2(condition=`cse_0 > 1`)");
+    EXPECT_EQ(plan[3], "GroupBy?id=d_3,input=s_2,output=s_3(keys=`a`,selects=`a, avg(cse_0) as d`)");
+    EXPECT_EQ(plan[4], "Filter?id=d_4,input=s_3,output=s_4(condition=`d > 5`)");
+    ASSERT_EQ(result->getDiagnostics().size(), 1);
+    EXPECT_EQ(result->getDiagnostics()[0], "cse_eliminated_evaluations=2");
+
+    // unaliased select items keep their engine generated names
+    stmt = parser.parse("SELECT abs(b), c FROM t1 WHERE abs(b) > 1");
+    result = planner.plan(stmt);
+    plan = result->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[1], "Filter?id=d_1,input=s_0,output=s_1(condition=`abs(b) > 1`)");
+    EXPECT_TRUE(result->getDiagnostics().empty());
+
+    // expressions the filter does not use are computed on the surviving rows only
+    stmt = parser.parse("SELECT abs(b) as x, abs(b) + 1 as y FROM s WHERE a > 2");
+    result = planner.plan(stmt);
+    plan = result->getPlan();
+    ASSERT_EQ(plan.size(), 4);
+    EXPECT_EQ(plan[1], "Filter?id=d_1,input=s_0,output=s_1(condition=`a > 2`)");
+    EXPECT_EQ(plan[2], "Project?id=d_2,input=s_1,output=s_2(selects=`*, abs(b) as cse_0`)");
+    EXPECT_EQ(plan[3], "Project?id=d_3,input=s_2,output=s_3(selects=`cse_0 as x, cse_0 + 1 as y`)");
+
+    stmt = parser.parse("SELECT sqrt(b - 15) as r, sqrt(b - 15) * 2 as d, abs(a) as x FROM s WHERE abs(a) < 3 and b > 15");
+    result = planner.plan(stmt);
+    plan = result->getPlan();
+    ASSERT_EQ(plan.size(), 5);
+    EXPECT_EQ(plan[1], "Project?id=d_1,input=s_0,output=s_1(selects=`*, abs(a) as cse_1`)");
+    EXPECT_EQ(plan[2], "Filter?id=d_2,input=s_1,output=s_2(condition=`cse_1 < 3 and b > 15`)");
+    EXPECT_EQ(plan[3], "Project?id=d_3,input=s_2,output=s_3(selects=`*, sqrt(b - 15) as cse_0`)");
+    EXPECT_EQ(plan[4], "Project?id=d_4,input=s_3,output=s_4(selects=`cse_0 as r, cse_0 * 2 as d, cse_1 as x`)");
+
+    // a call after a guarding and / or operand may be skipped, so it stays in the condition
+    stmt = parser.parse("SELECT sqrt(b - 15) as r, sqrt(b - 15) * 2 as d, abs(a) as x FROM s WHERE b > 15 and sqrt(b - 15) > 2 and abs(a) < 3");
+    result = planner.plan(stmt);
+    plan = result->getPlan();
+    ASSERT_EQ(plan.size(), 4);
+    EXPECT_EQ(plan[1], "Filter?id=d_1,input=s_0,output=s_1(condition=`b > 15 and sqrt(b - 15) > 2 and abs(a) < 3`)");
+    EXPECT_EQ(plan[2], "Project?id=d_2,input=s_1,output=s_2(selects=`*, sqrt(b - 15) as cse_0`)");
+    EXPECT_EQ(plan[3], "Project?id=d_3,input=s_2,output=s_3(selects=`cse_0 as r, cse_0 * 2 as d, abs(a) as x`)");
+
+    // the and of a between does not guard anything
+    stmt = parser.parse("SELECT abs(a) as x FROM s WHERE b between 0 and abs(a)");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 4);
+    EXPECT_EQ(plan[1], "Project?id=d_1,input=s_0,output=s_1(selects=`*, abs(a) as cse_0`)");
+    EXPECT_EQ(plan[2], "Filter?id=d_2,input=s_1,output=s_2(condition=`b between 0 and cse_0`)");
+
+    // calls inside case branches are only evaluated when their branch is taken
+    stmt = parser.parse("SELECT case when b > 15 then sqrt(b - 15) else 0 end as r, case when b > 15 then sqrt(b - 15) end as d FROM s");
+    result = planner.plan(stmt);
+    plan = result->getPlan();
+    ASSERT_EQ(plan.size(), 2);
+    EXPECT_TRUE(result->getDiagnostics().empty());
+}
 
 TEST(SqlQueryPlannerTest, Window) {
     SqlQueryParser parser;
@@ -184,7 +344,15 @@ TEST(SqlQueryPlannerTest, Window) {
     plan = planner.plan(stmt)->getPlan();
     ASSERT_EQ(plan.size(), 2);
     EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`t`)");
-    EXPECT_EQ(plan[1], "SlidingWindow?id=d_1,input=s_0,output=s_1(inclusion=`20`,selects=`time, wsum('b') as b`,validity=`wsize() == 20`)");
+    EXPECT_EQ(plan[1], "SlidingWindow?id=d_1,input=s_0,output=s_1(aggregations=`wsum('b'):subtract`,inclusion=`20`,selects=`time, wsum('b') as b`,validity=`wsize() == 20`)");
+
+    stmt = parser.parse(
+        "SELECT time, wmax('b') as hi, wavg( 'b' ) as mean, wmax('b') - wmin('b') as spread, wlag('b') as b from t "
+        "WINDOW OVER (SLIDING ON 10 HAVING wsize() > 1 )");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 2);
+    EXPECT_EQ(plan[1], "SlidingWindow?id=d_1,input=s_0,output=s_1(aggregations=`wmax('b'):two_stacks, wavg('b'):subtract, wmin('b'):two_stacks`,"
+                       "inclusion=`10`,selects=`time, wmax('b') as hi, wavg( 'b' ) as mean, wmax('b') - wmin('b') as spread, wlag('b') as b`,validity=`wsize() > 1`)");
 
     stmt = parser.parse(
         "SELECT time, wsum('b') as b from t "
@@ -263,6 +431,92 @@ TEST(SqlQueryPlannerTest, ReduceJoin) {
     EXPECT_EQ(plan[2], "ReduceJoin?id=d_2,input=s_0,input2=s_1,output=s_2(join_type=`left`,left_alias=`s`,lefts=`a,c,e`,right_alias=`t`,rights=`a,b,d`,selects=`s.a, t.b`)");
 } 
 
+TEST(SqlQueryPlannerTest, MultiwayJoin) {
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    std::shared_ptr<SqlStatement> stmt;
+    std::vector<std::string> plan;
+
+    // without statistics every order costs the same, so the written order is kept
+    stmt = parser.parse("SELECT s.a, t.b, u.c from s JOIN t ON s.a = t.a JOIN u ON t.b = u.b");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 5);
+    EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`s`)");
+    EXPECT_EQ(plan[1], "Input?id=d_1,output=s_1(name=`t`)");
+    EXPECT_EQ(plan[2], "Input?id=d_2,output=s_2(name=`u`)");
+    EXPECT_EQ(plan[3], "ReduceJoin?id=d_3,input=s_0,input2=s_1,output=s_3(join_type=`inner`,left_alias=`s`,lefts=`a`,right_alias=`t`,rights=`a`,selects=`*`)");
+    EXPECT_EQ(plan[4], "ReduceJoin?id=d_4,input=s_3,input2=s_2,output=s_4(join_type=`inner`,left_alias=`s,t`,lefts=`t.b`,right_alias=`u`,rights=`b`,selects=`s.a, t.b, u.c`)");
+
+    // a condition written on a later join is checked as soon as both sides are joined,
+    // as a residual next to the equi keys
+    stmt = parser.parse("SELECT s.a, t.b, u.c from s JOIN t ON s.a = t.a JOIN u ON t.b = u.b and s.c = 1");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 5);
+    EXPECT_EQ(plan[3], "ReduceJoin?id=d_3,input=s_0,input2=s_1,output=s_3(join_type=`inner`,left_alias=`s`,lefts=`a`,residual=`s.c = 1`,right_alias=`t`,rights=`a`,selects=`*`)");
+    EXPECT_EQ(plan[4], "ReduceJoin?id=d_4,input=s_3,input2=s_2,output=s_4(join_type=`inner`,left_alias=`s,t`,lefts=`t.b`,right_alias=`u`,rights=`b`,selects=`s.a, t.b, u.c`)");
+
+    // outer joins keep the written order and their own on conditions
+    stmt = parser.parse("SELECT s.a from s LEFT JOIN (select * from t2) t ON s.a = t.a JOIN u ON t.b = u.b and u.c > s.c");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 5);
+    EXPECT_EQ(plan[1], "Input?id=d_1,output=s_1(name=`t2`)");
+    EXPECT_EQ(plan[3], "ReduceJoin?id=d_3,input=s_0,input2=s_1,output=s_3(join_type=`left`,left_alias=`s`,lefts=`a`,right_alias=`t`,rights=`a`,selects=`*`)");
+    EXPECT_EQ(plan[4], "ReduceJoin?id=d_4,input=s_3,input2=s_2,output=s_4(join_type=`inner`,left_alias=`s,t`,lefts=`t.b`,residual=`u.c > s.c`,right_alias=`u`,rights=`b`,selects=`s.a`)");
+}
+
+TEST(SqlQueryPlannerTest, JoinPredicatePushdown) {
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    std::shared_ptr<SqlStatement> stmt;
+    std::vector<std::string> plan;
+
+    // single-side conjuncts go below the join, cross-side conjuncts stay above it
+    stmt = parser.parse("SELECT s.a, t.b from s JOIN t ON s.a = t.a where s.b > 1 and t.c = 'x' and s.d + t.d > 3");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 7);
+    EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`s`)");
+    EXPECT_EQ(plan[1], "Filter?id=d_1,input=s_0,output=s_1(condition=`b > 1`)");
+    EXPECT_EQ(plan[2], "Input?id=d_2,output=s_2(name=`t`)");
+    EXPECT_EQ(plan[3], "Filter?id=d_3,input=s_2,output=s_3(condition=`c = 'x'`)");
+    EXPECT_EQ(plan[4], "ReduceJoin?id=d_4,input=s_1,input2=s_3,output=s_4(join_type=`inner`,left_alias=`s`,lefts=`a`,right_alias=`t`,rights=`a`,selects=`*`)");
+    EXPECT_EQ(plan[5], "Filter?id=d_5,input=s_4,output=s_5(condition=`s.d + t.d > 3`)");
+    EXPECT_EQ(plan[6], "Project?id=d_6,input=s_5,output=s_6(selects=`s.a, t.b`)");
+
+    // the null-supplying side of an outer join is filtered after the join
+    stmt = parser.parse("SELECT s.a, t.b from s LEFT JOIN t ON s.a = t.a where s.b > 1 and t.c = 'x'");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 6);
+    EXPECT_EQ(plan[1], "Filter?id=d_1,input=s_0,output=s_1(condition=`b > 1`)");
+    EXPECT_EQ(plan[2], "Input?id=d_2,output=s_2(name=`t`)");
+    EXPECT_EQ(plan[3], "ReduceJoin?id=d_3,input=s_1,input2=s_2,output=s_3(join_type=`left`,left_alias=`s`,lefts=`a`,right_alias=`t`,rights=`a`,selects=`*`)");
+    EXPECT_EQ(plan[4], "Filter?id=d_4,input=s_3,output=s_4(condition=`t.c = 'x'`)");
+    EXPECT_EQ(plan[5], "Project?id=d_5,input=s_4,output=s_5(selects=`s.a, t.b`)");
+
+    // a top-level or cannot be split
+    stmt = parser.parse("SELECT s.a from s JOIN t ON s.a = t.a where s.b > 1 or t.c = 'x'");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 5);
+    EXPECT_EQ(plan[3], "Filter?id=d_3,input=s_2,output=s_3(condition=`s.b > 1 or t.c = 'x'`)");
+
+    // group by, having and limit follow the join
+    stmt = parser.parse("SELECT t.b, count(*) as n from s JOIN t ON s.a = t.a where s.b > 1 group by t.b having n > 2 limit 5");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 7);
+    EXPECT_EQ(plan[3], "ReduceJoin?id=d_3,input=s_1,input2=s_2,output=s_3(join_type=`inner`,left_alias=`s`,lefts=`a`,right_alias=`t`,rights=`a`,selects=`*`)");
+    EXPECT_EQ(plan[4], "GroupBy?id=d_4,input=s_3,output=s_4(keys=`t.b`,selects=`t.b, count(*) as n`)");
+    EXPECT_EQ(plan[5], "Filter?id=d_5,input=s_4,output=s_5(condition=`n > 2`)");
+    EXPECT_EQ(plan[6], "Take?id=d_6,input=s_5,output=s_6(rows=`5`)");
+
+    // each relation of a multi-way join gets its own filter
+    stmt = parser.parse("SELECT s.a, u.c from s JOIN t ON s.a = t.a JOIN u ON t.b = u.b where u.c > 0 and t.d = 1");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 7);
+    EXPECT_EQ(plan[2], "Filter?id=d_2,input=s_1,output=s_2(condition=`d = 1`)");
+    EXPECT_EQ(plan[4], "Filter?id=d_4,input=s_3,output=s_4(condition=`c > 0`)");
+    EXPECT_EQ(plan[5], "ReduceJoin?id=d_5,input=s_0,input2=s_2,output=s_5(join_type=`inner`,left_alias=`s`,lefts=`a`,right_alias=`t`,rights=`a`,selects=`*`)");
+    EXPECT_EQ(plan[6], "ReduceJoin?id=d_6,input=s_5,input2=s_4,output=s_6(join_type=`inner`,left_alias=`s,t`,lefts=`t.b`,right_alias=`u`,rights=`b`,selects=`s.a, u.c`)");
+}
+
 TEST(SqlQueryPlannerTest, NestedJoin) {
     SqlQueryParser parser;
     SqlQueryPlanner planner;
@@ -276,12 +530,13 @@ TEST(SqlQueryPlannerTest, NestedJoin) {
     EXPECT_EQ(plan[1], "Input?id=d_1,output=s_1(name=`t`)");
     EXPECT_EQ(plan[2], "NestedJoin?id=d_2,input=s_0,input2=s_1,output=s_2(condition=`s.a > t.a`,join_type=`inner`,left_alias=`s`,right_alias=`t`,selects=`s.a, t.b`)");
 
+    // equi keys are hashed and the rest is checked on matched pairs only
     stmt = parser.parse("SELECT s.a, t.b from s LEFT JOIN t ON s.a = t.a and t.b != s.c");
     plan = planner.plan(stmt)->getPlan();
     ASSERT_EQ(plan.size(), 3);
     EXPECT_EQ(plan[0], "Input?id=d_0,output=s_0(name=`s`)");
     EXPECT_EQ(plan[1], "Input?id=d_1,output=s_1(name=`t`)");
-    EXPECT_EQ(plan[2], "NestedJoin?id=d_2,input=s_0,input2=s_1,output=s_2(condition=`s.a = t.a and t.b != s.c`,join_type=`left`,left_alias=`s`,right_alias=`t`,selects=`s.a, t.b`)");
+    EXPECT_EQ(plan[2], "ReduceJoin?id=d_2,input=s_0,input2=s_1,output=s_2(join_type=`left`,left_alias=`s`,lefts=`a`,residual=`t.b != s.c`,right_alias=`t`,rights=`a`,selects=`s.a, t.b`)");
 
     stmt = parser.parse("SELECT s.a, t.b from s LEFT JOIN t ON s.a = t.a or t.b = s.c and t.d = s.e");
     plan = planner.plan(stmt)->getPlan();
@@ -290,6 +545,11 @@ TEST(SqlQueryPlannerTest, NestedJoin) {
     EXPECT_EQ(plan[1], "Input?id=d_1,output=s_1(name=`t`)");
     EXPECT_EQ(plan[2], "NestedJoin?id=d_2,input=s_0,input2=s_1,output=s_2(condition=`s.a = t.a or t.b = s.c and t.d = s.e`,join_type=`left`,left_alias=`s`,right_alias=`t`,selects=`s.a, t.b`)");
 
+    stmt = parser.parse("SELECT s.id, t.ts from s JOIN t ON s.id = t.id and s.ts > t.ts and s.k = t.k");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[2], "ReduceJoin?id=d_2,input=s_0,input2=s_1,output=s_2(join_type=`inner`,left_alias=`s`,lefts=`id,k`,residual=`s.ts > t.ts`,right_alias=`t`,rights=`id,k`,selects=`s.id, t.ts`)");
+
     stmt = parser.parse("SELECT s.a, t.b from s LEFT JOIN t ON s.a = 1");
     plan = planner.plan(stmt)->getPlan();
     ASSERT_EQ(plan.size(), 3);
@@ -297,3 +557,82 @@ TEST(SqlQueryPlannerTest, NestedJoin) {
     EXPECT_EQ(plan[1], "Input?id=d_1,output=s_1(name=`t`)");
     EXPECT_EQ(plan[2], "NestedJoin?id=d_2,input=s_0,input2=s_1,output=s_2(condition=`s.a = 1`,join_type=`left`,left_alias=`s`,right_alias=`t`,selects=`s.a, t.b`)");
 }
+
+TEST(SqlQueryPlannerTest, IntervalJoin) {
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    std::shared_ptr<SqlStatement> stmt;
+    std::vector<std::string> plan;
+
+    // keys partition both sides, the band bounds right_time - left_time
+    stmt = parser.parse("SELECT a.vin, b.code from signals a JOIN alarms b ON a.vin = b.vin and b.ts between a.ts - 5000 and a.ts + 5000");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[2], "IntervalJoin?id=d_2,input=s_0,input2=s_1,output=s_2(join_type=`inner`,left_alias=`a`,left_time=`ts`,lefts=`vin`,lower=`-5000`,right_alias=`b`,right_time=`ts`,rights=`vin`,selects=`a.vin, b.code`,upper=`5000`)");
+
+    // a pair of inclusive bounds written on the left column is turned around
+    stmt = parser.parse("SELECT a.vin from signals a JOIN alarms b ON a.ts >= b.ts - 100 and a.ts <= b.ts and a.x > b.x");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[2], "IntervalJoin?id=d_2,input=s_0,input2=s_1,output=s_2(join_type=`inner`,left_alias=`a`,left_time=`ts`,lower=`0`,residual=`a.x > b.x`,right_alias=`b`,right_time=`ts`,selects=`a.vin`,upper=`100`)");
+
+    // a single bound is unbounded on one side and stays a nested loop
+    stmt = parser.parse("SELECT a.vin from signals a LEFT JOIN alarms b ON b.ts >= a.ts");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[2], "NestedJoin?id=d_2,input=s_0,input2=s_1,output=s_2(condition=`b.ts >= a.ts`,join_type=`left`,left_alias=`a`,right_alias=`b`,selects=`a.vin`)");
+
+    // bounds on different columns do not form a band
+    stmt = parser.parse("SELECT a.vin from signals a JOIN alarms b ON a.vin = b.vin and b.ts >= a.ts and b.te <= a.ts + 10");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[2], "ReduceJoin?id=d_2,input=s_0,input2=s_1,output=s_2(join_type=`inner`,left_alias=`a`,lefts=`vin`,residual=`b.ts >= a.ts and b.te <= a.ts + 10`,right_alias=`b`,rights=`vin`,selects=`a.vin`)");
+
+    // a later join of a chain can be a band join on a qualified left column
+    stmt = parser.parse("SELECT a.vin from s a JOIN t b ON a.k = b.k JOIN u c ON c.ts between b.ts and b.ts + 10");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 5);
+    EXPECT_EQ(plan[4], "IntervalJoin?id=d_4,input=s_3,input2=s_2,output=s_4(join_type=`inner`,left_alias=`a,b`,left_time=`b.ts`,lower=`0`,right_alias=`c`,right_time=`ts`,selects=`a.vin`,upper=`10`)");
+
+    // an inverted band never matches, the inner join is empty
+    stmt = parser.parse("SELECT s.a, t.b from s JOIN t ON s.a = t.a and t.ts >= s.ts + 50 and t.ts <= s.ts - 50");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 1);
+    EXPECT_EQ(plan[0], "Empty?id=d_0,output=s_0(selects=`s.a, t.b`)");
+
+    // a left join still returns its left rows
+    stmt = parser.parse("SELECT s.a, t.b from s LEFT JOIN t ON t.ts >= s.ts + 50 and t.ts <= s.ts - 50");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+}
+
+TEST(SqlQueryPlannerTest, AsofJoin) {
+    SqlQueryParser parser;
+    SqlQueryPlanner planner;
+    std::shared_ptr<SqlStatement> stmt;
+    std::vector<std::string> plan;
+
+    stmt = parser.parse("SELECT c.ts, g.lat from can c ASOF JOIN gps g ON c.vin = g.vin MATCH_CONDITION(c.ts >= g.ts) where c.speed > 10 and g.fix = 1");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 6);
+    EXPECT_EQ(plan[1], "Filter?id=d_1,input=s_0,output=s_1(condition=`speed > 10`)");
+    EXPECT_EQ(plan[3], "AsofJoin?id=d_3,input=s_1,input2=s_2,output=s_3(join_type=`asof`,left_alias=`c`,left_time=`ts`,lefts=`vin`,match=`>=`,right_alias=`g`,right_time=`ts`,rights=`vin`,selects=`*`)");
+    // the matched side may be missing, so its filter stays above the join
+    EXPECT_EQ(plan[4], "Filter?id=d_4,input=s_3,output=s_4(condition=`g.fix = 1`)");
+
+    // the match condition is normalized to left_time match right_time
+    stmt = parser.parse("SELECT c.ts, g.lat from can c ASOF JOIN gps g ON c.vin = g.vin MATCH_CONDITION(g.ts < c.ts)");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 3);
+    EXPECT_EQ(plan[2], "AsofJoin?id=d_2,input=s_0,input2=s_1,output=s_2(join_type=`asof`,left_alias=`c`,left_time=`ts`,lefts=`vin`,match=`>`,right_alias=`g`,right_time=`ts`,rights=`vin`,selects=`c.ts, g.lat`)");
+
+    stmt = parser.parse("SELECT c.ts from can c join ev e on c.vin = e.vin asof join gps g on c.vin = g.vin match_condition(c.ts >= g.ts)");
+    plan = planner.plan(stmt)->getPlan();
+    ASSERT_EQ(plan.size(), 5);
+    EXPECT_EQ(plan[4], "AsofJoin?id=d_4,input=s_3,input2=s_2,output=s_4(join_type=`asof`,left_alias=`c,e`,left_time=`c.ts`,lefts=`c.vin`,match=`>=`,right_alias=`g`,right_time=`ts`,rights=`vin`,selects=`c.ts`)");
+
+    // every left row is kept once
+    SqlQueryPlanner estimated;
+    std::shared_ptr<SqlPlan> asof = estimated.plan(parser.parse("SELECT c.ts from can c asof join gps g on c.vin = g.vin match_condition(c.ts >= g.ts)"));
+    EXPECT_DOUBLE_EQ(asof->getEstimates()[2].getRows(), asof->getEstimates()[0].getRows());
+}